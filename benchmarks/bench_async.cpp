@@ -0,0 +1,193 @@
+/**
+ * @file bench_async.cpp
+ * @brief Blocking vs deferred handlers in front of a slow backend
+ *
+ * Every request waits on a simulated 10 ms backend call. The blocking
+ * route sleeps in the handler, so one server thread tops out near
+ * 100 req/s whatever the concurrency. The async route hands its
+ * HttpResponder to a backend thread that answers when the 10 ms are up,
+ * so throughput should grow with the number of concurrent keep-alive
+ * connections (ideal: connections / 10 ms).
+ * Usage: bench_async [max_connections] [seconds] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+constexpr auto BACKEND_LATENCY = std::chrono::milliseconds(10);
+
+/**
+ * @brief Answers each call once its latency has elapsed, from one thread
+ */
+class SimulatedBackend {
+public:
+	SimulatedBackend() : worker_([this] { run(); }) {}
+
+	~SimulatedBackend() {
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		cv_.notify_one();
+		worker_.join();
+	}
+
+	void call(etp::HttpResponder responder) {
+		{
+			std::lock_guard lock(mutex_);
+			pending_.push({Clock::now() + BACKEND_LATENCY, seq_++, std::move(responder)});
+		}
+		cv_.notify_one();
+	}
+
+private:
+	struct Call {
+		Clock::time_point due;
+		uint64_t seq;
+		etp::HttpResponder responder;
+		bool operator>(const Call& o) const { return due != o.due ? due > o.due : seq > o.seq; }
+	};
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::priority_queue<Call, std::vector<Call>, std::greater<>> pending_;
+	uint64_t seq_ = 0;
+	bool stopping_ = false;
+	std::thread worker_;
+
+	void run() {
+		std::unique_lock lock(mutex_);
+		while (!stopping_) {
+			if (pending_.empty()) {
+				cv_.wait(lock);
+				continue;
+			}
+			auto due = pending_.top().due;
+			if (Clock::now() < due) {
+				cv_.wait_until(lock, due);
+				continue;
+			}
+			auto responder = pending_.top().responder;
+			pending_.pop();
+			lock.unlock();
+			etp::HttpResponse resp;
+			resp.body = "ok";
+			responder.send(std::move(resp));
+			lock.lock();
+		}
+	}
+};
+
+struct Client {
+	etn::Socket<etn::Ip<4>> socket;
+	std::string in;
+};
+
+/// Completed requests per second with `connections` closed-loop keep-alive clients
+static double run_load(uint16_t port, std::string_view path, int connections, double seconds) {
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	std::string request = "GET " + std::string(path) + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	auto send_request = [&](Client& c) {
+		c.socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+	};
+
+	eta::EventLoop loop;
+	std::vector<std::unique_ptr<Client>> clients;
+	uint64_t completed = 0;
+	for (int i = 0; i < connections; ++i) {
+		auto c = std::make_unique<Client>();
+		c->socket.create();
+		if (etherz::core::is_error(c->socket.connect(addr))) break;
+		c->socket.set_nonblocking(true);
+		send_request(*c);
+		auto* raw = c.get();
+		loop.add(c->socket.native_handle(), eta::PollEvent::ReadReady,
+			[&, raw](etn::impl::socket_t, eta::PollEvent) {
+				std::array<uint8_t, 4096> buf{};
+				int n;
+				while ((n = raw->socket.recv(buf)) > 0) raw->in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				// Each response ends with the two-byte body
+				for (auto end = raw->in.find("\r\n\r\nok"); end != std::string::npos; end = raw->in.find("\r\n\r\nok")) {
+					raw->in.erase(0, end + 6);
+					++completed;
+					send_request(*raw);
+				}
+			});
+		clients.push_back(std::move(c));
+	}
+
+	auto start = Clock::now();
+	auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	while (Clock::now() < end) loop.run_once(20);
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	return static_cast<double>(completed) / elapsed;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int max_connections = (argc > 1) ? std::atoi(argv[1]) : 256;
+	double seconds = (argc > 2) ? std::atof(argv[2]) : 2.0;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Async Handler Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	SimulatedBackend backend;
+	etp::HttpServer server;
+	server.get("/blocking", [](const etp::HttpRequest&) {
+		std::this_thread::sleep_for(BACKEND_LATENCY);
+		etp::HttpResponse resp;
+		resp.body = "ok";
+		return resp;
+	});
+	server.get_async("/async", [&](const etp::HttpRequest&, etp::HttpResponder responder) {
+		backend.call(std::move(responder));
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	eta::EventLoop loop;
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	std::print("Backend latency {} ms, one server thread, {:.1f} s per run\n\n",
+		BACKEND_LATENCY.count(), seconds);
+	std::print("{:<12} {:>14} {:>14} {:>14}\n", "connections", "blocking r/s", "async r/s", "ideal r/s");
+	for (int c = 1; c <= max_connections; c *= 4) {
+		double blocking = c <= 16 ? run_load(port, "/blocking", c, seconds) : 0;
+		double deferred = run_load(port, "/async", c, seconds);
+		double ideal = c * 1000.0 / static_cast<double>(BACKEND_LATENCY.count());
+		if (c <= 16) std::print("{:<12} {:>14.0f} {:>14.0f} {:>14.0f}\n", c, blocking, deferred, ideal);
+		else std::print("{:<12} {:>14} {:>14.0f} {:>14.0f}\n", c, "-", deferred, ideal);
+	}
+	std::print("\n(blocking runs above 16 connections are skipped: they stay at ~100 r/s)\n");
+
+	running = false;
+	server_thread.join();
+	return 0;
+}
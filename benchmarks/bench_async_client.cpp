@@ -0,0 +1,126 @@
+/**
+ * @file bench_async_client.cpp
+ * @brief Completing thousands of concurrent requests from one thread with AsyncHttpClient
+ *
+ * An HttpServer runs on its own loop thread. The client thread submits
+ * every request at once on one EventLoop and runs it until the last
+ * callback; max_per_host bounds how many connections that takes, the
+ * rest queue. Latency is from send() to the callback, so it includes the
+ * time spent waiting for a connection. For comparison, the last row sends
+ * the same number of requests with the blocking HttpClient, one at a
+ * time on a pooled connection.
+ * Usage: bench_async_client [requests] [port]
+ */
+
+#include "protocol/http_async_client.hpp"
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+static double percentile(std::vector<double>& v, double q) {
+	if (v.empty()) return 0;
+	auto idx = static_cast<size_t>(q * static_cast<double>(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+	return v[idx];
+}
+
+static void report(const std::string& name, double seconds, std::vector<double>& latencies, size_t failures) {
+	std::print("{:<22} {:>9.1f} {:>10.0f} {:>10.2f} {:>10.2f} {:>8}\n", name, seconds * 1000.0,
+		static_cast<double>(latencies.size()) / seconds, percentile(latencies, 0.50), percentile(latencies, 0.99), failures);
+}
+
+static void run_async(const etp::Url& url, int requests, size_t max_per_host) {
+	eta::EventLoop loop;
+	etp::AsyncHttpClientOptions options;
+	options.max_per_host = max_per_host;
+	options.max_idle_per_host = max_per_host;
+	etp::AsyncHttpClient client(loop, options);
+	std::vector<double> latencies;
+	latencies.reserve(static_cast<size_t>(requests));
+	size_t failures = 0;
+	int done = 0;
+
+	auto start = Clock::now();
+	for (int i = 0; i < requests; ++i) {
+		client.get(url, [&, sent = Clock::now()](etp::AsyncHttpResult res) {
+			++done;
+			if (!res || res->body != "ok") ++failures;
+			latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - sent).count());
+		});
+	}
+	while (done < requests) loop.run_once(50);
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	report(std::format("async  {} conns", max_per_host), seconds, latencies, failures);
+}
+
+static void run_blocking(const etp::Url& url, int requests) {
+	etp::HttpClient client;
+	std::vector<double> latencies;
+	latencies.reserve(static_cast<size_t>(requests));
+	size_t failures = 0;
+	auto start = Clock::now();
+	for (int i = 0; i < requests; ++i) {
+		auto sent = Clock::now();
+		auto res = client.get(url);
+		if (!res || res->body != "ok") ++failures;
+		latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - sent).count());
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	report("blocking  sequential", seconds, latencies, failures);
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int requests = (argc > 1) ? std::atoi(argv[1]) : 10000;
+	auto port = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Async HttpClient Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} requests submitted at once, one client thread\n\n", requests);
+
+	eta::EventLoop server_loop;
+	etp::HttpServer server;
+	server.get("/", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "ok";
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	server.attach(server_loop);
+	std::atomic<bool> running{true};
+	std::thread thread([&] {
+		while (running.load(std::memory_order_relaxed)) server_loop.run_once(50);
+	});
+
+	auto url = etp::Url::parse(std::format("http://127.0.0.1:{}/", port));
+	std::print("{:<22} {:>9} {:>10} {:>10} {:>10} {:>8}\n", "client", "total ms", "req/s", "p50 ms", "p99 ms", "failed");
+	for (size_t conns : {1, 16, 128, 1024}) run_async(url, requests, conns);
+	run_blocking(url, requests);
+
+	running = false;
+	thread.join();
+	server.stop();
+	return 0;
+}
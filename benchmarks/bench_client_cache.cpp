@@ -0,0 +1,196 @@
+/**
+ * @file bench_client_cache.cpp
+ * @brief HttpClient GET latency with and without HttpClientCache, and cache memory per entry
+ *
+ * An HttpServer on an EventLoop thread serves a cacheable document and a
+ * no-cache one with an ETag. Each row times one way of getting the
+ * document: over the network, revalidated with a 304, and as a memory or
+ * disk-tier hit. The disk row alternates two URLs with room in memory for
+ * only one, so every hit maps a spilled entry back in and spills the
+ * other. The last table stores entries straight into a cache and reports
+ * the bytes it accounts per entry next to the process's RSS growth.
+ * Usage: bench_client_cache [requests] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+/// Resident set size in bytes (0 where /proc is unavailable)
+static double rss_bytes() {
+#ifdef _WIN32
+	return 0;
+#else
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	if (!(statm >> pages >> resident)) return 0;
+	return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+static double percentile(std::vector<double>& v, double q) {
+	if (v.empty()) return 0;
+	auto idx = static_cast<size_t>(q * static_cast<double>(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+	return v[idx];
+}
+
+/// Time requests calls of get(i); prints one row of microsecond figures
+static void run(std::string_view name, size_t body, int requests, const std::function<bool(int)>& get) {
+	std::vector<double> us;
+	us.reserve(static_cast<size_t>(requests));
+	int failed = 0;
+	for (int i = 0; i < requests; ++i) {
+		auto begin = Clock::now();
+		if (!get(i)) ++failed;
+		us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+	}
+	double mean = std::accumulate(us.begin(), us.end(), 0.0) / static_cast<double>(us.size());
+	std::print("{:<16} {:>8} {:>10.2f} {:>10.2f} {:>10.2f} {:>8}\n", name, body, mean,
+		percentile(us, 0.50), percentile(us, 0.99), failed);
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int requests = (argc > 1) ? std::atoi(argv[1]) : 5000;
+	auto port = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Client Cache Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::string body;
+	for (const char* path : {"/fresh", "/fresh2"}) {
+		server.get(path, [&](const etp::HttpRequest&) {
+			etp::HttpResponse resp;
+			resp.headers.set("Cache-Control", "max-age=3600");
+			resp.headers.set("Content-Type", "application/json");
+			resp.body = body;
+			return resp;
+		});
+	}
+	server.get("/validated", [&](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.headers.set("Cache-Control", "no-cache");
+		resp.headers.set("ETag", "\"v1\"");
+		if (req.headers.get("If-None-Match") == "\"v1\"") {
+			resp.status = etp::HttpStatus::NotModified;
+			return resp;
+		}
+		resp.body = body;
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	auto fresh = etp::Url::parse(std::format("http://127.0.0.1:{}/fresh", port));
+	auto fresh2 = etp::Url::parse(std::format("http://127.0.0.1:{}/fresh2", port));
+	auto validated = etp::Url::parse(std::format("http://127.0.0.1:{}/validated", port));
+	auto disk_dir = std::filesystem::temp_directory_path() / "etherz_bench_client_cache";
+
+	std::print("{} GETs per row, loopback, pooled connection\n\n", requests);
+	std::print("{:<16} {:>8} {:>10} {:>10} {:>10} {:>8}\n", "path", "body B", "mean us", "p50 us", "p99 us", "failed");
+	for (size_t size : {size_t(1024), size_t(64 * 1024)}) {
+		body.assign(size, 'b');
+		auto ok = [size](const auto& res) { return res && (*res)->body.size() == size; };
+
+		etp::HttpClient plain;
+		run("network", size, requests, [&](int) {
+			auto res = plain.get(fresh);
+			return res && res->body.size() == size;
+		});
+
+		etp::HttpClient cached;
+		cached.set_cache(std::make_shared<etp::HttpClientCache>());
+		cached.get(validated);
+		run("304 revalidate", size, requests, [&](int) { return ok(cached.get_shared(validated)); });
+		cached.get(fresh);
+		run("memory hit", size, requests, [&](int) { return ok(cached.get_shared(fresh)); });
+		run("memory hit copy", size, requests, [&](int) {
+			auto res = cached.get(fresh);
+			return res && res->body.size() == size;
+		});
+
+		std::filesystem::remove_all(disk_dir);
+		etp::HttpCacheOptions options;
+		options.memory_bytes = size + 2048;
+		options.disk_path = disk_dir.string();
+		auto disk_cache = std::make_shared<etp::HttpClientCache>(options);
+		etp::HttpClient spilling;
+		spilling.set_cache(disk_cache);
+		spilling.get(fresh);
+		spilling.get(fresh2);
+		run("disk hit", size, requests, [&](int i) { return ok(spilling.get_shared(i % 2 ? fresh2 : fresh)); });
+		if (disk_cache->disk_read_count() < static_cast<uint64_t>(requests)) {
+			std::print("  (only {} of the disk row's hits came from disk)\n", disk_cache->disk_read_count());
+		}
+	}
+	std::filesystem::remove_all(disk_dir);
+
+	running = false;
+	thread.join();
+	server.stop();
+
+	constexpr int entries = 100'000;
+	std::print("\n{} entries stored directly, typical response fields\n\n", entries);
+	std::print("{:<8} {:>16} {:>16} {:>16}\n", "body B", "accounted B/ent", "RSS B/entry", "overhead B/ent");
+	// Caches stay alive until the end so each row measures new growth, not reused frees
+	std::vector<std::unique_ptr<etp::HttpClientCache>> kept;
+	for (size_t size : {size_t(0), size_t(256), size_t(1024)}) {
+		etp::HttpCacheOptions options;
+		options.memory_bytes = size_t(4) << 30;
+		double before = rss_bytes();
+		auto& cache = *kept.emplace_back(std::make_unique<etp::HttpClientCache>(options));
+		auto now = etp::HttpClientCache::SysClock::now();
+		etp::HttpRequest req;
+		for (int i = 0; i < entries; ++i) {
+			req.path = "/api/items/" + std::to_string(i);
+			auto resp = std::make_shared<etp::HttpResponse>();
+			resp->headers.set("Date", "Thu, 19 Feb 2026 00:00:00 GMT");
+			resp->headers.set("Cache-Control", "max-age=3600");
+			resp->headers.set("Content-Type", "application/json");
+			resp->headers.set("Content-Length", std::to_string(size));
+			resp->headers.set("ETag", std::format("\"{:08x}\"", i));
+			resp->body.assign(size, 'b');
+			cache.store(fresh, req, std::move(resp), now, now);
+		}
+		double rss = (rss_bytes() - before) / entries;
+		double accounted = static_cast<double>(cache.memory_used()) / entries;
+		std::print("{:<8} {:>16.0f} {:>16.0f} {:>16.0f}\n", size, accounted, rss, rss - static_cast<double>(size));
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file bench_client_pool.cpp
+ * @brief Sequential HttpClient request latency with and without connection reuse
+ *
+ * An HttpServer runs on its own loop thread; one blocking HttpClient sends
+ * requests back to back. The "pooled" row keeps connections alive in a
+ * ConnectionPool, the "unpooled" row opens and closes one per request
+ * (the old Connection: close behaviour), so the gap is the cost of the
+ * TCP handshake and teardown on every call.
+ * Usage: bench_client_pool [requests] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+static double percentile(std::vector<double>& v, double q) {
+	if (v.empty()) return 0;
+	auto idx = static_cast<size_t>(q * static_cast<double>(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+	return v[idx];
+}
+
+struct RunResult {
+	double mean_us = 0;
+	double p50_us = 0;
+	double p99_us = 0;
+	size_t failures = 0;
+};
+
+static RunResult run(etp::HttpClient& client, const etp::Url& url, int requests) {
+	std::vector<double> latencies;
+	latencies.reserve(static_cast<size_t>(requests));
+	RunResult result;
+	for (int i = 0; i < requests; ++i) {
+		auto start = Clock::now();
+		auto res = client.get(url);
+		latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+		if (!res || res->body != "ok") ++result.failures;
+	}
+	result.mean_us = std::accumulate(latencies.begin(), latencies.end(), 0.0) / static_cast<double>(latencies.size());
+	result.p50_us = percentile(latencies, 0.50);
+	result.p99_us = percentile(latencies, 0.99);
+	return result;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int requests = (argc > 1) ? std::atoi(argv[1]) : 5000;
+	auto port = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz HttpClient Pool Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} sequential GETs per run\n\n", requests);
+
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	server.get("/", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "ok";
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	auto url = etp::Url::parse(std::format("http://127.0.0.1:{}/", port));
+	etp::HttpClient pooled;
+	etp::HttpClient unpooled(nullptr);
+
+	std::print("{:<10} {:>10} {:>10} {:>10} {:>10}\n", "client", "mean us", "p50 us", "p99 us", "failed");
+	for (auto [name, client] : {std::pair{"unpooled", &unpooled}, std::pair{"pooled", &pooled}}) {
+		run(*client, url, std::min(requests, 200)); // Warm up
+		auto r = run(*client, url, requests);
+		std::print("{:<10} {:>10.1f} {:>10.1f} {:>10.1f} {:>10}\n", name, r.mean_us, r.p50_us, r.p99_us, r.failures);
+	}
+	std::print("\npooled: {} connects, {} reuses\n", pooled.pool()->connect_count(), pooled.pool()->reuse_count());
+
+	running = false;
+	thread.join();
+	server.stop();
+	return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file bench_coalescing.cpp
+ * @brief Thundering herd of identical GETs with and without request coalescing
+ *
+ * An HttpServer serves one "config" document from 8 worker threads; each
+ * request costs the backend 5 ms. Every round, all client threads (one
+ * HttpClient each) are released together and GET the same URL through
+ * get_shared(). With a shared RequestCoalescer one request per burst
+ * reaches the server and the rest share its response object.
+ * Usage: bench_coalescing [threads] [rounds] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+static double percentile(std::vector<double>& v, double q) {
+	if (v.empty()) return 0;
+	auto idx = static_cast<size_t>(q * static_cast<double>(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+	return v[idx];
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int threads = (argc > 1) ? std::atoi(argv[1]) : 64;
+	int rounds = (argc > 2) ? std::atoi(argv[2]) : 50;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Request Coalescing Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} threads x {} rounds of one identical GET, 5 ms backend cost, 8 server workers\n\n", threads, rounds);
+
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	server.enable_workers(8);
+	std::atomic<uint64_t> backend{0};
+	const std::string config(16 * 1024, 'c');
+	server.get("/config", [&](const etp::HttpRequest&) {
+		++backend;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		etp::HttpResponse resp;
+		resp.body = config;
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	auto url = etp::Url::parse(std::format("http://127.0.0.1:{}/config", port));
+	std::print("{:<10} {:>10} {:>10} {:>10} {:>10} {:>8}\n", "coalesce", "backend", "mean ms", "p50 ms", "p99 ms", "failed");
+	for (bool coalesce : {false, true}) {
+		auto coalescer = coalesce ? std::make_shared<etp::RequestCoalescer>() : nullptr;
+		std::barrier start(threads);
+		std::mutex mutex;
+		std::vector<double> latencies;
+		std::atomic<size_t> failures{0};
+		backend = 0;
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			workers.emplace_back([&] {
+				etp::HttpClient client;
+				client.set_coalescer(coalescer);
+				std::vector<double> mine;
+				for (int r = 0; r < rounds; ++r) {
+					start.arrive_and_wait();
+					auto begin = Clock::now();
+					auto res = client.get_shared(url);
+					mine.push_back(std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+					if (!res || (*res)->body.size() != config.size()) ++failures;
+				}
+				std::lock_guard lock(mutex);
+				latencies.insert(latencies.end(), mine.begin(), mine.end());
+			});
+		}
+		for (auto& w : workers) w.join();
+		double mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / static_cast<double>(latencies.size());
+		std::print("{:<10} {:>10} {:>10.2f} {:>10.2f} {:>10.2f} {:>8}\n", coalesce ? "on" : "off", backend.load(), mean,
+			percentile(latencies, 0.50), percentile(latencies, 0.99), failures.load());
+	}
+
+	running = false;
+	thread.join();
+	server.stop();
+	return 0;
+}
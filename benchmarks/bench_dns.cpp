@@ -0,0 +1,120 @@
+/**
+ * @file bench_dns.cpp
+ * @brief HttpClient requests/s with and without a DnsCache in front of a slow resolver
+ *
+ * An HttpServer runs on its own loop thread. Clients connect per request
+ * (HttpClient(nullptr)), so every request resolves the host name. The
+ * resolver is a local stub that answers "stub.test" with 127.0.0.1 after a
+ * fixed delay, standing in for a resolver one network hop away. The
+ * "uncached" rows use a DnsCache with zero lifetimes, i.e. a lookup per
+ * request; the "cached" rows use the default options.
+ * Usage: bench_dns [requests per thread] [resolver delay us] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+struct RunResult {
+	double requests_per_sec = 0;
+	size_t failures = 0;
+};
+
+static RunResult run(const std::shared_ptr<etn::DnsCache>& cache, const etp::Url& url, int threads, int requests) {
+	std::atomic<size_t> failures{0};
+	std::vector<std::thread> workers;
+	auto start = Clock::now();
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&] {
+			etp::HttpClient client(nullptr);
+			client.set_dns_cache(cache);
+			for (int i = 0; i < requests; ++i) {
+				auto res = client.get(url);
+				if (!res || res->body != "ok") ++failures;
+			}
+		});
+	}
+	for (auto& w : workers) w.join();
+	double secs = std::chrono::duration<double>(Clock::now() - start).count();
+	return {static_cast<double>(threads * requests) / secs, failures.load()};
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int requests = (argc > 1) ? std::atoi(argv[1]) : 2000;
+	auto delay = std::chrono::microseconds((argc > 2) ? std::atoi(argv[2]) : 500);
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz DNS Cache Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} requests per thread, stub resolver delay {} us\n\n", requests, delay.count());
+
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	server.get("/", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "ok";
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	std::atomic<uint64_t> lookups{0};
+	auto stub = [&](std::string_view host) {
+		++lookups;
+		std::this_thread::sleep_for(delay);
+		etn::DnsResult result;
+		if (host == "stub.test") {
+			result.ipv4_addresses.emplace_back(127, 0, 0, 1);
+			result.success = true;
+		}
+		return result;
+	};
+	etn::DnsCacheOptions uncached_options;
+	uncached_options.max_ttl = std::chrono::milliseconds(0);
+	uncached_options.negative_ttl = std::chrono::milliseconds(0);
+
+	auto url = etp::Url::parse(std::format("http://stub.test:{}/", port));
+	std::print("{:<10} {:>8} {:>12} {:>10} {:>8}\n", "cache", "threads", "req/s", "lookups", "failed");
+	for (int threads : {1, 8}) {
+		for (bool cached : {false, true}) {
+			auto cache = std::make_shared<etn::DnsCache>(cached ? etn::DnsCacheOptions{} : uncached_options, stub);
+			run(cache, url, threads, std::min(requests, 100)); // Warm up
+			lookups = 0;
+			auto r = run(cache, url, threads, requests);
+			std::print("{:<10} {:>8} {:>12.0f} {:>10} {:>8}\n", cached ? "cached" : "uncached", threads,
+				r.requests_per_sec, lookups.load(), r.failures);
+		}
+	}
+
+	running = false;
+	thread.join();
+	server.stop();
+	return 0;
+}
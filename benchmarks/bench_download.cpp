@@ -0,0 +1,118 @@
+/**
+ * @file bench_download.cpp
+ * @brief Peak memory and throughput of streamed vs buffered HttpClient downloads
+ *
+ * A child process serves one large body over HttpServer so its copy does not
+ * count against the client. The parent fetches it with download() into
+ * /dev/null first, then with get(), and reports how far each one pushed the
+ * process's peak RSS. download() should stay near the size of the receive
+ * buffer; get() grows with the body (plus string reallocation slack).
+ * Peak RSS only moves up, which is why the streamed run goes first.
+ * Usage: bench_download [MiB] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <print>
+
+#if defined(__linux__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <signal.h>
+	#include <sys/resource.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+#if defined(__linux__) || defined(__APPLE__)
+
+/// Peak resident set size of this process in KiB
+static long peak_rss_kib() {
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+[[noreturn]] static void serve(uint16_t port, size_t bytes) {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::string body(bytes, 'x');
+	server.get("/file", [&body](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = body;
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) _exit(1);
+	server.attach(loop);
+	for (;;) loop.run_once(100);
+}
+
+int main(int argc, char* argv[]) {
+	size_t mib = (argc > 1) ? static_cast<size_t>(std::atoi(argv[1])) : 64;
+	auto port = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 18080);
+	size_t bytes = mib << 20;
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz HttpClient Download Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} MiB body\n\n", mib);
+
+	pid_t child = fork();
+	if (child < 0) {
+		std::print("fork failed\n");
+		return 1;
+	}
+	if (child == 0) serve(port, bytes);
+
+	auto url = etp::Url::parse(std::format("http://127.0.0.1:{}/file", port));
+	etp::HttpClient client;
+	int sink = ::open("/dev/null", O_WRONLY);
+	// Wait for the child to start listening
+	auto deadline = Clock::now() + std::chrono::seconds(5);
+	while (!client.download(url, sink) && Clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	std::print("{:<10} {:>12} {:>10} {:>8}\n", "mode", "peak +KiB", "MiB/s", "ok");
+	auto report = [&](const char* name, auto fetch) {
+		long before = peak_rss_kib();
+		auto start = Clock::now();
+		bool ok = fetch();
+		double secs = std::chrono::duration<double>(Clock::now() - start).count();
+		std::print("{:<10} {:>12} {:>10.0f} {:>8}\n", name, peak_rss_kib() - before,
+			static_cast<double>(mib) / secs, ok ? "yes" : "no");
+	};
+	report("download", [&] {
+		auto res = client.download(url, sink);
+		return res && res->status == etp::HttpStatus::OK;
+	});
+	report("get", [&] {
+		auto res = client.get(url);
+		return res && res->body.size() == bytes;
+	});
+
+	::close(sink);
+	kill(child, SIGTERM);
+	waitpid(child, nullptr, 0);
+	return 0;
+}
+
+#else
+
+int main() {
+	std::print("bench_download needs fork() and getrusage(); unsupported on this platform\n");
+	return 0;
+}
+
+#endif
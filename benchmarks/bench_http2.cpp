@@ -0,0 +1,184 @@
+/**
+ * @file bench_http2.cpp
+ * @brief Multiplexed HTTP/2 (h2c) vs HTTP/1.1 keep-alive over one connection
+ *
+ * Runs HttpServer on an EventLoop thread over loopback, then issues the
+ * same number of GET requests through a single TCP connection: sequentially
+ * with HTTP/1.1 keep-alive, and with up to `streams` concurrent HTTP/2
+ * streams in flight.
+ * Usage: bench_http2 [requests] [streams] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "protocol/http2.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+static bool send_all(etn::Socket<etn::Ip<4>>& sock, std::string_view data) {
+	while (!data.empty()) {
+		int n = sock.send(std::span<const uint8_t>(
+			reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+		if (n <= 0) return false;
+		data.remove_prefix(static_cast<size_t>(n));
+	}
+	return true;
+}
+
+static bool recv_some(etn::Socket<etn::Ip<4>>& sock, std::string& buf) {
+	std::array<uint8_t, 16384> chunk{};
+	int n = sock.recv(chunk);
+	if (n <= 0) return false;
+	buf.append(reinterpret_cast<const char*>(chunk.data()), static_cast<size_t>(n));
+	return true;
+}
+
+static double bench_http1(const etn::SocketAddress<etn::Ip<4>>& addr, int requests) {
+	etn::Socket<etn::Ip<4>> sock;
+	sock.create();
+	if (etherz::core::is_error(sock.connect(addr))) return 0;
+
+	const std::string request = "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	std::string buf;
+	auto start = Clock::now();
+	for (int i = 0; i < requests; ++i) {
+		if (!send_all(sock, request)) return 0;
+		// Read one response: headers, then Content-Length bytes
+		while (true) {
+			auto end = buf.find("\r\n\r\n");
+			if (end != std::string::npos) {
+				auto resp = etp::http_parser::parse_response(std::string_view(buf).substr(0, end + 4));
+				size_t len = std::stoul(std::string(resp.headers.get("Content-Length")));
+				if (buf.size() >= end + 4 + len) {
+					buf.erase(0, end + 4 + len);
+					break;
+				}
+			}
+			if (!recv_some(sock, buf)) return 0;
+		}
+	}
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double bench_http2(const etn::SocketAddress<etn::Ip<4>>& addr, int requests, int streams) {
+	etn::Socket<etn::Ip<4>> sock;
+	sock.create();
+	if (etherz::core::is_error(sock.connect(addr))) return 0;
+
+	etp::HpackEncoder encoder;
+	etp::HpackDecoder decoder;
+	std::string out = std::string(etp::h2_preface);
+	etp::h2_write_frame(out, etp::H2FrameType::Settings, 0, 0);
+	if (!send_all(sock, out)) return 0;
+
+	std::string buf;
+	uint32_t next_id = 1;
+	int sent = 0, done = 0, in_flight = 0;
+	size_t unacked_data = 0;
+
+	auto start = Clock::now();
+	while (done < requests) {
+		out.clear();
+		while (in_flight < streams && sent < requests) {
+			std::string block;
+			encoder.encode({{":method", "GET"}, {":scheme", "http"},
+				{":path", "/hello"}, {":authority", "localhost"}}, block);
+			etp::h2_write_frame(out, etp::H2FrameType::Headers,
+				etp::h2_flags::EndHeaders | etp::h2_flags::EndStream, next_id, block);
+			next_id += 2;
+			++sent;
+			++in_flight;
+		}
+		if (unacked_data > etp::H2_DEFAULT_WINDOW / 2) {
+			std::string inc;
+			etp::h2_detail::put_u32(inc, static_cast<uint32_t>(unacked_data));
+			etp::h2_write_frame(out, etp::H2FrameType::WindowUpdate, 0, 0, inc);
+			unacked_data = 0;
+		}
+		if (!out.empty() && !send_all(sock, out)) return 0;
+
+		if (!recv_some(sock, buf)) return 0;
+		std::string_view view = buf;
+		while (auto h = etp::h2_read_frame_header(view)) {
+			if (view.size() < etp::H2_FRAME_HEADER_SIZE + h->length) break;
+			auto payload = view.substr(etp::H2_FRAME_HEADER_SIZE, h->length);
+			if (h->type == etp::H2FrameType::Headers) {
+				std::vector<etp::HpackHeader> fields;
+				decoder.decode(payload, fields);
+			} else if (h->type == etp::H2FrameType::Data) {
+				unacked_data += h->length;
+			} else if (h->type == etp::H2FrameType::Settings && !h->has(etp::h2_flags::Ack)) {
+				std::string ack;
+				etp::h2_write_frame(ack, etp::H2FrameType::Settings, etp::h2_flags::Ack, 0);
+				send_all(sock, ack);
+			}
+			if (h->stream_id != 0 && h->has(etp::h2_flags::EndStream)) {
+				++done;
+				--in_flight;
+			}
+			view.remove_prefix(etp::H2_FRAME_HEADER_SIZE + h->length);
+		}
+		buf.erase(0, buf.size() - view.size());
+	}
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int requests = (argc > 1) ? std::atoi(argv[1]) : 20000;
+	int streams = (argc > 2) ? std::atoi(argv[2]) : 64;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz HTTP/2 vs HTTP/1.1 Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	etp::HttpServer server;
+	server.get("/hello", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.headers.set("Content-Type", "text/plain");
+		resp.body = "Hello from etherz";
+		return resp;
+	});
+	server.enable_http2();
+	if (etherz::core::is_error(server.listen(addr))) {
+		std::print("Failed to listen on port {}\n", port);
+		return 1;
+	}
+
+	eta::EventLoop loop;
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	double h1 = bench_http1(addr, requests);
+	double h2 = bench_http2(addr, requests, streams);
+
+	running = false;
+	server_thread.join();
+
+	std::print("{} requests over one connection\n\n", requests);
+	std::print("{:<28} {:>10} {:>12}\n", "protocol", "seconds", "req/s");
+	std::print("{:<28} {:>10.3f} {:>12.0f}\n", "HTTP/1.1 keep-alive", h1, h1 > 0 ? requests / h1 : 0.0);
+	std::print("{:<28} {:>10.3f} {:>12.0f}\n",
+		std::format("HTTP/2 h2c ({} streams)", streams), h2, h2 > 0 ? requests / h2 : 0.0);
+	return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file bench_load_balancer.cpp
+ * @brief LoadBalancer pick throughput, load spread and Maglev disruption
+ *
+ * Throughput: each thread picks in a tight loop against one shared
+ * balancer of 16 endpoints, per policy. Spread: a discrete simulation
+ * sends one request per tick to 10 endpoints, one of which takes 10x as
+ * long to answer, and reports each policy's share for the slow endpoint
+ * and its peak outstanding requests. Maglev: keys per endpoint and the
+ * fraction of keys that move when one endpoint leaves or joins.
+ * Usage: bench_load_balancer [millions of picks per thread] [max threads]
+ */
+
+#include "net/load_balancer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etn = etherz::net;
+using Clock = std::chrono::steady_clock;
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+static std::vector<Address> endpoints(int n) {
+	std::vector<Address> out;
+	for (int i = 0; i < n; ++i) out.emplace_back(etn::Ip<4>(10, 0, static_cast<uint8_t>(i / 250), static_cast<uint8_t>(i % 250 + 1)), 80);
+	return out;
+}
+
+/// Picks per second across threads, each running pick(lb, i) per iteration
+template <typename Pick>
+static double throughput(etn::LoadBalancer& lb, int threads, uint64_t per_thread, Pick pick) {
+	std::barrier start(threads + 1);
+	std::atomic<uint64_t> sink{0};
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t] {
+			uint64_t local = 0;
+			start.arrive_and_wait();
+			for (uint64_t i = 0; i < per_thread; ++i) local += pick(lb, i * 2654435761u + static_cast<uint64_t>(t));
+			sink += local;
+		});
+	}
+	start.arrive_and_wait();
+	auto begin = Clock::now();
+	for (auto& w : workers) w.join();
+	double secs = std::chrono::duration<double>(Clock::now() - begin).count();
+	return static_cast<double>(per_thread) * threads / secs;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	double millions = (argc > 1) ? std::atof(argv[1]) : 5.0;
+	int max_threads = (argc > 2) ? std::atoi(argv[2]) : 8;
+	auto per_thread = static_cast<uint64_t>(millions * 1e6);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Load Balancer Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	etn::LoadBalancer lb(endpoints(16));
+	std::print("Mpicks/s, 16 endpoints, {} M picks per thread\n\n", millions);
+	std::print("{:<8} {:>12} {:>12} {:>12} {:>12}\n", "threads", "round-robin", "p2c lease", "maglev", "maglev lease");
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+		auto rr = throughput(lb, threads, per_thread, [](auto& b, uint64_t) { return b.next()->port(); });
+		auto p2c = throughput(lb, threads, per_thread, [](auto& b, uint64_t) { return b.acquire().address().port(); });
+		auto maglev = throughput(lb, threads, per_thread, [](auto& b, uint64_t i) { return b.for_hash(i)->port(); });
+		auto leased = throughput(lb, threads, per_thread, [](auto& b, uint64_t i) {
+			return b.pick(etn::BalancePolicy::Maglev, std::string_view(reinterpret_cast<const char*>(&i), sizeof(i))).address().port();
+		});
+		std::print("{:<8} {:>12.1f} {:>12.1f} {:>12.1f} {:>12.1f}\n", threads, rr / 1e6, p2c / 1e6, maglev / 1e6, leased / 1e6);
+	}
+
+	// One request per tick; endpoint 0 takes 10x as long as the rest
+	constexpr int servers = 10;
+	constexpr int ticks = 1'000'000;
+	std::print("\n{} requests, one per tick, {} endpoints; endpoint 0 answers in 50 ticks, the rest in 5\n\n", ticks, servers);
+	std::print("{:<14} {:>12} {:>12} {:>14} {:>14}\n", "policy", "slow share", "mean ticks", "slow peak out", "fast peak out");
+	auto set = endpoints(servers);
+	for (auto policy : {etn::BalancePolicy::RoundRobin, etn::BalancePolicy::LeastOutstanding, etn::BalancePolicy::Maglev}) {
+		etn::LoadBalancer sim(set);
+		using Pending = std::pair<int, size_t>; // Finish tick, lease slot
+		std::priority_queue<Pending, std::vector<Pending>, std::greater<>> finishing;
+		std::vector<etn::LoadBalancer::Lease> leases;
+		std::vector<size_t> free_slots;
+		uint64_t slow = 0;
+		uint32_t slow_peak = 0, fast_peak = 0;
+		for (int tick = 0; tick < ticks; ++tick) {
+			while (!finishing.empty() && finishing.top().first <= tick) {
+				leases[finishing.top().second].release();
+				free_slots.push_back(finishing.top().second);
+				finishing.pop();
+			}
+			auto key = std::to_string(tick);
+			auto lease = sim.pick(policy, key);
+			bool is_slow = lease.address() == set[0];
+			slow += is_slow;
+			size_t slot;
+			if (free_slots.empty()) {
+				slot = leases.size();
+				leases.push_back(std::move(lease));
+			} else {
+				slot = free_slots.back();
+				free_slots.pop_back();
+				leases[slot] = std::move(lease);
+			}
+			finishing.emplace(tick + (is_slow ? 50 : 5), slot);
+			slow_peak = std::max(slow_peak, sim.outstanding(set[0]));
+			for (int s = 1; s < servers; ++s) fast_peak = std::max(fast_peak, sim.outstanding(set[s]));
+		}
+		const char* name = policy == etn::BalancePolicy::RoundRobin ? "round-robin"
+			: policy == etn::BalancePolicy::LeastOutstanding ? "p2c" : "maglev";
+		double share = static_cast<double>(slow) / ticks;
+		std::print("{:<14} {:>11.1f}% {:>12.2f} {:>14} {:>14}\n", name, 100.0 * share, share * 50 + (1 - share) * 5, slow_peak, fast_peak);
+	}
+
+	constexpr int keys = 1'000'000;
+	std::print("\nMaglev, {} keys, table {}\n\n", keys, lb.table_size());
+	std::print("{:<10} {:>10} {:>12} {:>12} {:>14} {:>14}\n", "endpoints", "build ms", "min keys", "max keys", "moved on -1", "moved on +1");
+	for (int n : {3, 10, 100}) {
+		auto begin = Clock::now();
+		etn::LoadBalancer m(endpoints(n));
+		double build = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+		std::vector<Address> before(keys);
+		std::map<Address, int> load;
+		for (int k = 0; k < keys; ++k) ++load[before[k] = *m.for_key("key-" + std::to_string(k))];
+		auto [lo, hi] = std::minmax_element(load.begin(), load.end(),
+			[](const auto& a, const auto& b) { return a.second < b.second; });
+
+		auto moved = [&](const std::vector<Address>& next) {
+			m.set_endpoints(next);
+			int n_moved = 0;
+			for (int k = 0; k < keys; ++k) n_moved += *m.for_key("key-" + std::to_string(k)) != before[k];
+			return 100.0 * n_moved / keys;
+		};
+		auto fewer = endpoints(n);
+		fewer.erase(fewer.begin());
+		double removed = moved(fewer);
+		double added = moved(endpoints(n + 1));
+		std::print("{:<10} {:>10.2f} {:>12} {:>12} {:>13.2f}% {:>13.2f}%\n", n, build, lo->second, hi->second, removed, added);
+	}
+	std::print("\n(ideal: 1/n of the keys move when one of n leaves, 1/(n+1) when one joins)\n");
+	return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file bench_metrics.cpp
+ * @brief Cost of always-on server metrics
+ *
+ * Measures ServerMetrics recording per request from 1..N threads (each
+ * thread records into its own shard, so per-op cost should stay flat),
+ * then serves keep-alive HTTP/1.1 over loopback with metrics off and on,
+ * alternating rounds and comparing the median request rates.
+ * Usage: bench_metrics [requests] [rounds] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "protocol/http_metrics.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+static double record_ns(int threads, int per_thread) {
+	etp::ServerMetrics metrics;
+	auto slot = metrics.add_route("GET", "/bench");
+	std::vector<std::thread> workers;
+	auto start = Clock::now();
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t] {
+			for (int i = 0; i < per_thread; ++i) {
+				metrics.request_started(slot);
+				metrics.request_finished(slot, etp::HttpStatus::OK,
+					static_cast<uint64_t>(1000 + (i * 7919 + t) % 100000), 0, 64);
+			}
+		});
+	}
+	for (auto& w : workers) w.join();
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / per_thread;
+}
+
+static bool send_all(etn::Socket<etn::Ip<4>>& sock, std::string_view data) {
+	while (!data.empty()) {
+		int n = sock.send(std::span<const uint8_t>(
+			reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+		if (n <= 0) return false;
+		data.remove_prefix(static_cast<size_t>(n));
+	}
+	return true;
+}
+
+/// Requests per second for one keep-alive client, pipelining depth 16
+static double serve_rate(bool metrics, uint16_t port, int requests) {
+	etp::HttpServer server;
+	server.get("/hello", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.headers.set("Content-Type", "text/plain");
+		resp.body = "Hello from etherz";
+		return resp;
+	});
+	if (metrics) server.enable_metrics();
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	if (etherz::core::is_error(server.listen(addr))) return 0;
+
+	eta::EventLoop loop;
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	etn::Socket<etn::Ip<4>> sock;
+	sock.create();
+	double seconds = 0;
+	if (!etherz::core::is_error(sock.connect(addr))) {
+		constexpr int DEPTH = 16;
+		std::string batch;
+		for (int i = 0; i < DEPTH; ++i) batch += "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n";
+		std::array<uint8_t, 65536> buf{};
+		auto start = Clock::now();
+		int done = 0;
+		while (done < requests) {
+			if (!send_all(sock, batch)) break;
+			int responses = 0;
+			while (responses < DEPTH) {
+				int n = sock.recv(buf);
+				if (n <= 0) break;
+				// Each response body ends with the same text; count them
+				std::string_view chunk(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				for (size_t p = chunk.find("etherz"); p != std::string_view::npos; p = chunk.find("etherz", p + 1)) ++responses;
+			}
+			done += DEPTH;
+		}
+		seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	running = false;
+	server_thread.join();
+	return seconds > 0 ? requests / seconds : 0;
+}
+
+static double median(std::vector<double> v) {
+	std::sort(v.begin(), v.end());
+	return v.empty() ? 0 : v[v.size() / 2];
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int requests = (argc > 1) ? std::atoi(argv[1]) : 100000;
+	int rounds = (argc > 2) ? std::atoi(argv[2]) : 5;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Server Metrics Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	std::print("{:<10} {:>16}\n", "threads", "ns per request");
+	for (int threads : {1, 2, 4, 8}) {
+		std::print("{:<10} {:>16.1f}\n", threads, record_ns(threads, 2'000'000));
+	}
+
+	std::vector<double> off, on;
+	for (int r = 0; r < rounds; ++r) {
+		off.push_back(serve_rate(false, port, requests));
+		on.push_back(serve_rate(true, port, requests));
+	}
+	double base = median(off), with = median(on);
+	std::print("\n{} pipelined keep-alive requests, median of {} rounds\n\n", requests, rounds);
+	std::print("{:<16} {:>12}\n", "metrics", "req/s");
+	std::print("{:<16} {:>12.0f}\n", "off", base);
+	std::print("{:<16} {:>12.0f}\n", "on", with);
+	std::print("\nOverhead: {:.2f}%\n", base > 0 ? (base - with) / base * 100.0 : 0.0);
+	return 0;
+}
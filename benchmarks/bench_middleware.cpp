@@ -0,0 +1,133 @@
+/**
+ * @file bench_middleware.cpp
+ * @brief Per-request cost of a 5-middleware chain over a bare handler
+ *
+ * Calls the same handler as a plain HttpHandler and wrapped in a chain of
+ * five middlewares (request id into the context arena, bearer auth, CORS
+ * origin check, method guard, counter), in-process with no I/O, and
+ * reports the added nanoseconds per request. A third variant performs the
+ * same checks inline in one handler, separating the cost of the work from
+ * the cost of composing it as a chain.
+ * Usage: bench_middleware [iterations]
+ */
+
+#include "protocol/http_middleware.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_call(const std::function<etp::HttpResponse(const etp::HttpRequest&)>& handler,
+	const etp::HttpRequest& req, int iterations) {
+	size_t sink = 0;
+	for (int i = 0; i < iterations / 10; ++i) sink += handler(req).body.size(); // Warm-up
+	auto start = Clock::now();
+	for (int i = 0; i < iterations; ++i) sink += handler(req).body.size();
+	double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+	if (sink == 42) std::print(" ");
+	return ns;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int iterations = (argc > 1) ? std::atoi(argv[1]) : 2'000'000;
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Middleware Chain Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	auto body = [](const etp::HttpRequest&, etp::RequestContext&) {
+		etp::HttpResponse resp;
+		resp.body = "ok";
+		return resp;
+	};
+	std::function<etp::HttpResponse(const etp::HttpRequest&)> bare = [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "ok";
+		return resp;
+	};
+	uint64_t counter = 0;
+	auto chain = etp::make_middleware(
+		[](const etp::HttpRequest& req, etp::RequestContext& ctx, auto&& next) {
+			ctx.set("request_id", req.headers.get("X-Request-ID"));
+			return next();
+		},
+		etp::BearerAuthMiddleware{[](std::string_view token) { return token == "secret-token"; }},
+		[](const etp::HttpRequest& req, etp::RequestContext&, auto&& next) {
+			bool cors = req.headers.get("Origin") == "https://app.example";
+			auto resp = next();
+			if (cors) resp.status = etp::HttpStatus::OK;
+			return resp;
+		},
+		[](const etp::HttpRequest& req, etp::RequestContext&, auto&& next) {
+			if (req.method != etp::HttpMethod::Get) {
+				etp::HttpResponse resp;
+				resp.status = etp::HttpStatus::MethodNotAllowed;
+				return resp;
+			}
+			return next();
+		},
+		[&counter](const etp::HttpRequest&, etp::RequestContext&, auto&& next) {
+			++counter;
+			return next();
+		});
+	auto wrapped = chain.wrap(body);
+
+	// The same five checks written inline in one handler, no chain
+	std::function<etp::HttpResponse(const etp::HttpRequest&)> inlined = [&](const etp::HttpRequest& req) {
+		auto& arena = etp::middleware_detail::thread_arena().arena;
+		arena.reset();
+		etp::RequestContext ctx(arena);
+		ctx.set("request_id", req.headers.get("X-Request-ID"));
+		auto auth = etherz::protocol::detail::trim(req.headers.get("Authorization"));
+		if (!(auth.size() > 7 && etherz::protocol::detail::iequals(auth.substr(0, 7), "Bearer ")
+			&& etherz::protocol::detail::trim(auth.substr(7)) == "secret-token")) {
+			etp::HttpResponse resp;
+			resp.status = etp::HttpStatus::Unauthorized;
+			return resp;
+		}
+		ctx.set("principal", etherz::protocol::detail::trim(auth.substr(7)));
+		bool cors = req.headers.get("Origin") == "https://app.example";
+		if (req.method != etp::HttpMethod::Get) {
+			etp::HttpResponse resp;
+			resp.status = etp::HttpStatus::MethodNotAllowed;
+			return resp;
+		}
+		++counter;
+		auto resp = body(req, ctx);
+		if (cors) resp.status = etp::HttpStatus::OK;
+		return resp;
+	};
+
+	etp::HttpRequest req;
+	req.path = "/api/items";
+	req.headers.set("Host", "localhost");
+	req.headers.set("X-Request-ID", "0001-000000000042");
+	req.headers.set("Authorization", "Bearer secret-token");
+
+	// Interleave rounds and keep the best of each to damp scheduler noise
+	double base = 1e9, inline_work = 1e9, with = 1e9;
+	for (int round = 0; round < 5; ++round) {
+		base = std::min(base, ns_per_call(bare, req, iterations));
+		inline_work = std::min(inline_work, ns_per_call(inlined, req, iterations));
+		with = std::min(with, ns_per_call(wrapped, req, iterations));
+	}
+
+	std::print("{} iterations x 5 rounds (best), {} middlewares\n\n", iterations, chain.size());
+	std::print("{:<32} {:>12}\n", "handler", "ns/request");
+	std::print("{:<32} {:>12.1f}\n", "bare", base);
+	std::print("{:<32} {:>12.1f}\n", "same checks inlined in handler", inline_work);
+	std::print("{:<32} {:>12.1f}\n", "5-middleware chain", with);
+	std::print("\nAdded over bare handler:  {:.1f} ns\n", with - base);
+	std::print("Cost of chaining itself:  {:.1f} ns\n", with - inline_work);
+	return counter == 0 ? 1 : 0;
+}
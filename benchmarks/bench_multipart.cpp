@@ -0,0 +1,138 @@
+/**
+ * @file bench_multipart.cpp
+ * @brief Parse throughput of MultipartParser on large multi-file uploads
+ *
+ * Generates a multipart/form-data body of several files with random
+ * content on the fly and feeds it to the parser in fixed-size pieces, as
+ * an HttpStreamHandler would see it. The whole body never exists in
+ * memory; only one file's worth of payload is built and replayed. As a
+ * reference the same pieces are scanned for the delimiter with
+ * std::string_view::find.
+ * Usage: bench_multipart [gib] [files]
+ */
+
+#include "protocol/multipart.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view BOUNDARY = "----EtherzFormBoundary7MA4YWxkTrZu0gW";
+
+/// Random bytes; avoiding '-' keeps the boundary from occurring by chance
+static std::string random_payload(size_t size) {
+	std::mt19937_64 rng(42);
+	std::string out(size, '\0');
+	for (size_t i = 0; i < size; i += 8) {
+		uint64_t v = rng();
+		for (size_t j = 0; j < 8 && i + j < size; ++j) {
+			char c = static_cast<char>(v >> (j * 8));
+			out[i + j] = c == '-' ? '+' : c;
+		}
+	}
+	return out;
+}
+
+/**
+ * @brief Replays the body in pieces of `piece` bytes
+ */
+template <typename Sink>
+static void replay(const std::string& head, const std::string& payload, size_t files,
+	size_t piece, Sink&& sink) {
+	std::string tail = "\r\n--" + std::string(BOUNDARY) + "--\r\n";
+	std::string buf;
+	buf.reserve(piece);
+	auto push = [&](std::string_view data) {
+		while (!data.empty()) {
+			size_t n = std::min(piece - buf.size(), data.size());
+			if (buf.empty() && n == piece) {
+				// Full pieces straight from the source, no copy
+				sink(data.substr(0, n));
+			} else {
+				buf.append(data.substr(0, n));
+				if (buf.size() == piece) {
+					sink(std::string_view(buf));
+					buf.clear();
+				}
+			}
+			data.remove_prefix(n);
+		}
+	};
+	for (size_t f = 0; f < files; ++f) {
+		push(f == 0 ? std::string_view(head).substr(2) : std::string_view(head));
+		push(payload);
+	}
+	push(tail);
+	if (!buf.empty()) sink(std::string_view(buf));
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	double gib = (argc > 1) ? std::atof(argv[1]) : 1.0;
+	size_t files = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : 16;
+	if (files == 0) files = 1;
+	auto total = static_cast<uint64_t>(gib * 1024.0 * 1024.0 * 1024.0);
+	size_t file_size = static_cast<size_t>(total / files);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Multipart Parse Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	std::string head = "\r\n--" + std::string(BOUNDARY) + "\r\n"
+		"Content-Disposition: form-data; name=\"file\"; filename=\"upload.bin\"\r\n"
+		"Content-Type: application/octet-stream\r\n\r\n";
+	std::string payload = random_payload(file_size);
+
+	std::print("Body: {} files x {:.1f} MiB, boundary {} bytes\n\n",
+		files, static_cast<double>(file_size) / (1024.0 * 1024.0), BOUNDARY.size());
+	std::print("{:<14} {:>10} {:>12} {:>12} {:>14}\n", "piece", "method", "seconds", "MiB/s", "max buffered");
+
+	double mib = static_cast<double>(file_size * files) / (1024.0 * 1024.0);
+	for (size_t piece : {size_t{16} * 1024, size_t{64} * 1024, size_t{1024} * 1024}) {
+		// MultipartParser: boundary search, header parsing and data callbacks
+		uint64_t data_bytes = 0;
+		size_t parts = 0;
+		etp::MultipartParser parser(BOUNDARY, {
+			.on_part_begin = [&](const etp::MultipartPart&) { ++parts; },
+			.on_data = [&](std::string_view data) { data_bytes += data.size(); },
+			.on_part_end = {},
+		});
+		size_t max_buffered = 0;
+		auto start = Clock::now();
+		replay(head, payload, files, piece, [&](std::string_view data) {
+			parser.feed(data);
+			max_buffered = std::max(max_buffered, parser.buffered());
+		});
+		double parse_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+		// Reference: std::string_view::find for the delimiter, nothing else
+		std::string delim = "\r\n--" + std::string(BOUNDARY);
+		size_t found = 0;
+		start = Clock::now();
+		replay(head, payload, files, piece, [&](std::string_view data) {
+			for (size_t at = data.find(delim); at != std::string_view::npos; at = data.find(delim, at + 1)) ++found;
+		});
+		double find_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+		auto label = std::format("{} KiB", piece / 1024);
+		std::print("{:<14} {:>10} {:>12.3f} {:>12.0f} {:>14}\n", label, "parser", parse_s,
+			parse_s > 0 ? mib / parse_s : 0.0, max_buffered);
+		std::print("{:<14} {:>10} {:>12.3f} {:>12.0f} {:>14}\n", "", "find", find_s,
+			find_s > 0 ? mib / find_s : 0.0, "-");
+		if (!parser.done() || parts != files || data_bytes != file_size * files) {
+			std::print("  parser mismatch: done={} parts={} bytes={}\n", parser.done(), parts, data_bytes);
+		}
+		(void)found;
+	}
+	return 0;
+}
@@ -0,0 +1,242 @@
+/**
+ * @file bench_pipeline.cpp
+ * @brief Batch latency of pipelined vs one-at-a-time HttpClient requests over a delayed link
+ *
+ * An HttpServer runs on its own loop thread behind a relay that holds
+ * every chunk of bytes for a fixed one-way delay, so each round trip
+ * costs twice that. A batch of N GETs is sent either one request at a
+ * time on a keep-alive connection (N round trips) or with get_batch()
+ * (about one), and the time for the whole batch is reported.
+ * Usage: bench_pipeline [one-way delay ms] [rounds] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include "async/poll.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <numeric>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+static Address local(uint16_t port) { return Address(etn::Ip<4>(127, 0, 0, 1), port); }
+
+/**
+ * @brief TCP relay that delivers each chunk it reads only after a fixed delay
+ */
+struct DelayRelay {
+	struct Chunk {
+		Clock::time_point due;
+		std::string data;
+	};
+	struct Side {
+		etn::Socket<etn::Ip<4>> socket;
+		std::deque<Chunk> out;   // Waiting to be written to this socket
+	};
+	struct Link {
+		Side client, server;
+	};
+
+	etn::Socket<etn::Ip<4>> listener;
+	std::chrono::microseconds delay;
+	uint16_t target = 0;
+	std::vector<std::unique_ptr<Link>> links;
+	std::atomic<bool> running{true};
+	std::thread thread;
+
+	bool start(uint16_t port, uint16_t target_port, std::chrono::microseconds one_way) {
+		delay = one_way;
+		target = target_port;
+		listener.create();
+		listener.set_reuse_addr(true);
+		if (etherz::core::is_error(listener.bind(local(port))) || etherz::core::is_error(listener.listen())) return false;
+		listener.set_nonblocking(true);
+		thread = std::thread([this] { run(); });
+		return true;
+	}
+
+	~DelayRelay() {
+		running = false;
+		if (thread.joinable()) thread.join();
+	}
+
+	void run() {
+		std::vector<eta::PollEntry> entries;
+		std::array<uint8_t, 64 * 1024> buf{};
+		while (running.load(std::memory_order_relaxed)) {
+			entries.assign(1, {listener.native_handle(), eta::PollEvent::ReadReady, eta::PollEvent::None});
+			auto next_due = Clock::now() + std::chrono::milliseconds(5);
+			for (auto& link : links) {
+				for (auto* side : {&link->client, &link->server}) {
+					entries.push_back({side->socket.native_handle(), eta::PollEvent::ReadReady, eta::PollEvent::None});
+					if (!side->out.empty()) next_due = std::min(next_due, side->out.front().due);
+				}
+			}
+			auto wait = std::chrono::duration_cast<std::chrono::microseconds>(next_due - Clock::now()).count();
+			eta::poll(entries, wait <= 0 ? 0 : static_cast<int>((wait + 999) / 1000));
+
+			if (entries[0].returned != eta::PollEvent::None) accept();
+			for (size_t i = 0; i < links.size(); ++i) {
+				auto& link = *links[i];
+				bool open = relay(link.client, link.server, buf) && relay(link.server, link.client, buf);
+				if (!open) {
+					links.erase(links.begin() + static_cast<std::ptrdiff_t>(i--));
+					continue;
+				}
+				flush(link.client);
+				flush(link.server);
+			}
+		}
+	}
+
+	void accept() {
+		while (auto accepted = listener.accept()) {
+			auto link = std::make_unique<Link>();
+			link->client.socket = std::move(accepted->socket);
+			link->server.socket.create();
+			if (etherz::core::is_error(link->server.socket.connect(local(target)))) continue;
+			for (auto* side : {&link->client, &link->server}) {
+				side->socket.set_nonblocking(true);
+				side->socket.set_no_delay(true);
+			}
+			links.push_back(std::move(link));
+		}
+	}
+
+	/// Read what from has and schedule it for to; false once from has closed
+	bool relay(Side& from, Side& to, std::array<uint8_t, 64 * 1024>& buf) {
+		while (true) {
+			int n = from.socket.recv(buf);
+			if (n > 0) {
+				to.out.push_back({Clock::now() + delay, std::string(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n))});
+				continue;
+			}
+			return n < 0 && etherz::core::last_platform_error() == etherz::core::Error::WouldBlock;
+		}
+	}
+
+	void flush(Side& side) {
+		auto now = Clock::now();
+		while (!side.out.empty() && side.out.front().due <= now) {
+			auto& chunk = side.out.front();
+			int n = side.socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(chunk.data.data()), chunk.data.size()));
+			if (n <= 0) return;
+			chunk.data.erase(0, static_cast<size_t>(n));
+			if (chunk.data.empty()) side.out.pop_front();
+		}
+	}
+};
+
+static double percentile(std::vector<double>& v, double q) {
+	if (v.empty()) return 0;
+	auto idx = static_cast<size_t>(q * static_cast<double>(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+	return v[idx];
+}
+
+struct BatchStats {
+	double mean_ms = 0;
+	double p99_ms = 0;
+	size_t failures = 0;
+};
+
+template <typename Fn>
+static BatchStats measure(int rounds, Fn&& batch) {
+	std::vector<double> samples;
+	BatchStats stats;
+	for (int r = 0; r < rounds; ++r) {
+		auto start = Clock::now();
+		stats.failures += batch();
+		samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+	stats.mean_ms = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+	stats.p99_ms = percentile(samples, 0.99);
+	return stats;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	double delay_ms = (argc > 1) ? std::atof(argv[1]) : 1.0;
+	int rounds = (argc > 2) ? std::atoi(argv[2]) : 20;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz HTTP Pipelining Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("one-way delay {:.1f} ms (RTT {:.1f} ms), {} rounds per row\n\n", delay_ms, 2 * delay_ms, rounds);
+
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	server.get("/item", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "value";
+		return resp;
+	});
+	if (etherz::core::is_error(server.listen(local(port)))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	{
+		DelayRelay relay;
+		auto relay_port = static_cast<uint16_t>(port + 1);
+		if (!relay.start(relay_port, port, std::chrono::microseconds(static_cast<int64_t>(delay_ms * 1000)))) {
+			std::print("relay failed on port {}\n", relay_port);
+			return 1;
+		}
+		auto url = etp::Url::parse(std::format("http://127.0.0.1:{}/item", relay_port));
+		etp::HttpClient client;
+		client.get(url); // Connect once; both modes reuse the connection
+
+		std::print("{:>4} {:>14} {:>14} {:>14} {:>14} {:>9}\n", "N", "serial mean", "serial p99", "pipeline mean", "pipeline p99", "speedup");
+		for (size_t n : {1, 2, 4, 8, 16, 32, 64}) {
+			std::vector<std::string> paths(n, "/item");
+			auto serial = measure(rounds, [&] {
+				size_t failed = 0;
+				for (size_t i = 0; i < n; ++i) {
+					auto res = client.get(url);
+					if (!res || res->body != "value") ++failed;
+				}
+				return failed;
+			});
+			auto pipelined = measure(rounds, [&] {
+				size_t failed = 0;
+				for (auto& res : client.get_batch(url, paths)) {
+					if (!res || res->body != "value") ++failed;
+				}
+				return failed;
+			});
+			std::print("{:>4} {:>11.2f} ms {:>11.2f} ms {:>11.2f} ms {:>11.2f} ms {:>8.1f}x{}\n", n,
+				serial.mean_ms, serial.p99_ms, pipelined.mean_ms, pipelined.p99_ms, serial.mean_ms / pipelined.mean_ms,
+				serial.failures + pipelined.failures > 0 ? "  (failures)" : "");
+		}
+		std::print("\n{} connects, {} reuses\n", client.pool()->connect_count(), client.pool()->reuse_count());
+	}
+
+	running = false;
+	server_thread.join();
+	server.stop();
+	return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file bench_proxy.cpp
+ * @brief Cost of HttpServer::proxy() over serving the upstream directly
+ *
+ * An upstream HttpServer and a proxying HttpServer each run on their own
+ * loop thread; keep-alive clients hit either one. The gap between the
+ * "direct" and "proxy" rows is what the extra hop costs: one more parse,
+ * one more write and a loopback round trip per request. Upstream
+ * connections are pooled, so the connect count printed at the end should
+ * stay near the client connection count while reuses grow with requests.
+ * The large-body rows compare copying the response through user space
+ * with splice(2) (Linux only; elsewhere both rows copy).
+ * Usage: bench_proxy [connections] [seconds] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+struct Client {
+	etn::Socket<etn::Ip<4>> socket;
+	std::string in;
+	Clock::time_point sent;
+};
+
+struct LoadResult {
+	double rps = 0;
+	double p50_ms = 0;
+	double p99_ms = 0;
+	double mib_s = 0;
+};
+
+static double percentile(std::vector<double>& v, double q) {
+	if (v.empty()) return 0;
+	auto idx = static_cast<size_t>(q * static_cast<double>(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+	return v[idx];
+}
+
+/**
+ * @brief Length of the first complete response in buf, or 0 if it is still arriving
+ */
+static size_t complete_response(std::string_view buf) {
+	auto head = buf.find("\r\n\r\n");
+	if (head == std::string_view::npos) return 0;
+	auto cl = buf.substr(0, head).find("Content-Length: ");
+	size_t body = cl == std::string_view::npos ? 0 : static_cast<size_t>(std::atoll(buf.data() + cl + 16));
+	size_t total = head + 4 + body;
+	return buf.size() >= total ? total : 0;
+}
+
+/// Closed-loop keep-alive clients, one request in flight each
+static LoadResult run_load(uint16_t port, std::string_view path, int connections, double seconds) {
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	auto request = std::format("GET {} HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+	std::vector<double> latencies;
+	uint64_t bytes = 0;
+	auto send_request = [&](Client& c) {
+		c.sent = Clock::now();
+		c.socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+	};
+
+	eta::EventLoop loop;
+	std::vector<std::unique_ptr<Client>> clients;
+	bool measuring = true;
+	for (int i = 0; i < connections; ++i) {
+		auto c = std::make_unique<Client>();
+		c->socket.create();
+		if (etherz::core::is_error(c->socket.connect(addr))) break;
+		c->socket.set_nonblocking(true);
+		send_request(*c);
+		auto* raw = c.get();
+		loop.add(c->socket.native_handle(), eta::PollEvent::ReadReady,
+			[&, raw](etn::impl::socket_t, eta::PollEvent) {
+				std::array<uint8_t, 64 * 1024> buf{};
+				int n;
+				while ((n = raw->socket.recv(buf)) > 0) raw->in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				while (auto len = complete_response(raw->in)) {
+					raw->in.erase(0, len);
+					if (measuring) {
+						latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - raw->sent).count());
+						bytes += len;
+					}
+					send_request(*raw);
+				}
+			});
+		clients.push_back(std::move(c));
+	}
+
+	auto start = Clock::now();
+	auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	while (Clock::now() < end) loop.run_once(20);
+	measuring = false;
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	LoadResult result;
+	result.rps = static_cast<double>(latencies.size()) / elapsed;
+	result.mib_s = static_cast<double>(bytes) / elapsed / (1024.0 * 1024.0);
+	result.p50_ms = percentile(latencies, 0.50);
+	result.p99_ms = percentile(latencies, 0.99);
+	auto drain_until = Clock::now() + std::chrono::milliseconds(200);
+	while (Clock::now() < drain_until) loop.run_once(10);
+	return result;
+}
+
+/**
+ * @brief An HttpServer running on its own loop thread
+ */
+struct ServerThread {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::atomic<bool> running{true};
+	std::thread thread;
+
+	bool start(uint16_t port) {
+		if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) {
+			std::print("listen failed on port {}\n", port);
+			return false;
+		}
+		server.attach(loop);
+		thread = std::thread([this] {
+			while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+		});
+		return true;
+	}
+
+	void halt() {
+		running = false;
+		if (thread.joinable()) thread.join();
+	}
+
+	~ServerThread() {
+		halt();
+		server.stop();
+	}
+};
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int connections = (argc > 1) ? std::atoi(argv[1]) : 32;
+	double seconds = (argc > 2) ? std::atof(argv[2]) : 2.0;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Reverse Proxy Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} keep-alive connections, {:.1f} s per run, splice {}\n\n", connections, seconds,
+		etn::SplicePipe::supported() ? "available" : "unavailable");
+
+	const std::string small = "ok";
+	const std::string large(256 * 1024, 'x');
+
+	ServerThread upstream;
+	upstream.server.get("/small", [&](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = small;
+		return resp;
+	});
+	upstream.server.get("/large", [&](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = large;
+		return resp;
+	});
+	auto upstream_port = port;
+	if (!upstream.start(upstream_port)) return 1;
+
+	etp::UpstreamCluster cluster;
+	cluster.endpoints.emplace_back(etn::Ip<4>(127, 0, 0, 1), upstream_port);
+	ServerThread copying, splicing;
+	etp::ProxyOptions copy_options;
+	copy_options.splice = false;
+	copying.server.proxy("/", cluster, copy_options);
+	splicing.server.proxy("/", cluster);
+	auto copy_port = static_cast<uint16_t>(port + 1), splice_port = static_cast<uint16_t>(port + 2);
+	if (!copying.start(copy_port) || !splicing.start(splice_port)) return 1;
+
+	std::print("{:<22} {:>10} {:>10} {:>10} {:>10}\n", "target", "req/s", "p50 ms", "p99 ms", "MiB/s");
+	struct Run { const char* name; uint16_t port; const char* path; };
+	for (auto run : {
+		Run{"direct  2 B", upstream_port, "/small"},
+		Run{"proxy   2 B", splice_port, "/small"},
+		Run{"direct  256 KiB", upstream_port, "/large"},
+		Run{"proxy   256 KiB copy", copy_port, "/large"},
+		Run{"proxy   256 KiB splice", splice_port, "/large"},
+	}) {
+		auto r = run_load(run.port, run.path, connections, seconds);
+		std::print("{:<22} {:>10.0f} {:>10.2f} {:>10.2f} {:>10.0f}\n", run.name, r.rps, r.p50_ms, r.p99_ms, r.mib_s);
+	}
+	// The pools belong to the proxy loop threads
+	copying.halt();
+	splicing.halt();
+	auto reuse = [](const etp::HttpServer& s) {
+		auto* pool = s.upstream_pool("/");
+		return pool ? std::format("{} connects, {} reuses", pool->connect_count(), pool->reuse_count()) : std::string("-");
+	};
+	std::print("\nupstream pool: splice {}; copy {}\n", reuse(splicing.server), reuse(copying.server));
+	return 0;
+}
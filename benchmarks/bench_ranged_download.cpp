@@ -0,0 +1,192 @@
+/**
+ * @file bench_ranged_download.cpp
+ * @brief Parallel Range downloads vs one stream from a per-connection rate-limited server
+ *
+ * The server is a small thread-per-connection HTTP/1.1 responder that
+ * answers HEAD and (ranged) GET for one generated object and paces every
+ * connection to a fixed byte rate, like a CDN or object store that caps
+ * each stream. The client downloads the object into a temporary file with
+ * HttpClient::download_ranges() at several connection counts; with one
+ * connection it is a single stream. Each run checks the file contents.
+ * Usage: bench_ranged_download [MiB] [MiB/s per connection] [port]
+ */
+
+#include "protocol/http_client.hpp"
+#include "net/socket.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+using Clock = std::chrono::steady_clock;
+
+/// Byte i of the object
+static char pattern(uint64_t i) { return static_cast<char>(i % 251); }
+
+class PacedServer {
+public:
+	PacedServer(uint16_t port, uint64_t size, double bytes_per_sec)
+		: address_(etn::Ip<4>(127, 0, 0, 1), port), size_(size), rate_(bytes_per_sec) {
+		listener_.create();
+		listener_.set_reuse_addr(true);
+		ok_ = !etherz::core::is_error(listener_.bind(address_))
+			&& !etherz::core::is_error(listener_.listen());
+		if (ok_) acceptor_ = std::thread([this] { accept_loop(); });
+	}
+
+	~PacedServer() {
+		stopping_ = true;
+		if (acceptor_.joinable()) {
+			// Closing the listener does not wake a blocked accept(); a connection does
+			etn::Socket<etn::Ip<4>> wake;
+			wake.create();
+			wake.connect(address_);
+			acceptor_.join();
+		}
+		listener_.close();
+		std::lock_guard lock(mutex_);
+		for (auto& t : connections_) t.join();
+	}
+
+	bool ok() const { return ok_; }
+
+private:
+	etn::Socket<etn::Ip<4>> listener_;
+	etn::SocketAddress<etn::Ip<4>> address_;
+	uint64_t size_;
+	double rate_;
+	bool ok_ = false;
+	std::atomic<bool> stopping_{false};
+	std::thread acceptor_;
+	std::mutex mutex_;
+	std::vector<std::thread> connections_;
+
+	void accept_loop() {
+		while (!stopping_) {
+			auto conn = listener_.accept();
+			if (!conn || stopping_) return;
+			std::lock_guard lock(mutex_);
+			connections_.emplace_back([this, sock = std::move(conn->socket)]() mutable { serve(sock); });
+		}
+	}
+
+	void serve(etn::Socket<etn::Ip<4>>& sock) {
+		std::string in;
+		std::array<uint8_t, 4096> buf{};
+		while (!stopping_) {
+			size_t end;
+			while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+				int n = sock.recv(buf);
+				if (n <= 0) return;
+				in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+			}
+			auto head = in.substr(0, end);
+			in.erase(0, end + 4);
+			bool is_head = head.starts_with("HEAD ");
+			uint64_t first = 0, last = size_ - 1;
+			bool ranged = false;
+			if (auto pos = head.find("\r\nRange: bytes="); pos != std::string::npos) {
+				ranged = std::sscanf(head.c_str() + pos + 15, "%llu-%llu",
+					reinterpret_cast<unsigned long long*>(&first), reinterpret_cast<unsigned long long*>(&last)) == 2;
+				if (last >= size_) last = size_ - 1;
+			}
+			auto length = last - first + 1;
+			std::string out = ranged
+				? std::format("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes {}-{}/{}\r\n", first, last, size_)
+				: std::string("HTTP/1.1 200 OK\r\nAccept-Ranges: bytes\r\n");
+			out += std::format("Content-Length: {}\r\n\r\n", length);
+			if (!send_all(sock, out)) return;
+			if (!is_head && !send_body(sock, first, length)) return;
+		}
+	}
+
+	bool send_body(etn::Socket<etn::Ip<4>>& sock, uint64_t offset, uint64_t length) {
+		constexpr size_t CHUNK = 64 * 1024;
+		std::string chunk;
+		auto start = Clock::now();
+		uint64_t sent = 0;
+		while (sent < length) {
+			// Pace: never ahead of rate_ bytes per second since the body started
+			auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(static_cast<double>(sent) / rate_));
+			std::this_thread::sleep_until(due);
+			auto n = static_cast<size_t>(std::min<uint64_t>(CHUNK, length - sent));
+			chunk.resize(n);
+			for (size_t i = 0; i < n; ++i) chunk[i] = pattern(offset + sent + i);
+			if (!send_all(sock, chunk)) return false;
+			sent += n;
+		}
+		return true;
+	}
+
+	static bool send_all(etn::Socket<etn::Ip<4>>& sock, std::string_view data) {
+		while (!data.empty()) {
+			int n = sock.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+			if (n <= 0) return false;
+			data.remove_prefix(static_cast<size_t>(n));
+		}
+		return true;
+	}
+};
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	uint64_t mib = (argc > 1) ? static_cast<uint64_t>(std::atoi(argv[1])) : 64;
+	double rate_mib = (argc > 2) ? std::atof(argv[2]) : 16;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+	uint64_t size = mib << 20;
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Ranged Download Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("{} MiB object, server paces each connection to {} MiB/s\n\n", mib, rate_mib);
+
+	PacedServer server(port, size, rate_mib * 1024 * 1024);
+	if (!server.ok()) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+
+	auto url = etp::Url::parse(std::format("http://127.0.0.1:{}/object", port));
+	etp::HttpClient client;
+	std::print("{:<12} {:>10} {:>10} {:>10}\n", "connections", "seconds", "MiB/s", "intact");
+	for (size_t connections : {1, 2, 4, 8}) {
+		auto* file = std::tmpfile();
+		if (!file) return 1;
+		etp::RangedDownloadOptions options;
+		options.connections = connections;
+		options.part_size = 4ull << 20;
+		bool intact = false;
+		options.verify = [&](int, uint64_t bytes) {
+			if (bytes != size) return false;
+			std::vector<char> buf(1 << 20);
+			std::rewind(file); // Written through the descriptor only, so stdio has nothing buffered
+			uint64_t offset = 0;
+			bool same = true;
+			while (auto n = std::fread(buf.data(), 1, buf.size(), file)) {
+				for (size_t i = 0; i < n && same; ++i) same = buf[i] == pattern(offset + i);
+				offset += n;
+			}
+			return intact = same && offset == size;
+		};
+		auto start = Clock::now();
+		auto res = client.download_ranges(url, fileno(file), options);
+		double secs = std::chrono::duration<double>(Clock::now() - start).count();
+		std::fclose(file);
+		std::print("{:<12} {:>10.2f} {:>10.1f} {:>10}\n", connections, secs,
+			static_cast<double>(mib) / secs, res && intact ? "yes" : "no");
+	}
+	return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file bench_shedding.cpp
+ * @brief Goodput and tail latency at 2x overload, with and without shedding
+ *
+ * One server thread runs a handler that burns 1 ms of CPU, so it tops out
+ * near 1000 req/s. An open-loop client offers a multiple of that rate
+ * (requests are sent on schedule whether or not earlier ones finished,
+ * pipelined over a pool of keep-alive connections) and measures each
+ * response against the time its request was due. Without admission
+ * control the backlog and the latency of every request grow for the whole
+ * run; with it, excess requests get a fast 503 and the ones served stay
+ * near the queue-delay target.
+ * Usage: bench_shedding [overload_factor] [seconds] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+constexpr auto WORK = std::chrono::microseconds(1000);
+constexpr auto SLO = std::chrono::milliseconds(100);
+constexpr int CONNECTIONS = 64;
+
+struct Client {
+	etn::Socket<etn::Ip<4>> socket;
+	std::string in;
+	std::deque<Clock::time_point> due; // Responses arrive in request order
+};
+
+struct RunResult {
+	uint64_t sent = 0;
+	uint64_t ok = 0;
+	uint64_t ok_in_slo = 0;
+	uint64_t shed = 0;
+	std::vector<double> ok_ms;
+};
+
+/**
+ * @brief Offer `rate` req/s for `seconds`, then collect outstanding responses for as long again
+ */
+static RunResult run_load(uint16_t port, double rate, double seconds) {
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	constexpr std::string_view request = "GET /work HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	RunResult result;
+
+	eta::EventLoop loop;
+	std::vector<std::unique_ptr<Client>> clients;
+	for (int i = 0; i < CONNECTIONS; ++i) {
+		auto c = std::make_unique<Client>();
+		c->socket.create();
+		if (etherz::core::is_error(c->socket.connect(addr))) break;
+		c->socket.set_nonblocking(true);
+		auto* raw = c.get();
+		loop.add(c->socket.native_handle(), eta::PollEvent::ReadReady,
+			[&, raw](etn::impl::socket_t, eta::PollEvent) {
+				std::array<uint8_t, 16384> buf{};
+				int n;
+				while ((n = raw->socket.recv(buf)) > 0) raw->in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				while (true) {
+					auto head_end = raw->in.find("\r\n\r\n");
+					if (head_end == std::string::npos || raw->due.empty()) break;
+					auto head = std::string_view(raw->in).substr(0, head_end);
+					auto cl = head.find("Content-Length: ");
+					size_t length = cl == std::string_view::npos ? 0
+						: static_cast<size_t>(std::atoll(head.data() + cl + 16));
+					if (raw->in.size() < head_end + 4 + length) break;
+
+					auto latency = Clock::now() - raw->due.front();
+					raw->due.pop_front();
+					if (head.starts_with("HTTP/1.1 200")) {
+						++result.ok;
+						if (latency <= SLO) ++result.ok_in_slo;
+						result.ok_ms.push_back(std::chrono::duration<double, std::milli>(latency).count());
+					} else {
+						++result.shed;
+					}
+					raw->in.erase(0, head_end + 4 + length);
+				}
+			});
+		clients.push_back(std::move(c));
+	}
+	if (clients.empty()) return result;
+
+	auto start = Clock::now();
+	auto run_for = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	size_t next = 0;
+	while (Clock::now() < start + run_for) {
+		auto now = Clock::now();
+		auto target = static_cast<uint64_t>(std::chrono::duration<double>(now - start).count() * rate);
+		for (; result.sent < target; ++result.sent) {
+			auto& c = *clients[next++ % clients.size()];
+			// Charge the request to when it was due, not when the loop got to it
+			auto due = start + std::chrono::duration_cast<Clock::duration>(
+				std::chrono::duration<double>(static_cast<double>(result.sent) / rate));
+			c.due.push_back(due);
+			c.socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+		}
+		loop.run_once(1);
+	}
+
+	auto give_up = Clock::now() + run_for;
+	auto outstanding = [&] {
+		return std::any_of(clients.begin(), clients.end(), [](const auto& c) { return !c->due.empty(); });
+	};
+	while (outstanding() && Clock::now() < give_up) loop.run_once(10);
+	return result;
+}
+
+static double percentile(std::vector<double>& samples, double q) {
+	if (samples.empty()) return 0;
+	std::sort(samples.begin(), samples.end());
+	auto idx = static_cast<size_t>(q * static_cast<double>(samples.size() - 1));
+	return samples[idx];
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	double factor = (argc > 1) ? std::atof(argv[1]) : 2.0;
+	double seconds = (argc > 2) ? std::atof(argv[2]) : 3.0;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Load Shedding Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	double capacity = 1e6 / static_cast<double>(WORK.count());
+	double rate = capacity * factor;
+	std::print("Handler {} us CPU (~{:.0f} req/s), offered {:.0f} req/s for {:.1f} s, SLO {} ms\n\n",
+		WORK.count(), capacity, rate, seconds, SLO.count());
+	std::print("{:<10} {:>10} {:>10} {:>14} {:>10} {:>10} {:>10}\n",
+		"shedding", "ok r/s", "503 r/s", "goodput r/s", "lost", "p50 ms", "p99 ms");
+
+	for (bool shedding : {false, true}) {
+		etp::HttpServer server;
+		server.get("/work", [](const etp::HttpRequest&) {
+			auto until = Clock::now() + WORK;
+			while (Clock::now() < until) {}
+			etp::HttpResponse resp;
+			resp.body = "ok";
+			return resp;
+		});
+		if (shedding) server.enable_admission_control();
+		auto run_port = static_cast<uint16_t>(port + (shedding ? 1 : 0));
+		if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), run_port)))) {
+			std::print("listen failed on port {}\n", run_port);
+			return 1;
+		}
+		eta::EventLoop loop;
+		server.attach(loop);
+		std::atomic<bool> running{true};
+		std::thread server_thread([&] {
+			while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+		});
+
+		auto r = run_load(run_port, rate, seconds);
+		running = false;
+		server_thread.join();
+
+		// Every request counts against the offered window, however late it finished
+		std::print("{:<10} {:>10.0f} {:>10.0f} {:>14.0f} {:>10} {:>10.1f} {:>10.1f}\n",
+			shedding ? "on" : "off",
+			static_cast<double>(r.ok) / seconds, static_cast<double>(r.shed) / seconds,
+			static_cast<double>(r.ok_in_slo) / seconds, r.sent - r.ok - r.shed,
+			percentile(r.ok_ms, 0.50), percentile(r.ok_ms, 0.99));
+	}
+	std::print("\n(goodput: 200 responses within the SLO; lost: no response before giving up)\n");
+	return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file bench_sse.cpp
+ * @brief Server-Sent Events fan-out to many subscribers on one loop
+ *
+ * Opens up to 10k event-stream subscribers against one HttpServer, then
+ * publishes rounds of events and drains every client until all bytes have
+ * arrived. "shared" publishes through SseBroadcaster (one serialization,
+ * one buffer referenced by every write queue); "per-sub" serializes the
+ * event again for each subscriber, as a naive loop over streams would.
+ * The subscriber count is clamped to what the open-file limit allows.
+ * Usage: bench_sse [subscribers] [rounds] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+constexpr int EVENTS_PER_ROUND = 8;
+
+/// Subscribers that fit in the fd limit (each takes a client and a server socket)
+static int clamp_to_fd_limit(int wanted) {
+#ifndef _WIN32
+	rlimit lim{};
+	if (getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+		lim.rlim_cur = lim.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &lim);
+		getrlimit(RLIMIT_NOFILE, &lim);
+		auto fit = static_cast<int>((lim.rlim_cur - 64) / 2);
+		if (fit < wanted) return fit;
+	}
+#endif
+	return wanted;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int wanted = (argc > 1) ? std::atoi(argv[1]) : 10'000;
+	int rounds = (argc > 2) ? std::atoi(argv[2]) : 50;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+	int subscribers = clamp_to_fd_limit(wanted);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz SSE Fan-out Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	etp::HttpServer server;
+	etp::SseBroadcaster hub;
+	std::vector<std::shared_ptr<etp::SseStream>> streams;
+	server.set_sse_options({.heartbeat = std::chrono::milliseconds(0)});
+	server.sse("/events", [&](const etp::HttpRequest&, std::shared_ptr<etp::SseStream> stream) {
+		streams.push_back(stream);
+		hub.subscribe(std::move(stream));
+	});
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	if (etherz::core::is_error(server.listen(addr))) {
+		std::print("listen failed on port {}\n", port);
+		return 1;
+	}
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	// ─── Subscribe ────────────────
+
+	std::string request = "GET /events HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	std::vector<etn::Socket<etn::Ip<4>>> clients;
+	clients.reserve(static_cast<size_t>(subscribers));
+	std::array<uint8_t, 16384> buf{};
+	auto drain_client = [&](etn::Socket<etn::Ip<4>>& c) {
+		uint64_t got = 0;
+		int n;
+		while ((n = c.recv(buf)) > 0) got += static_cast<uint64_t>(n);
+		return got;
+	};
+
+	for (int i = 0; i < subscribers; ++i) {
+		etn::Socket<etn::Ip<4>> c;
+		c.create();
+		if (etherz::core::is_error(c.connect(addr))) break;
+		c.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+		c.set_nonblocking(true);
+		clients.push_back(std::move(c));
+		if (clients.size() % 128 == 0) {
+			while (streams.size() < clients.size()) loop.run_once(10);
+		}
+	}
+	while (streams.size() < clients.size()) loop.run_once(10);
+	for (auto& c : clients) drain_client(c); // Response heads
+	subscribers = static_cast<int>(clients.size());
+
+	// ─── Publish ────────────────
+
+	etp::SseEvent event;
+	event.event = "quote";
+	event.data = R"({"symbol":"ETHZ","bid":101.25,"ask":101.27,"ts":1760000000000})";
+	auto wire_size = event.serialize().size();
+
+	auto run = [&](bool shared) {
+		auto expected = static_cast<uint64_t>(wire_size) * EVENTS_PER_ROUND * static_cast<uint64_t>(subscribers);
+		auto start = Clock::now();
+		for (int r = 0; r < rounds; ++r) {
+			for (int e = 0; e < EVENTS_PER_ROUND; ++e) {
+				if (shared) {
+					hub.publish(event);
+				} else {
+					for (auto& s : streams) s->send(event);
+				}
+			}
+			uint64_t received = 0;
+			while (received < expected) {
+				loop.run_once(0);
+				for (auto& c : clients) received += drain_client(c);
+			}
+		}
+		double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		return static_cast<double>(rounds) * EVENTS_PER_ROUND * subscribers / elapsed;
+	};
+
+	std::print("{} subscribers ({} requested), {} B per event, {} rounds of {} events\n\n",
+		subscribers, wanted, wire_size, rounds, EVENTS_PER_ROUND);
+	double per_sub = run(false);
+	double shared = run(true);
+	std::print("{:<10} {:>18}\n", "mode", "events/s delivered");
+	std::print("{:<10} {:>18.0f}\n", "per-sub", per_sub);
+	std::print("{:<10} {:>18.0f}\n", "shared", shared);
+	std::print("\n(delivered = events x subscribers; client reads run on the same thread)\n");
+
+	server.stop();
+	return 0;
+}
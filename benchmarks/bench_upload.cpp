@@ -0,0 +1,160 @@
+/**
+ * @file bench_upload.cpp
+ * @brief Multi-GB uploads into a streaming route with flat memory
+ *
+ * Runs HttpServer on an EventLoop thread and PUTs a large body over
+ * loopback, once with Content-Length and once chunked. The handler only
+ * counts bytes, so resident memory should stay at its baseline however
+ * large the upload; RSS is sampled from /proc/self/statm while sending.
+ * Usage: bench_upload [gib] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+/// Resident set size in MiB (0 where /proc is unavailable)
+static double rss_mib() {
+#ifdef _WIN32
+	return 0;
+#else
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	if (!(statm >> pages >> resident)) return 0;
+	return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#endif
+}
+
+static bool send_all(etn::Socket<etn::Ip<4>>& sock, std::string_view data) {
+	while (!data.empty()) {
+		int n = sock.send(std::span<const uint8_t>(
+			reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+		if (n <= 0) return false;
+		data.remove_prefix(static_cast<size_t>(n));
+	}
+	return true;
+}
+
+struct UploadResult {
+	double seconds = 0;
+	double peak_rss = 0;
+	std::string reply;
+};
+
+static UploadResult upload(const etn::SocketAddress<etn::Ip<4>>& addr, uint64_t total, bool chunked) {
+	UploadResult result;
+	etn::Socket<etn::Ip<4>> sock;
+	sock.create();
+	if (etherz::core::is_error(sock.connect(addr))) return result;
+
+	std::string head = "PUT /upload HTTP/1.1\r\nHost: localhost\r\n";
+	head += chunked ? std::string("Transfer-Encoding: chunked\r\n\r\n")
+		: std::format("Content-Length: {}\r\n\r\n", total);
+	if (!send_all(sock, head)) return result;
+
+	constexpr size_t BLOCK = 256 * 1024;
+	std::string block(BLOCK, 'x');
+	std::string chunk_head = std::format("{:x}\r\n", BLOCK);
+	uint64_t sent = 0, next_sample = 0;
+
+	auto start = Clock::now();
+	while (sent < total) {
+		size_t n = static_cast<size_t>(std::min<uint64_t>(BLOCK, total - sent));
+		if (chunked) {
+			if (n != BLOCK) chunk_head = std::format("{:x}\r\n", n);
+			if (!send_all(sock, chunk_head)) return result;
+		}
+		if (!send_all(sock, std::string_view(block).substr(0, n))) return result;
+		if (chunked && !send_all(sock, "\r\n")) return result;
+		sent += n;
+		if (sent >= next_sample) {
+			result.peak_rss = std::max(result.peak_rss, rss_mib());
+			next_sample += 64ull << 20;
+		}
+	}
+	if (chunked && !send_all(sock, "0\r\n\r\n")) return result;
+
+	std::array<uint8_t, 4096> buf{};
+	while (result.reply.find("\r\n\r\n") == std::string::npos || !result.reply.ends_with("\n")) {
+		int n = sock.recv(buf);
+		if (n <= 0) break;
+		result.reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+	}
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	double gib = (argc > 1) ? std::atof(argv[1]) : 4.0;
+	auto port = static_cast<uint16_t>((argc > 2) ? std::atoi(argv[2]) : 18080);
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	auto total = static_cast<uint64_t>(gib * 1024.0 * 1024.0 * 1024.0);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Streaming Upload Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+
+	etp::HttpServer server;
+	std::atomic<uint64_t> consumed{0};
+	server.stream(etp::HttpMethod::Put, "/upload", {
+		.on_headers = {},
+		.on_data = [&](std::string_view data, etp::BodyStream&) {
+			consumed.fetch_add(data.size(), std::memory_order_relaxed);
+		},
+		.on_complete = [](const etp::HttpRequest&, etp::BodyStream& body) {
+			etp::HttpResponse resp;
+			resp.body = std::format("{}\n", body.bytes_received());
+			return resp;
+		},
+		.on_abort = {},
+	});
+	if (etherz::core::is_error(server.listen(addr))) {
+		std::print("Failed to listen on port {}\n", port);
+		return 1;
+	}
+
+	eta::EventLoop loop;
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+	});
+
+	double baseline = rss_mib();
+	auto by_length = upload(addr, total, false);
+	auto by_chunks = upload(addr, total, true);
+
+	running = false;
+	server_thread.join();
+
+	std::print("Upload size: {:.2f} GiB, baseline RSS {:.1f} MiB\n\n", gib, baseline);
+	std::print("{:<16} {:>10} {:>12} {:>16}\n", "framing", "seconds", "MiB/s", "peak RSS (MiB)");
+	auto row = [&](const char* name, const UploadResult& r) {
+		std::print("{:<16} {:>10.3f} {:>12.0f} {:>16.1f}\n", name, r.seconds,
+			r.seconds > 0 ? static_cast<double>(total) / (1024.0 * 1024.0) / r.seconds : 0.0, r.peak_rss);
+	};
+	row("Content-Length", by_length);
+	row("chunked", by_chunks);
+	std::print("\nServer consumed {} bytes\n", consumed.load());
+	return 0;
+}
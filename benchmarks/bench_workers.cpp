@@ -0,0 +1,147 @@
+/**
+ * @file bench_workers.cpp
+ * @brief Requests/s and p99 of a blocking handler across worker pool sizes
+ *
+ * The handler sleeps 2 ms, standing in for a blocking library call. With
+ * no pool it runs on the event-loop thread, so throughput caps near
+ * 500 req/s and every connection queues behind every other. With
+ * enable_workers(n), n handlers block in parallel while the loop keeps
+ * doing the I/O; throughput should scale with n until the connection
+ * count or the reactor thread becomes the limit.
+ * Usage: bench_workers [connections] [seconds] [port]
+ */
+
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+constexpr auto BLOCKING_CALL = std::chrono::milliseconds(2);
+
+struct Client {
+	etn::Socket<etn::Ip<4>> socket;
+	std::string in;
+	Clock::time_point sent;
+};
+
+struct LoadResult {
+	double rps = 0;
+	double p99_ms = 0;
+};
+
+/// Closed-loop keep-alive clients, one request in flight each
+static LoadResult run_load(uint16_t port, int connections, double seconds) {
+	etn::SocketAddress<etn::Ip<4>> addr(etn::Ip<4>(127, 0, 0, 1), port);
+	constexpr std::string_view request = "GET /blocking HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	std::vector<double> latencies;
+	auto send_request = [&](Client& c) {
+		c.sent = Clock::now();
+		c.socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+	};
+
+	eta::EventLoop loop;
+	std::vector<std::unique_ptr<Client>> clients;
+	bool measuring = true;
+	for (int i = 0; i < connections; ++i) {
+		auto c = std::make_unique<Client>();
+		c->socket.create();
+		if (etherz::core::is_error(c->socket.connect(addr))) break;
+		c->socket.set_nonblocking(true);
+		send_request(*c);
+		auto* raw = c.get();
+		loop.add(c->socket.native_handle(), eta::PollEvent::ReadReady,
+			[&, raw](etn::impl::socket_t, eta::PollEvent) {
+				std::array<uint8_t, 4096> buf{};
+				int n;
+				while ((n = raw->socket.recv(buf)) > 0) raw->in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				// Each response ends with the two-byte body
+				for (auto end = raw->in.find("\r\n\r\nok"); end != std::string::npos; end = raw->in.find("\r\n\r\nok")) {
+					raw->in.erase(0, end + 6);
+					if (measuring) latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - raw->sent).count());
+					send_request(*raw);
+				}
+			});
+		clients.push_back(std::move(c));
+	}
+
+	auto start = Clock::now();
+	auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	while (Clock::now() < end) loop.run_once(20);
+	measuring = false;
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	LoadResult result;
+	result.rps = static_cast<double>(latencies.size()) / elapsed;
+	if (!latencies.empty()) {
+		auto idx = static_cast<size_t>(0.99 * static_cast<double>(latencies.size() - 1));
+		std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(idx), latencies.end());
+		result.p99_ms = latencies[idx];
+	}
+	// Let the server finish what is in flight before the next run
+	auto drain_until = Clock::now() + std::chrono::milliseconds(200);
+	while (Clock::now() < drain_until) loop.run_once(10);
+	return result;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	int connections = (argc > 1) ? std::atoi(argv[1]) : 64;
+	double seconds = (argc > 2) ? std::atof(argv[2]) : 2.0;
+	auto port = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 18080);
+
+	std::print("═══════════════════════════════════\n");
+	std::print("  Etherz Worker Pool Benchmark\n");
+	std::print("═══════════════════════════════════\n\n");
+	std::print("Handler blocks {} ms, {} keep-alive connections, {:.1f} s per run\n\n",
+		BLOCKING_CALL.count(), connections, seconds);
+	std::print("{:<10} {:>12} {:>12} {:>12}\n", "workers", "req/s", "p99 ms", "ideal r/s");
+
+	for (size_t workers : {size_t{0}, size_t{1}, size_t{2}, size_t{4}, size_t{8}, size_t{16}, size_t{32}, size_t{64}}) {
+		etp::HttpServer server;
+		server.get("/blocking", [](const etp::HttpRequest&) {
+			std::this_thread::sleep_for(BLOCKING_CALL);
+			etp::HttpResponse resp;
+			resp.body = "ok";
+			return resp;
+		});
+		if (workers > 0) server.enable_workers(workers);
+		auto run_port = static_cast<uint16_t>(port + workers);
+		if (etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), run_port)))) {
+			std::print("listen failed on port {}\n", run_port);
+			return 1;
+		}
+		eta::EventLoop loop;
+		server.attach(loop);
+		std::atomic<bool> running{true};
+		std::thread server_thread([&] {
+			while (running.load(std::memory_order_relaxed)) loop.run_once(50);
+		});
+
+		auto r = run_load(run_port, connections, seconds);
+		running = false;
+		server_thread.join();
+		server.stop();
+
+		double ideal = static_cast<double>(std::min<size_t>(std::max<size_t>(workers, 1), static_cast<size_t>(connections)))
+			* 1000.0 / static_cast<double>(BLOCKING_CALL.count());
+		std::print("{:<10} {:>12.0f} {:>12.1f} {:>12.0f}\n",
+			workers == 0 ? std::string("inline") : std::to_string(workers), r.rps, r.p99_ms, ideal);
+	}
+	return 0;
+}
@@ -14,9 +14,14 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <print>
 
 #include "poll.hpp"
+#include "timer_wheel.hpp"
 #include "../net/socket.hpp"
 
 namespace etherz {
@@ -29,15 +34,95 @@ namespace async {
  */
 using EventCallback = std::function<void(net::impl::socket_t fd, PollEvent events)>;
 
+/**
+ * @brief Pollable self-notification channel
+ *
+ * A non-blocking pipe on POSIX; on Windows, where only sockets can be
+ * polled, a UDP socket connected to itself on loopback. notify() makes
+ * handle() readable until drain() is called.
+ */
+class Waker {
+public:
+	Waker() noexcept {
+#ifdef _WIN32
+		net::impl::ensure_wsa();
+		read_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (read_ == net::impl::invalid_socket) return;
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		int len = sizeof(addr);
+		if (::bind(read_, reinterpret_cast<sockaddr*>(&addr), len) != 0
+			|| ::getsockname(read_, reinterpret_cast<sockaddr*>(&addr), &len) != 0
+			|| ::connect(read_, reinterpret_cast<sockaddr*>(&addr), len) != 0) {
+			net::impl::close_socket(read_);
+			read_ = net::impl::invalid_socket;
+			return;
+		}
+		net::impl::set_nonblocking_impl(read_, true);
+		write_ = read_;
+#else
+		int fds[2];
+		if (::pipe(fds) != 0) return;
+		for (int fd : fds) {
+			::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+			::fcntl(fd, F_SETFD, FD_CLOEXEC);
+		}
+		read_ = fds[0];
+		write_ = fds[1];
+#endif
+	}
+
+	~Waker() noexcept {
+		if (read_ != net::impl::invalid_socket) net::impl::close_socket(read_);
+#ifndef _WIN32
+		if (write_ != net::impl::invalid_socket) ::close(write_);
+#endif
+	}
+
+	Waker(const Waker&) = delete;
+	Waker& operator=(const Waker&) = delete;
+
+	bool is_open() const noexcept { return read_ != net::impl::invalid_socket; }
+	net::impl::socket_t handle() const noexcept { return read_; }
+
+	void notify() noexcept {
+		char byte = 1;
+#ifdef _WIN32
+		::send(write_, &byte, 1, 0);
+#else
+		[[maybe_unused]] auto n = ::write(write_, &byte, 1);
+#endif
+	}
+
+	void drain() noexcept {
+		char buf[64];
+#ifdef _WIN32
+		while (::recv(read_, buf, sizeof(buf), 0) > 0) {}
+#else
+		while (::read(read_, buf, sizeof(buf)) > 0) {}
+#endif
+	}
+
+private:
+	net::impl::socket_t read_ = net::impl::invalid_socket;
+	net::impl::socket_t write_ = net::impl::invalid_socket;
+};
+
 /**
  * @brief Single-threaded event loop using poll-based I/O multiplexing
  * 
  * Register sockets with interest events and callbacks. The loop polls
  * all registered sockets and dispatches callbacks when events occur.
+ * Coarse timers (timers()) are fired after each poll; while any are armed
+ * the poll timeout is capped at one wheel tick. post() is the one call
+ * that is safe from other threads: it queues a task for the loop thread
+ * and wakes a blocked poll.
  */
 class EventLoop {
 public:
-	EventLoop() noexcept = default;
+	EventLoop() = default;
+	explicit EventLoop(std::chrono::milliseconds timer_tick) : timers_(timer_tick) {}
 
 	/**
 	 * @brief Register a socket with interest events and callback
@@ -70,18 +155,44 @@ public:
 	 * @return Number of events dispatched
 	 */
 	int run_once(int timeout_ms = -1) {
-		if (registrations_.empty()) return 0;
+		loop_thread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+		if (registrations_.empty()) {
+			run_posted();
+			if (timers_.empty()) return 0;
+			std::this_thread::sleep_for(timers_.tick());
+			timers_.advance();
+			return 0;
+		}
+		if (!timers_.empty()) {
+			auto tick = static_cast<int>(timers_.tick().count());
+			if (timeout_ms < 0 || timeout_ms > tick) timeout_ms = tick;
+		}
+		if (has_posted_.load(std::memory_order_acquire)) timeout_ms = 0;
 
-		// Build poll entries
-		poll_entries_.resize(registrations_.size());
-		for (size_t i = 0; i < registrations_.size(); ++i) {
+		// Build poll entries; the waker, if any, goes last
+		size_t count = registrations_.size();
+		poll_entries_.resize(count + (waker_.is_open() ? 1 : 0));
+		for (size_t i = 0; i < count; ++i) {
 			poll_entries_[i].fd = registrations_[i].fd;
 			poll_entries_[i].requested = registrations_[i].interest;
 			poll_entries_[i].returned = PollEvent::None;
 		}
+		if (waker_.is_open()) poll_entries_[count] = {waker_.handle(), PollEvent::ReadReady, PollEvent::None};
 
+		auto entered = std::chrono::steady_clock::now();
 		int ready = async::poll(poll_entries_, timeout_ms);
-		if (ready <= 0) return 0;
+		auto returned = std::chrono::steady_clock::now();
+		// Without blocking, the events were already pending while the last cycle ran
+		pending_since_ = returned - entered < std::chrono::microseconds(100) ? turn_started_ : returned;
+		turn_started_ = returned;
+		if (ready <= 0) {
+			run_posted();
+			timers_.advance();
+			return 0;
+		}
+		if (poll_entries_.size() > count && poll_entries_[count].returned != PollEvent::None) {
+			waker_.drain();
+		}
 
 		// Snapshot registrations to avoid iterator invalidation
 		// when callbacks call add()/remove()
@@ -100,9 +211,27 @@ public:
 			}
 		}
 
+		run_posted();
+		timers_.advance();
 		return dispatched;
 	}
 
+	/**
+	 * @brief Queue task to run on the loop thread (safe from any thread)
+	 *
+	 * Tasks run after the current dispatch cycle, in posting order. A post
+	 * from another thread wakes a loop blocked in poll; one from the loop
+	 * thread only shortens the next poll to zero.
+	 */
+	void post(std::function<void()> task) {
+		{
+			std::lock_guard lock(post_mutex_);
+			posted_.push_back(std::move(task));
+			has_posted_.store(true, std::memory_order_release);
+		}
+		if (loop_thread_.load(std::memory_order_relaxed) != std::this_thread::get_id()) waker_.notify();
+	}
+
 	/**
 	 * @brief Run the event loop continuously until stop() is called
 	 * @param timeout_ms Timeout per poll cycle
@@ -136,6 +265,20 @@ public:
 	 */
 	bool empty() const noexcept { return registrations_.empty(); }
 
+	/**
+	 * @brief Coarse timers driven by this loop
+	 */
+	TimerWheel& timers() noexcept { return timers_; }
+
+	/**
+	 * @brief Earliest time the events of the current dispatch cycle may have become ready
+	 *
+	 * The poll's return if it had to wait for them; otherwise the start of
+	 * the previous cycle, since they piled up while its callbacks ran. Used
+	 * as an upper-bound estimate of how long an event has been queued.
+	 */
+	std::chrono::steady_clock::time_point pending_since() const noexcept { return pending_since_; }
+
 private:
 	struct Registration {
 		net::impl::socket_t fd;
@@ -145,7 +288,28 @@ private:
 
 	std::vector<Registration> registrations_;
 	std::vector<PollEntry> poll_entries_;
+	TimerWheel timers_;
+	std::chrono::steady_clock::time_point turn_started_ = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point pending_since_ = turn_started_;
 	bool running_ = false;
+
+	// Cross-thread task queue
+	Waker waker_;
+	std::mutex post_mutex_;
+	std::vector<std::function<void()>> posted_;
+	std::atomic<bool> has_posted_{false};
+	std::atomic<std::thread::id> loop_thread_{};
+
+	void run_posted() {
+		if (!has_posted_.load(std::memory_order_acquire)) return;
+		std::vector<std::function<void()>> tasks;
+		{
+			std::lock_guard lock(post_mutex_);
+			tasks.swap(posted_);
+			has_posted_.store(false, std::memory_order_relaxed);
+		}
+		for (auto& task : tasks) task();
+	}
 };
 
 } // namespace async
@@ -12,7 +12,10 @@
 
 #include <cstdint>
 #include <span>
+#include <memory>
+#include <string_view>
 #include "../core/error.hpp"
+#include "../net/socket.hpp"
 
 #ifdef _WIN32
 	#ifndef WIN32_LEAN_AND_MEAN
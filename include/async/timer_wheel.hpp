@@ -0,0 +1,188 @@
+/**
+ * @file timer_wheel.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Coarse hashed timing wheel with O(1) schedule and cancel
+ * @version 1.0.0
+ * @date 2026-02-19
+ * 
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+namespace etherz {
+namespace async {
+
+class TimerWheel;
+
+/**
+ * @brief Intrusive timer owned by the caller
+ *
+ * Embed one in per-connection state; scheduling and cancelling only relink
+ * it, so arming a timeout never allocates. Destroying an armed timer
+ * cancels it.
+ */
+class Timer {
+public:
+	Timer() noexcept = default;
+	explicit Timer(std::function<void()> callback) : callback(std::move(callback)) {}
+	~Timer();
+
+	Timer(const Timer&) = delete;
+	Timer& operator=(const Timer&) = delete;
+
+	/// Invoked from TimerWheel::advance() when the timer expires
+	std::function<void()> callback;
+
+	bool armed() const noexcept { return prev_ != nullptr; }
+
+private:
+	friend class TimerWheel;
+
+	Timer* prev_ = nullptr;
+	Timer* next_ = nullptr;
+	TimerWheel* wheel_ = nullptr;
+	uint64_t expiry_ = 0;
+
+	void unlink() noexcept {
+		if (!prev_) return;
+		prev_->next_ = next_;
+		next_->prev_ = prev_;
+		prev_ = next_ = nullptr;
+	}
+
+	void link_before(Timer& pos) noexcept {
+		prev_ = pos.prev_;
+		next_ = &pos;
+		pos.prev_->next_ = this;
+		pos.prev_ = this;
+	}
+};
+
+/**
+ * @brief Hashed timing wheel
+ *
+ * Time advances in fixed ticks; a timer lands in slot (expiry % slots).
+ * Delays are rounded up to whole ticks and measured from the last
+ * advance(), which is what makes the wheel coarse and cheap: neither
+ * schedule() nor cancel() reads the clock. Delays longer than one
+ * revolution stay in their slot until their tick comes round.
+ */
+class TimerWheel {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(100), size_t slots = 512)
+		: tick_(std::max<std::chrono::milliseconds>(tick, std::chrono::milliseconds(1)))
+		, slots_(std::max<size_t>(slots, 1))
+		, origin_(Clock::now())
+	{
+		for (auto& s : slots_) s.prev_ = s.next_ = &s;
+	}
+
+	TimerWheel(const TimerWheel&) = delete;
+	TimerWheel& operator=(const TimerWheel&) = delete;
+
+	~TimerWheel() {
+		for (auto& s : slots_) {
+			while (s.next_ != &s) {
+				s.next_->wheel_ = nullptr;
+				s.next_->unlink();
+			}
+			s.prev_ = s.next_ = nullptr;
+		}
+	}
+
+	/**
+	 * @brief Arm (or re-arm) timer to fire after delay
+	 */
+	void schedule(Timer& timer, std::chrono::milliseconds delay) noexcept {
+		cancel(timer);
+		auto ticks = static_cast<uint64_t>((delay + tick_ - std::chrono::milliseconds(1)) / tick_);
+		timer.expiry_ = now_ + std::max<uint64_t>(ticks, 1);
+		timer.link_before(slots_[timer.expiry_ % slots_.size()]);
+		timer.wheel_ = this;
+		++armed_;
+	}
+
+	void cancel(Timer& timer) noexcept {
+		if (!timer.armed()) return;
+		timer.unlink();
+		timer.wheel_ = nullptr;
+		--armed_;
+	}
+
+	/**
+	 * @brief Fire every timer whose tick has passed
+	 * @return Number of timers fired
+	 */
+	size_t advance(Clock::time_point now = Clock::now()) {
+		auto target = static_cast<uint64_t>((now - origin_) / tick_);
+		if (target <= now_) return 0;
+
+		// After a long stall every slot is visited once rather than every tick
+		uint64_t steps = std::min<uint64_t>(target - now_, slots_.size());
+		uint64_t first = target - steps + 1;
+		now_ = target;
+
+		size_t fired = 0;
+		for (uint64_t t = first; t <= target; ++t) {
+			auto& slot = slots_[t % slots_.size()];
+
+			// Detach the slot so callbacks may schedule into it safely
+			Timer pending;
+			pending.prev_ = pending.next_ = &pending;
+			if (slot.next_ != &slot) {
+				pending.next_ = slot.next_;
+				pending.prev_ = slot.prev_;
+				pending.next_->prev_ = &pending;
+				pending.prev_->next_ = &pending;
+				slot.prev_ = slot.next_ = &slot;
+			}
+
+			while (pending.next_ != &pending) {
+				Timer* timer = pending.next_;
+				timer->unlink();
+				if (timer->expiry_ > target) {
+					timer->link_before(slot); // Due on a later revolution
+					continue;
+				}
+				timer->wheel_ = nullptr;
+				--armed_;
+				++fired;
+				if (timer->callback) timer->callback();
+			}
+			pending.prev_ = pending.next_ = nullptr;
+		}
+		return fired;
+	}
+
+	/// Current tick count since construction (as of the last advance)
+	uint64_t now_tick() const noexcept { return now_; }
+
+	std::chrono::milliseconds tick() const noexcept { return tick_; }
+
+	/// Number of armed timers
+	size_t size() const noexcept { return armed_; }
+	bool empty() const noexcept { return armed_ == 0; }
+
+private:
+	std::chrono::milliseconds tick_;
+	std::vector<Timer> slots_;    // Sentinel per slot (circular list)
+	Clock::time_point origin_;
+	uint64_t now_ = 0;
+	size_t armed_ = 0;
+};
+
+inline Timer::~Timer() {
+	if (wheel_) wheel_->cancel(*this);
+}
+
+} // namespace async
+} // namespace etherz
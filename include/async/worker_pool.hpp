@@ -0,0 +1,165 @@
+/**
+ * @file worker_pool.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Bounded worker threads fed from one producer through lock-free queues
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <bit>
+#include <algorithm>
+
+namespace etherz {
+namespace async {
+
+/**
+ * @brief Bounded single-producer / single-consumer ring
+ *
+ * Capacity is rounded up to a power of two. push() and pop() are wait-free;
+ * head and tail live on separate cache lines so producer and consumer do
+ * not contend.
+ */
+template <typename T>
+class SpscQueue {
+public:
+	explicit SpscQueue(size_t capacity)
+		: slots_(std::bit_ceil(std::max<size_t>(capacity, 2)))
+		, mask_(slots_.size() - 1) {}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	/**
+	 * @return false if the ring is full (value is left untouched)
+	 */
+	bool push(T& value) {
+		auto tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) == slots_.size()) return false;
+		slots_[tail & mask_] = std::move(value);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T& out) {
+		auto head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) return false;
+		auto& slot = slots_[head & mask_];
+		out = std::move(slot);
+		slot = T{}; // Release what the moved-from slot still holds
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const noexcept {
+		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const noexcept { return slots_.size(); }
+
+private:
+	std::vector<T> slots_;
+	size_t mask_;
+	alignas(64) std::atomic<size_t> head_{0};
+	alignas(64) std::atomic<size_t> tail_{0};
+};
+
+/**
+ * @brief Fixed set of threads running tasks submitted by one thread
+ *
+ * Every worker has its own SpscQueue, and submit() picks it by key, so
+ * tasks with the same key run one at a time, in order, on the same
+ * thread. A worker with nothing to do sleeps on an atomic wait. submit()
+ * must always be called from the same thread (e.g. an event loop).
+ */
+class WorkerPool {
+public:
+	using Task = std::function<void()>;
+
+	/**
+	 * @param threads        Number of workers (at least one)
+	 * @param queue_capacity Tasks each worker may have waiting
+	 */
+	explicit WorkerPool(size_t threads, size_t queue_capacity = 256) {
+		threads = std::max<size_t>(threads, 1);
+		workers_.reserve(threads);
+		for (size_t i = 0; i < threads; ++i) workers_.push_back(std::make_unique<Worker>(queue_capacity));
+		for (auto& w : workers_) w->thread = std::thread([this, worker = w.get()] { run(*worker); });
+	}
+
+	/**
+	 * @brief Stop the workers after their current task; queued tasks are destroyed unrun
+	 */
+	~WorkerPool() {
+		stopping_.store(true, std::memory_order_release);
+		for (auto& w : workers_) {
+			w->signal.fetch_add(1, std::memory_order_release);
+			w->signal.notify_one();
+		}
+		for (auto& w : workers_) w->thread.join();
+	}
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	/**
+	 * @brief Queue task on the worker that owns key
+	 * @return false if that worker's queue is full (task is left untouched)
+	 */
+	bool submit(uint64_t key, Task& task) {
+		auto& w = *workers_[key % workers_.size()];
+		if (!w.queue.push(task)) return false;
+		// Pairs with the worker's store to sleeping: one side always sees the other
+		w.signal.fetch_add(1, std::memory_order_seq_cst);
+		if (w.sleeping.load(std::memory_order_seq_cst)) w.signal.notify_one();
+		return true;
+	}
+
+	size_t size() const noexcept { return workers_.size(); }
+
+private:
+	struct Worker {
+		explicit Worker(size_t capacity) : queue(capacity) {}
+
+		SpscQueue<Task> queue;
+		std::atomic<uint32_t> signal{0};
+		std::atomic<bool> sleeping{false};
+		std::thread thread;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::atomic<bool> stopping_{false};
+
+	void run(Worker& w) {
+		Task task;
+		while (!stopping_.load(std::memory_order_acquire)) {
+			if (w.queue.pop(task)) {
+				task();
+				task = nullptr;
+				continue;
+			}
+			// Announce the sleep, then re-check so a push in between is not missed
+			auto seen = w.signal.load(std::memory_order_acquire);
+			w.sleeping.store(true, std::memory_order_seq_cst);
+			if (w.signal.load(std::memory_order_seq_cst) == seen && w.queue.empty()
+				&& !stopping_.load(std::memory_order_acquire)) {
+				w.signal.wait(seen);
+			}
+			w.sleeping.store(false, std::memory_order_relaxed);
+		}
+		while (w.queue.pop(task)) task = nullptr;
+	}
+};
+
+} // namespace async
+} // namespace etherz
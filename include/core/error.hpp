@@ -21,6 +21,7 @@
 	#include <winsock2.h>
 #else
 	#include <cerrno>
+	#include <sys/socket.h>
 #endif
 
 namespace etherz {
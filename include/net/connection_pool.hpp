@@ -0,0 +1,395 @@
+/**
+ * @file connection_pool.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Thread-safe keep-alive pool of blocking TCP client connections
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <functional>
+#include <expected>
+#include <chrono>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+
+#include "socket.hpp"
+#include "socket_address.hpp"
+#include "internet_protocol.hpp"
+#include "dns_cache.hpp"
+#include "../async/poll.hpp"
+#include "../core/error.hpp"
+
+namespace etherz {
+namespace net {
+
+/**
+ * @brief Identifies interchangeable connections: same scheme, host and port
+ */
+struct PoolKey {
+	std::string scheme;
+	std::string host;
+	uint16_t port = 0;
+
+	auto operator<=>(const PoolKey&) const = default;
+};
+
+/**
+ * @brief Limits of a ConnectionPool (per key unless noted)
+ */
+struct ConnectionPoolOptions {
+	/// Connections open at once, leased plus idle; acquire() waits for one beyond this
+	size_t max_per_host = 8;
+	/// Idle connections kept; the oldest is closed past this
+	size_t max_idle_per_host = 8;
+	/// Idle connections older than this are closed instead of reused
+	std::chrono::milliseconds idle_timeout{30'000};
+	/// Longest acquire() waits for a free slot when max_per_host is reached
+	std::chrono::milliseconds acquire_timeout{10'000};
+};
+
+class ConnectionPool;
+struct ConnectionPoolState;
+
+/**
+ * @brief A connection on loan from a ConnectionPool
+ *
+ * Dropping the lease closes the connection unless keep() was called, so a
+ * connection abandoned mid-exchange (an exception, an early return) is
+ * never handed to the next caller with a half-read response in it.
+ */
+class PooledConnection {
+public:
+	PooledConnection() noexcept = default;
+	~PooledConnection() { reset(); }
+
+	PooledConnection(PooledConnection&& other) noexcept { *this = std::move(other); }
+	PooledConnection& operator=(PooledConnection&& other) noexcept {
+		if (this != &other) {
+			reset();
+			pool_ = std::exchange(other.pool_, nullptr);
+			key_ = std::move(other.key_);
+			socket_ = std::move(other.socket_);
+			reused_ = other.reused_;
+			keep_ = std::exchange(other.keep_, false);
+		}
+		return *this;
+	}
+
+	PooledConnection(const PooledConnection&) = delete;
+	PooledConnection& operator=(const PooledConnection&) = delete;
+
+	Socket<Ip<4>>& socket() noexcept { return socket_; }
+	const PoolKey& key() const noexcept { return key_; }
+
+	/// Came from the idle list rather than a new connect
+	bool reused() const noexcept { return reused_; }
+
+	/// The exchange ended cleanly: return the connection to the pool when the lease ends
+	void keep() noexcept { keep_ = true; }
+
+	explicit operator bool() const noexcept { return pool_ != nullptr; }
+
+	/// End the lease now
+	void reset() noexcept;
+
+private:
+	friend class ConnectionPool;
+
+	std::shared_ptr<ConnectionPoolState> pool_;
+	PoolKey key_;
+	Socket<Ip<4>> socket_;
+	bool reused_ = false;
+	bool keep_ = false;
+};
+
+namespace impl {
+	/**
+	 * @brief An idle client connection that polls readable has been closed or sent something unasked
+	 */
+	inline bool idle_connection_usable(socket_t fd) noexcept {
+		async::PollEntry entry{fd, async::PollEvent::ReadReady, async::PollEvent::None};
+		if (async::poll(std::span(&entry, 1), 0) <= 0) return true;
+		// Readable means EOF, an error or bytes nobody asked for: none can carry a request
+		return entry.returned == async::PollEvent::None;
+	}
+} // namespace impl
+
+/**
+ * @brief Shared state of a pool; leases hold it so they may outlive the ConnectionPool
+ */
+struct ConnectionPoolState {
+	using Clock = std::chrono::steady_clock;
+
+	struct Idle {
+		Socket<Ip<4>> socket;
+		Clock::time_point since;
+	};
+
+	struct Host {
+		std::deque<Idle> idle;             // Most recently returned at the back
+		size_t open = 0;                   // Leased + idle
+		std::condition_variable freed;     // A slot or idle connection came back for this key
+	};
+
+	std::mutex mutex;
+	std::map<PoolKey, Host> hosts;
+	ConnectionPoolOptions options;
+	uint64_t connects = 0;
+	uint64_t reuses = 0;
+	uint64_t evictions = 0;
+
+	void give_back(const PoolKey& key, Socket<Ip<4>> socket, bool keep) {
+		Socket<Ip<4>> surplus; // Closed once the lock is released
+		std::lock_guard lock(mutex);
+		auto& host = hosts[key];
+		if (keep && options.max_idle_per_host > 0) {
+			if (host.idle.size() >= options.max_idle_per_host) {
+				surplus = std::move(host.idle.front().socket);
+				host.idle.pop_front();
+				--host.open;
+			}
+			host.idle.push_back({std::move(socket), Clock::now()});
+		} else {
+			--host.open;
+		}
+		host.freed.notify_one();
+	}
+
+	/// Give up a reserved slot whose connection was closed or never opened
+	void release_slot(const PoolKey& key, bool evicted) {
+		std::lock_guard lock(mutex);
+		auto& host = hosts[key];
+		--host.open;
+		if (evicted) ++evictions;
+		host.freed.notify_one();
+	}
+};
+
+inline void PooledConnection::reset() noexcept {
+	if (!pool_) return;
+	auto pool = std::move(pool_);
+	pool->give_back(key_, std::move(socket_), keep_);
+	keep_ = false;
+}
+
+/**
+ * @brief Keep-alive connections for blocking clients, keyed by (scheme, host, port)
+ *
+ * acquire() hands out the most recently used idle connection that still
+ * looks alive (it is polled, and a readable one is dropped: the server
+ * closed it or it holds stray bytes), or opens a new one through the
+ * connector. At most max_per_host connections exist per key; callers
+ * beyond that wait. Safe to share between threads.
+ */
+class ConnectionPool {
+public:
+	using Clock = std::chrono::steady_clock;
+	/// Opens a new blocking connection for a key
+	using Connector = std::function<std::expected<Socket<Ip<4>>, core::Error>(const PoolKey&)>;
+
+	explicit ConnectionPool(ConnectionPoolOptions options = {}, Connector connector = resolve_and_connect)
+		: state_(std::make_shared<ConnectionPoolState>()), connector_(std::move(connector)) {
+		state_->options = options;
+	}
+
+	ConnectionPool(const ConnectionPool&) = delete;
+	ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+	/**
+	 * @brief Lease a connection for key
+	 * @return The connector's error, or Timeout if no slot freed up within acquire_timeout
+	 */
+	std::expected<PooledConnection, core::Error> acquire(const PoolKey& key) {
+		auto& s = *state_;
+		auto deadline = Clock::now() + s.options.acquire_timeout;
+		while (true) {
+			std::optional<ConnectionPoolState::Idle> idle;
+			{
+				std::unique_lock lock(s.mutex);
+				auto& host = s.hosts[key];
+				while (host.idle.empty() && host.open >= s.options.max_per_host) {
+					if (host.freed.wait_until(lock, deadline) == std::cv_status::timeout) {
+						return std::unexpected(core::Error::Timeout);
+					}
+				}
+				if (host.idle.empty()) {
+					++host.open; // Reserve the slot; connect outside the lock
+					break;
+				}
+				idle = std::move(host.idle.back()); // Still counted in open while it is checked
+				host.idle.pop_back();
+			}
+			// Polled and, if dead or expired, closed outside the lock
+			if (idle->since >= Clock::now() - s.options.idle_timeout
+				&& impl::idle_connection_usable(idle->socket.native_handle())) {
+				std::lock_guard lock(s.mutex);
+				++s.reuses;
+				return lease(key, std::move(idle->socket), true);
+			}
+			idle->socket.close();
+			s.release_slot(key, true);
+		}
+		return open(key, false);
+	}
+
+	/**
+	 * @brief Lease a newly opened connection, bypassing idle ones (e.g. to retry on a stale one)
+	 */
+	std::expected<PooledConnection, core::Error> acquire_fresh(const PoolKey& key) {
+		auto& s = *state_;
+		Socket<Ip<4>> oldest; // Closed once the lock is released
+		{
+			std::unique_lock lock(s.mutex);
+			auto deadline = Clock::now() + s.options.acquire_timeout;
+			auto& host = s.hosts[key];
+			while (true) {
+				if (host.open < s.options.max_per_host) break;
+				if (!host.idle.empty()) { // Make room by closing the oldest idle one
+					oldest = std::move(host.idle.front().socket);
+					host.idle.pop_front();
+					--host.open;
+					++s.evictions;
+					break;
+				}
+				if (host.freed.wait_until(lock, deadline) == std::cv_status::timeout) {
+					return std::unexpected(core::Error::Timeout);
+				}
+			}
+			++host.open;
+		}
+		return open(key, false);
+	}
+
+	/**
+	 * @brief Open connections to key until count are idle (capped by the per-host limits)
+	 * @return Connections opened
+	 */
+	size_t prewarm(const PoolKey& key, size_t count) {
+		size_t opened = 0;
+		while (true) {
+			{
+				std::lock_guard lock(state_->mutex);
+				auto& host = state_->hosts[key];
+				auto limit = std::min(state_->options.max_per_host, state_->options.max_idle_per_host);
+				if (host.idle.size() >= std::min(count, limit) || host.open >= state_->options.max_per_host) break;
+				++host.open;
+			}
+			auto conn = open(key, false);
+			if (!conn) break;
+			conn->keep();
+			++opened;
+		}
+		return opened;
+	}
+
+	/**
+	 * @brief Close idle connections past idle_timeout (acquire() also skips them lazily)
+	 */
+	size_t evict_expired() {
+		std::vector<ConnectionPoolState::Idle> closing; // Closed once the lock is released
+		std::lock_guard lock(state_->mutex);
+		auto cutoff = Clock::now() - state_->options.idle_timeout;
+		for (auto& [key, host] : state_->hosts) {
+			size_t before = closing.size();
+			while (!host.idle.empty() && host.idle.front().since < cutoff) {
+				closing.push_back(std::move(host.idle.front()));
+				host.idle.pop_front();
+				--host.open;
+			}
+			if (closing.size() > before) host.freed.notify_all();
+		}
+		state_->evictions += closing.size();
+		return closing.size();
+	}
+
+	/// Close every idle connection
+	void clear() {
+		std::vector<ConnectionPoolState::Idle> closing; // Closed once the lock is released
+		std::lock_guard lock(state_->mutex);
+		for (auto& [key, host] : state_->hosts) {
+			host.open -= host.idle.size();
+			std::move(host.idle.begin(), host.idle.end(), std::back_inserter(closing));
+			host.idle.clear();
+			host.freed.notify_all();
+		}
+	}
+
+	size_t idle_count(const PoolKey& key) const {
+		std::lock_guard lock(state_->mutex);
+		auto it = state_->hosts.find(key);
+		return it == state_->hosts.end() ? 0 : it->second.idle.size();
+	}
+
+	size_t open_count(const PoolKey& key) const {
+		std::lock_guard lock(state_->mutex);
+		auto it = state_->hosts.find(key);
+		return it == state_->hosts.end() ? 0 : it->second.open;
+	}
+
+	/// Connections opened so far
+	uint64_t connect_count() const { std::lock_guard lock(state_->mutex); return state_->connects; }
+	/// Leases served from an idle connection
+	uint64_t reuse_count() const { std::lock_guard lock(state_->mutex); return state_->reuses; }
+	/// Idle connections closed as expired, dead or surplus
+	uint64_t eviction_count() const { std::lock_guard lock(state_->mutex); return state_->evictions; }
+
+	const ConnectionPoolOptions& options() const noexcept { return state_->options; }
+
+	/**
+	 * @brief Default connector: "localhost" or a literal IPv4 address, else the first IPv4 address from DnsCache::shared()
+	 */
+	static std::expected<Socket<Ip<4>>, core::Error> resolve_and_connect(const PoolKey& key) {
+		auto ip = DnsCache::shared()->resolve_ipv4(key.host);
+		if (!ip) return std::unexpected(ip.error());
+		Socket<Ip<4>> sock;
+		if (auto err = sock.create(); core::is_error(err)) return std::unexpected(err);
+		if (auto err = sock.connect(SocketAddress<Ip<4>>(*ip, key.port)); core::is_error(err)) return std::unexpected(err);
+		sock.set_no_delay(true); // Requests usually go out in more than one write
+		return sock;
+	}
+
+private:
+	std::shared_ptr<ConnectionPoolState> state_;
+	Connector connector_;
+
+	PooledConnection lease(const PoolKey& key, Socket<Ip<4>> socket, bool reused) {
+		PooledConnection conn;
+		conn.pool_ = state_;
+		conn.key_ = key;
+		conn.socket_ = std::move(socket);
+		conn.reused_ = reused;
+		return conn;
+	}
+
+	/// Connect for a slot already reserved in host.open
+	std::expected<PooledConnection, core::Error> open(const PoolKey& key, bool reused) {
+		auto socket = connector_(key);
+		if (!socket) {
+			state_->release_slot(key, false);
+			return std::unexpected(socket.error());
+		}
+		{
+			std::lock_guard lock(state_->mutex);
+			++state_->connects;
+		}
+		return lease(key, std::move(*socket), reused);
+	}
+};
+
+} // namespace net
+} // namespace etherz
@@ -14,6 +14,7 @@
 #include <string>
 #include <string_view>
 #include <vector>
+#include <chrono>
 #include <print>
 
 #include "internet_protocol.hpp"
@@ -42,6 +43,8 @@ struct DnsResult {
 	std::vector<Ip<6>> ipv6_addresses;
 	std::string        canonical_name;
 	bool               success = false;
+	/// Time to live of the answer; zero when unknown (getaddrinfo does not report it)
+	std::chrono::seconds ttl{0};
 
 	/**
 	 * @brief Total number of resolved addresses
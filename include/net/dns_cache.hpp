@@ -0,0 +1,290 @@
+/**
+ * @file dns_cache.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Thread-safe DNS cache with TTLs, negative caching and refresh-ahead
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <expected>
+#include <optional>
+#include <chrono>
+#include <algorithm>
+
+#include "dns.hpp"
+#include "internet_protocol.hpp"
+#include "../core/error.hpp"
+
+namespace etherz {
+namespace net {
+
+/**
+ * @brief Lifetimes and limits of a DnsCache
+ */
+struct DnsCacheOptions {
+	/// Longest a successful answer is kept; also its lifetime when the resolver reports no TTL
+	std::chrono::milliseconds max_ttl{60'000};
+	/// How long a failed lookup is remembered before the name is tried again
+	std::chrono::milliseconds negative_ttl{5'000};
+	/// Fraction of an entry's lifetime after which a hit starts a background refresh
+	double refresh_ahead = 0.8;
+	/// Hits an entry needs within its lifetime to be refreshed ahead; colder ones just expire
+	uint32_t refresh_min_hits = 2;
+	/// Names kept; inserting beyond this drops expired entries, then the one closest to expiry
+	size_t max_entries = 1024;
+};
+
+/**
+ * @brief Caches hostname lookups for blocking clients
+ *
+ * resolve() answers from the cache while an entry is fresh. A miss calls
+ * the resolver outside the lock; concurrent callers asking for the same
+ * name wait for that one lookup instead of starting their own. Failures
+ * are cached for negative_ttl. A popular entry (refresh_min_hits hits)
+ * seen past refresh_ahead of its lifetime is re-resolved on a background
+ * thread, so callers keep getting the old answer instead of blocking when
+ * it expires. Safe to share between threads.
+ */
+class DnsCache {
+public:
+	using Clock = std::chrono::steady_clock;
+	/// Looks a name up; called from several threads at once
+	using Resolver = std::function<DnsResult(std::string_view)>;
+
+	explicit DnsCache(DnsCacheOptions options = {}, Resolver resolver = Dns::resolve4)
+		: options_(options), resolver_(std::move(resolver)) {}
+
+	~DnsCache() {
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		refresh_wake_.notify_all();
+		if (refresher_.joinable()) refresher_.join();
+	}
+
+	DnsCache(const DnsCache&) = delete;
+	DnsCache& operator=(const DnsCache&) = delete;
+
+	/// Process-wide cache used by HttpClient, ConnectionPool and AsyncHttpClient by default
+	static const std::shared_ptr<DnsCache>& shared() {
+		static const auto cache = std::make_shared<DnsCache>();
+		return cache;
+	}
+
+	/**
+	 * @brief Look hostname up, from the cache when possible
+	 * @return The resolver's answer (success == false for a cached or fresh failure)
+	 *
+	 * An exception from the resolver reaches the caller that made the
+	 * lookup and is not cached; callers waiting on it retry the lookup.
+	 */
+	DnsResult resolve(std::string_view hostname) {
+		std::string host(hostname);
+		std::unique_lock lock(mutex_);
+		while (true) {
+			auto it = entries_.find(host);
+			if (it == entries_.end()) break;
+			auto& entry = it->second;
+			if (entry.pending) {
+				++coalesced_;
+				resolved_.wait(lock, [&] {
+					auto again = entries_.find(host);
+					return again == entries_.end() || !again->second.pending;
+				});
+				auto done = entries_.find(host);
+				if (done != entries_.end()) return done->second.result;
+				continue; // Dropped by clear() meanwhile
+			}
+			auto now = Clock::now();
+			if (now >= entry.expires) break;
+			++hits_;
+			++entry.hits;
+			if (entry.result.success && !entry.refreshing && now >= entry.refresh_at
+				&& entry.hits >= options_.refresh_min_hits) {
+				entry.refreshing = true;
+				schedule_refresh(host);
+			}
+			return entry.result;
+		}
+
+		++misses_;
+		make_room();
+		entries_[host].pending = true;
+		lock.unlock();
+		DnsResult result;
+		try {
+			result = resolver_(host);
+		} catch (...) {
+			// Nothing cached: waiters wake to find the name gone and look it up themselves
+			lock.lock();
+			entries_.erase(host);
+			resolved_.notify_all();
+			throw;
+		}
+		lock.lock();
+		store(host, result);
+		resolved_.notify_all();
+		return result;
+	}
+
+	/**
+	 * @brief "localhost" or a literal IPv4 address as is, otherwise the first IPv4 address resolve() finds
+	 * @return InvalidAddress when the name does not resolve to an IPv4 address
+	 */
+	std::expected<Ip<4>, core::Error> resolve_ipv4(std::string_view hostname) {
+		if (auto literal = literal_ipv4(hostname)) return *literal;
+		auto result = resolve(hostname);
+		if (!result.success || result.ipv4_addresses.empty()) return std::unexpected(core::Error::InvalidAddress);
+		return result.ipv4_addresses.front();
+	}
+
+	/**
+	 * @brief resolve_ipv4() through cache, or straight through Dns::resolve4 when cache is null
+	 */
+	static std::expected<Ip<4>, core::Error> resolve_ipv4(std::string_view hostname, DnsCache* cache) {
+		if (cache) return cache->resolve_ipv4(hostname);
+		if (auto literal = literal_ipv4(hostname)) return *literal;
+		auto result = Dns::resolve4(hostname);
+		if (!result.success || result.ipv4_addresses.empty()) return std::unexpected(core::Error::InvalidAddress);
+		return result.ipv4_addresses.front();
+	}
+
+	/// "localhost" or a dotted-decimal address, which need no lookup
+	static std::optional<Ip<4>> literal_ipv4(std::string_view hostname) {
+		if (hostname == "localhost") return Ip<4>(127, 0, 0, 1);
+		if (!hostname.empty() && hostname.find_first_not_of("0123456789.") == std::string_view::npos) {
+			return Ip<4>{hostname};
+		}
+		return std::nullopt;
+	}
+
+	/// Forget hostname; the next resolve() looks it up again
+	void invalidate(std::string_view hostname) {
+		std::lock_guard lock(mutex_);
+		if (auto it = entries_.find(std::string(hostname)); it != entries_.end() && !it->second.pending) entries_.erase(it);
+	}
+
+	/// Forget every name that is not being looked up right now
+	void clear() {
+		std::lock_guard lock(mutex_);
+		std::erase_if(entries_, [](const auto& item) { return !item.second.pending; });
+	}
+
+	/// Names cached, including failures and lookups in progress
+	size_t size() const { std::lock_guard lock(mutex_); return entries_.size(); }
+	/// resolve() calls answered from a fresh entry
+	uint64_t hit_count() const { std::lock_guard lock(mutex_); return hits_; }
+	/// resolve() calls that had to call the resolver
+	uint64_t miss_count() const { std::lock_guard lock(mutex_); return misses_; }
+	/// resolve() calls that waited for another caller's lookup of the same name
+	uint64_t coalesced_count() const { std::lock_guard lock(mutex_); return coalesced_; }
+	/// Background refreshes completed
+	uint64_t refresh_count() const { std::lock_guard lock(mutex_); return refreshes_; }
+
+	const DnsCacheOptions& options() const noexcept { return options_; }
+
+private:
+	struct Entry {
+		DnsResult result;
+		Clock::time_point expires;
+		Clock::time_point refresh_at;
+		uint32_t hits = 0;
+		bool pending = false;     // First lookup in progress; callers wait on resolved_
+		bool refreshing = false;  // Queued for, or inside, a background refresh
+	};
+
+	DnsCacheOptions options_;
+	Resolver resolver_;
+	mutable std::mutex mutex_;
+	std::condition_variable resolved_;
+	std::condition_variable refresh_wake_;
+	std::map<std::string, Entry, std::less<>> entries_;
+	std::deque<std::string> refresh_queue_;
+	std::thread refresher_;
+	bool stopping_ = false;
+	uint64_t hits_ = 0;
+	uint64_t misses_ = 0;
+	uint64_t coalesced_ = 0;
+	uint64_t refreshes_ = 0;
+
+	/// Record an answer; mutex_ held
+	void store(const std::string& host, const DnsResult& result) {
+		auto& entry = entries_[host];
+		auto lifetime = options_.negative_ttl;
+		if (result.success) {
+			lifetime = options_.max_ttl;
+			if (result.ttl.count() > 0) lifetime = std::min<std::chrono::milliseconds>(lifetime, result.ttl);
+		}
+		auto now = Clock::now();
+		entry.result = result;
+		entry.expires = now + lifetime;
+		entry.refresh_at = now + std::chrono::duration_cast<Clock::duration>(lifetime * options_.refresh_ahead);
+		entry.hits = 0;
+		entry.pending = false;
+		entry.refreshing = false;
+	}
+
+	/// Keep entries_ under max_entries before a new name goes in; mutex_ held
+	void make_room() {
+		if (entries_.size() < options_.max_entries) return;
+		auto now = Clock::now();
+		std::erase_if(entries_, [now](const auto& item) { return !item.second.pending && item.second.expires <= now; });
+		if (entries_.size() < options_.max_entries) return;
+		auto victim = entries_.end();
+		for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+			if (it->second.pending) continue;
+			if (victim == entries_.end() || it->second.expires < victim->second.expires) victim = it;
+		}
+		if (victim != entries_.end()) entries_.erase(victim);
+	}
+
+	/// Queue host for the refresher thread, starting it on first use; mutex_ held
+	void schedule_refresh(const std::string& host) {
+		refresh_queue_.push_back(host);
+		if (!refresher_.joinable()) refresher_ = std::thread([this] { refresh_loop(); });
+		refresh_wake_.notify_one();
+	}
+
+	void refresh_loop() {
+		std::unique_lock lock(mutex_);
+		while (true) {
+			refresh_wake_.wait(lock, [this] { return stopping_ || !refresh_queue_.empty(); });
+			if (stopping_) return;
+			auto host = std::move(refresh_queue_.front());
+			refresh_queue_.pop_front();
+			lock.unlock();
+			DnsResult result;
+			try {
+				result = resolver_(host);
+			} catch (...) {
+				result.success = false; // Treated as a failed refresh rather than escaping the thread
+			}
+			lock.lock();
+			auto it = entries_.find(host);
+			if (it == entries_.end() || it->second.pending) continue; // Dropped meanwhile
+			// A failed refresh keeps serving the old answer until it expires; it is not retried before then
+			if (result.success) {
+				store(host, result);
+				++refreshes_;
+			}
+		}
+	}
+};
+
+} // namespace net
+} // namespace etherz
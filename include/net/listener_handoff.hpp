@@ -0,0 +1,411 @@
+/**
+ * @file listener_handoff.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Inherited listeners (LISTEN_FDS) and listener handoff over Unix sockets
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <chrono>
+#include <expected>
+#include <utility>
+
+#include "socket.hpp"
+#include "../core/error.hpp"
+
+#ifndef _WIN32
+	#include <sys/un.h>
+#endif
+
+namespace etherz {
+namespace net {
+
+namespace impl {
+	// Descriptors must not leak into exec'd children
+#if defined(SOCK_CLOEXEC)
+	constexpr int unix_socket_flags = SOCK_CLOEXEC;
+#else
+	constexpr int unix_socket_flags = 0;
+#endif
+#if defined(MSG_CMSG_CLOEXEC)
+	constexpr int recv_fds_flags = MSG_CMSG_CLOEXEC;
+#else
+	constexpr int recv_fds_flags = 0;
+#endif
+} // namespace impl
+
+/// First descriptor passed by a service manager (SD_LISTEN_FDS_START)
+inline constexpr int LISTEN_FDS_START = 3;
+
+/**
+ * @brief Listening sockets passed by a service manager (systemd LISTEN_FDS)
+ *
+ * Honoured only when LISTEN_PID names this process. The descriptors are
+ * marked close-on-exec and, with unset_env, the variables are removed so
+ * child processes do not claim them too. Empty on Windows.
+ */
+inline std::vector<impl::socket_t> inherited_listeners(bool unset_env = true) {
+	std::vector<impl::socket_t> fds;
+#ifndef _WIN32
+	auto number = [](const char* text) -> long {
+		if (!text || !*text) return -1;
+		char* end = nullptr;
+		long v = std::strtol(text, &end, 10);
+		return (*end == '\0' && v >= 0) ? v : -1;
+	};
+	long pid = number(std::getenv("LISTEN_PID"));
+	long count = number(std::getenv("LISTEN_FDS"));
+	if (unset_env) {
+		::unsetenv("LISTEN_PID");
+		::unsetenv("LISTEN_FDS");
+		::unsetenv("LISTEN_FDNAMES");
+	}
+	if (pid != static_cast<long>(::getpid()) || count <= 0) return fds;
+
+	for (long i = 0; i < count; ++i) {
+		int fd = LISTEN_FDS_START + static_cast<int>(i);
+		int flags = ::fcntl(fd, F_GETFD);
+		if (flags < 0) continue; // Not actually open
+		::fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+		fds.push_back(fd);
+	}
+#else
+	(void)unset_env;
+#endif
+	return fds;
+}
+
+// ═══════════════════════════════════════════════
+//  UnixChannel — connected AF_UNIX stream socket
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Connected Unix-domain stream socket that can carry descriptors
+ *
+ * Descriptors travel as SCM_RIGHTS ancillary data next to a short text
+ * message. Every operation fails with FeatureNotSupported on Windows.
+ */
+class UnixChannel {
+public:
+	/// Most descriptors accepted in one message
+	static constexpr size_t MAX_FDS = 16;
+
+	UnixChannel() noexcept = default;
+	explicit UnixChannel(impl::socket_t fd) noexcept : fd_(fd) {}
+	~UnixChannel() noexcept { close(); }
+
+	UnixChannel(const UnixChannel&) = delete;
+	UnixChannel& operator=(const UnixChannel&) = delete;
+
+	UnixChannel(UnixChannel&& other) noexcept : fd_(other.fd_) { other.fd_ = impl::invalid_socket; }
+
+	UnixChannel& operator=(UnixChannel&& other) noexcept {
+		if (this != &other) {
+			close();
+			fd_ = other.fd_;
+			other.fd_ = impl::invalid_socket;
+		}
+		return *this;
+	}
+
+	/**
+	 * @brief Connect to a Unix socket at path
+	 */
+	static std::expected<UnixChannel, core::Error> connect(std::string_view path) {
+#ifndef _WIN32
+		sockaddr_un addr{};
+		if (path.size() >= sizeof(addr.sun_path)) return std::unexpected(core::Error::InvalidAddress);
+		addr.sun_family = AF_UNIX;
+		std::memcpy(addr.sun_path, path.data(), path.size());
+
+		UnixChannel ch(::socket(AF_UNIX, SOCK_STREAM | impl::unix_socket_flags, 0));
+		if (!ch.is_open()) return std::unexpected(core::Error::SocketCreationFailed);
+		if (::connect(ch.fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+			return std::unexpected(core::last_platform_error());
+		}
+		return ch;
+#else
+		(void)path;
+		return std::unexpected(core::Error::FeatureNotSupported);
+#endif
+	}
+
+	/**
+	 * @brief Send message with fds attached (the fds stay open here)
+	 */
+	core::Error send_fds(std::span<const impl::socket_t> fds, std::string_view message) noexcept {
+#ifndef _WIN32
+		if (fds.size() > MAX_FDS || message.empty()) return core::Error::SendFailed;
+		iovec iov{const_cast<char*>(message.data()), message.size()};
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS)]{};
+		msghdr msg{};
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		if (!fds.empty()) {
+			msg.msg_control = control;
+			msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+			auto* cmsg = CMSG_FIRSTHDR(&msg);
+			cmsg->cmsg_level = SOL_SOCKET;
+			cmsg->cmsg_type = SCM_RIGHTS;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+			std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+		}
+		auto sent = ::sendmsg(fd_, &msg, impl::send_flags);
+		if (sent < 0) return core::last_platform_error();
+		return static_cast<size_t>(sent) == message.size() ? core::Error::None : core::Error::SendFailed;
+#else
+		(void)fds; (void)message;
+		return core::Error::FeatureNotSupported;
+#endif
+	}
+
+	/**
+	 * @brief Receive one message and the fds attached to it (now owned by the caller)
+	 */
+	auto recv_fds(std::string& message) -> std::expected<std::vector<impl::socket_t>, core::Error> {
+#ifndef _WIN32
+		char buf[256];
+		iovec iov{buf, sizeof(buf)};
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS)]{};
+		msghdr msg{};
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		auto n = ::recvmsg(fd_, &msg, impl::recv_fds_flags);
+		if (n < 0) return std::unexpected(core::last_platform_error());
+		if (n == 0) return std::unexpected(core::Error::SocketClosed);
+
+		std::vector<impl::socket_t> fds;
+		for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+			size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+			for (size_t i = 0; i < count; ++i) {
+				int fd;
+				std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+				fds.push_back(fd);
+			}
+		}
+		if (msg.msg_flags & MSG_CTRUNC) {
+			for (auto fd : fds) impl::close_socket(fd);
+			return std::unexpected(core::Error::ReceiveFailed);
+		}
+		message.assign(buf, static_cast<size_t>(n));
+		return fds;
+#else
+		(void)message;
+		return std::unexpected(core::Error::FeatureNotSupported);
+#endif
+	}
+
+	int send(std::string_view data) noexcept {
+		if (fd_ == impl::invalid_socket) return -1;
+		return static_cast<int>(::send(fd_, data.data(), static_cast<int>(data.size()), impl::send_flags));
+	}
+
+	int recv(std::span<char> buffer) noexcept {
+		if (fd_ == impl::invalid_socket) return -1;
+		return static_cast<int>(::recv(fd_, buffer.data(), static_cast<int>(buffer.size()), 0));
+	}
+
+	/**
+	 * @brief Bound blocking send/recv calls
+	 */
+	core::Error set_timeout(std::chrono::milliseconds timeout) noexcept {
+#ifndef _WIN32
+		timeval tv{};
+		tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+		tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+		auto err = impl::set_sock_opt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		if (core::is_error(err)) return err;
+		return impl::set_sock_opt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#else
+		(void)timeout;
+		return core::Error::FeatureNotSupported;
+#endif
+	}
+
+	core::Error set_nonblocking(bool enable) noexcept { return impl::set_nonblocking_impl(fd_, enable); }
+
+	void close() noexcept {
+		if (fd_ != impl::invalid_socket) {
+			impl::close_socket(fd_);
+			fd_ = impl::invalid_socket;
+		}
+	}
+
+	bool is_open() const noexcept { return fd_ != impl::invalid_socket; }
+	impl::socket_t native_handle() const noexcept { return fd_; }
+
+private:
+	impl::socket_t fd_ = impl::invalid_socket;
+};
+
+// ═══════════════════════════════════════════════
+//  UnixListener — AF_UNIX stream listener
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Non-blocking Unix-domain listener at a filesystem path
+ *
+ * listen() replaces a stale socket file left by an earlier process.
+ * close() keeps the file, since a successor may already have bound the
+ * same path; remove() closes and unlinks it.
+ */
+class UnixListener {
+public:
+	UnixListener() noexcept = default;
+	~UnixListener() noexcept { close(); }
+
+	UnixListener(const UnixListener&) = delete;
+	UnixListener& operator=(const UnixListener&) = delete;
+
+	core::Error listen(std::string path, int backlog = 8) {
+#ifndef _WIN32
+		close();
+		sockaddr_un addr{};
+		if (path.empty() || path.size() >= sizeof(addr.sun_path)) return core::Error::InvalidAddress;
+		addr.sun_family = AF_UNIX;
+		std::memcpy(addr.sun_path, path.data(), path.size());
+
+		fd_ = ::socket(AF_UNIX, SOCK_STREAM | impl::unix_socket_flags, 0);
+		if (fd_ == impl::invalid_socket) return core::Error::SocketCreationFailed;
+		::unlink(path.c_str());
+		if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+			|| ::listen(fd_, backlog) != 0) {
+			auto err = core::last_platform_error();
+			close();
+			return err;
+		}
+		path_ = std::move(path);
+		return impl::set_nonblocking_impl(fd_, true);
+#else
+		(void)path; (void)backlog;
+		return core::Error::FeatureNotSupported;
+#endif
+	}
+
+	/**
+	 * @brief Accept a pending peer (WouldBlock if none)
+	 */
+	auto accept() noexcept -> std::expected<UnixChannel, core::Error> {
+		if (fd_ == impl::invalid_socket) return std::unexpected(core::Error::SocketClosed);
+		auto peer = ::accept(fd_, nullptr, nullptr);
+		if (peer == impl::invalid_socket) return std::unexpected(core::last_platform_error());
+		return UnixChannel(peer);
+	}
+
+	void close() noexcept {
+		if (fd_ != impl::invalid_socket) {
+			impl::close_socket(fd_);
+			fd_ = impl::invalid_socket;
+		}
+	}
+
+	void remove() noexcept {
+		bool owned = is_open();
+		close();
+#ifndef _WIN32
+		if (owned && !path_.empty()) ::unlink(path_.c_str());
+#endif
+		path_.clear();
+	}
+
+	bool is_open() const noexcept { return fd_ != impl::invalid_socket; }
+	impl::socket_t native_handle() const noexcept { return fd_; }
+	const std::string& path() const noexcept { return path_; }
+
+private:
+	impl::socket_t fd_ = impl::invalid_socket;
+	std::string path_;
+};
+
+// ═══════════════════════════════════════════════
+//  Listener handoff protocol
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Wire messages of the handoff exchange
+ *
+ * The new process connects to the old one's handoff path; the old process
+ * answers with OFFER carrying its listening fds; once the new process is
+ * accepting on them it sends READY and the old process starts draining.
+ * If the channel closes before READY the old process keeps serving.
+ */
+namespace handoff {
+	inline constexpr std::string_view OFFER = "ETHERZ-LISTENERS\n";
+	inline constexpr std::string_view READY = "READY\n";
+}
+
+/**
+ * @brief Listeners received from a running process, pending confirmation
+ */
+class HandoffTicket {
+public:
+	HandoffTicket() = default;
+	~HandoffTicket() noexcept {
+		for (auto fd : fds_) impl::close_socket(fd);
+	}
+
+	HandoffTicket(const HandoffTicket&) = delete;
+	HandoffTicket& operator=(const HandoffTicket&) = delete;
+	HandoffTicket(HandoffTicket&& other) noexcept
+		: channel_(std::move(other.channel_)), fds_(std::move(other.fds_)) { other.fds_.clear(); }
+	HandoffTicket& operator=(HandoffTicket&&) = delete;
+
+	/**
+	 * @brief Ask the process listening at path for its listeners
+	 */
+	static auto request(std::string_view path, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+		-> std::expected<HandoffTicket, core::Error> {
+		auto channel = UnixChannel::connect(path);
+		if (!channel) return std::unexpected(channel.error());
+		auto err = channel->set_timeout(timeout);
+		if (core::is_error(err)) return std::unexpected(err);
+
+		HandoffTicket ticket;
+		ticket.channel_ = std::move(*channel);
+		std::string message;
+		auto fds = ticket.channel_.recv_fds(message);
+		if (!fds) return std::unexpected(fds.error());
+		ticket.fds_ = std::move(*fds);
+		if (message != handoff::OFFER || ticket.fds_.empty()) return std::unexpected(core::Error::ReceiveFailed);
+		return ticket;
+	}
+
+	/// Received descriptors, still owned by the ticket
+	std::span<const impl::socket_t> fds() const noexcept { return fds_; }
+
+	/**
+	 * @brief Take ownership of the received descriptors
+	 */
+	std::vector<impl::socket_t> take() noexcept { return std::exchange(fds_, {}); }
+
+	/**
+	 * @brief Tell the old process this one is accepting, so it may drain
+	 */
+	core::Error confirm() noexcept {
+		int n = channel_.send(handoff::READY);
+		channel_.close();
+		return n == static_cast<int>(handoff::READY.size()) ? core::Error::None : core::Error::SendFailed;
+	}
+
+private:
+	UnixChannel channel_;
+	std::vector<impl::socket_t> fds_;
+};
+
+} // namespace net
+} // namespace etherz
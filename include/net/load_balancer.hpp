@@ -0,0 +1,378 @@
+/**
+ * @file load_balancer.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Endpoint selection: round-robin, power-of-two-choices and Maglev consistent hashing
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <algorithm>
+#include <functional>
+
+#include "socket_address.hpp"
+#include "internet_protocol.hpp"
+
+namespace etherz {
+namespace net {
+
+/**
+ * @brief How LoadBalancer::pick() chooses an endpoint
+ */
+enum class BalancePolicy : uint8_t {
+	RoundRobin,        ///< Each endpoint in turn
+	LeastOutstanding,  ///< The less busy of two random endpoints
+	Maglev,            ///< The endpoint a key hashes to; stable as endpoints come and go
+};
+
+/**
+ * @brief Sizing of a LoadBalancer
+ */
+struct LoadBalancerOptions {
+	/// Maglev lookup table slots, rounded up to a prime; keep it above 100x the endpoint count for an even spread
+	size_t table_size = 65'537;
+};
+
+/**
+ * @brief Spreads requests over a set of interchangeable endpoints
+ *
+ * next() is round-robin. acquire() is least-outstanding by power of two
+ * choices: it samples two endpoints at random and leases the one with
+ * fewer leases out, which keeps load even without scanning every endpoint.
+ * for_key() is Maglev consistent hashing: a key always maps to the same
+ * endpoint, and changing the set moves only the keys of the endpoints
+ * that were added or removed (plus a small fraction of others).
+ *
+ * Every lookup is O(1) and takes no lock: the endpoints and Maglev table
+ * form an immutable snapshot that set_endpoints() replaces. Readers
+ * announce themselves in per-thread-sharded counters, and the writer
+ * frees the old snapshot only once those drain. Outstanding counts belong
+ * to the endpoint rather than the snapshot, so they carry over for
+ * endpoints that stay in the set. Safe to share between threads.
+ */
+class LoadBalancer {
+public:
+	using Address = SocketAddress<Ip<4>>;
+
+private:
+	struct alignas(64) Endpoint {  // Own cache line: outstanding is written on every lease
+		Address address;
+		std::atomic<uint32_t> outstanding{0};
+
+		explicit Endpoint(const Address& a) noexcept : address(a) {}
+	};
+
+	struct Snapshot {
+		std::vector<std::shared_ptr<Endpoint>> endpoints;  // Sorted by address
+		std::vector<uint32_t> table;                       // Maglev slot -> endpoint index
+	};
+
+	struct alignas(64) ReaderShard {
+		std::atomic<uint64_t> count{0};
+	};
+	static constexpr size_t READER_SHARDS = 16;
+
+	/// Run f on the current snapshot, keeping set_endpoints() from freeing it meanwhile
+	template <typename F>
+	auto read(F&& f) const {
+		// Handed out in turn: thread ids are page-aligned addresses and would all hash to one shard
+		static std::atomic<size_t> threads{0};
+		static thread_local const size_t shard = threads.fetch_add(1, std::memory_order_relaxed) % READER_SHARDS;
+		auto& counter = readers_[epoch_.load() & 1][shard].count;
+		counter.fetch_add(1);
+		struct Leave {
+			std::atomic<uint64_t>& counter;
+			~Leave() { counter.fetch_sub(1, std::memory_order_release); }
+		} leave{counter};
+		return f(*current_.load());
+	}
+
+public:
+	/**
+	 * @brief An endpoint counted as busy until the lease is released or destroyed
+	 */
+	class Lease {
+	public:
+		Lease() noexcept = default;
+		~Lease() { release(); }
+
+		Lease(Lease&& other) noexcept : endpoint_(std::move(other.endpoint_)) {}
+		Lease& operator=(Lease&& other) noexcept {
+			if (this != &other) {
+				release();
+				endpoint_ = std::move(other.endpoint_);
+			}
+			return *this;
+		}
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+		explicit operator bool() const noexcept { return static_cast<bool>(endpoint_); }
+		const Address& address() const noexcept { return endpoint_->address; }
+
+		/// Stop counting the endpoint as busy; done by the destructor otherwise
+		void release() noexcept {
+			if (!endpoint_) return;
+			endpoint_->outstanding.fetch_sub(1, std::memory_order_relaxed);
+			endpoint_.reset();
+		}
+
+	private:
+		friend class LoadBalancer;
+		std::shared_ptr<Endpoint> endpoint_;
+
+		explicit Lease(std::shared_ptr<Endpoint> endpoint) noexcept : endpoint_(std::move(endpoint)) {
+			endpoint_->outstanding.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	explicit LoadBalancer(std::vector<Address> endpoints = {}, LoadBalancerOptions options = {})
+		: table_size_(next_prime(std::max<size_t>(options.table_size, 2))) {
+		current_.store(build(std::move(endpoints), nullptr).release());
+	}
+
+	~LoadBalancer() { delete current_.load(); }
+
+	LoadBalancer(const LoadBalancer&) = delete;
+	LoadBalancer& operator=(const LoadBalancer&) = delete;
+
+	/**
+	 * @brief Replace the endpoint set; lookups in progress finish on the old one
+	 *
+	 * Duplicates are dropped and order does not matter. Blocks until no
+	 * reader can still see the old set.
+	 */
+	void set_endpoints(std::vector<Address> endpoints) {
+		std::lock_guard lock(update_);
+		auto next = build(std::move(endpoints), current_.load());
+		const Snapshot* old = current_.exchange(next.release());
+		// Flip readers to the other counters, wait for the ones on the old ones; twice, for both
+		for (int phase = 0; phase < 2; ++phase) {
+			auto slot = epoch_.fetch_add(1) & 1;
+			for (auto& shard : readers_[slot]) {
+				while (shard.count.load() != 0) std::this_thread::yield();
+			}
+		}
+		delete old;
+	}
+
+	/// Next endpoint in turn (nullopt: empty set)
+	std::optional<Address> next() const {
+		return read([this](const Snapshot& s) -> std::optional<Address> {
+			if (s.endpoints.empty()) return std::nullopt;
+			return s.endpoints[cursor_.fetch_add(1, std::memory_order_relaxed) % s.endpoints.size()]->address;
+		});
+	}
+
+	/**
+	 * @brief Lease the less loaded of two endpoints chosen at random (empty lease: empty set)
+	 */
+	Lease acquire() const {
+		return read([](const Snapshot& s) { return two_choices(s, nullptr); });
+	}
+
+	/**
+	 * @brief acquire() among the endpoints other than avoid (empty lease: there is no other)
+	 *
+	 * For a second try at a request that should not land where the first
+	 * one did, such as a hedge.
+	 */
+	Lease acquire_other(const Address& avoid) const {
+		return read([&avoid](const Snapshot& s) { return two_choices(s, &avoid); });
+	}
+
+	/// Endpoint key maps to under Maglev hashing (nullopt: empty set)
+	std::optional<Address> for_key(std::string_view key) const { return for_hash(hash(key)); }
+
+	/// for_key() with the key already hashed
+	std::optional<Address> for_hash(uint64_t h) const {
+		return read([h](const Snapshot& s) -> std::optional<Address> {
+			if (s.endpoints.empty()) return std::nullopt;
+			return s.endpoints[s.table[h % s.table.size()]]->address;
+		});
+	}
+
+	/**
+	 * @brief Lease an endpoint chosen by policy; key is only used by Maglev
+	 *
+	 * Every policy counts the lease, so acquire() stays accurate when
+	 * policies are mixed on one balancer.
+	 */
+	Lease pick(BalancePolicy policy, std::string_view key = {}) const {
+		if (policy == BalancePolicy::LeastOutstanding) return acquire();
+		auto h = policy == BalancePolicy::Maglev ? hash(key) : 0;
+		return read([&](const Snapshot& s) -> Lease {
+			if (s.endpoints.empty()) return {};
+			auto index = policy == BalancePolicy::Maglev
+				? s.table[h % s.table.size()]
+				: cursor_.fetch_add(1, std::memory_order_relaxed) % s.endpoints.size();
+			return Lease(s.endpoints[index]);
+		});
+	}
+
+	/// Endpoints, sorted
+	std::vector<Address> endpoints() const {
+		return read([](const Snapshot& s) {
+			std::vector<Address> out;
+			out.reserve(s.endpoints.size());
+			for (const auto& e : s.endpoints) out.push_back(e->address);
+			return out;
+		});
+	}
+
+	size_t size() const { return read([](const Snapshot& s) { return s.endpoints.size(); }); }
+
+	/// Leases out on address (0 if it is not in the set)
+	uint32_t outstanding(const Address& address) const {
+		return read([&](const Snapshot& s) -> uint32_t {
+			for (const auto& e : s.endpoints) {
+				if (e->address == address) return e->outstanding.load(std::memory_order_relaxed);
+			}
+			return 0;
+		});
+	}
+
+	/// Maglev table slots in use (a prime)
+	size_t table_size() const noexcept { return table_size_; }
+
+	/// 64-bit FNV-1a of key, finished with a mixer so nearby keys spread over the table
+	static uint64_t hash(std::string_view key) noexcept {
+		uint64_t h = 0xcbf29ce484222325ull;
+		for (unsigned char c : key) {
+			h ^= c;
+			h *= 0x100000001b3ull;
+		}
+		return mix(h);
+	}
+
+private:
+	size_t table_size_;
+	std::atomic<const Snapshot*> current_{nullptr};
+	std::mutex update_;
+	std::atomic<uint64_t> epoch_{0};
+	mutable ReaderShard readers_[2][READER_SHARDS];
+	alignas(64) mutable std::atomic<size_t> cursor_{0};  // Away from the read-mostly fields above
+
+	/// Snapshot of endpoints, reusing previous's Endpoint objects (and their counts) where addresses match
+	std::unique_ptr<Snapshot> build(std::vector<Address> addresses, const Snapshot* previous) const {
+		std::sort(addresses.begin(), addresses.end());
+		addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+		auto s = std::make_unique<Snapshot>();
+		s->endpoints.reserve(addresses.size());
+		for (const auto& a : addresses) {
+			std::shared_ptr<Endpoint> kept;
+			if (previous) {
+				auto it = std::lower_bound(previous->endpoints.begin(), previous->endpoints.end(), a,
+					[](const auto& e, const Address& x) { return e->address < x; });
+				if (it != previous->endpoints.end() && (*it)->address == a) kept = *it;
+			}
+			s->endpoints.push_back(kept ? std::move(kept) : std::make_shared<Endpoint>(a));
+		}
+		if (!addresses.empty()) s->table = maglev_table(addresses, table_size_);
+		return s;
+	}
+
+	/**
+	 * @brief Maglev lookup table (Eisenbud et al., NSDI 2016)
+	 *
+	 * Each endpoint walks its own permutation of the slots, derived from a
+	 * hash of its address, and the endpoints take turns claiming their next
+	 * free slot until the table is full. Every endpoint ends up with
+	 * size/n slots, give or take one, and an endpoint's permutation does
+	 * not depend on the others, so most slots keep their owner when the set
+	 * changes.
+	 */
+	static std::vector<uint32_t> maglev_table(const std::vector<Address>& endpoints, size_t size) {
+		constexpr uint32_t EMPTY = UINT32_MAX;
+		auto n = endpoints.size();
+		std::vector<uint64_t> offset(n), skip(n), next(n, 0);
+		for (size_t i = 0; i < n; ++i) {
+			auto key = (uint64_t(endpoints[i].address().to_uint32()) << 16) | endpoints[i].port();
+			offset[i] = mix(key) % size;
+			skip[i] = mix(key ^ 0x9e3779b97f4a7c15ull) % (size - 1) + 1;
+		}
+		std::vector<uint32_t> table(size, EMPTY);
+		size_t filled = 0;
+		while (true) {
+			for (size_t i = 0; i < n; ++i) {
+				auto slot = (offset[i] + next[i] * skip[i]) % size;
+				while (table[slot] != EMPTY) {
+					++next[i];
+					slot = (offset[i] + next[i] * skip[i]) % size;
+				}
+				table[slot] = static_cast<uint32_t>(i);
+				++next[i];
+				if (++filled == size) return table;
+			}
+		}
+	}
+
+	/// Lease the less loaded of two random endpoints, leaving *avoid out when it is in the set
+	static Lease two_choices(const Snapshot& s, const Address* avoid) {
+		auto n = s.endpoints.size();
+		size_t skip = n; // Index left out (n: none)
+		if (avoid) {
+			auto it = std::lower_bound(s.endpoints.begin(), s.endpoints.end(), *avoid,
+				[](const auto& e, const Address& x) { return e->address < x; });
+			if (it != s.endpoints.end() && (*it)->address == *avoid) skip = static_cast<size_t>(it - s.endpoints.begin());
+		}
+		auto candidates = skip < n ? n - 1 : n;
+		auto at = [&](size_t i) -> const std::shared_ptr<Endpoint>& { return s.endpoints[i < skip ? i : i + 1]; };
+		if (candidates == 0) return {};
+		if (candidates == 1) return Lease(at(0));
+		auto r = random();
+		auto a = static_cast<size_t>(r % candidates);
+		auto b = static_cast<size_t>((r >> 32) % (candidates - 1));
+		if (b >= a) ++b; // Two distinct endpoints
+		const auto& first = at(a);
+		const auto& second = at(b);
+		bool pick_second = second->outstanding.load(std::memory_order_relaxed)
+			< first->outstanding.load(std::memory_order_relaxed);
+		return Lease(pick_second ? second : first);
+	}
+
+	/// splitmix64 finalizer
+	static uint64_t mix(uint64_t x) noexcept {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebull;
+		x ^= x >> 31;
+		return x;
+	}
+
+	/// Per-thread xorshift64* stream for acquire()'s two samples
+	static uint64_t random() noexcept {
+		static thread_local uint64_t state = mix(std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1);
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545f4914f6cdd1dull;
+	}
+
+	static size_t next_prime(size_t n) noexcept {
+		auto prime = [](size_t v) {
+			if (v < 2) return false;
+			for (size_t d = 2; d * d <= v; ++d) {
+				if (v % d == 0) return false;
+			}
+			return true;
+		};
+		while (!prime(n)) ++n;
+		return n;
+	}
+};
+
+} // namespace net
+} // namespace etherz
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
 #include <span>
 #include <print>
 #include <type_traits>
@@ -30,7 +31,9 @@
 	#pragma comment(lib, "ws2_32.lib")
 #else
 	#include <sys/socket.h>
+	#include <sys/uio.h>
 	#include <netinet/in.h>
+	#include <netinet/tcp.h>
 	#include <arpa/inet.h>
 	#include <unistd.h>
 	#include <fcntl.h>
@@ -81,6 +84,42 @@ namespace impl {
 	inline int close_socket(socket_t s) noexcept { return close(s); }
 #endif
 
+	// Writing to a reset connection must fail with EPIPE, not raise SIGPIPE
+#if defined(MSG_NOSIGNAL)
+	constexpr int send_flags = MSG_NOSIGNAL;
+#else
+	constexpr int send_flags = 0;
+#endif
+
+	/**
+	 * @brief Gather-send several buffers in one call
+	 * @return Bytes sent, or -1 on error (check core::last_platform_error())
+	 */
+	inline int send_vectored(socket_t fd, std::span<const std::span<const uint8_t>> buffers) noexcept {
+		constexpr size_t MAX_BUFFERS = 64;
+		size_t count = std::min(buffers.size(), MAX_BUFFERS);
+#ifdef _WIN32
+		WSABUF bufs[MAX_BUFFERS];
+		for (size_t i = 0; i < count; ++i) {
+			bufs[i].buf = const_cast<char*>(reinterpret_cast<const char*>(buffers[i].data()));
+			bufs[i].len = static_cast<ULONG>(buffers[i].size());
+		}
+		DWORD sent = 0;
+		if (WSASend(fd, bufs, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) == socket_error) return -1;
+		return static_cast<int>(sent);
+#else
+		iovec iov[MAX_BUFFERS];
+		for (size_t i = 0; i < count; ++i) {
+			iov[i].iov_base = const_cast<uint8_t*>(buffers[i].data());
+			iov[i].iov_len = buffers[i].size();
+		}
+		msghdr msg{};
+		msg.msg_iov = iov;
+		msg.msg_iovlen = count;
+		return static_cast<int>(::sendmsg(fd, &msg, send_flags));
+#endif
+	}
+
 	/**
 	 * @brief Set socket option helper
 	 */
@@ -195,7 +234,15 @@ public:
 	int send(std::span<const uint8_t> data) noexcept {
 		if (fd_ == impl::invalid_socket) return -1;
 		return static_cast<int>(::send(fd_, reinterpret_cast<const char*>(data.data()),
-			static_cast<int>(data.size()), 0));
+			static_cast<int>(data.size()), impl::send_flags));
+	}
+
+	/**
+	 * @brief Send several buffers with one syscall (at most 64 are used)
+	 */
+	int send_vectored(std::span<const std::span<const uint8_t>> buffers) noexcept {
+		if (fd_ == impl::invalid_socket) return -1;
+		return impl::send_vectored(fd_, buffers);
 	}
 
 	int recv(std::span<uint8_t> buffer) noexcept {
@@ -234,6 +281,15 @@ public:
 		return impl::set_sock_opt(fd_, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
 	}
 
+	/**
+	 * @brief Enable/disable TCP_NODELAY (send small writes without waiting for ACKs)
+	 */
+	core::Error set_no_delay(bool enable = true) noexcept {
+		if (fd_ == impl::invalid_socket) return core::Error::SocketClosed;
+		int val = enable ? 1 : 0;
+		return impl::set_sock_opt(fd_, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+	}
+
 	/**
 	 * @brief Enable/disable non-blocking mode
 	 */
@@ -267,6 +323,24 @@ public:
 	bool is_open() const noexcept { return fd_ != impl::invalid_socket; }
 	impl::socket_t native_handle() const noexcept { return fd_; }
 
+	/**
+	 * @brief Take ownership of an already-open socket (e.g. an inherited listener)
+	 */
+	static Socket adopt(impl::socket_t fd) noexcept {
+		Socket s;
+		s.fd_ = fd;
+		return s;
+	}
+
+	/**
+	 * @brief Give up ownership of the handle without closing it
+	 */
+	impl::socket_t release() noexcept {
+		auto fd = fd_;
+		fd_ = impl::invalid_socket;
+		return fd;
+	}
+
 private:
 	impl::socket_t fd_ = impl::invalid_socket;
 	friend class Socket;
@@ -345,7 +419,15 @@ public:
 	int send(std::span<const uint8_t> data) noexcept {
 		if (fd_ == impl::invalid_socket) return -1;
 		return static_cast<int>(::send(fd_, reinterpret_cast<const char*>(data.data()),
-			static_cast<int>(data.size()), 0));
+			static_cast<int>(data.size()), impl::send_flags));
+	}
+
+	/**
+	 * @brief Send several buffers with one syscall (at most 64 are used)
+	 */
+	int send_vectored(std::span<const std::span<const uint8_t>> buffers) noexcept {
+		if (fd_ == impl::invalid_socket) return -1;
+		return impl::send_vectored(fd_, buffers);
 	}
 
 	int recv(std::span<uint8_t> buffer) noexcept {
@@ -378,6 +460,15 @@ public:
 		return impl::set_sock_opt(fd_, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
 	}
 
+	/**
+	 * @brief Enable/disable TCP_NODELAY (send small writes without waiting for ACKs)
+	 */
+	core::Error set_no_delay(bool enable = true) noexcept {
+		if (fd_ == impl::invalid_socket) return core::Error::SocketClosed;
+		int val = enable ? 1 : 0;
+		return impl::set_sock_opt(fd_, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+	}
+
 	core::Error set_nonblocking(bool enable = true) noexcept {
 		if (fd_ == impl::invalid_socket) return core::Error::SocketClosed;
 		return impl::set_nonblocking_impl(fd_, enable);
@@ -405,6 +496,24 @@ public:
 	bool is_open() const noexcept { return fd_ != impl::invalid_socket; }
 	impl::socket_t native_handle() const noexcept { return fd_; }
 
+	/**
+	 * @brief Take ownership of an already-open socket (e.g. an inherited listener)
+	 */
+	static Socket adopt(impl::socket_t fd) noexcept {
+		Socket s;
+		s.fd_ = fd;
+		return s;
+	}
+
+	/**
+	 * @brief Give up ownership of the handle without closing it
+	 */
+	impl::socket_t release() noexcept {
+		auto fd = fd_;
+		fd_ = impl::invalid_socket;
+		return fd;
+	}
+
 private:
 	impl::socket_t fd_ = impl::invalid_socket;
 	friend class Socket;
@@ -0,0 +1,133 @@
+/**
+ * @file splice.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Zero-copy socket-to-socket transfer through a pipe (Linux splice)
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "socket.hpp"
+#include "../core/error.hpp"
+
+#ifdef __linux__
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <csignal>
+	#include <cerrno>
+	#include <ctime>
+	#include <pthread.h>
+#endif
+
+namespace etherz {
+namespace net {
+
+/**
+ * @brief Kernel pipe used to move bytes between two sockets without copying them to user space
+ *
+ * fill() splices from a socket into the pipe, drain() from the pipe into
+ * another socket; both are non-blocking and return -1 with WouldBlock
+ * when they cannot make progress. Bytes left in the pipe by a partial
+ * drain() stay there until the next one. Only available on Linux;
+ * elsewhere open() fails and callers copy instead.
+ */
+class SplicePipe {
+public:
+	SplicePipe() noexcept = default;
+	~SplicePipe() { close(); }
+
+	SplicePipe(const SplicePipe&) = delete;
+	SplicePipe& operator=(const SplicePipe&) = delete;
+
+	static constexpr bool supported() noexcept {
+#ifdef __linux__
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool open() noexcept {
+#ifdef __linux__
+		if (is_open()) return true;
+		int fds[2];
+		if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) return false;
+		read_end_ = fds[0];
+		write_end_ = fds[1];
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void close() noexcept {
+#ifdef __linux__
+		if (read_end_ >= 0) ::close(read_end_);
+		if (write_end_ >= 0) ::close(write_end_);
+#endif
+		read_end_ = write_end_ = -1;
+		buffered_ = 0;
+	}
+
+	bool is_open() const noexcept { return read_end_ >= 0; }
+
+	/// Bytes in the pipe, not yet drained
+	size_t size() const noexcept { return buffered_; }
+
+	/**
+	 * @brief Move up to max bytes from a socket into the pipe
+	 * @return Bytes moved, 0 at end of stream, -1 on error
+	 */
+	int64_t fill(impl::socket_t from, size_t max) noexcept {
+#ifdef __linux__
+		auto n = ::splice(from, nullptr, write_end_, nullptr, max, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (n > 0) buffered_ += static_cast<size_t>(n);
+		return n;
+#else
+		(void)from; (void)max;
+		return -1;
+#endif
+	}
+
+	/**
+	 * @brief Move buffered bytes from the pipe into a socket
+	 * @return Bytes moved, -1 on error
+	 */
+	int64_t drain(impl::socket_t to) noexcept {
+#ifdef __linux__
+		if (buffered_ == 0) return 0;
+		// splice() has no MSG_NOSIGNAL: hold SIGPIPE back and swallow it if the peer is gone
+		sigset_t pipe_signal, previous;
+		sigemptyset(&pipe_signal);
+		sigaddset(&pipe_signal, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &pipe_signal, &previous);
+		auto n = ::splice(read_end_, nullptr, to, nullptr, buffered_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		int err = errno;
+		if (n < 0 && err == EPIPE) {
+			timespec poll_only{};
+			sigtimedwait(&pipe_signal, nullptr, &poll_only);
+		}
+		pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+		errno = err;
+		if (n > 0) buffered_ -= static_cast<size_t>(n);
+		return n;
+#else
+		(void)to;
+		return -1;
+#endif
+	}
+
+private:
+	int read_end_ = -1;
+	int write_end_ = -1;
+	size_t buffered_ = 0;
+};
+
+} // namespace net
+} // namespace etherz
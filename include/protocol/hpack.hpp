@@ -0,0 +1,571 @@
+/**
+ * @file hpack.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief HPACK header compression for HTTP/2 (RFC 7541)
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <array>
+#include <utility>
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief A decoded header field (names are lowercase in HTTP/2)
+ */
+struct HpackHeader {
+	std::string name;
+	std::string value;
+};
+
+namespace hpack {
+
+/// Per-entry overhead counted against the dynamic table size (RFC 7541 §4.1)
+inline constexpr size_t ENTRY_OVERHEAD = 32;
+inline constexpr size_t DEFAULT_TABLE_SIZE = 4096;
+
+// ═══════════════════════════════════════════════
+//  Static Table (RFC 7541 Appendix A)
+// ═══════════════════════════════════════════════
+
+inline constexpr std::array<std::pair<std::string_view, std::string_view>, 61> static_table = {{
+	{":authority", ""},                  {":method", "GET"},
+	{":method", "POST"},                 {":path", "/"},
+	{":path", "/index.html"},            {":scheme", "http"},
+	{":scheme", "https"},                {":status", "200"},
+	{":status", "204"},                  {":status", "206"},
+	{":status", "304"},                  {":status", "400"},
+	{":status", "404"},                  {":status", "500"},
+	{"accept-charset", ""},              {"accept-encoding", "gzip, deflate"},
+	{"accept-language", ""},             {"accept-ranges", ""},
+	{"accept", ""},                      {"access-control-allow-origin", ""},
+	{"age", ""},                         {"allow", ""},
+	{"authorization", ""},               {"cache-control", ""},
+	{"content-disposition", ""},         {"content-encoding", ""},
+	{"content-language", ""},            {"content-length", ""},
+	{"content-location", ""},            {"content-range", ""},
+	{"content-type", ""},                {"cookie", ""},
+	{"date", ""},                        {"etag", ""},
+	{"expect", ""},                      {"expires", ""},
+	{"from", ""},                        {"host", ""},
+	{"if-match", ""},                    {"if-modified-since", ""},
+	{"if-none-match", ""},               {"if-range", ""},
+	{"if-unmodified-since", ""},         {"last-modified", ""},
+	{"link", ""},                        {"location", ""},
+	{"max-forwards", ""},                {"proxy-authenticate", ""},
+	{"proxy-authorization", ""},         {"range", ""},
+	{"referer", ""},                     {"refresh", ""},
+	{"retry-after", ""},                 {"server", ""},
+	{"set-cookie", ""},                  {"strict-transport-security", ""},
+	{"transfer-encoding", ""},           {"user-agent", ""},
+	{"vary", ""},                        {"via", ""},
+	{"www-authenticate", ""}
+}};
+
+namespace detail {
+
+	// Huffman code table (RFC 7541 Appendix B); index 256 is EOS
+	inline constexpr std::array<uint32_t, 257> huffman_codes = {
+		0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+		0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+		0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+		0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+		0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+		0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+		0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+		0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+		0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+		0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+		0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+		0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+		0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+		0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+		0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+		0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+		0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+		0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+		0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+		0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+		0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+		0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+		0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+		0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+		0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+		0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+		0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+		0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+		0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+		0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+		0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+		0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+		0x3fffffff,
+	};
+
+	inline constexpr std::array<uint8_t, 257> huffman_lengths = {
+		13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+		28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+		6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+		5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+		13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+		15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+		6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+		20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+		24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+		22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+		21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+		26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+		19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+		20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+		26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+		30,
+	};
+
+
+	/**
+	 * @brief Binary decoding tree built once from the code table
+	 */
+	struct HuffmanTree {
+		struct Node {
+			int16_t child[2] = {-1, -1};
+			int16_t symbol = -1;
+		};
+		std::vector<Node> nodes;
+
+		HuffmanTree() {
+			nodes.reserve(512);
+			nodes.emplace_back();
+			for (size_t sym = 0; sym < huffman_codes.size(); ++sym) {
+				uint32_t code = huffman_codes[sym];
+				int len = huffman_lengths[sym];
+				size_t cur = 0;
+				for (int bit = len - 1; bit >= 0; --bit) {
+					int b = static_cast<int>((code >> bit) & 1u);
+					if (nodes[cur].child[b] < 0) {
+						nodes[cur].child[b] = static_cast<int16_t>(nodes.size());
+						nodes.emplace_back();
+					}
+					cur = static_cast<size_t>(nodes[cur].child[b]);
+				}
+				nodes[cur].symbol = static_cast<int16_t>(sym);
+			}
+		}
+	};
+
+	inline const HuffmanTree& huffman_tree() {
+		static const HuffmanTree tree;
+		return tree;
+	}
+
+} // namespace detail
+
+// ═══════════════════════════════════════════════
+//  Primitive Coding
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Encode an integer with an N-bit prefix (RFC 7541 §5.1)
+ * @param flags High bits of the first byte (pattern bits above the prefix)
+ */
+inline void encode_integer(std::string& out, uint64_t value, int prefix_bits, uint8_t flags = 0) {
+	uint64_t max_prefix = (uint64_t{1} << prefix_bits) - 1;
+	if (value < max_prefix) {
+		out.push_back(static_cast<char>(flags | static_cast<uint8_t>(value)));
+		return;
+	}
+	out.push_back(static_cast<char>(flags | static_cast<uint8_t>(max_prefix)));
+	value -= max_prefix;
+	while (value >= 128) {
+		out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Decode an N-bit prefix integer starting at pos
+ * @return false on truncated input or overflow
+ */
+inline bool decode_integer(std::string_view in, size_t& pos, int prefix_bits, uint64_t& value) noexcept {
+	if (pos >= in.size()) return false;
+	uint64_t max_prefix = (uint64_t{1} << prefix_bits) - 1;
+	value = static_cast<uint8_t>(in[pos++]) & max_prefix;
+	if (value < max_prefix) return true;
+
+	int shift = 0;
+	while (pos < in.size()) {
+		auto b = static_cast<uint8_t>(in[pos++]);
+		if (shift > 56) return false;
+		value += static_cast<uint64_t>(b & 0x7F) << shift;
+		shift += 7;
+		if ((b & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Number of bytes s occupies once Huffman coded
+ */
+inline size_t huffman_encoded_size(std::string_view s) noexcept {
+	size_t bits = 0;
+	for (char c : s) bits += detail::huffman_lengths[static_cast<uint8_t>(c)];
+	return (bits + 7) / 8;
+}
+
+/**
+ * @brief Huffman-code s, padding the last byte with EOS bits
+ */
+inline void huffman_encode(std::string_view s, std::string& out) {
+	uint64_t acc = 0;
+	int bits = 0;
+	for (char c : s) {
+		auto sym = static_cast<uint8_t>(c);
+		acc = (acc << detail::huffman_lengths[sym]) | detail::huffman_codes[sym];
+		bits += detail::huffman_lengths[sym];
+		while (bits >= 8) {
+			bits -= 8;
+			out.push_back(static_cast<char>((acc >> bits) & 0xFF));
+		}
+	}
+	if (bits > 0) {
+		acc = (acc << (8 - bits)) | ((1u << (8 - bits)) - 1);
+		out.push_back(static_cast<char>(acc & 0xFF));
+	}
+}
+
+/**
+ * @brief Decode a Huffman-coded string
+ * @return false on invalid code, EOS in data, or bad padding
+ */
+inline bool huffman_decode(std::string_view in, std::string& out) {
+	const auto& tree = detail::huffman_tree();
+	size_t cur = 0;
+	int depth = 0;      // Bits consumed since last emitted symbol
+	bool all_ones = true;
+
+	for (char c : in) {
+		auto byte = static_cast<uint8_t>(c);
+		for (int bit = 7; bit >= 0; --bit) {
+			int b = (byte >> bit) & 1;
+			auto next = tree.nodes[cur].child[b];
+			if (next < 0) return false;
+			cur = static_cast<size_t>(next);
+			++depth;
+			all_ones = all_ones && b == 1;
+			auto sym = tree.nodes[cur].symbol;
+			if (sym >= 0) {
+				if (sym == 256) return false;
+				out.push_back(static_cast<char>(sym));
+				cur = 0;
+				depth = 0;
+				all_ones = true;
+			}
+		}
+	}
+	// Leftover bits must be a strict EOS prefix of at most 7 bits
+	return depth <= 7 && all_ones;
+}
+
+/**
+ * @brief Encode a string literal, Huffman-coding it when that is shorter
+ */
+inline void encode_string(std::string& out, std::string_view s) {
+	size_t huff = huffman_encoded_size(s);
+	if (huff < s.size()) {
+		encode_integer(out, huff, 7, 0x80);
+		huffman_encode(s, out);
+	} else {
+		encode_integer(out, s.size(), 7, 0x00);
+		out.append(s);
+	}
+}
+
+/**
+ * @brief Decode a string literal at pos
+ */
+inline bool decode_string(std::string_view in, size_t& pos, std::string& out) {
+	if (pos >= in.size()) return false;
+	bool huffman = (static_cast<uint8_t>(in[pos]) & 0x80) != 0;
+	uint64_t len = 0;
+	if (!decode_integer(in, pos, 7, len)) return false;
+	if (len > in.size() - pos) return false;
+	auto data = in.substr(pos, static_cast<size_t>(len));
+	pos += static_cast<size_t>(len);
+	out.clear();
+	if (huffman) return huffman_decode(data, out);
+	out.assign(data);
+	return true;
+}
+
+} // namespace hpack
+
+// ═══════════════════════════════════════════════
+//  Dynamic Table
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief FIFO of recently indexed fields, bounded by octet size
+ *
+ * Index 1 is the newest entry; HPACK addresses it as 62 (after the static table).
+ */
+class HpackDynamicTable {
+public:
+	explicit HpackDynamicTable(size_t max_size = hpack::DEFAULT_TABLE_SIZE) noexcept
+		: max_size_(max_size) {}
+
+	void add(std::string name, std::string value) {
+		size_t entry = name.size() + value.size() + hpack::ENTRY_OVERHEAD;
+		if (entry > max_size_) {
+			// An oversized entry empties the table (RFC 7541 §4.4)
+			entries_.clear();
+			size_ = 0;
+			return;
+		}
+		size_ += entry;
+		entries_.push_front({std::move(name), std::move(value)});
+		evict();
+	}
+
+	void set_max_size(size_t max_size) {
+		max_size_ = max_size;
+		evict();
+	}
+
+	/**
+	 * @brief Get entry by 1-based dynamic index (nullptr if out of range)
+	 */
+	const HpackHeader* get(size_t index) const noexcept {
+		if (index == 0 || index > entries_.size()) return nullptr;
+		return &entries_[index - 1];
+	}
+
+	/**
+	 * @brief Find a field, returning the 1-based index; name_only is set on a name-only match
+	 */
+	size_t find(std::string_view name, std::string_view value, bool& name_only) const noexcept {
+		size_t name_match = 0;
+		for (size_t i = 0; i < entries_.size(); ++i) {
+			if (entries_[i].name != name) continue;
+			if (entries_[i].value == value) {
+				name_only = false;
+				return i + 1;
+			}
+			if (name_match == 0) name_match = i + 1;
+		}
+		name_only = name_match != 0;
+		return name_match;
+	}
+
+	size_t size() const noexcept { return size_; }
+	size_t max_size() const noexcept { return max_size_; }
+	size_t count() const noexcept { return entries_.size(); }
+
+private:
+	std::deque<HpackHeader> entries_;
+	size_t size_ = 0;
+	size_t max_size_;
+
+	void evict() {
+		while (size_ > max_size_ && !entries_.empty()) {
+			const auto& e = entries_.back();
+			size_ -= e.name.size() + e.value.size() + hpack::ENTRY_OVERHEAD;
+			entries_.pop_back();
+		}
+	}
+};
+
+// ═══════════════════════════════════════════════
+//  Decoder
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Stateful HPACK decoder (one per connection direction)
+ */
+class HpackDecoder {
+public:
+	/**
+	 * @param max_table_size  SETTINGS_HEADER_TABLE_SIZE we advertised
+	 * @param max_list_size   Upper bound on decoded header bytes per block
+	 */
+	explicit HpackDecoder(size_t max_table_size = hpack::DEFAULT_TABLE_SIZE,
+		size_t max_list_size = 64 * 1024) noexcept
+		: table_(max_table_size), max_table_size_(max_table_size), max_list_size_(max_list_size) {}
+
+	/**
+	 * @brief Decode a complete header block
+	 * @return false on a compression error (connection must be torn down)
+	 */
+	bool decode(std::string_view block, std::vector<HpackHeader>& headers) {
+		size_t pos = 0;
+		size_t list_size = 0;
+		bool fields_seen = false;
+
+		while (pos < block.size()) {
+			auto b = static_cast<uint8_t>(block[pos]);
+			uint64_t index = 0;
+
+			if (b & 0x80) {
+				// Indexed header field
+				if (!hpack::decode_integer(block, pos, 7, index)) return false;
+				HpackHeader h;
+				if (!lookup(index, h, true)) return false;
+				list_size += h.name.size() + h.value.size() + hpack::ENTRY_OVERHEAD;
+				headers.push_back(std::move(h));
+				fields_seen = true;
+			} else if ((b & 0xE0) == 0x20) {
+				// Dynamic table size update — only allowed before the first field
+				if (fields_seen) return false;
+				if (!hpack::decode_integer(block, pos, 5, index)) return false;
+				if (index > max_table_size_) return false;
+				table_.set_max_size(static_cast<size_t>(index));
+			} else {
+				// Literal: 01 = incremental indexing, 0000 = without, 0001 = never indexed
+				bool indexing = (b & 0xC0) == 0x40;
+				int prefix = indexing ? 6 : 4;
+				if (!hpack::decode_integer(block, pos, prefix, index)) return false;
+
+				HpackHeader h;
+				if (index == 0) {
+					if (!hpack::decode_string(block, pos, h.name)) return false;
+				} else if (!lookup(index, h, false)) {
+					return false;
+				}
+				if (!hpack::decode_string(block, pos, h.value)) return false;
+
+				list_size += h.name.size() + h.value.size() + hpack::ENTRY_OVERHEAD;
+				if (indexing) table_.add(h.name, h.value);
+				headers.push_back(std::move(h));
+				fields_seen = true;
+			}
+
+			if (list_size > max_list_size_) return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Change the table size limit we advertise to the peer
+	 */
+	void set_max_table_size(size_t size) {
+		max_table_size_ = size;
+		if (table_.max_size() > size) table_.set_max_size(size);
+	}
+
+	const HpackDynamicTable& table() const noexcept { return table_; }
+
+private:
+	HpackDynamicTable table_;
+	size_t max_table_size_;
+	size_t max_list_size_;
+
+	bool lookup(uint64_t index, HpackHeader& out, bool with_value) const {
+		if (index == 0) return false;
+		if (index <= hpack::static_table.size()) {
+			const auto& [name, value] = hpack::static_table[static_cast<size_t>(index - 1)];
+			out.name.assign(name);
+			if (with_value) out.value.assign(value);
+			return true;
+		}
+		const auto* entry = table_.get(static_cast<size_t>(index - hpack::static_table.size()));
+		if (!entry) return false;
+		out.name = entry->name;
+		if (with_value) out.value = entry->value;
+		return true;
+	}
+};
+
+// ═══════════════════════════════════════════════
+//  Encoder
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Stateful HPACK encoder (one per connection direction)
+ *
+ * Uses full static/dynamic matches where possible, indexes new fields
+ * incrementally, and never indexes credentials.
+ */
+class HpackEncoder {
+public:
+	explicit HpackEncoder(size_t max_table_size = hpack::DEFAULT_TABLE_SIZE) noexcept
+		: table_(max_table_size) {}
+
+	/**
+	 * @brief Apply the peer's SETTINGS_HEADER_TABLE_SIZE
+	 *
+	 * The change is signalled at the start of the next header block.
+	 */
+	void set_max_table_size(size_t size) {
+		if (size == table_.max_size()) return;
+		table_.set_max_size(size);
+		pending_size_update_ = true;
+	}
+
+	/**
+	 * @brief Encode a list of fields as one header block
+	 */
+	void encode(const std::vector<HpackHeader>& headers, std::string& out) {
+		if (pending_size_update_) {
+			hpack::encode_integer(out, table_.max_size(), 5, 0x20);
+			pending_size_update_ = false;
+		}
+		for (const auto& h : headers) encode_field(h.name, h.value, out);
+	}
+
+	void encode_field(std::string_view name, std::string_view value, std::string& out) {
+		size_t static_name = 0;
+		for (size_t i = 0; i < hpack::static_table.size(); ++i) {
+			if (hpack::static_table[i].first != name) continue;
+			if (hpack::static_table[i].second == value) {
+				hpack::encode_integer(out, i + 1, 7, 0x80);
+				return;
+			}
+			if (static_name == 0) static_name = i + 1;
+		}
+
+		bool name_only = false;
+		size_t dyn = table_.find(name, value, name_only);
+		if (dyn != 0 && !name_only) {
+			hpack::encode_integer(out, hpack::static_table.size() + dyn, 7, 0x80);
+			return;
+		}
+
+		size_t name_index = static_name;
+		if (name_index == 0 && dyn != 0) name_index = hpack::static_table.size() + dyn;
+
+		if (is_sensitive(name)) {
+			hpack::encode_integer(out, name_index, 4, 0x10);
+		} else if (name.size() + value.size() + hpack::ENTRY_OVERHEAD > table_.max_size() / 2) {
+			hpack::encode_integer(out, name_index, 4, 0x00);
+		} else {
+			hpack::encode_integer(out, name_index, 6, 0x40);
+			table_.add(std::string(name), std::string(value));
+		}
+		if (name_index == 0) hpack::encode_string(out, name);
+		hpack::encode_string(out, value);
+	}
+
+	const HpackDynamicTable& table() const noexcept { return table_; }
+
+private:
+	HpackDynamicTable table_;
+	bool pending_size_update_ = false;
+
+	static bool is_sensitive(std::string_view name) noexcept {
+		return name == "authorization" || name == "proxy-authorization"
+			|| name == "cookie" || name == "set-cookie";
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
@@ -15,11 +15,42 @@
 #include <string_view>
 #include <vector>
 #include <utility>
+#include <algorithm>
 #include <print>
+#include <functional>
 
 namespace etherz {
 namespace protocol {
 
+namespace detail {
+	inline char ascii_lower(char c) noexcept {
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+	}
+
+	inline bool iequals(std::string_view a, std::string_view b) noexcept {
+		if (a.size() != b.size()) return false;
+		if (a == b) return true; // Header names usually arrive in canonical case
+		for (size_t i = 0; i < a.size(); ++i) {
+			if (ascii_lower(a[i]) != ascii_lower(b[i])) return false;
+		}
+		return true;
+	}
+
+	inline bool icontains(std::string_view haystack, std::string_view needle) noexcept {
+		if (needle.size() > haystack.size()) return false;
+		for (size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+			if (iequals(haystack.substr(i, needle.size()), needle)) return true;
+		}
+		return false;
+	}
+
+	inline std::string_view trim(std::string_view s) noexcept {
+		while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+		while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+		return s;
+	}
+} // namespace detail
+
 // ═══════════════════════════════════════════════
 //  HTTP Method
 // ═══════════════════════════════════════════════
@@ -57,9 +88,11 @@ inline HttpMethod method_from_string(std::string_view s) noexcept {
 // ═══════════════════════════════════════════════
 
 enum class HttpStatus : uint16_t {
+	SwitchingProtocols  = 101,
 	OK                  = 200,
 	Created             = 201,
 	NoContent           = 204,
+	PartialContent      = 206,
 	MovedPermanently    = 301,
 	Found               = 302,
 	NotModified         = 304,
@@ -68,18 +101,24 @@ enum class HttpStatus : uint16_t {
 	Forbidden           = 403,
 	NotFound            = 404,
 	MethodNotAllowed    = 405,
+	RequestTimeout      = 408,
+	PayloadTooLarge     = 413,
+	RangeNotSatisfiable = 416,
 	InternalServerError = 500,
 	NotImplemented      = 501,
 	BadGateway          = 502,
 	ServiceUnavailable  = 503,
+	GatewayTimeout      = 504,
 	Unknown             = 0
 };
 
 inline constexpr std::string_view status_text(HttpStatus s) noexcept {
 	switch (s) {
+		case HttpStatus::SwitchingProtocols:  return "Switching Protocols";
 		case HttpStatus::OK:                  return "OK";
 		case HttpStatus::Created:             return "Created";
 		case HttpStatus::NoContent:           return "No Content";
+		case HttpStatus::PartialContent:      return "Partial Content";
 		case HttpStatus::MovedPermanently:    return "Moved Permanently";
 		case HttpStatus::Found:               return "Found";
 		case HttpStatus::NotModified:         return "Not Modified";
@@ -88,10 +127,14 @@ inline constexpr std::string_view status_text(HttpStatus s) noexcept {
 		case HttpStatus::Forbidden:           return "Forbidden";
 		case HttpStatus::NotFound:            return "Not Found";
 		case HttpStatus::MethodNotAllowed:    return "Method Not Allowed";
+		case HttpStatus::RequestTimeout:      return "Request Timeout";
+		case HttpStatus::PayloadTooLarge:     return "Payload Too Large";
+		case HttpStatus::RangeNotSatisfiable: return "Range Not Satisfiable";
 		case HttpStatus::InternalServerError: return "Internal Server Error";
 		case HttpStatus::NotImplemented:      return "Not Implemented";
 		case HttpStatus::BadGateway:          return "Bad Gateway";
 		case HttpStatus::ServiceUnavailable:  return "Service Unavailable";
+		case HttpStatus::GatewayTimeout:      return "Gateway Timeout";
 		default:                              return "Unknown";
 	}
 }
@@ -106,21 +149,21 @@ public:
 
 	void set(std::string key, std::string value) {
 		for (auto& [k, v] : entries_) {
-			if (iequals(k, key)) { v = std::move(value); return; }
+			if (detail::iequals(k, key)) { v = std::move(value); return; }
 		}
 		entries_.emplace_back(std::move(key), std::move(value));
 	}
 
 	std::string_view get(std::string_view key) const noexcept {
 		for (const auto& [k, v] : entries_) {
-			if (iequals(k, key)) return v;
+			if (detail::iequals(k, key)) return v;
 		}
 		return {};
 	}
 
 	bool has(std::string_view key) const noexcept {
 		for (const auto& [k, v] : entries_) {
-			if (iequals(k, key)) return true;
+			if (detail::iequals(k, key)) return true;
 		}
 		return false;
 	}
@@ -141,16 +184,6 @@ public:
 
 private:
 	std::vector<Entry> entries_;
-
-	static bool iequals(std::string_view a, std::string_view b) noexcept {
-		if (a.size() != b.size()) return false;
-		for (size_t i = 0; i < a.size(); ++i) {
-			char ca = (a[i] >= 'A' && a[i] <= 'Z') ? static_cast<char>(a[i] + 32) : a[i];
-			char cb = (b[i] >= 'A' && b[i] <= 'Z') ? static_cast<char>(b[i] + 32) : b[i];
-			if (ca != cb) return false;
-		}
-		return true;
-	}
 };
 
 // ═══════════════════════════════════════════════
@@ -325,6 +358,300 @@ inline HttpResponse parse_response(std::string_view raw) {
 	return resp;
 }
 
+/**
+ * @brief Incremental decoder for "Transfer-Encoding: chunked" bodies
+ *
+ * Feed raw bytes as they arrive; each call consumes what it can and yields
+ * at most one slice of body data pointing into the input, so callers can
+ * stop between slices (e.g. to apply back-pressure) without copying.
+ */
+class ChunkedDecoder {
+public:
+	/**
+	 * @brief Consume bytes from in
+	 * @param data Set to the next body slice (empty if none is available yet)
+	 * @return Number of input bytes consumed
+	 */
+	size_t decode(std::string_view in, std::string_view& data) noexcept {
+		data = {};
+		size_t pos = 0;
+		while (pos < in.size() && state_ != State::Done && state_ != State::Error) {
+			switch (state_) {
+				case State::Size: {
+					auto eol = detail::find_crlf(in, pos);
+					if (eol == std::string_view::npos) {
+						if (in.size() - pos > MAX_LINE) state_ = State::Error;
+						return pos;
+					}
+					auto line = in.substr(pos, eol - pos);
+					auto ext = line.find(';');
+					if (ext != std::string_view::npos) line = line.substr(0, ext);
+					if (!parse_hex(line, remaining_)) { state_ = State::Error; return pos; }
+					pos = eol + 2;
+					state_ = (remaining_ == 0) ? State::Trailer : State::Data;
+					break;
+				}
+				case State::Data: {
+					size_t n = std::min<size_t>(remaining_, in.size() - pos);
+					data = in.substr(pos, n);
+					remaining_ -= n;
+					pos += n;
+					if (remaining_ == 0) state_ = State::DataEnd;
+					return pos;
+				}
+				case State::DataEnd: {
+					if (in.size() - pos < 2) return pos;
+					if (in[pos] != '\r' || in[pos + 1] != '\n') { state_ = State::Error; return pos; }
+					pos += 2;
+					state_ = State::Size;
+					break;
+				}
+				case State::Trailer: {
+					// Trailer fields are skipped; an empty line ends the message
+					auto eol = detail::find_crlf(in, pos);
+					if (eol == std::string_view::npos) {
+						if (in.size() - pos > MAX_LINE) state_ = State::Error;
+						return pos;
+					}
+					state_ = (eol == pos) ? State::Done : State::Trailer;
+					pos = eol + 2;
+					break;
+				}
+				default:
+					return pos;
+			}
+		}
+		return pos;
+	}
+
+	bool done() const noexcept { return state_ == State::Done; }
+	bool failed() const noexcept { return state_ == State::Error; }
+
+private:
+	enum class State : uint8_t { Size, Data, DataEnd, Trailer, Done, Error };
+	static constexpr size_t MAX_LINE = 4096;
+
+	State state_ = State::Size;
+	uint64_t remaining_ = 0;
+
+	static bool parse_hex(std::string_view s, uint64_t& out) noexcept {
+		while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+		if (s.empty() || s.size() > 15) return false;
+		out = 0;
+		for (char c : s) {
+			int v;
+			if (c >= '0' && c <= '9') v = c - '0';
+			else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+			else return false;
+			out = (out << 4) | static_cast<uint64_t>(v);
+		}
+		return true;
+	}
+};
+
+/**
+ * @brief Incremental reader for one HTTP/1.x response
+ *
+ * Feed bytes as they arrive. The body is collected by its framing
+ * (Content-Length, chunked, or up to end of stream; none for HEAD, 204
+ * and 304) and feed() stops at the end of the message, so bytes it
+ * leaves unconsumed belong to whatever follows on the connection. 1xx
+ * interim responses are skipped. With stream(), the body is handed out
+ * as it arrives instead of collected.
+ */
+class ResponseParser {
+public:
+	using HeadCallback = std::function<bool(const HttpResponse&)>;
+	using BodyCallback = std::function<bool(std::string_view)>;
+
+	explicit ResponseParser(bool head_request = false) noexcept : head_request_(head_request) {}
+
+	/**
+	 * @brief Pass the final head to on_head, then body bytes to on_body as they arrive
+	 *
+	 * Nothing is collected into response().body. Either callback returning
+	 * false stops the parser (stopped()), leaving the rest unread.
+	 */
+	void stream(HeadCallback on_head, BodyCallback on_body) {
+		on_head_ = std::move(on_head);
+		on_body_ = std::move(on_body);
+	}
+
+	/**
+	 * @brief Consume bytes from in
+	 * @return Number of input bytes consumed (less than in.size() only once done or failed)
+	 */
+	size_t feed(std::string_view in) {
+		size_t pos = 0;
+		while (pos < in.size()) {
+			if (state_ == State::Head) {
+				size_t old_size = head_.size();
+				head_.append(in.substr(pos));
+				auto end = head_.find("\r\n\r\n", old_size >= 3 ? old_size - 3 : 0);
+				if (end == std::string::npos) {
+					if (head_.size() > MAX_HEAD) state_ = State::Error;
+					return in.size();
+				}
+				pos += end + 4 - old_size;
+				head_.resize(end + 4);
+				parse_head();
+			} else if (state_ == State::Body) {
+				pos += feed_body(in.substr(pos));
+			} else {
+				break;
+			}
+		}
+		return pos;
+	}
+
+	/**
+	 * @brief The stream ended: completes a close-delimited body, fails anything unfinished
+	 */
+	void finish() noexcept {
+		if (state_ == State::Body && framing_ == Framing::Close) state_ = State::Done;
+		else if (state_ != State::Done) state_ = State::Error;
+	}
+
+	bool done() const noexcept { return state_ == State::Done; }
+	bool failed() const noexcept { return state_ == State::Error; }
+	/// A stream() callback asked to stop
+	bool stopped() const noexcept { return state_ == State::Stopped; }
+	/// The final response's status line and fields have been read
+	bool has_head() const noexcept { return state_ == State::Body || state_ == State::Done; }
+
+	/**
+	 * @brief Once done: the connection may carry another exchange
+	 */
+	bool keep_alive() const noexcept { return keep_alive_ && framing_ != Framing::Close; }
+
+	/// Responses with a larger collected body fail
+	void set_body_limit(size_t limit) noexcept { body_limit_ = limit; }
+
+	HttpResponse& response() noexcept { return response_; }
+
+private:
+	enum class State : uint8_t { Head, Body, Done, Error, Stopped };
+	enum class Framing : uint8_t { None, Length, Chunked, Close };
+	static constexpr size_t MAX_HEAD = 64 * 1024;
+
+	State state_ = State::Head;
+	Framing framing_ = Framing::None;
+	bool head_request_;
+	bool keep_alive_ = false;
+	uint64_t remaining_ = 0;
+	size_t body_limit_ = SIZE_MAX;
+	std::string head_;
+	std::string pending_;
+	HttpResponse response_;
+	ChunkedDecoder decoder_;
+	HeadCallback on_head_;
+	BodyCallback on_body_;
+
+	void parse_head() {
+		response_ = parse_response(head_);
+		head_.clear();
+		auto code = static_cast<uint16_t>(response_.status);
+		if (code < 100 || code > 999 || !response_.version.starts_with("HTTP/1.")) {
+			state_ = State::Error;
+			return;
+		}
+		if (code < 200) return; // Interim: the final response follows
+
+		auto connection = response_.headers.get("Connection");
+		keep_alive_ = response_.version == "HTTP/1.0"
+			? ::etherz::protocol::detail::icontains(connection, "keep-alive")
+			: !::etherz::protocol::detail::icontains(connection, "close");
+
+		if (head_request_ || code == 204 || code == 304) {
+			framing_ = Framing::None;
+		} else if (::etherz::protocol::detail::icontains(response_.headers.get("Transfer-Encoding"), "chunked")) {
+			framing_ = Framing::Chunked;
+		} else if (response_.headers.has("Content-Length")) {
+			auto value = response_.headers.get("Content-Length");
+			if (value.empty() || value.size() > 18) { state_ = State::Error; return; }
+			remaining_ = 0;
+			for (char c : value) {
+				if (c < '0' || c > '9') { state_ = State::Error; return; }
+				remaining_ = remaining_ * 10 + static_cast<uint64_t>(c - '0');
+			}
+			if (remaining_ > body_limit_) { state_ = State::Error; return; }
+			framing_ = remaining_ > 0 ? Framing::Length : Framing::None;
+		} else {
+			framing_ = Framing::Close;
+		}
+		if (on_head_ && !on_head_(response_)) {
+			state_ = State::Stopped;
+			return;
+		}
+		state_ = framing_ == Framing::None ? State::Done : State::Body;
+	}
+
+	void deliver(std::string_view data) {
+		if (data.empty()) return;
+		if (!on_body_) {
+			response_.body.append(data);
+			if (response_.body.size() > body_limit_) state_ = State::Error;
+		} else if (!on_body_(data)) {
+			state_ = State::Stopped;
+		}
+	}
+
+	size_t feed_body(std::string_view in) {
+		size_t used = 0;
+		switch (framing_) {
+			case Framing::Length: {
+				used = static_cast<size_t>(std::min<uint64_t>(remaining_, in.size()));
+				remaining_ -= used;
+				if (remaining_ == 0) state_ = State::Done;
+				deliver(in.substr(0, used));
+				return used;
+			}
+			case Framing::Chunked: {
+				// A size line or trailer split across reads is held until the rest arrives
+				if (!pending_.empty()) {
+					size_t old_size = pending_.size();
+					pending_.append(in);
+					size_t n = decode_chunks(pending_);
+					if (state_ == State::Body) {
+						pending_.erase(0, n);
+						used = in.size();
+					} else {
+						pending_.clear();
+						used = n > old_size ? n - old_size : 0;
+					}
+					break;
+				}
+				used = decode_chunks(in);
+				if (state_ == State::Body) {
+					pending_.assign(in.substr(used));
+					used = in.size();
+				}
+				break;
+			}
+			default:
+				used = in.size();
+				deliver(in);
+				break;
+		}
+		return used;
+	}
+
+	size_t decode_chunks(std::string_view in) {
+		size_t used = 0;
+		while (used < in.size()) {
+			std::string_view data;
+			size_t n = decoder_.decode(in.substr(used), data);
+			used += n;
+			if (decoder_.failed()) { state_ = State::Error; break; }
+			if (decoder_.done()) state_ = State::Done;
+			deliver(data);
+			if (state_ != State::Body || n == 0) break;
+		}
+		return used;
+	}
+};
+
 } // namespace http_parser
 
 } // namespace protocol
@@ -0,0 +1,845 @@
+/**
+ * @file http2.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief HTTP/2 frame codec and server-side session (RFC 9113)
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <optional>
+#include <functional>
+#include <algorithm>
+
+#include "http.hpp"
+#include "hpack.hpp"
+
+namespace etherz {
+namespace protocol {
+
+// ═══════════════════════════════════════════════
+//  Frame Types, Flags, Errors, Settings
+// ═══════════════════════════════════════════════
+
+enum class H2FrameType : uint8_t {
+	Data         = 0x0,
+	Headers      = 0x1,
+	Priority     = 0x2,
+	RstStream    = 0x3,
+	Settings     = 0x4,
+	PushPromise  = 0x5,
+	Ping         = 0x6,
+	GoAway       = 0x7,
+	WindowUpdate = 0x8,
+	Continuation = 0x9
+};
+
+inline constexpr std::string_view h2_frame_name(H2FrameType t) noexcept {
+	switch (t) {
+		case H2FrameType::Data:         return "DATA";
+		case H2FrameType::Headers:      return "HEADERS";
+		case H2FrameType::Priority:     return "PRIORITY";
+		case H2FrameType::RstStream:    return "RST_STREAM";
+		case H2FrameType::Settings:     return "SETTINGS";
+		case H2FrameType::PushPromise:  return "PUSH_PROMISE";
+		case H2FrameType::Ping:         return "PING";
+		case H2FrameType::GoAway:       return "GOAWAY";
+		case H2FrameType::WindowUpdate: return "WINDOW_UPDATE";
+		case H2FrameType::Continuation: return "CONTINUATION";
+		default:                        return "UNKNOWN";
+	}
+}
+
+namespace h2_flags {
+	inline constexpr uint8_t EndStream  = 0x01;
+	inline constexpr uint8_t Ack        = 0x01;
+	inline constexpr uint8_t EndHeaders = 0x04;
+	inline constexpr uint8_t Padded     = 0x08;
+	inline constexpr uint8_t Priority   = 0x20;
+} // namespace h2_flags
+
+enum class H2Error : uint32_t {
+	NoError            = 0x0,
+	ProtocolError      = 0x1,
+	InternalError      = 0x2,
+	FlowControlError   = 0x3,
+	SettingsTimeout    = 0x4,
+	StreamClosed       = 0x5,
+	FrameSizeError     = 0x6,
+	RefusedStream      = 0x7,
+	Cancel             = 0x8,
+	CompressionError   = 0x9,
+	ConnectError       = 0xA,
+	EnhanceYourCalm    = 0xB,
+	InadequateSecurity = 0xC,
+	Http11Required     = 0xD
+};
+
+enum class H2SettingId : uint16_t {
+	HeaderTableSize      = 0x1,
+	EnablePush           = 0x2,
+	MaxConcurrentStreams = 0x3,
+	InitialWindowSize    = 0x4,
+	MaxFrameSize         = 0x5,
+	MaxHeaderListSize    = 0x6
+};
+
+/// Client connection preface (RFC 9113 §3.4)
+inline constexpr std::string_view h2_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+inline constexpr size_t   H2_FRAME_HEADER_SIZE  = 9;
+inline constexpr uint32_t H2_DEFAULT_WINDOW     = 65535;
+inline constexpr uint32_t H2_MAX_WINDOW         = 0x7FFFFFFF;
+inline constexpr uint32_t H2_MIN_FRAME_SIZE     = 16384;
+inline constexpr uint32_t H2_MAX_FRAME_SIZE     = 16777215;
+
+/**
+ * @brief Connection settings (one set per endpoint)
+ */
+struct H2Settings {
+	uint32_t header_table_size      = 4096;
+	uint32_t enable_push            = 0;
+	uint32_t max_concurrent_streams = 100;
+	uint32_t initial_window_size    = H2_DEFAULT_WINDOW;
+	uint32_t max_frame_size         = H2_MIN_FRAME_SIZE;
+	uint32_t max_header_list_size   = 64 * 1024;
+};
+
+// ═══════════════════════════════════════════════
+//  Frame Codec
+// ═══════════════════════════════════════════════
+
+struct H2FrameHeader {
+	uint32_t    length    = 0;
+	H2FrameType type      = H2FrameType::Data;
+	uint8_t     flags     = 0;
+	uint32_t    stream_id = 0;
+
+	bool has(uint8_t flag) const noexcept { return (flags & flag) != 0; }
+};
+
+namespace h2_detail {
+	inline void put_u32(std::string& out, uint32_t v) {
+		out.push_back(static_cast<char>((v >> 24) & 0xFF));
+		out.push_back(static_cast<char>((v >> 16) & 0xFF));
+		out.push_back(static_cast<char>((v >> 8) & 0xFF));
+		out.push_back(static_cast<char>(v & 0xFF));
+	}
+
+	inline uint32_t get_u32(std::string_view s, size_t pos) noexcept {
+		return (static_cast<uint32_t>(static_cast<uint8_t>(s[pos])) << 24)
+			 | (static_cast<uint32_t>(static_cast<uint8_t>(s[pos + 1])) << 16)
+			 | (static_cast<uint32_t>(static_cast<uint8_t>(s[pos + 2])) << 8)
+			 |  static_cast<uint32_t>(static_cast<uint8_t>(s[pos + 3]));
+	}
+
+	inline uint16_t get_u16(std::string_view s, size_t pos) noexcept {
+		return static_cast<uint16_t>((static_cast<uint8_t>(s[pos]) << 8) | static_cast<uint8_t>(s[pos + 1]));
+	}
+
+	/**
+	 * @brief Decode base64url without padding (HTTP2-Settings header)
+	 */
+	inline std::optional<std::string> base64url_decode(std::string_view in) {
+		auto value = [](char c) -> int {
+			if (c >= 'A' && c <= 'Z') return c - 'A';
+			if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+			if (c >= '0' && c <= '9') return c - '0' + 52;
+			if (c == '-' || c == '+') return 62;
+			if (c == '_' || c == '/') return 63;
+			return -1;
+		};
+		std::string out;
+		uint32_t acc = 0;
+		int bits = 0;
+		for (char c : in) {
+			if (c == '=') break;
+			int v = value(c);
+			if (v < 0) return std::nullopt;
+			acc = (acc << 6) | static_cast<uint32_t>(v);
+			bits += 6;
+			if (bits >= 8) {
+				bits -= 8;
+				out.push_back(static_cast<char>((acc >> bits) & 0xFF));
+			}
+		}
+		return out;
+	}
+} // namespace h2_detail
+
+/**
+ * @brief Append a frame header
+ */
+inline void h2_write_frame_header(std::string& out, const H2FrameHeader& h) {
+	out.push_back(static_cast<char>((h.length >> 16) & 0xFF));
+	out.push_back(static_cast<char>((h.length >> 8) & 0xFF));
+	out.push_back(static_cast<char>(h.length & 0xFF));
+	out.push_back(static_cast<char>(h.type));
+	out.push_back(static_cast<char>(h.flags));
+	h2_detail::put_u32(out, h.stream_id & H2_MAX_WINDOW);
+}
+
+/**
+ * @brief Append a complete frame (header + payload)
+ */
+inline void h2_write_frame(std::string& out, H2FrameType type, uint8_t flags,
+	uint32_t stream_id, std::string_view payload = {}) {
+	h2_write_frame_header(out, {static_cast<uint32_t>(payload.size()), type, flags, stream_id});
+	out.append(payload);
+}
+
+/**
+ * @brief Parse a 9-byte frame header (nullopt if fewer bytes are available)
+ */
+inline std::optional<H2FrameHeader> h2_read_frame_header(std::string_view in) noexcept {
+	if (in.size() < H2_FRAME_HEADER_SIZE) return std::nullopt;
+	H2FrameHeader h;
+	h.length = (static_cast<uint32_t>(static_cast<uint8_t>(in[0])) << 16)
+			 | (static_cast<uint32_t>(static_cast<uint8_t>(in[1])) << 8)
+			 |  static_cast<uint32_t>(static_cast<uint8_t>(in[2]));
+	h.type = static_cast<H2FrameType>(in[3]);
+	h.flags = static_cast<uint8_t>(in[4]);
+	h.stream_id = h2_detail::get_u32(in, 5) & H2_MAX_WINDOW;
+	return h;
+}
+
+/**
+ * @brief Serialize a SETTINGS payload carrying every field explicitly
+ */
+inline std::string h2_encode_settings(const H2Settings& s) {
+	std::string out;
+	auto put = [&](H2SettingId id, uint32_t v) {
+		out.push_back(static_cast<char>((static_cast<uint16_t>(id) >> 8) & 0xFF));
+		out.push_back(static_cast<char>(static_cast<uint16_t>(id) & 0xFF));
+		h2_detail::put_u32(out, v);
+	};
+	put(H2SettingId::HeaderTableSize, s.header_table_size);
+	put(H2SettingId::EnablePush, s.enable_push);
+	put(H2SettingId::MaxConcurrentStreams, s.max_concurrent_streams);
+	put(H2SettingId::InitialWindowSize, s.initial_window_size);
+	put(H2SettingId::MaxFrameSize, s.max_frame_size);
+	put(H2SettingId::MaxHeaderListSize, s.max_header_list_size);
+	return out;
+}
+
+// ═══════════════════════════════════════════════
+//  Server Session
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Transport-agnostic HTTP/2 server connection
+ *
+ * Bytes read from the socket go into feed(); bytes to write accumulate in
+ * output(). Each completed stream is turned into an HttpRequest, passed to
+ * the handler, and the HttpResponse is framed back onto the same stream.
+ * Responses are interleaved across streams within the peer's flow-control
+ * windows, so many requests share one TCP connection.
+ */
+class Http2Session {
+public:
+	using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+	/// Upper bound on a buffered request body per stream
+	static constexpr size_t MAX_BODY_SIZE = 1024 * 1024;
+
+	explicit Http2Session(Handler handler, H2Settings local = {})
+		: handler_(std::move(handler)), local_(local),
+		  decoder_(local.header_table_size, local.max_header_list_size) {}
+
+	/**
+	 * @brief Queue the server connection preface (prior-knowledge h2c)
+	 */
+	void start() {
+		send_preface();
+	}
+
+	/**
+	 * @brief Continue an HTTP/1.1 request that was upgraded with "Upgrade: h2c"
+	 *
+	 * The upgraded request becomes stream 1 (half-closed remote) and is
+	 * answered over HTTP/2. The client still sends its connection preface.
+	 */
+	bool start_upgraded(const HttpRequest& req, std::string_view http2_settings) {
+		auto payload = h2_detail::base64url_decode(http2_settings);
+		if (!payload || apply_settings(*payload) != H2Error::NoError) return false;
+		send_preface();
+
+		last_stream_id_ = 1;
+		auto& stream = streams_[1];
+		stream.id = 1;
+		stream.send_window = peer_.initial_window_size;
+		stream.remote_closed = true;
+		HttpRequest upgraded = req;
+		upgraded.version = "HTTP/2.0";
+		respond(stream, handler_(upgraded));
+		flush_data();
+		return true;
+	}
+
+	/**
+	 * @brief Consume bytes received from the peer
+	 * @return false if the connection must be closed once output() is flushed
+	 */
+	bool feed(std::string_view data) {
+		if (closing_) return false;
+		in_.append(data);
+
+		size_t pos = 0;
+		if (!preface_received_) {
+			if (in_.size() < h2_preface.size()) {
+				if (std::string_view(in_) != h2_preface.substr(0, in_.size())) return fail(H2Error::ProtocolError);
+				return true;
+			}
+			if (std::string_view(in_).substr(0, h2_preface.size()) != h2_preface) return fail(H2Error::ProtocolError);
+			preface_received_ = true;
+			pos = h2_preface.size();
+		}
+
+		while (!closing_) {
+			auto header = h2_read_frame_header(std::string_view(in_).substr(pos));
+			if (!header) break;
+			if (header->length > local_.max_frame_size) return fail(H2Error::FrameSizeError);
+			if (in_.size() - pos < H2_FRAME_HEADER_SIZE + header->length) break;
+
+			auto payload = std::string_view(in_).substr(pos + H2_FRAME_HEADER_SIZE, header->length);
+			pos += H2_FRAME_HEADER_SIZE + header->length;
+			if (!handle_frame(*header, payload)) break;
+		}
+
+		in_.erase(0, pos);
+		flush_data();
+		return !closing_;
+	}
+
+	/**
+	 * @brief Pending bytes to write to the socket
+	 */
+	std::string& output() noexcept { return out_; }
+
+	/**
+	 * @brief Begin graceful shutdown: GOAWAY with the last processed stream
+	 */
+	void shutdown(H2Error code = H2Error::NoError) {
+		if (goaway_sent_) return;
+		std::string payload;
+		h2_detail::put_u32(payload, last_stream_id_);
+		h2_detail::put_u32(payload, static_cast<uint32_t>(code));
+		h2_write_frame(out_, H2FrameType::GoAway, 0, 0, payload);
+		goaway_sent_ = true;
+	}
+
+	bool is_closing() const noexcept { return closing_; }
+	size_t active_streams() const noexcept { return streams_.size(); }
+	uint32_t last_stream_id() const noexcept { return last_stream_id_; }
+	uint64_t completed_streams() const noexcept { return completed_; }
+	const H2Settings& peer_settings() const noexcept { return peer_; }
+
+private:
+	struct Stream {
+		uint32_t id = 0;
+		bool remote_closed = false;     // END_STREAM received
+		bool responded = false;         // HEADERS for the response sent
+		bool refused = false;           // Over the concurrency limit
+		bool reset_when_done = false;   // RST_STREAM(NO_ERROR) after an early response
+		std::string header_block;
+		std::vector<HpackHeader> headers;
+		std::string body;
+		int64_t send_window = H2_DEFAULT_WINDOW;
+		int64_t recv_window = H2_DEFAULT_WINDOW;
+		std::string pending;            // Response body not yet framed
+		size_t pending_offset = 0;
+	};
+
+	Handler handler_;
+	H2Settings local_;
+	H2Settings peer_;
+	HpackDecoder decoder_;
+	HpackEncoder encoder_;
+
+	std::map<uint32_t, Stream> streams_;
+	std::set<uint32_t> reset_streams_;  // Reset after an early response; their DATA is dropped
+	std::string in_;
+	std::string out_;
+
+	int64_t conn_send_window_ = H2_DEFAULT_WINDOW;
+	int64_t conn_recv_window_ = H2_DEFAULT_WINDOW;
+	uint32_t last_stream_id_ = 0;
+	uint32_t continuation_stream_ = 0;   // Non-zero while a header block is open
+	std::string discarded_block_;        // Header block of a stream ignored after GOAWAY
+	bool discarding_ = false;            // continuation_stream_ is such a stream
+	uint64_t completed_ = 0;
+	bool preface_received_ = false;
+	bool goaway_sent_ = false;
+	bool closing_ = false;
+
+	void send_preface() {
+		h2_write_frame(out_, H2FrameType::Settings, 0, 0, h2_encode_settings(local_));
+		// INITIAL_WINDOW_SIZE is for streams; the connection window starts at
+		// 65535 whatever the setting and can only be raised with WINDOW_UPDATE
+		conn_recv_window_ = H2_DEFAULT_WINDOW;
+		if (local_.initial_window_size > H2_DEFAULT_WINDOW) {
+			send_window_update(0, local_.initial_window_size - H2_DEFAULT_WINDOW);
+			conn_recv_window_ = local_.initial_window_size;
+		}
+	}
+
+	bool fail(H2Error code) {
+		shutdown(code);
+		closing_ = true;
+		return false;
+	}
+
+	void send_rst(uint32_t stream_id, H2Error code) {
+		std::string payload;
+		h2_detail::put_u32(payload, static_cast<uint32_t>(code));
+		h2_write_frame(out_, H2FrameType::RstStream, 0, stream_id, payload);
+	}
+
+	void send_window_update(uint32_t stream_id, uint32_t increment) {
+		std::string payload;
+		h2_detail::put_u32(payload, increment);
+		h2_write_frame(out_, H2FrameType::WindowUpdate, 0, stream_id, payload);
+	}
+
+	H2Error apply_settings(std::string_view payload) {
+		if (payload.size() % 6 != 0) return H2Error::FrameSizeError;
+		for (size_t i = 0; i < payload.size(); i += 6) {
+			auto id = static_cast<H2SettingId>(h2_detail::get_u16(payload, i));
+			uint32_t value = h2_detail::get_u32(payload, i + 2);
+			switch (id) {
+				case H2SettingId::HeaderTableSize:
+					peer_.header_table_size = value;
+					encoder_.set_max_table_size(std::min<size_t>(value, hpack::DEFAULT_TABLE_SIZE));
+					break;
+				case H2SettingId::EnablePush:
+					if (value > 1) return H2Error::ProtocolError;
+					peer_.enable_push = value;
+					break;
+				case H2SettingId::MaxConcurrentStreams:
+					peer_.max_concurrent_streams = value;
+					break;
+				case H2SettingId::InitialWindowSize: {
+					if (value > H2_MAX_WINDOW) return H2Error::FlowControlError;
+					int64_t delta = static_cast<int64_t>(value) - static_cast<int64_t>(peer_.initial_window_size);
+					for (auto& [sid, s] : streams_) {
+						s.send_window += delta;
+						if (s.send_window > H2_MAX_WINDOW) return H2Error::FlowControlError;
+					}
+					peer_.initial_window_size = value;
+					break;
+				}
+				case H2SettingId::MaxFrameSize:
+					if (value < H2_MIN_FRAME_SIZE || value > H2_MAX_FRAME_SIZE) return H2Error::ProtocolError;
+					peer_.max_frame_size = value;
+					break;
+				case H2SettingId::MaxHeaderListSize:
+					peer_.max_header_list_size = value;
+					break;
+				default:
+					break; // Unknown settings are ignored
+			}
+		}
+		return H2Error::NoError;
+	}
+
+	bool handle_frame(const H2FrameHeader& h, std::string_view payload) {
+		if (continuation_stream_ != 0
+			&& (h.type != H2FrameType::Continuation || h.stream_id != continuation_stream_)) {
+			return fail(H2Error::ProtocolError);
+		}
+
+		switch (h.type) {
+			case H2FrameType::Data:         return on_data(h, payload);
+			case H2FrameType::Headers:      return on_headers(h, payload);
+			case H2FrameType::Continuation: return on_continuation(h, payload);
+			case H2FrameType::Settings:     return on_settings(h, payload);
+			case H2FrameType::WindowUpdate: return on_window_update(h, payload);
+			case H2FrameType::Ping:
+				if (h.stream_id != 0) return fail(H2Error::ProtocolError);
+				if (payload.size() != 8) return fail(H2Error::FrameSizeError);
+				if (!h.has(h2_flags::Ack)) h2_write_frame(out_, H2FrameType::Ping, h2_flags::Ack, 0, payload);
+				return true;
+			case H2FrameType::RstStream:
+				if (h.stream_id == 0) return fail(H2Error::ProtocolError);
+				if (payload.size() != 4) return fail(H2Error::FrameSizeError);
+				// RST_STREAM on an idle stream is a connection error (RFC 9113 §6.4)
+				if (h.stream_id > last_stream_id_) return fail(H2Error::ProtocolError);
+				streams_.erase(h.stream_id);
+				reset_streams_.erase(h.stream_id);
+				return true;
+			case H2FrameType::Priority:
+				if (h.stream_id == 0) return fail(H2Error::ProtocolError);
+				if (payload.size() != 5) return fail(H2Error::FrameSizeError);
+				return true;
+			case H2FrameType::GoAway:
+				// Peer is leaving: finish what we have, then close
+				shutdown(H2Error::NoError);
+				closing_ = streams_.empty();
+				return true;
+			case H2FrameType::PushPromise:
+				return fail(H2Error::ProtocolError); // Clients never push
+			default:
+				return true; // Unknown frame types are ignored
+		}
+	}
+
+	/**
+	 * @brief Strip padding (and priority fields) from DATA/HEADERS payloads
+	 */
+	bool strip_padding(const H2FrameHeader& h, std::string_view& payload) {
+		if (h.has(h2_flags::Padded)) {
+			if (payload.empty()) return false;
+			size_t pad = static_cast<uint8_t>(payload[0]);
+			payload.remove_prefix(1);
+			if (pad > payload.size()) return false;
+			payload.remove_suffix(pad);
+		}
+		return true;
+	}
+
+	bool on_settings(const H2FrameHeader& h, std::string_view payload) {
+		if (h.stream_id != 0) return fail(H2Error::ProtocolError);
+		if (h.has(h2_flags::Ack)) {
+			if (!payload.empty()) return fail(H2Error::FrameSizeError);
+			return true;
+		}
+		if (auto err = apply_settings(payload); err != H2Error::NoError) return fail(err);
+		h2_write_frame(out_, H2FrameType::Settings, h2_flags::Ack, 0);
+		return true;
+	}
+
+	bool on_window_update(const H2FrameHeader& h, std::string_view payload) {
+		if (payload.size() != 4) return fail(H2Error::FrameSizeError);
+		uint32_t increment = h2_detail::get_u32(payload, 0) & H2_MAX_WINDOW;
+		if (h.stream_id == 0) {
+			if (increment == 0) return fail(H2Error::ProtocolError);
+			conn_send_window_ += increment;
+			if (conn_send_window_ > H2_MAX_WINDOW) return fail(H2Error::FlowControlError);
+			return true;
+		}
+		auto it = streams_.find(h.stream_id);
+		if (it == streams_.end()) return true; // Closed stream: ignore
+		if (increment == 0) {
+			send_rst(h.stream_id, H2Error::ProtocolError);
+			streams_.erase(it);
+			return true;
+		}
+		it->second.send_window += increment;
+		if (it->second.send_window > H2_MAX_WINDOW) {
+			send_rst(h.stream_id, H2Error::FlowControlError);
+			streams_.erase(it);
+		}
+		return true;
+	}
+
+	bool on_headers(const H2FrameHeader& h, std::string_view payload) {
+		if (h.stream_id == 0 || (h.stream_id & 1) == 0) return fail(H2Error::ProtocolError);
+		if (!strip_padding(h, payload)) return fail(H2Error::ProtocolError);
+		if (h.has(h2_flags::Priority)) {
+			if (payload.size() < 5) return fail(H2Error::FrameSizeError);
+			payload.remove_prefix(5);
+		}
+
+		auto it = streams_.find(h.stream_id);
+		if (it == streams_.end()) {
+			if (h.stream_id <= last_stream_id_) return fail(H2Error::StreamClosed);
+			last_stream_id_ = h.stream_id;
+			if (goaway_sent_) {
+				// Not processed, but HPACK state must still follow the block (RFC 9113 §6.8)
+				discarding_ = true;
+				discarded_block_.assign(payload);
+				if (!h.has(h2_flags::EndHeaders)) {
+					continuation_stream_ = h.stream_id;
+					return true;
+				}
+				return discard_headers();
+			}
+
+			auto& stream = streams_[h.stream_id];
+			stream.id = h.stream_id;
+			stream.send_window = peer_.initial_window_size;
+			stream.recv_window = local_.initial_window_size;
+			it = streams_.find(h.stream_id);
+
+			// Over the limit: the block is still decoded to keep HPACK state in sync
+			stream.refused = streams_.size() > local_.max_concurrent_streams;
+		} else if (it->second.remote_closed) {
+			send_rst(h.stream_id, H2Error::StreamClosed);
+			return true;
+		}
+
+		auto& stream = it->second;
+		stream.header_block.append(payload);
+		if (h.has(h2_flags::EndStream)) stream.remote_closed = true;
+		if (!h.has(h2_flags::EndHeaders)) {
+			continuation_stream_ = h.stream_id;
+			return true;
+		}
+		return headers_complete(stream);
+	}
+
+	bool on_continuation(const H2FrameHeader& h, std::string_view payload) {
+		if (continuation_stream_ == 0 || h.stream_id != continuation_stream_) return fail(H2Error::ProtocolError);
+		if (discarding_) {
+			discarded_block_.append(payload);
+			if (discarded_block_.size() > local_.max_header_list_size * 2) return fail(H2Error::EnhanceYourCalm);
+			if (!h.has(h2_flags::EndHeaders)) return true;
+			continuation_stream_ = 0;
+			return discard_headers();
+		}
+		auto it = streams_.find(h.stream_id);
+		if (it == streams_.end()) return fail(H2Error::InternalError);
+		it->second.header_block.append(payload);
+		if (it->second.header_block.size() > local_.max_header_list_size * 2) return fail(H2Error::EnhanceYourCalm);
+		if (!h.has(h2_flags::EndHeaders)) return true;
+		continuation_stream_ = 0;
+		return headers_complete(it->second);
+	}
+
+	/// Decode and drop the header block of a stream ignored after GOAWAY
+	bool discard_headers() {
+		std::vector<HpackHeader> decoded;
+		bool ok = decoder_.decode(discarded_block_, decoded);
+		discarded_block_.clear();
+		discarding_ = false;
+		return ok ? true : fail(H2Error::CompressionError);
+	}
+
+	bool headers_complete(Stream& stream) {
+		std::vector<HpackHeader> decoded;
+		if (!decoder_.decode(stream.header_block, decoded)) return fail(H2Error::CompressionError);
+		stream.header_block.clear();
+		stream.header_block.shrink_to_fit();
+
+		if (stream.refused) {
+			auto id = stream.id;
+			send_rst(id, H2Error::RefusedStream);
+			streams_.erase(id);
+			return true;
+		}
+
+		// First block carries the request; a later one is trailers (ignored)
+		if (stream.headers.empty()) stream.headers = std::move(decoded);
+		if (stream.remote_closed) dispatch(stream);
+		return true;
+	}
+
+	bool on_data(const H2FrameHeader& h, std::string_view payload) {
+		if (h.stream_id == 0) return fail(H2Error::ProtocolError);
+
+		// Flow control counts the whole frame, padding included
+		conn_recv_window_ -= h.length;
+		if (conn_recv_window_ < 0) return fail(H2Error::FlowControlError);
+		replenish(0, conn_recv_window_);
+
+		// The rest of a body cut short by an early response: dropped, the client was told once
+		auto it = streams_.find(h.stream_id);
+		if (it != streams_.end() ? it->second.reset_when_done : reset_streams_.contains(h.stream_id)) {
+			// Once the client has finished sending there is nothing left to stop
+			if (h.has(h2_flags::EndStream)) {
+				if (it != streams_.end()) it->second.reset_when_done = false;
+				reset_streams_.erase(h.stream_id);
+			}
+			return true;
+		}
+		if (it == streams_.end() || it->second.remote_closed) {
+			if (h.stream_id > last_stream_id_) return fail(H2Error::ProtocolError);
+			send_rst(h.stream_id, H2Error::StreamClosed);
+			return true;
+		}
+		if (!strip_padding(h, payload)) return fail(H2Error::ProtocolError);
+
+		auto& stream = it->second;
+		stream.recv_window -= h.length;
+		if (stream.recv_window < 0) {
+			send_rst(h.stream_id, H2Error::FlowControlError);
+			streams_.erase(it);
+			return true;
+		}
+
+		if (stream.body.size() + payload.size() > MAX_BODY_SIZE) {
+			// Answer early, then tell the client to stop sending (RFC 9113 §8.1)
+			HttpResponse resp;
+			resp.status = HttpStatus::PayloadTooLarge;
+			resp.headers.set("Content-Type", "text/plain");
+			resp.body = "413 Payload Too Large";
+			stream.remote_closed = true;
+			stream.reset_when_done = true;
+			stream.body.clear();
+			respond(stream, std::move(resp));
+			return true;
+		}
+		stream.body.append(payload);
+
+		if (h.has(h2_flags::EndStream)) {
+			stream.remote_closed = true;
+			dispatch(stream);
+		} else {
+			replenish(stream.id, stream.recv_window);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Reopen a receive window once it drops below half
+	 */
+	void replenish(uint32_t stream_id, int64_t& window) {
+		int64_t target = local_.initial_window_size;
+		if (stream_id == 0) target = std::max<int64_t>(target, H2_DEFAULT_WINDOW);
+		if (window < target / 2) {
+			send_window_update(stream_id, static_cast<uint32_t>(target - window));
+			window = target;
+		}
+	}
+
+	void dispatch(Stream& stream) {
+		HttpRequest req;
+		req.version = "HTTP/2.0";
+		bool valid = true;
+		std::string_view method, path;
+
+		for (const auto& [name, value] : stream.headers) {
+			if (name.starts_with(':')) {
+				if (name == ":method") method = value;
+				else if (name == ":path") path = value;
+				else if (name == ":authority") req.headers.set("Host", value);
+				else if (name != ":scheme") valid = false;
+			} else {
+				req.headers.set(name, value);
+			}
+		}
+		if (method.empty() || path.empty()) valid = false;
+
+		if (!valid) {
+			auto id = stream.id;
+			send_rst(id, H2Error::ProtocolError);
+			streams_.erase(id);
+			return;
+		}
+
+		req.method = method_from_string(method);
+		req.path = std::string(path);
+		req.body = std::move(stream.body);
+		stream.headers.clear();
+		stream.headers.shrink_to_fit();
+
+		auto resp = handler_(req);
+		if (req.method == HttpMethod::Head) {
+			if (!resp.headers.has("Content-Length")) {
+				resp.headers.set("Content-Length", std::to_string(resp.body.size()));
+			}
+			resp.body.clear();
+		}
+		respond(stream, std::move(resp));
+	}
+
+	/**
+	 * @brief Frame response headers now and queue the body for flush_data()
+	 */
+	void respond(Stream& stream, HttpResponse resp) {
+		std::vector<HpackHeader> fields;
+		fields.reserve(resp.headers.size() + 2);
+		fields.push_back({":status", std::to_string(static_cast<uint16_t>(resp.status))});
+
+		bool has_length = false;
+		for (const auto& [key, value] : resp.headers.entries()) {
+			std::string name(key);
+			for (auto& c : name) {
+				if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + 32);
+			}
+			// Connection-specific fields are forbidden in HTTP/2
+			if (name == "connection" || name == "keep-alive" || name == "proxy-connection"
+				|| name == "transfer-encoding" || name == "upgrade") continue;
+			if (name == "content-length") has_length = true;
+			fields.push_back({std::move(name), value});
+		}
+		if (!has_length && !resp.body.empty()) {
+			fields.push_back({"content-length", std::to_string(resp.body.size())});
+		}
+
+		std::string block;
+		encoder_.encode(fields, block);
+
+		bool end_stream = resp.body.empty();
+		size_t max_frame = peer_.max_frame_size;
+		size_t offset = 0;
+		bool first = true;
+		do {
+			size_t n = std::min(max_frame, block.size() - offset);
+			bool last = offset + n == block.size();
+			uint8_t flags = last ? h2_flags::EndHeaders : 0;
+			if (first && end_stream) flags |= h2_flags::EndStream;
+			h2_write_frame(out_, first ? H2FrameType::Headers : H2FrameType::Continuation,
+				flags, stream.id, std::string_view(block).substr(offset, n));
+			offset += n;
+			first = false;
+		} while (offset < block.size());
+
+		stream.responded = true;
+		if (end_stream) {
+			finish_stream(stream.id);
+		} else {
+			stream.pending = std::move(resp.body);
+			stream.pending_offset = 0;
+		}
+	}
+
+	void finish_stream(uint32_t id) {
+		auto it = streams_.find(id);
+		if (it == streams_.end()) return;
+		if (it->second.reset_when_done) {
+			send_rst(id, H2Error::NoError);
+			reset_streams_.insert(id);
+		}
+		streams_.erase(it);
+		++completed_;
+		if (goaway_sent_ && streams_.empty()) closing_ = true;
+	}
+
+	/**
+	 * @brief Emit DATA frames round-robin across streams within the send windows
+	 */
+	void flush_data() {
+		bool progress = true;
+		while (progress && conn_send_window_ > 0) {
+			progress = false;
+			for (auto it = streams_.begin(); it != streams_.end() && conn_send_window_ > 0;) {
+				auto& s = it->second;
+				if (!s.responded || s.pending_offset >= s.pending.size() || s.send_window <= 0) {
+					++it;
+					continue;
+				}
+				size_t remaining = s.pending.size() - s.pending_offset;
+				size_t n = std::min<size_t>({remaining, peer_.max_frame_size,
+					static_cast<size_t>(s.send_window), static_cast<size_t>(conn_send_window_)});
+				bool last = n == remaining;
+				h2_write_frame(out_, H2FrameType::Data, last ? h2_flags::EndStream : 0, s.id,
+					std::string_view(s.pending).substr(s.pending_offset, n));
+				s.pending_offset += n;
+				s.send_window -= static_cast<int64_t>(n);
+				conn_send_window_ -= static_cast<int64_t>(n);
+				progress = true;
+
+				if (last) {
+					auto id = s.id;
+					++it;
+					finish_stream(id);
+				} else {
+					++it;
+				}
+			}
+		}
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
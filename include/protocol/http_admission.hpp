@@ -0,0 +1,102 @@
+/**
+ * @file http_admission.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Queue-delay based admission control (CoDel-style load shedding)
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief How readily a route's requests are shed under overload
+ */
+enum class RequestPriority : uint8_t {
+	Critical,  ///< Never shed (health checks, control endpoints)
+	Normal,    ///< Shed once queue delay exceeds the target while overloaded
+	Low,       ///< Shed outright while overloaded
+};
+
+/**
+ * @brief Tuning of an AdmissionController
+ */
+struct AdmissionOptions {
+	/// Queue delay the server should sit at; sustained delay above it means overload
+	std::chrono::milliseconds target{5};
+	/// Window over which the minimum delay is taken, and the delay cap when not overloaded
+	std::chrono::milliseconds interval{100};
+	/// Advertised in the Retry-After header of a shed request (rounded up to seconds)
+	std::chrono::milliseconds retry_after{1'000};
+	/// Priority of routes without an explicit one
+	RequestPriority default_priority = RequestPriority::Normal;
+};
+
+/**
+ * @brief Decides whether a request that waited `sojourn` is still worth serving
+ *
+ * Follows CoDel's observation that a good queue drains at least once per
+ * interval: if even the shortest queue delay seen over an interval stayed
+ * above target, the server is overloaded rather than bursting. While
+ * overloaded, Normal requests that waited longer than target and all Low
+ * requests are shed, so the queue drains back to target and the requests
+ * that are served still meet a deadline. Otherwise only requests that
+ * waited a whole interval are shed. Single-threaded, like the event loop
+ * that feeds it.
+ */
+class AdmissionController {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit AdmissionController(AdmissionOptions options = {}) noexcept : options_(options) {}
+
+	/**
+	 * @brief Record the queue delay of a request about to be dispatched
+	 * @return false if the request should be shed
+	 */
+	bool admit(Clock::duration sojourn, RequestPriority priority, Clock::time_point now = Clock::now()) noexcept {
+		observe(sojourn, now);
+		bool ok = priority == RequestPriority::Critical
+			|| (!overloaded_ ? sojourn <= options_.interval
+				: priority == RequestPriority::Normal && sojourn <= options_.target);
+		if (ok) ++admitted_;
+		else ++shed_;
+		return ok;
+	}
+
+	/// The last completed interval never drained to target
+	bool overloaded() const noexcept { return overloaded_; }
+
+	uint64_t admitted_count() const noexcept { return admitted_; }
+	uint64_t shed_count() const noexcept { return shed_; }
+
+	const AdmissionOptions& options() const noexcept { return options_; }
+
+private:
+	AdmissionOptions options_;
+	Clock::time_point interval_start_{};
+	Clock::duration min_delay_ = Clock::duration::max();
+	bool overloaded_ = false;
+	uint64_t admitted_ = 0;
+	uint64_t shed_ = 0;
+
+	void observe(Clock::duration sojourn, Clock::time_point now) noexcept {
+		if (interval_start_ == Clock::time_point{}) interval_start_ = now;
+		if (sojourn < min_delay_) min_delay_ = sojourn;
+		if (now - interval_start_ < options_.interval) return;
+		// An idle gap longer than an interval says nothing about load
+		overloaded_ = now - interval_start_ < 2 * options_.interval && min_delay_ > options_.target;
+		min_delay_ = Clock::duration::max();
+		interval_start_ = now;
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
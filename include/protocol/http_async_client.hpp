@@ -0,0 +1,467 @@
+/**
+ * @file http_async_client.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Non-blocking HTTP/1.1 client on async::EventLoop
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <expected>
+#include <chrono>
+#include <array>
+#include <algorithm>
+
+#include "url.hpp"
+#include "http.hpp"
+#include "../net/socket.hpp"
+#include "../net/socket_address.hpp"
+#include "../net/internet_protocol.hpp"
+#include "../net/dns_cache.hpp"
+#include "../async/event_loop.hpp"
+#include "../async/timer_wheel.hpp"
+#include "../core/error.hpp"
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief Limits of an AsyncHttpClient (per host unless noted)
+ */
+struct AsyncHttpClientOptions {
+	/// Connections open at once, busy plus idle; requests beyond this wait in line
+	size_t max_per_host = 64;
+	/// Kept-alive connections held between requests
+	size_t max_idle_per_host = 64;
+	/// Default deadline of a request, from send() to its last response byte (queueing included)
+	std::chrono::milliseconds timeout{30'000};
+	/// Idle connections older than this are closed instead of reused
+	std::chrono::milliseconds idle_timeout{30'000};
+	/// Responses with a larger body fail with ReceiveFailed
+	size_t max_response_body = 64 * 1024 * 1024;
+};
+
+using AsyncHttpResult = std::expected<HttpResponse, core::Error>;
+using AsyncHttpCallback = std::function<void(AsyncHttpResult)>;
+
+/**
+ * @brief HTTP/1.1 client driven by an EventLoop: many requests in flight on one thread
+ *
+ * Connects, sends and parses without blocking; each request completes by
+ * calling its callback on the loop thread with the response or an error
+ * (Timeout once its deadline passes, which the loop's timer wheel checks
+ * at tick granularity). Connections are kept alive and reused per host,
+ * at most max_per_host at a time; further requests queue in order. A
+ * request whose reused connection turns out closed is retried once on a
+ * new one if its method is idempotent. Host names other than literal
+ * addresses are resolved once per host, blocking. Plain HTTP only.
+ * Loop thread only; destroying the client drops outstanding requests
+ * without calling their callbacks.
+ */
+class AsyncHttpClient {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit AsyncHttpClient(async::EventLoop& loop, AsyncHttpClientOptions options = {})
+		: loop_(loop), options_(options) {}
+
+	~AsyncHttpClient() {
+		for (auto& [fd, exchange] : active_) loop_.remove(fd);
+		for (auto& [fd, host] : idle_fds_) loop_.remove(fd);
+	}
+
+	AsyncHttpClient(const AsyncHttpClient&) = delete;
+	AsyncHttpClient& operator=(const AsyncHttpClient&) = delete;
+
+	void get(const Url& url, AsyncHttpCallback callback) {
+		send(url, request_for(HttpMethod::Get, url), std::move(callback));
+	}
+
+	void post(const Url& url, std::string body, std::string_view content_type, AsyncHttpCallback callback) {
+		auto req = request_for(HttpMethod::Post, url);
+		req.headers.set("Content-Type", std::string(content_type));
+		req.headers.set("Content-Length", std::to_string(body.size()));
+		req.body = std::move(body);
+		send(url, req, std::move(callback));
+	}
+
+	void send(const Url& url, const HttpRequest& req, AsyncHttpCallback callback) {
+		send(url, req, std::move(callback), options_.timeout);
+	}
+
+	/**
+	 * @brief Queue a request; callback runs on the loop thread, never from inside send()
+	 */
+	void send(const Url& url, const HttpRequest& req, AsyncHttpCallback callback, std::chrono::milliseconds timeout) {
+		auto id = next_id_++;
+		auto ex = std::make_unique<Exchange>();
+		auto* raw = ex.get();
+		raw->id = id;
+		raw->out = req.serialize();
+		raw->head_request = req.method == HttpMethod::Head;
+		raw->idempotent = idempotent(req.method);
+		raw->callback = std::move(callback);
+		raw->deadline.callback = [this, raw] { expire(*raw); };
+		exchanges_.emplace(id, std::move(ex));
+		loop_.timers().schedule(raw->deadline, timeout);
+
+		if (url.scheme != "http") {
+			defer_failure(id, core::Error::FeatureNotSupported);
+			return;
+		}
+		auto& host = host_for(url);
+		if (!host.resolved) {
+			defer_failure(id, core::Error::InvalidAddress);
+			return;
+		}
+		raw->host = &host;
+		host.waiting.push_back(raw);
+		raw->queued = true;
+		pump(host);
+	}
+
+	/// Requests sent and not yet completed
+	size_t in_flight() const noexcept { return exchanges_.size(); }
+
+	/// Requests waiting for a connection slot
+	size_t queued() const noexcept {
+		size_t n = 0;
+		for (const auto& [key, host] : hosts_) n += host->waiting.size();
+		return n;
+	}
+
+	size_t idle_count() const noexcept { return idle_fds_.size(); }
+
+	/// Connections opened so far
+	uint64_t connect_count() const noexcept { return connected_; }
+	/// Requests sent over an idle connection instead of a new one
+	uint64_t reuse_count() const noexcept { return reused_; }
+	/// Requests failed by their deadline
+	uint64_t timeout_count() const noexcept { return timed_out_; }
+
+	const AsyncHttpClientOptions& options() const noexcept { return options_; }
+
+private:
+	struct Host;
+
+	struct Connection {
+		net::Socket<net::Ip<4>> socket;
+		Host* host = nullptr;
+		bool connecting = false;
+		bool reused = false;
+		Clock::time_point idle_since;
+	};
+
+	struct Exchange {
+		uint64_t id = 0;
+		Host* host = nullptr;
+		std::string out;
+		size_t sent = 0;
+		http_parser::ResponseParser parser;
+		std::unique_ptr<Connection> conn;
+		AsyncHttpCallback callback;
+		async::Timer deadline;
+		bool head_request = false;
+		bool idempotent = false;
+		bool queued = false;
+		bool retried = false;
+		bool received = false;   // Any response byte arrived on the current connection
+	};
+
+	struct Host {
+		net::SocketAddress<net::Ip<4>> address;
+		bool resolved = false;
+		size_t open = 0;   // Busy, connecting or idle
+		std::vector<std::unique_ptr<Connection>> idle;   // Most recently used at the back
+		std::deque<Exchange*> waiting;
+	};
+
+	static constexpr size_t READ_CHUNK = 64 * 1024;
+
+	async::EventLoop& loop_;
+	AsyncHttpClientOptions options_;
+	std::map<std::pair<std::string, uint16_t>, std::unique_ptr<Host>> hosts_;
+	std::unordered_map<uint64_t, std::unique_ptr<Exchange>> exchanges_;
+	std::unordered_map<net::impl::socket_t, Exchange*> active_;   // Connection fd → its exchange
+	std::unordered_map<net::impl::socket_t, Host*> idle_fds_;
+	uint64_t next_id_ = 1;
+	uint64_t connected_ = 0;
+	uint64_t reused_ = 0;
+	uint64_t timed_out_ = 0;
+
+	static bool idempotent(HttpMethod method) noexcept {
+		return method == HttpMethod::Get || method == HttpMethod::Head || method == HttpMethod::Put
+			|| method == HttpMethod::Delete || method == HttpMethod::Options;
+	}
+
+	static HttpRequest request_for(HttpMethod method, const Url& url) {
+		HttpRequest req;
+		req.method = method;
+		req.path = url.path.empty() ? "/" : url.path;
+		if (!url.query.empty()) req.path += "?" + url.query;
+		req.headers.set("Host", url.host);
+		req.headers.set("User-Agent", "Etherz/1.0.0");
+		return req;
+	}
+
+	Host& host_for(const Url& url) {
+		auto& slot = hosts_[{url.host, url.port}];
+		if (slot) return *slot;
+		slot = std::make_unique<Host>();
+		auto ip = net::DnsCache::shared()->resolve_ipv4(url.host);
+		slot->address = net::SocketAddress<net::Ip<4>>(ip.value_or(net::Ip<4>{}), url.port);
+		slot->resolved = ip.has_value();
+		return *slot;
+	}
+
+	// ─── Scheduling ────────────────
+
+	/**
+	 * @brief Start waiting requests on idle connections, or new ones while under max_per_host
+	 */
+	void pump(Host& host) {
+		while (!host.waiting.empty()) {
+			auto conn = take_idle(host);
+			if (!conn) {
+				if (host.open >= options_.max_per_host) return;
+				auto* ex = host.waiting.front();
+				conn = connect(host);
+				if (!conn) {
+					host.waiting.pop_front();
+					ex->queued = false;
+					defer_failure(ex->id, core::Error::ConnectFailed);
+					continue;
+				}
+			}
+			auto* ex = host.waiting.front();
+			host.waiting.pop_front();
+			ex->queued = false;
+			start(*ex, std::move(conn));
+		}
+	}
+
+	std::unique_ptr<Connection> take_idle(Host& host) {
+		auto now = Clock::now();
+		while (!host.idle.empty()) {
+			auto conn = std::move(host.idle.back());
+			host.idle.pop_back();
+			idle_fds_.erase(conn->socket.native_handle());
+			if (now - conn->idle_since > options_.idle_timeout) {
+				close(std::move(conn));
+				continue;
+			}
+			// Still registered with the idle callback; start() replaces it
+			conn->reused = true;
+			++reused_;
+			return conn;
+		}
+		return nullptr;
+	}
+
+	std::unique_ptr<Connection> connect(Host& host) {
+		auto conn = std::make_unique<Connection>();
+		conn->host = &host;
+		if (core::is_error(conn->socket.create())) return nullptr;
+		if (core::is_error(conn->socket.set_nonblocking(true))) return nullptr;
+		conn->socket.set_no_delay(true);
+		auto err = conn->socket.connect(host.address);
+		if (core::is_error(err) && err != core::Error::WouldBlock) return nullptr;
+		// A non-blocking connect is writable once established
+		conn->connecting = true;
+		++host.open;
+		++connected_;
+		return conn;
+	}
+
+	void close(std::unique_ptr<Connection> conn) noexcept {
+		loop_.remove(conn->socket.native_handle());
+		--conn->host->open;
+	}
+
+	/**
+	 * @brief Keep a connection whose exchange ended cleanly
+	 */
+	void release(std::unique_ptr<Connection> conn) {
+		auto& host = *conn->host;
+		if (host.idle.size() >= options_.max_idle_per_host) {
+			close(std::move(conn));
+			return;
+		}
+		auto fd = conn->socket.native_handle();
+		conn->idle_since = Clock::now();
+		conn->reused = false;
+		loop_.add(fd, async::PollEvent::ReadReady,
+			[this](net::impl::socket_t ready, async::PollEvent events) { on_event(ready, events); });
+		idle_fds_[fd] = &host;
+		host.idle.push_back(std::move(conn));
+	}
+
+	/// An idle connection spoke or hung up, so it cannot carry another request
+	void drop_idle(net::impl::socket_t fd, Host& host) {
+		idle_fds_.erase(fd);
+		auto it = std::find_if(host.idle.begin(), host.idle.end(),
+			[fd](const auto& c) { return c->socket.native_handle() == fd; });
+		if (it == host.idle.end()) return;
+		auto conn = std::move(*it);
+		host.idle.erase(it);
+		close(std::move(conn));
+		pump(host);
+	}
+
+	// ─── Exchange ────────────────
+
+	void start(Exchange& ex, std::unique_ptr<Connection> conn) {
+		ex.conn = std::move(conn);
+		ex.sent = 0;
+		ex.received = false;
+		ex.parser = http_parser::ResponseParser(ex.head_request);
+		ex.parser.set_body_limit(options_.max_response_body);
+		auto fd = ex.conn->socket.native_handle();
+		active_[fd] = &ex;
+		watch(ex);
+		if (!ex.conn->connecting) flush(ex);
+	}
+
+	void watch(Exchange& ex) {
+		auto interest = ex.conn->connecting || ex.sent < ex.out.size()
+			? async::PollEvent::WriteReady | async::PollEvent::ReadReady : async::PollEvent::ReadReady;
+		loop_.add(ex.conn->socket.native_handle(), interest,
+			[this](net::impl::socket_t ready, async::PollEvent events) { on_event(ready, events); });
+	}
+
+	void on_event(net::impl::socket_t fd, async::PollEvent events) {
+		// Callbacks from one poll are snapshotted: the fd may since have changed hands
+		if (auto it = active_.find(fd); it != active_.end()) {
+			auto& ex = *it->second;
+			if (ex.conn->connecting || has_event(events, async::PollEvent::WriteReady)) {
+				bool was_connecting = ex.conn->connecting;
+				ex.conn->connecting = false;
+				if (was_connecting && has_event(events, async::PollEvent::Error)) {
+					connection_failed(ex, core::Error::ConnectFailed);
+					return;
+				}
+				if (!flush(ex)) return;
+			}
+			if (has_event(events, async::PollEvent::ReadReady) || has_event(events, async::PollEvent::HangUp)
+				|| has_event(events, async::PollEvent::Error)) {
+				read(ex);
+			}
+			return;
+		}
+		if (auto it = idle_fds_.find(fd); it != idle_fds_.end()) drop_idle(fd, *it->second);
+	}
+
+	/// @return false if the exchange ended
+	bool flush(Exchange& ex) {
+		bool pending = ex.sent < ex.out.size();
+		while (ex.sent < ex.out.size()) {
+			auto data = std::string_view(ex.out).substr(ex.sent);
+			int n = ex.conn->socket.send(std::span<const uint8_t>(
+				reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+			if (n > 0) {
+				ex.sent += static_cast<size_t>(n);
+				continue;
+			}
+			if (n < 0 && core::last_platform_error() == core::Error::WouldBlock) break;
+			connection_failed(ex, core::Error::SendFailed);
+			return false;
+		}
+		if (pending && ex.sent == ex.out.size()) watch(ex); // Only reads from here on
+		return true;
+	}
+
+	void read(Exchange& ex) {
+		std::array<uint8_t, READ_CHUNK> buf;
+		while (true) {
+			int n = ex.conn->socket.recv(buf);
+			if (n > 0) {
+				ex.received = true;
+				auto data = std::string_view(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				auto used = ex.parser.feed(data);
+				if (ex.parser.failed()) {
+					complete(ex, std::unexpected(core::Error::ReceiveFailed), false);
+					return;
+				}
+				if (ex.parser.done()) {
+					// Bytes past the end of the response: the connection is out of step
+					bool reusable = ex.parser.keep_alive() && used == data.size() && ex.sent == ex.out.size();
+					complete(ex, std::move(ex.parser.response()), reusable);
+					return;
+				}
+				continue;
+			}
+			if (n < 0 && core::last_platform_error() == core::Error::WouldBlock) return;
+			if (n == 0) {
+				ex.parser.finish();
+				if (ex.parser.done()) {
+					complete(ex, std::move(ex.parser.response()), false);
+					return;
+				}
+			}
+			connection_failed(ex, core::Error::ReceiveFailed);
+			return;
+		}
+	}
+
+	void connection_failed(Exchange& ex, core::Error error) {
+		if (ex.conn->reused && !ex.received && !ex.retried && ex.idempotent) {
+			// Most likely closed by the server while idle: one retry on a new connection
+			ex.retried = true;
+			auto& host = *ex.conn->host;
+			active_.erase(ex.conn->socket.native_handle());
+			close(std::move(ex.conn));
+			if (auto conn = connect(host)) {
+				start(ex, std::move(conn));
+				return;
+			}
+			complete(ex, std::unexpected(core::Error::ConnectFailed), false);
+			return;
+		}
+		complete(ex, std::unexpected(error), false);
+	}
+
+	void expire(Exchange& ex) {
+		++timed_out_;
+		complete(ex, std::unexpected(core::Error::Timeout), false);
+	}
+
+	/**
+	 * @brief Fail a request from the loop rather than inside send()
+	 */
+	void defer_failure(uint64_t id, core::Error error) {
+		loop_.post([this, id, error] {
+			auto it = exchanges_.find(id);
+			if (it != exchanges_.end()) complete(*it->second, std::unexpected(error), false);
+		});
+	}
+
+	void complete(Exchange& ex, AsyncHttpResult result, bool reusable) {
+		loop_.timers().cancel(ex.deadline);
+		auto* host = ex.host;
+		if (ex.queued) std::erase(host->waiting, &ex);
+		if (ex.conn) {
+			active_.erase(ex.conn->socket.native_handle());
+			if (reusable) release(std::move(ex.conn));
+			else close(std::move(ex.conn));
+		}
+		auto callback = std::move(ex.callback);
+		exchanges_.erase(ex.id);
+		if (host) pump(*host);
+		if (callback) callback(std::move(result));
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
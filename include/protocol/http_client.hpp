@@ -16,38 +16,187 @@
 #include <vector>
 #include <print>
 #include <expected>
+#include <memory>
+#include <array>
+#include <optional>
+#include <span>
+#include <functional>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <format>
+#include <thread>
+#include <atomic>
 
 #include "url.hpp"
 #include "http.hpp"
+#include "http_coalescer.hpp"
+#include "http_client_cache.hpp"
 #include "../net/socket.hpp"
 #include "../net/socket_address.hpp"
 #include "../net/internet_protocol.hpp"
 #include "../security/tls_socket.hpp"
-#include "../net/dns.hpp"
+#include "../net/dns_cache.hpp"
+#include "../net/load_balancer.hpp"
+#include "../net/connection_pool.hpp"
+#include "../async/poll.hpp"
 #include "../core/error.hpp"
 
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
 namespace etherz {
 namespace protocol {
 
+/**
+ * @brief When HttpClient sends a backup copy of a slow request, and how many it may send
+ */
+struct HedgingOptions {
+	/// Off unless set_hedging() turns it on
+	bool enabled = false;
+	/// Hedge once a request has waited longer than this percentile of the host's recent latencies
+	double percentile = 0.95;
+	/// Hedge delay until min_samples latencies are known for the host
+	std::chrono::milliseconds initial_delay{50};
+	/// Shortest hedge delay, so a fast host is not hedged on noise
+	std::chrono::milliseconds min_delay{1};
+	size_t min_samples = 20;
+	/// Latencies kept per host
+	size_t window = 256;
+	/// Hedges earned per request sent: extra load stays under this fraction of traffic
+	double budget_ratio = 0.1;
+	/// Hedges that can be saved up while the host is healthy
+	double budget_burst = 10;
+};
+
+/**
+ * @brief How HttpClient spreads requests over the addresses a host resolves to
+ */
+struct LoadBalancingOptions {
+	/// false sends everything to the first address
+	bool enabled = true;
+	net::BalancePolicy policy = net::BalancePolicy::RoundRobin;
+	/// Maglev key: this request header's value, or the path when it is empty or absent
+	std::string key_header;
+	net::LoadBalancerOptions balancer;
+};
+
+/**
+ * @brief How HttpClient::download_ranges() splits a download
+ */
+struct RangedDownloadOptions {
+	/// Range requests in flight at once, each on its own connection
+	size_t connections = 4;
+	/// Bytes per Range request; connections take the next part as they finish one (0: one stream)
+	uint64_t part_size = 8ull << 20;
+	/// Requests per part (resuming where the last one stopped) before the download fails
+	int max_attempts = 3;
+	/// Checks the finished file given its descriptor and size; false fails the download
+	std::function<bool(int fd, uint64_t size)> verify;
+};
+
 /**
  * @brief Simple synchronous HTTP/1.1 client with HTTPS support
  * 
- * Uses Socket<Ip<4>> for HTTP, TlsSocket<Ip<4>> for HTTPS.
+ * Uses Socket<Ip<4>> for HTTP, TlsSocket<Ip<4>> for HTTPS. Host names
+ * are resolved through a net::DnsCache. Plain HTTP connections are kept
+ * alive in a net::ConnectionPool, keyed by the address they connect to,
+ * and reused by later requests there, which saves the connect on every
+ * call after the first. Responses are read by their framing
+ * (Content-Length, chunked or close), so a connection goes back to the
+ * pool as soon as its response is complete. A request that finds its
+ * pooled connection closed by the server is retried once on a new one if
+ * its method is idempotent.
+ *
+ * With hedging on (set_hedging()), an idempotent pooled request that has
+ * had no answer after the host's recent pN latency is sent again to
+ * another address the host resolves to (or on another connection when it
+ * has only one). The primary goes where the load balancer sends it and
+ * the backup to the least loaded other address. Whichever connection
+ * starts answering first wins; the other is closed, which cancels it.
+ * Hedges draw on a token budget refilled by budget_ratio per request, so
+ * they cannot multiply load on a host that is slow across the board.
+ *
+ * A host that resolves to several addresses gets a net::LoadBalancer, so
+ * requests are spread over all of them (round-robin unless changed with
+ * set_load_balancing()) rather than all going to the first.
+ *
+ * With a cache set (set_cache()), GETs are answered from it while fresh,
+ * stale entries are revalidated with If-None-Match / If-Modified-Since,
+ * and a successful unsafe request drops what is stored for its URL.
  */
 class HttpClient {
 public:
+	/// Pools its own connections
+	HttpClient() : pool_(std::make_shared<net::ConnectionPool>()) {}
+
+	/**
+	 * @brief Use a pool shared with other clients; nullptr opens and closes a connection per request
+	 */
+	explicit HttpClient(std::shared_ptr<net::ConnectionPool> pool) noexcept : pool_(std::move(pool)) {}
+
+	/// Connection pool in use (nullptr: no reuse)
+	const std::shared_ptr<net::ConnectionPool>& pool() const noexcept { return pool_; }
+
+	/**
+	 * @brief Cache for this client's host lookups (net::DnsCache::shared() by default); nullptr resolves every time
+	 */
+	void set_dns_cache(std::shared_ptr<net::DnsCache> cache) noexcept { dns_ = std::move(cache); }
+	const std::shared_ptr<net::DnsCache>& dns_cache() const noexcept { return dns_; }
+
+	/**
+	 * @brief Choose how requests spread over a host's addresses; forgets the per-host balancers
+	 *
+	 * Hedged requests follow it too: the primary goes where the policy
+	 * picks, and the backup goes to the least loaded of the others.
+	 */
+	void set_load_balancing(LoadBalancingOptions options) {
+		balancing_ = std::make_shared<BalancingState>(std::move(options));
+	}
+	const LoadBalancingOptions& load_balancing() const noexcept { return balancing_->options; }
+
+	/// Balancer in use for url's host (nullptr until a request finds it has several addresses)
+	std::shared_ptr<net::LoadBalancer> load_balancer(const Url& url) const {
+		std::lock_guard lock(balancing_->mutex);
+		auto it = balancing_->hosts.find(host_key(url));
+		return it == balancing_->hosts.end() ? nullptr : it->second.balancer;
+	}
+
+	/**
+	 * @brief Turn hedging of idempotent pooled requests on or off; resets the latency history and budget
+	 *
+	 * Both copies of a hedged request are counted by the host's load
+	 * balancer (set_load_balancing()) for as long as they are out.
+	 */
+	void set_hedging(HedgingOptions options) {
+		hedge_ = options.enabled ? std::make_shared<HedgeState>(options) : nullptr;
+	}
+
+	/// Backup requests sent
+	uint64_t hedge_count() const { return hedge_ ? hedge_->read(&HedgeState::hedges) : 0; }
+	/// Requests answered first by their backup
+	uint64_t hedge_win_count() const { return hedge_ ? hedge_->read(&HedgeState::wins) : 0; }
+	/// Hedges skipped because the budget was spent
+	uint64_t hedge_denied_count() const { return hedge_ ? hedge_->read(&HedgeState::denied) : 0; }
+
+	/// Current hedge delay for url's host (zero with hedging off)
+	std::chrono::milliseconds hedge_delay(const Url& url) const {
+		if (!hedge_) return {};
+		std::lock_guard lock(hedge_->mutex);
+		return hedge_->delay_for(host_key(url));
+	}
+
 	/**
 	 * @brief Perform a GET request (auto-detects HTTP/HTTPS)
 	 */
 	std::expected<HttpResponse, core::Error> get(const Url& url) {
-		HttpRequest req;
-		req.method = HttpMethod::Get;
-		req.path = url.path.empty() ? "/" : url.path;
-		if (!url.query.empty()) req.path += "?" + url.query;
-		req.headers.set("Host", url.host);
-		req.headers.set("Connection", "close");
-		req.headers.set("User-Agent", "Etherz/1.0.0");
-		return send_request(url, req);
+		return send_request(url, get_request(url));
 	}
 
 	/**
@@ -58,7 +207,7 @@ public:
 		req.method = HttpMethod::Post;
 		req.path = url.path.empty() ? "/" : url.path;
 		req.headers.set("Host", url.host);
-		req.headers.set("Connection", "close");
+		if (!reuses_connections(url)) req.headers.set("Connection", "close");
 		req.headers.set("User-Agent", "Etherz/0.5.0");
 		req.headers.set("Content-Type", std::string(content_type));
 		req.headers.set("Content-Length", std::to_string(body.size()));
@@ -72,12 +221,250 @@ public:
 	 * Automatically uses TLS for https:// URLs.
 	 */
 	std::expected<HttpResponse, core::Error> send_request(const Url& url, const HttpRequest& req) {
+		if (cache_ && req.method == HttpMethod::Get) {
+			auto res = send_cached(url, req, false);
+			if (!res) return std::unexpected(res.error());
+			return **res;
+		}
+		auto res = send_uncached(url, req);
+		if (cache_ && res && !safe(req.method) && static_cast<uint16_t>(res->status) < 400) {
+			cache_->invalidate(url, req);
+		}
+		return res;
+	}
+
+	/**
+	 * @brief Answer GETs from cache where RFC 9111 allows; nullptr turns caching off
+	 *
+	 * Share one cache between clients to share their entries. send_shared()
+	 * hands out the stored response object itself on a hit; send_request()
+	 * and get() return a copy of it.
+	 */
+	void set_cache(std::shared_ptr<HttpClientCache> cache) noexcept { cache_ = std::move(cache); }
+	const std::shared_ptr<HttpClientCache>& cache() const noexcept { return cache_; }
+
+	/**
+	 * @brief Coalesce identical concurrent requests made with send_shared() / get_shared(); nullptr turns it off
+	 *
+	 * Share one coalescer between the clients of several threads to merge
+	 * their requests too.
+	 */
+	void set_coalescer(std::shared_ptr<RequestCoalescer> coalescer) noexcept { coalescer_ = std::move(coalescer); }
+	const std::shared_ptr<RequestCoalescer>& coalescer() const noexcept { return coalescer_; }
+
+	/**
+	 * @brief send_request(), with the response held by a shared pointer
+	 *
+	 * With a coalescer set, a GET or HEAD identical (by the coalescer's key)
+	 * to one already in flight waits for that one and gets the same
+	 * response object instead of sending its own.
+	 */
+	SharedHttpResult send_shared(const Url& url, const HttpRequest& req) {
+		if (cache_ && req.method == HttpMethod::Get) return send_cached(url, req, true);
+		if (!cache_ || safe(req.method)) return send_coalesced(url, req);
+		auto res = send_coalesced(url, req);
+		if (res && static_cast<uint16_t>((*res)->status) < 400) cache_->invalidate(url, req);
+		return res;
+	}
+
+	SharedHttpResult get_shared(const Url& url) {
+		return send_shared(url, get_request(url));
+	}
+
+	/**
+	 * @brief Callbacks that take a response as it arrives instead of collecting it
+	 */
+	struct StreamHandler {
+		/// The status line and fields, before any body; false skips the body
+		std::function<bool(const HttpResponse&)> on_head;
+		/// The next piece of body (chunked framing already removed); false stops the transfer
+		std::function<bool(std::string_view)> on_body;
+	};
+
+	/**
+	 * @brief Send a request and stream the response body to handler
+	 *
+	 * Memory stays at one receive buffer however large the body is. If a
+	 * callback stops the transfer, the connection is closed rather than
+	 * reused and the head is still returned.
+	 * @return The response head (body empty)
+	 */
+	std::expected<HttpResponse, core::Error> stream(const Url& url, const HttpRequest& req, const StreamHandler& handler) {
+		if (url.scheme == "https") {
+			return send_secure(url, req, &handler);
+		}
+		return send_plain(url, req, &handler);
+	}
+
+	std::expected<HttpResponse, core::Error> get_stream(const Url& url, const StreamHandler& handler) {
+		return stream(url, get_request(url), handler);
+	}
+
+	/**
+	 * @brief GET url and write a 2xx response body straight to fd
+	 *
+	 * Other statuses return their head without writing anything.
+	 * @return The response head, or SendFailed if fd would not take the data
+	 */
+	std::expected<HttpResponse, core::Error> download(const Url& url, int fd) {
+		bool write_failed = false;
+		StreamHandler handler;
+		handler.on_head = [](const HttpResponse& head) { return static_cast<uint16_t>(head.status) / 100 == 2; };
+		handler.on_body = [fd, &write_failed](std::string_view data) {
+			while (!data.empty()) {
+#ifdef _WIN32
+				auto n = ::_write(fd, data.data(), static_cast<unsigned>(data.size()));
+#else
+				auto n = ::write(fd, data.data(), data.size());
+				if (n < 0 && errno == EINTR) continue;
+#endif
+				if (n <= 0) {
+					write_failed = true;
+					return false;
+				}
+				data.remove_prefix(static_cast<size_t>(n));
+			}
+			return true;
+		};
+		auto head = get_stream(url, handler);
+		if (head && write_failed) return std::unexpected(core::Error::SendFailed);
+		return head;
+	}
+
+	/**
+	 * @brief GET url over several connections at once, each part written at its offset in fd
+	 *
+	 * A HEAD request finds the size. If the server takes byte ranges
+	 * (Accept-Ranges: bytes) and the object is bigger than one part, it is
+	 * split into part_size Range requests spread over up to connections
+	 * connections; otherwise it comes in one stream. Either way bytes go to
+	 * their absolute offset with pwrite(), so fd should be a regular file.
+	 * A part that fails or is cut short is requested again from where it
+	 * stopped, up to max_attempts times.
+	 * @return The HEAD response (a non-2xx one without downloading); SendFailed if fd would not take the
+	 *         data, ReceiveFailed if a part ran out of attempts or verify() rejected the file
+	 */
+	std::expected<HttpResponse, core::Error> download_ranges(const Url& url, int fd, const RangedDownloadOptions& options = {}) {
+		auto probe = get_request(url);
+		probe.method = HttpMethod::Head;
+		auto head = send_request(url, probe);
+		if (!head || static_cast<uint16_t>(head->status) / 100 != 2) return head;
+
+		uint64_t size = 0;
+		auto length = head->headers.get("Content-Length");
+		bool sized = !length.empty() && std::from_chars(length.data(), length.data() + length.size(), size).ec == std::errc{};
+		bool ranges = sized && accepts_byte_ranges(head->headers.get("Accept-Ranges"));
+		if (!ranges || options.part_size == 0 || size <= options.part_size || options.connections < 2) {
+			uint64_t written = 0;
+			bool write_failed = false;
+			StreamHandler handler;
+			handler.on_head = [](const HttpResponse& resp) { return static_cast<uint16_t>(resp.status) / 100 == 2; };
+			handler.on_body = [&](std::string_view data) {
+				if (!write_at(fd, data, written)) {
+					write_failed = true;
+					return false;
+				}
+				written += data.size();
+				return true;
+			};
+			auto whole = get_stream(url, handler);
+			if (!whole) return std::unexpected(whole.error());
+			if (write_failed) return std::unexpected(core::Error::SendFailed);
+			if (static_cast<uint16_t>(whole->status) / 100 != 2 || (sized && written != size)) {
+				return std::unexpected(core::Error::ReceiveFailed);
+			}
+			if (options.verify && !options.verify(fd, written)) return std::unexpected(core::Error::ReceiveFailed);
+			return head;
+		}
+
+		auto parts = (size + options.part_size - 1) / options.part_size;
+		std::atomic<uint64_t> next{0};
+		std::atomic<bool> failed{false};
+		std::atomic<core::Error> error{core::Error::ReceiveFailed};
+		auto worker = [&] {
+			while (!failed.load(std::memory_order_relaxed)) {
+				auto part = next.fetch_add(1);
+				if (part >= parts) return;
+				auto begin = part * options.part_size;
+				auto end = std::min(size, begin + options.part_size); // Exclusive
+				if (auto err = fetch_range(url, fd, begin, end, options.max_attempts); err != core::Error::None) {
+					error = err;
+					failed = true;
+				}
+			}
+		};
+		// No more threads than parts, and the calling thread is one of them
+		auto count = static_cast<size_t>(std::min<uint64_t>(options.connections, parts));
+		std::vector<std::thread> threads;
+		threads.reserve(count - 1);
+		for (size_t i = 1; i < count; ++i) threads.emplace_back(worker);
+		worker();
+		for (auto& t : threads) t.join();
+		if (failed) return std::unexpected(error.load());
+		if (options.verify && !options.verify(fd, size)) return std::unexpected(core::Error::ReceiveFailed);
+		return head;
+	}
+
+	/**
+	 * @brief Send requests to url's host pipelined: written back to back, responses read in order
+	 *
+	 * Costs about one round trip for the whole batch instead of one per
+	 * request. Requests go out in writes of up to PIPELINE_WINDOW bytes,
+	 * each window's responses read before the next is written. If the
+	 * connection closes or falls out of step before every response is in,
+	 * the unanswered idempotent requests are sent again on another
+	 * connection; unanswered non-idempotent ones fail with ReceiveFailed,
+	 * since the server may have acted on them. HTTPS requests are sent one
+	 * at a time.
+	 * @return One result per request, in request order
+	 */
+	std::vector<std::expected<HttpResponse, core::Error>> send_batch(const Url& url, std::span<const HttpRequest> requests) {
+		std::vector<std::expected<HttpResponse, core::Error>> results(requests.size(), std::unexpected(core::Error::ReceiveFailed));
 		if (url.scheme == "https") {
-			return send_secure(url, req);
+			for (size_t i = 0; i < requests.size(); ++i) results[i] = send_secure(url, requests[i], nullptr);
+			return results;
 		}
-		return send_plain(url, req);
+		std::vector<size_t> pending(requests.size());
+		for (size_t i = 0; i < pending.size(); ++i) pending[i] = i;
+		bool fresh = false;
+		while (!pending.empty()) {
+			auto answered = pipeline(url, requests, pending, results, fresh);
+			if (!answered) {
+				for (auto i : pending) results[i] = std::unexpected(answered.error());
+				break;
+			}
+			// Nothing answered even on a new connection: the rest stay failed
+			if (*answered == 0 && fresh) break;
+			std::vector<size_t> retry;
+			for (size_t k = *answered; k < pending.size(); ++k) {
+				if (idempotent(requests[pending[k]].method)) retry.push_back(pending[k]);
+			}
+			fresh = *answered == 0;
+			pending = std::move(retry);
+		}
+		return results;
 	}
 
+	/**
+	 * @brief GET each of paths (path plus query) from url's host, pipelined
+	 */
+	std::vector<std::expected<HttpResponse, core::Error>> get_batch(const Url& url, std::span<const std::string> paths) {
+		std::vector<HttpRequest> requests(paths.size());
+		for (size_t i = 0; i < paths.size(); ++i) {
+			auto& req = requests[i];
+			req.method = HttpMethod::Get;
+			req.path = paths[i].empty() ? "/" : paths[i];
+			req.headers.set("Host", url.host);
+			// Without a pool only the last response may end the connection
+			if (!reuses_connections(url) && i + 1 == paths.size()) req.headers.set("Connection", "close");
+			req.headers.set("User-Agent", "Etherz/1.0.0");
+		}
+		return send_batch(url, requests);
+	}
+
+	/// Request bytes written before the responses to them are read
+	static constexpr size_t PIPELINE_WINDOW = 64 * 1024;
+
 	/**
 	 * @brief Check if HTTPS is supported
 	 */
@@ -90,58 +477,558 @@ public:
 	}
 
 private:
+	std::shared_ptr<net::ConnectionPool> pool_;
+	std::shared_ptr<net::DnsCache> dns_ = net::DnsCache::shared();
+	std::shared_ptr<RequestCoalescer> coalescer_;
+	std::shared_ptr<HttpClientCache> cache_;
+
 	/**
-	 * @brief Resolve host to IPv4 via DNS
+	 * @brief Latency history and budget behind hedging; shared by copies of a client
 	 */
-	static net::Ip<4> resolve_host(const Url& url) noexcept {
-		if (url.host == "localhost" || url.host == "127.0.0.1") {
-			return net::Ip<4>(127, 0, 0, 1);
+	struct HedgeState {
+		struct Window {
+			std::vector<std::chrono::microseconds> samples;
+			size_t next = 0; // Slot the next sample overwrites once the window is full
+		};
+
+		std::mutex mutex;
+		HedgingOptions options;
+		std::map<std::string, Window, std::less<>> hosts;
+		double tokens;
+		uint64_t hedges = 0;
+		uint64_t wins = 0;
+		uint64_t denied = 0;
+
+		explicit HedgeState(HedgingOptions o) : options(o), tokens(o.budget_burst) {}
+
+		uint64_t read(uint64_t HedgeState::*counter) {
+			std::lock_guard lock(mutex);
+			return this->*counter;
 		}
 
-		// Try DNS resolution first (handles hostnames like "example.com")
-		auto dns_result = net::Dns::resolve(url.host);
-		if (dns_result.success && !dns_result.ipv4_addresses.empty()) {
-			return dns_result.ipv4_addresses[0];
+		/// mutex held
+		std::chrono::milliseconds delay_for(std::string_view host) {
+			auto it = hosts.find(host);
+			if (it == hosts.end() || it->second.samples.size() < options.min_samples) return options.initial_delay;
+			auto sorted = it->second.samples;
+			auto idx = static_cast<size_t>(options.percentile * static_cast<double>(sorted.size() - 1));
+			std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(idx), sorted.end());
+			auto delay = std::chrono::ceil<std::chrono::milliseconds>(sorted[idx]);
+			return std::max(delay, options.min_delay);
 		}
 
-		// Fallback: try parsing as a raw IP string
-		return net::Ip<4>{url.host};
+		/// Add a request's budget share; mutex held
+		void deposit() {
+			tokens = std::min(options.budget_burst, tokens + options.budget_ratio);
+		}
+
+		/// Spend one hedge from the budget; mutex held
+		bool withdraw() {
+			if (tokens < 1.0) {
+				++denied;
+				return false;
+			}
+			tokens -= 1.0;
+			++hedges;
+			return true;
+		}
+
+		/// mutex held
+		void record(std::string_view host, std::chrono::microseconds latency) {
+			auto it = hosts.find(host);
+			if (it == hosts.end()) it = hosts.emplace(std::string(host), Window{}).first;
+			auto& window = it->second;
+			if (window.samples.size() < options.window) {
+				window.samples.push_back(latency);
+			} else {
+				window.samples[window.next] = latency;
+				window.next = (window.next + 1) % window.samples.size();
+			}
+		}
+	};
+	std::shared_ptr<HedgeState> hedge_;
+
+	/**
+	 * @brief A balancer per multi-address host; shared by copies of a client
+	 */
+	struct BalancingState {
+		struct Host {
+			std::vector<net::Ip<4>> addresses; // Sorted; the set the balancer was built from
+			std::shared_ptr<net::LoadBalancer> balancer;
+		};
+
+		std::mutex mutex;
+		const LoadBalancingOptions options;
+		std::map<std::string, Host, std::less<>> hosts;
+
+		explicit BalancingState(LoadBalancingOptions o) : options(std::move(o)) {}
+	};
+	std::shared_ptr<BalancingState> balancing_ = std::make_shared<BalancingState>(LoadBalancingOptions{});
+
+	/// Address a request goes to, counted as outstanding on its balancer until the target is dropped
+	struct Target {
+		net::SocketAddress<net::Ip<4>> address;
+		net::LoadBalancer::Lease lease;
+		std::shared_ptr<net::LoadBalancer> balancer; // Null: one address, or balancing is off
+	};
+
+	static std::string host_key(const Url& url) { return std::format("{}:{}", url.host, url.port); }
+
+	bool reuses_connections(const Url& url) const noexcept { return pool_ && url.scheme != "https"; }
+
+	std::expected<HttpResponse, core::Error> send_uncached(const Url& url, const HttpRequest& req) {
+		if (url.scheme == "https") {
+			return send_secure(url, req, nullptr);
+		}
+		return send_plain(url, req, nullptr);
+	}
+
+	/// To the network, or through the coalescer when one is set and coalesce is true
+	SharedHttpResult send_coalesced(const Url& url, const HttpRequest& req, bool coalesce = true) {
+		auto send = [&]() -> SharedHttpResult {
+			auto res = send_uncached(url, req);
+			if (!res) return std::unexpected(res.error());
+			return std::make_shared<const HttpResponse>(std::move(*res));
+		};
+		if (!coalesce || !coalescer_ || !RequestCoalescer::coalescable(req)) return send();
+		return coalescer_->run(coalescer_->make_key(url, req), send);
+	}
+
+	/**
+	 * @brief A GET through cache_: a fresh hit, a revalidated entry, or a new response to store
+	 *
+	 * What has to go to the network goes through the coalescer only when
+	 * coalesce is true, i.e. for send_shared().
+	 */
+	SharedHttpResult send_cached(const Url& url, const HttpRequest& req, bool coalesce) {
+		auto found = cache_->lookup(url, req);
+		if (found.fresh) return found.response;
+
+		// A stale entry with validators is revalidated, unless the caller sent conditions of its own
+		bool conditional = found.response && (!found.etag.empty() || !found.last_modified.empty())
+			&& !req.headers.has("If-None-Match") && !req.headers.has("If-Modified-Since");
+		HttpRequest revalidation;
+		if (conditional) {
+			revalidation = req;
+			if (!found.etag.empty()) revalidation.headers.set("If-None-Match", found.etag);
+			if (!found.last_modified.empty()) revalidation.headers.set("If-Modified-Since", found.last_modified);
+		}
+		auto sent = HttpClientCache::SysClock::now();
+		auto res = send_coalesced(url, conditional ? revalidation : req, coalesce);
+		auto received = HttpClientCache::SysClock::now();
+		if (!res) {
+			if (found.response && found.stale_if_error) return found.response;
+			return res;
+		}
+		if ((*res)->status == HttpStatus::NotModified && conditional) {
+			if (auto stored = cache_->freshen(url, req, **res, sent, received)) return stored;
+			// The entry went away meanwhile: ask for the full response
+			sent = HttpClientCache::SysClock::now();
+			res = send_coalesced(url, req, coalesce);
+			received = HttpClientCache::SysClock::now();
+			if (!res) return res;
+		}
+		cache_->store(url, req, *res, sent, received);
+		return res;
+	}
+
+	HttpRequest get_request(const Url& url) const {
+		HttpRequest req;
+		req.method = HttpMethod::Get;
+		req.path = url.path.empty() ? "/" : url.path;
+		if (!url.query.empty()) req.path += "?" + url.query;
+		req.headers.set("Host", url.host);
+		if (!reuses_connections(url)) req.headers.set("Connection", "close");
+		req.headers.set("User-Agent", "Etherz/1.0.0");
+		return req;
+	}
+
+	/// Safe to send twice: a retry cannot repeat a side effect
+	static bool idempotent(HttpMethod method) noexcept {
+		return method == HttpMethod::Get || method == HttpMethod::Head || method == HttpMethod::Put
+			|| method == HttpMethod::Delete || method == HttpMethod::Options;
+	}
+
+	/// Read-only methods; any other one invalidates what the cache holds for its URL
+	static bool safe(HttpMethod method) noexcept {
+		return method == HttpMethod::Get || method == HttpMethod::Head || method == HttpMethod::Options;
+	}
+
+	/// Pooled connections are keyed by the address they go to, so a changed DNS answer gets new ones
+	static net::PoolKey address_key(const Url& url, const net::Ip<4>& ip) {
+		auto b = ip.bytes();
+		return net::PoolKey{url.scheme, std::format("{}.{}.{}.{}", b[0], b[1], b[2], b[3]), url.port};
+	}
+
+	/**
+	 * @brief Resolve url's host and pick the address req goes to with the host's balancer
+	 */
+	std::expected<Target, core::Error> choose(const Url& url, const HttpRequest& req) const {
+		auto addresses = resolve_all(url);
+		if (addresses.empty()) return std::unexpected(core::Error::InvalidAddress);
+		const auto& options = balancing_->options;
+		if (addresses.size() == 1 || !options.enabled) return Target{{addresses.front(), url.port}, {}, nullptr};
+
+		auto balancer = balancer_for(url, std::move(addresses));
+		std::string_view key = req.path;
+		if (!options.key_header.empty()) {
+			if (auto value = req.headers.get(options.key_header); !value.empty()) key = value;
+		}
+		auto lease = balancer->pick(options.policy, key);
+		if (!lease) return std::unexpected(core::Error::InvalidAddress);
+		auto address = lease.address();
+		return Target{address, std::move(lease), std::move(balancer)};
+	}
+
+	/// The host's balancer, rebuilt when its DNS answer has changed
+	std::shared_ptr<net::LoadBalancer> balancer_for(const Url& url, std::vector<net::Ip<4>> addresses) const {
+		std::sort(addresses.begin(), addresses.end());
+		auto& state = *balancing_;
+		std::lock_guard lock(state.mutex);
+		auto key = host_key(url);
+		auto it = state.hosts.find(key);
+		if (it == state.hosts.end()) it = state.hosts.emplace(std::move(key), BalancingState::Host{}).first;
+		auto& host = it->second;
+		if (!host.balancer || host.addresses != addresses) {
+			std::vector<net::SocketAddress<net::Ip<4>>> endpoints;
+			for (const auto& ip : addresses) endpoints.emplace_back(ip, url.port);
+			if (host.balancer) host.balancer->set_endpoints(std::move(endpoints));
+			else host.balancer = std::make_shared<net::LoadBalancer>(std::move(endpoints), state.options.balancer);
+			host.addresses = std::move(addresses);
+		}
+		return host.balancer;
 	}
 
 	/**
 	 * @brief Send over plain HTTP
 	 */
-	std::expected<HttpResponse, core::Error> send_plain(const Url& url, const HttpRequest& req) {
-		auto addr = net::SocketAddress<net::Ip<4>>(resolve_host(url), url.port);
+	std::expected<HttpResponse, core::Error> send_plain(const Url& url, const HttpRequest& req, const StreamHandler* handler) {
+		auto raw = req.serialize();
+		if (pool_ && hedge_ && !handler && idempotent(req.method)) return send_hedged(url, req, raw);
+		if (pool_) return send_pooled(url, req, raw, handler);
+
+		auto target = choose(url, req);
+		if (!target) return std::unexpected(target.error());
 
 		net::Socket<net::Ip<4>> sock;
 		if (auto err = sock.create(); core::is_error(err)) return std::unexpected(err);
 
-		if (auto err = sock.connect(addr); core::is_error(err)) return std::unexpected(err);
+		if (auto err = sock.connect(target->address); core::is_error(err)) return std::unexpected(err);
 
-		auto raw = req.serialize();
-		auto data = std::span<const uint8_t>(
-			reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
-		int sent = sock.send(data);
-		if (sent < 0) return std::unexpected(core::Error::SendFailed);
+		if (!send_all(sock, raw)) return std::unexpected(core::Error::SendFailed);
 
-		auto res = receive_response(sock);
+		auto res = ResponseReader(sock).next(req.method, handler);
 		sock.close();
 		return res;
 	}
 
+	/**
+	 * @brief Send over a pooled connection, retrying once if a reused one turns out dead
+	 */
+	std::expected<HttpResponse, core::Error> send_pooled(const Url& url, const HttpRequest& req, std::string_view raw,
+			const StreamHandler* handler) {
+		auto target = choose(url, req);
+		if (!target) return std::unexpected(target.error());
+		auto key = address_key(url, target->address.address());
+		for (int attempt = 0; attempt < 2; ++attempt) {
+			auto conn = attempt == 0 ? pool_->acquire(key) : pool_->acquire_fresh(key);
+			if (!conn) return std::unexpected(conn.error());
+			// Closed by the server between the health check and now; nothing reached it
+			bool stale_ok = conn->reused() && attempt == 0;
+
+			if (!send_all(conn->socket(), raw)) {
+				if (stale_ok) continue;
+				return std::unexpected(core::Error::SendFailed);
+			}
+			ResponseReader reader(conn->socket());
+			// Nothing reaches the handler before the first response byte, so a retry is safe
+			auto res = reader.next(req.method, handler);
+			if (!res && stale_ok && reader.bytes == 0 && idempotent(req.method)) continue;
+			// Bytes past the end of the response: the connection is out of step
+			if (res && reader.reusable()) conn->keep();
+			return res;
+		}
+		return std::unexpected(core::Error::ReceiveFailed);
+	}
+
+	/// Accept-Ranges lists "bytes" (range units are case-insensitive tokens)
+	static bool accepts_byte_ranges(std::string_view accept_ranges) noexcept {
+		while (!accept_ranges.empty()) {
+			auto comma = accept_ranges.find(',');
+			if (detail::iequals(detail::trim(accept_ranges.substr(0, comma)), "bytes")) return true;
+			if (comma == std::string_view::npos) break;
+			accept_ranges.remove_prefix(comma + 1);
+		}
+		return false;
+	}
+
+	/// Content-Range is "bytes <begin>-<last>/<length>", with the unit matched case-insensitively
+	static bool content_range_starts_at(std::string_view content_range, uint64_t begin) noexcept {
+		content_range = detail::trim(content_range);
+		auto space = content_range.find(' ');
+		if (space == std::string_view::npos || !detail::iequals(content_range.substr(0, space), "bytes")) return false;
+		auto range = detail::trim(content_range.substr(space + 1));
+		uint64_t first = 0;
+		auto [ptr, ec] = std::from_chars(range.data(), range.data() + range.size(), first);
+		return ec == std::errc{} && ptr != range.data() + range.size() && *ptr == '-' && first == begin;
+	}
+
+	/**
+	 * @brief Write all of data at offset in fd
+	 */
+	static bool write_at(int fd, std::string_view data, uint64_t offset) {
+#ifdef _WIN32
+		// No pwrite(): position and write under a lock shared by every caller
+		static std::mutex mutex;
+		std::lock_guard lock(mutex);
+		if (::_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+#endif
+		while (!data.empty()) {
+#ifdef _WIN32
+			auto n = ::_write(fd, data.data(), static_cast<unsigned>(data.size()));
+#else
+			auto n = ::pwrite(fd, data.data(), data.size(), static_cast<off_t>(offset));
+			if (n < 0 && errno == EINTR) continue;
+#endif
+			if (n <= 0) return false;
+			data.remove_prefix(static_cast<size_t>(n));
+			offset += static_cast<uint64_t>(n);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Fetch bytes [begin, end) of url into fd at the same offsets, resuming after a failed attempt
+	 */
+	core::Error fetch_range(const Url& url, int fd, uint64_t begin, uint64_t end, int max_attempts) {
+		auto error = core::Error::ReceiveFailed;
+		for (int attempt = 0; attempt < max_attempts && begin < end; ++attempt) {
+			auto req = get_request(url);
+			req.headers.set("Range", std::format("bytes={}-{}", begin, end - 1));
+			bool write_failed = false;
+			StreamHandler handler;
+			// Only a 206 for exactly the asked-for start may be written at these offsets
+			handler.on_head = [&](const HttpResponse& resp) {
+				return resp.status == HttpStatus::PartialContent
+					&& content_range_starts_at(resp.headers.get("Content-Range"), begin);
+			};
+			handler.on_body = [&](std::string_view data) {
+				// More than was asked for: keep the requested bytes and drop the connection
+				bool overrun = data.size() > end - begin;
+				if (overrun) data = data.substr(0, static_cast<size_t>(end - begin));
+				if (!write_at(fd, data, begin)) {
+					write_failed = true;
+					return false;
+				}
+				begin += data.size();
+				return !overrun;
+			};
+			auto res = stream(url, req, handler);
+			if (write_failed) return core::Error::SendFailed;
+			if (!res) error = res.error();
+		}
+		return begin < end ? error : core::Error::None;
+	}
+
+	/**
+	 * @brief Every IPv4 address url's host resolves to, through the DNS cache
+	 */
+	std::vector<net::Ip<4>> resolve_all(const Url& url) const {
+		if (auto literal = net::DnsCache::literal_ipv4(url.host)) return {*literal};
+		auto result = dns_ ? dns_->resolve(url.host) : net::Dns::resolve4(url.host);
+		if (!result.success) return {};
+		return result.ipv4_addresses;
+	}
+
+	/**
+	 * @brief send_pooled() with a backup request to another address if the first is slow to answer
+	 */
+	std::expected<HttpResponse, core::Error> send_hedged(const Url& url, const HttpRequest& req, std::string_view raw) {
+		auto primary_target = choose(url, req);
+		if (!primary_target) return std::unexpected(primary_target.error());
+		auto host = host_key(url);
+		auto& state = *hedge_;
+		std::chrono::milliseconds delay;
+		{
+			std::lock_guard lock(state.mutex);
+			state.deposit();
+			delay = state.delay_for(host);
+		}
+
+		struct Leg {
+			net::PooledConnection conn;
+			net::PoolKey key;
+			std::chrono::steady_clock::time_point sent;
+			bool backup = false;
+			bool retried = false;
+			net::LoadBalancer::Lease lease; // Keeps the endpoint counted as busy while the leg is out
+		};
+		// A different endpoint than the primary's: the balancer's least loaded other one, else the next address
+		auto backup_target = [&]() -> Target {
+			const auto& primary = primary_target->address;
+			if (primary_target->balancer) {
+				if (auto lease = primary_target->balancer->acquire_other(primary)) {
+					auto address = lease.address();
+					return Target{address, std::move(lease), nullptr};
+				}
+			} else if (!balancing_->options.enabled) {
+				auto addresses = resolve_all(url);
+				auto other = std::find_if(addresses.begin(), addresses.end(), [&](const auto& ip) { return ip != primary.address(); });
+				if (other != addresses.end()) return Target{{*other, url.port}, {}, nullptr};
+			}
+			return Target{primary, {}, nullptr}; // One address: another connection to it
+		};
+		// Connect (or reuse) and send; a reused connection that will not take the request is replaced once
+		auto launch = [&](const net::PoolKey& key, bool fresh) -> std::expected<net::PooledConnection, core::Error> {
+			for (int attempt = 0; attempt < 2; ++attempt) {
+				auto conn = (fresh || attempt > 0) ? pool_->acquire_fresh(key) : pool_->acquire(key);
+				if (!conn) return conn;
+				if (send_all(conn->socket(), raw)) return conn;
+				if (!conn->reused()) break;
+			}
+			return std::unexpected(core::Error::SendFailed);
+		};
+		// Index of the first leg with something to read, or -1 on timeout
+		auto first_ready = [](std::vector<Leg>& legs, int timeout_ms) {
+			std::array<async::PollEntry, 2> entries{};
+			for (size_t i = 0; i < legs.size(); ++i) {
+				entries[i] = {legs[i].conn.socket().native_handle(), async::PollEvent::ReadReady, async::PollEvent::None};
+			}
+			if (async::poll(std::span(entries.data(), legs.size()), timeout_ms) <= 0) return -1;
+			for (size_t i = 0; i < legs.size(); ++i) {
+				if (entries[i].returned != async::PollEvent::None) return static_cast<int>(i);
+			}
+			return -1;
+		};
+		bool hedged = false;
+		auto hedge = [&](std::vector<Leg>& legs) {
+			hedged = true;
+			{
+				std::lock_guard lock(state.mutex);
+				if (!state.withdraw()) return;
+			}
+			auto target = backup_target();
+			auto key = address_key(url, target.address.address());
+			if (auto conn = launch(key, false)) {
+				legs.push_back({std::move(*conn), std::move(key), std::chrono::steady_clock::now(), true, false, std::move(target.lease)});
+			}
+		};
+
+		std::vector<Leg> legs;
+		auto start = std::chrono::steady_clock::now();
+		auto primary_key = address_key(url, primary_target->address.address());
+		auto primary = launch(primary_key, false);
+		if (primary) {
+			legs.push_back({std::move(*primary), std::move(primary_key), start, false, false, std::move(primary_target->lease)});
+		}
+		// No answer within the delay, or no primary at all: send the backup
+		if (legs.empty() || first_ready(legs, static_cast<int>(delay.count())) < 0) hedge(legs);
+		if (legs.empty()) return std::unexpected(primary.error());
+
+		core::Error error = core::Error::ReceiveFailed;
+		while (!legs.empty()) {
+			auto ready = first_ready(legs, -1);
+			auto& leg = legs[ready < 0 ? 0 : static_cast<size_t>(ready)];
+			ResponseReader reader(leg.conn.socket());
+			auto res = reader.next(req.method);
+			if (res) {
+				if (reader.reusable()) leg.conn.keep();
+				std::lock_guard lock(state.mutex);
+				if (leg.backup) ++state.wins;
+				// The answering replica's own time: counting a hedged request's wait would push the delay up after every stall
+				state.record(host, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - leg.sent));
+				return res; // The other leg, if any, is closed with legs: that cancels it
+			}
+			error = res.error();
+			// Closed by the server while idle: nothing reached it, try once on a new connection
+			if (reader.bytes == 0 && leg.conn.reused() && !leg.retried) {
+				if (auto conn = launch(leg.key, true)) {
+					leg.conn = std::move(*conn);
+					leg.sent = std::chrono::steady_clock::now();
+					leg.retried = true;
+					continue;
+				}
+			}
+			legs.erase(legs.begin() + (&leg - legs.data()));
+			// The primary failed outright before the delay ran out: the backup doubles as a retry
+			if (legs.empty() && !hedged) hedge(legs);
+		}
+		return std::unexpected(error);
+	}
+
+	/**
+	 * @brief One pass of send_batch(): pipeline the requests at indices over one connection
+	 * @return How many of them (a prefix) were answered, or why no connection was had
+	 */
+	std::expected<size_t, core::Error> pipeline(const Url& url, std::span<const HttpRequest> requests,
+			const std::vector<size_t>& indices, std::vector<std::expected<HttpResponse, core::Error>>& results, bool fresh) {
+		auto exchange = [&](auto& sock, bool& reusable) {
+			ResponseReader reader(sock);
+			size_t answered = 0;
+			std::string out;
+			for (size_t begin = 0; begin < indices.size();) {
+				size_t end = begin;
+				out.clear();
+				while (end < indices.size() && (end == begin || out.size() < PIPELINE_WINDOW)) {
+					out += requests[indices[end++]].serialize();
+				}
+				// Even after a failed write, responses to what did get through may be waiting
+				bool sent = send_all(sock, out);
+				for (; answered < end; ++answered) {
+					auto res = reader.next(requests[indices[answered]].method);
+					if (!res) return answered;
+					results[indices[answered]] = std::move(res);
+					if (!reader.keep_alive) return answered + 1; // The server is done with the connection
+				}
+				if (!sent) return answered;
+				begin = end;
+			}
+			reusable = reader.reusable();
+			return answered;
+		};
+
+		bool reusable = false;
+		// One connection carries the whole pass, so the first request picks it
+		auto target = choose(url, requests[indices.front()]);
+		if (!target) return std::unexpected(target.error());
+		if (pool_) {
+			auto key = address_key(url, target->address.address());
+			auto conn = fresh ? pool_->acquire_fresh(key) : pool_->acquire(key);
+			if (!conn) return std::unexpected(conn.error());
+			auto answered = exchange(conn->socket(), reusable);
+			if (answered == indices.size() && reusable) conn->keep();
+			return answered;
+		}
+		net::Socket<net::Ip<4>> sock;
+		if (auto err = sock.create(); core::is_error(err)) return std::unexpected(err);
+		if (auto err = sock.connect(target->address); core::is_error(err)) return std::unexpected(err);
+		return exchange(sock, reusable);
+	}
+
+	template <typename SocketT>
+	static bool send_all(SocketT& sock, std::string_view raw) {
+		while (!raw.empty()) {
+			int sent = sock.send(std::span<const uint8_t>(
+				reinterpret_cast<const uint8_t*>(raw.data()), raw.size()));
+			if (sent <= 0) return false;
+			raw.remove_prefix(static_cast<size_t>(sent));
+		}
+		return true;
+	}
+
 	/**
 	 * @brief Send over HTTPS using TlsSocket
 	 */
-	std::expected<HttpResponse, core::Error> send_secure(const Url& url, const HttpRequest& req) {
-		auto addr = net::SocketAddress<net::Ip<4>>(resolve_host(url), url.port);
+	std::expected<HttpResponse, core::Error> send_secure(const Url& url, const HttpRequest& req, const StreamHandler* handler) {
+		auto target = choose(url, req);
+		if (!target) return std::unexpected(target.error());
 
 		auto tls_ctx = security::TlsContext::client(url.host);
 		security::TlsSocket<net::Ip<4>> tls_sock;
 
 		if (auto err = tls_sock.create(tls_ctx); core::is_error(err)) return std::unexpected(err);
 
-		if (auto err = tls_sock.connect(addr); core::is_error(err)) return std::unexpected(err);
+		if (auto err = tls_sock.connect(target->address); core::is_error(err)) return std::unexpected(err);
 
 		auto raw = req.serialize();
 		auto data = std::span<const uint8_t>(
@@ -149,44 +1036,59 @@ private:
 		int sent = tls_sock.send(data);
 		if (sent < 0) return std::unexpected(core::Error::SendFailed);
 
-		std::string response_data;
-		std::array<uint8_t, 4096> buffer{};
-		while (true) {
-			int received = tls_sock.recv(buffer);
-			if (received <= 0) break;
-			response_data.append(reinterpret_cast<const char*>(buffer.data()),
-				static_cast<size_t>(received));
-		}
-
+		auto res = ResponseReader(tls_sock).next(req.method, handler);
 		tls_sock.close();
-
-		if (response_data.empty()) {
-			return std::unexpected(core::Error::ReceiveFailed);
-		}
-
-		return http_parser::parse_response(response_data);
+		return res;
 	}
 
 	/**
-	 * @brief Helper: receive and parse HTTP response from a plain socket
+	 * @brief Reads consecutive responses off one connection
+	 *
+	 * Bodies are read by their framing (Content-Length, chunked, or to EOF)
+	 * so the connection can carry another request; bytes read past the end
+	 * of one response are kept for the next, which is what lets pipelined
+	 * responses be taken one after another. 1xx interim responses are
+	 * skipped.
 	 */
 	template <typename SocketT>
-	std::expected<HttpResponse, core::Error> receive_response(SocketT& sock) {
-		std::string response_data;
-		std::array<uint8_t, 4096> buffer{};
-		while (true) {
-			int received = sock.recv(buffer);
-			if (received <= 0) break;
-			response_data.append(reinterpret_cast<const char*>(buffer.data()),
-				static_cast<size_t>(received));
-		}
+	struct ResponseReader {
+		SocketT& sock;
+		std::string buffered;     ///< Read past the end of the last response
+		size_t bytes = 0;         ///< Bytes received (0: the connection was dead on arrival)
+		bool keep_alive = false;  ///< The last response allows another on the connection
+
+		explicit ResponseReader(SocketT& s) noexcept : sock(s) {}
 
-		if (response_data.empty()) {
-			return std::unexpected(core::Error::ReceiveFailed);
+		/**
+		 * @param handler Streams the body instead of collecting it (nullptr: collect)
+		 */
+		std::expected<HttpResponse, core::Error> next(HttpMethod method, const StreamHandler* handler = nullptr) {
+			http_parser::ResponseParser parser(method == HttpMethod::Head);
+			if (handler) parser.stream(handler->on_head, handler->on_body);
+			keep_alive = false;
+			if (!buffered.empty()) buffered.erase(0, parser.feed(buffered));
+			std::array<uint8_t, 16 * 1024> buffer{};
+			while (!parser.done() && !parser.failed() && !parser.stopped()) {
+				int received = sock.recv(buffer);
+				if (received < 0) break;
+				if (received == 0) {
+					parser.finish();
+					break;
+				}
+				bytes += static_cast<size_t>(received);
+				auto data = std::string_view(reinterpret_cast<const char*>(buffer.data()), static_cast<size_t>(received));
+				buffered.append(data.substr(parser.feed(data)));
+			}
+			// Stopped by the handler: the rest of the body is still on the wire
+			if (parser.stopped()) return std::move(parser.response());
+			if (!parser.done()) return std::unexpected(core::Error::ReceiveFailed);
+			keep_alive = parser.keep_alive();
+			return std::move(parser.response());
 		}
 
-		return http_parser::parse_response(response_data);
-	}
+		/// Done with the connection: it may carry another request
+		bool reusable() const noexcept { return keep_alive && buffered.empty(); }
+	};
 };
 
 } // namespace protocol
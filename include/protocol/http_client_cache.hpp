@@ -0,0 +1,621 @@
+/**
+ * @file http_client_cache.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief RFC 9111 private cache for HttpClient: memory LRU with an optional disk tier
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <filesystem>
+#include <format>
+
+#include "url.hpp"
+#include "http.hpp"
+#include "http_response_cache.hpp"
+
+#ifndef _WIN32
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief Sizing and heuristics of an HttpClientCache
+ */
+struct HttpCacheOptions {
+	/// Bytes of responses (bodies, fields and bookkeeping) kept in memory
+	size_t memory_bytes = 64 * 1024 * 1024;
+	/// Directory that entries evicted from memory spill to; empty keeps the cache in memory only
+	std::string disk_path;
+	/// Bytes of spilled entries kept under disk_path
+	size_t disk_bytes = 1024 * 1024 * 1024;
+	/// Larger responses are not stored
+	size_t max_entry_bytes = 8 * 1024 * 1024;
+	/// Lifetime of a response without max-age or Expires, as a fraction of its age at Last-Modified
+	double heuristic_fraction = 0.1;
+	/// Cap on a heuristic lifetime
+	std::chrono::seconds heuristic_max{86'400};
+};
+
+/**
+ * @brief Private (single user) HTTP cache of GET responses, per RFC 9111
+ *
+ * Freshness comes from max-age, else Expires - Date, else a fraction of
+ * the time since Last-Modified, and the age from Date, Age and the
+ * request's round trip. no-store (request or response) and "Vary: *"
+ * are not stored; no-cache and must-revalidate are honored, as are the
+ * request's max-age, min-fresh and max-stale. Vary variants of one URL are
+ * kept side by side and selected by the request's header values.
+ *
+ * Entries are held as the parsed, immutable HttpResponse, so a hit is a
+ * shared_ptr copy. Past memory_bytes the least recently used entries are
+ * written to disk_path (when set) as length-prefixed records and mapped
+ * back in with mmap on their next hit. disk_path must not be shared by two
+ * live caches; the files a cache wrote are removed with it. One lock
+ * guards the whole cache, disk reads and writes included.
+ */
+class HttpClientCache {
+public:
+	using SysClock = std::chrono::system_clock;
+	using TimePoint = SysClock::time_point;
+	using Response = std::shared_ptr<const HttpResponse>;
+
+	/**
+	 * @brief What the cache holds for a request
+	 */
+	struct Lookup {
+		Response response;            ///< Stored response; null on a miss
+		bool fresh = false;           ///< Usable without contacting the origin
+		bool stale_if_error = false;  ///< May stand in, stale, when the origin cannot be reached
+		std::string etag;             ///< Validators for revalidating a stale response
+		std::string last_modified;
+	};
+
+	explicit HttpClientCache(HttpCacheOptions options = {}) : options_(std::move(options)) {
+		if (!options_.disk_path.empty()) {
+			std::error_code ec;
+			std::filesystem::create_directories(options_.disk_path, ec);
+			if (ec) options_.disk_path.clear();
+		}
+	}
+
+	~HttpClientCache() { clear(); }
+
+	HttpClientCache(const HttpClientCache&) = delete;
+	HttpClientCache& operator=(const HttpClientCache&) = delete;
+
+	/**
+	 * @brief Cache key of every variant of a request: origin and path
+	 */
+	static std::string primary_key(const Url& url, const HttpRequest& req) {
+		return std::format("{}://{}:{}{}", url.scheme, url.host, url.port, req.path);
+	}
+
+	/**
+	 * @brief Find the stored response that req selects and judge its freshness at now
+	 */
+	Lookup lookup(const Url& url, const HttpRequest& req, TimePoint now = SysClock::now()) {
+		auto cc = req.headers.get("Cache-Control");
+		std::lock_guard lock(mutex_);
+		if (ResponseCache::directive(cc, "no-store")) { ++misses_; return {}; }
+		auto it = find(primary_key(url, req), req);
+		if (!it || !touch(*it)) { ++misses_; return {}; }
+		auto& entry = **it;
+
+		auto age = entry.initial_age + std::chrono::duration_cast<std::chrono::seconds>(now - entry.response_time);
+		bool fresh = !entry.no_cache && age < entry.lifetime;
+		if (auto max_age = ResponseCache::seconds(cc, "max-age"); max_age && age.count() > static_cast<int64_t>(*max_age)) {
+			fresh = false;
+		}
+		if (auto min_fresh = ResponseCache::seconds(cc, "min-fresh");
+			min_fresh && (entry.lifetime - age).count() < static_cast<int64_t>(*min_fresh)) {
+			fresh = false;
+		}
+		if (!fresh && !entry.no_cache && !entry.must_revalidate && ResponseCache::directive(cc, "max-stale")) {
+			auto limit = ResponseCache::seconds(cc, "max-stale");
+			fresh = !limit || (age - entry.lifetime).count() <= static_cast<int64_t>(*limit);
+		}
+		if (ResponseCache::directive(cc, "no-cache") || (cc.empty() && detail::icontains(req.headers.get("Pragma"), "no-cache"))) {
+			fresh = false;
+		}
+
+		Lookup result;
+		result.response = entry.response;
+		result.fresh = fresh;
+		result.stale_if_error = !entry.no_cache && !entry.must_revalidate;
+		if (fresh) {
+			++hits_;
+		} else {
+			++stale_;
+			result.etag = entry.etag;
+			result.last_modified = entry.last_modified;
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Store resp, the answer to req sent at request_time and received at response_time
+	 * @return false when the response may not or need not be stored
+	 */
+	bool store(const Url& url, const HttpRequest& req, Response resp, TimePoint request_time, TimePoint response_time) {
+		if (!resp || !storable(req, *resp)) return false;
+		Entry entry;
+		entry.key = primary_key(url, req);
+		entry.selecting = selecting_fields(req, *resp);
+		entry.response = std::move(resp);
+		stamp(entry, request_time, response_time);
+		if (entry.lifetime.count() <= 0 && entry.etag.empty() && entry.last_modified.empty()) return false;
+		entry.bytes = resident_bytes(entry);
+		if (entry.bytes > options_.max_entry_bytes) return false;
+
+		std::lock_guard lock(mutex_);
+		// A new response replaces the variant the same request selected
+		if (auto old = find(entry.key, req)) erase(*old);
+		memory_.push_front(std::move(entry));
+		index_[memory_.front().key].push_back(memory_.begin());
+		memory_used_ += memory_.front().bytes;
+		make_room();
+		return true;
+	}
+
+	/**
+	 * @brief Refresh the entry req selects with a 304 Not Modified answer to its revalidation
+	 * @return The refreshed stored response, or null if there is no entry the 304 validates
+	 */
+	Response freshen(const Url& url, const HttpRequest& req, const HttpResponse& not_modified,
+		TimePoint request_time, TimePoint response_time) {
+		std::lock_guard lock(mutex_);
+		auto it = find(primary_key(url, req), req);
+		if (!it || !touch(*it)) return nullptr;
+		auto& entry = **it;
+		auto etag = not_modified.headers.get("ETag");
+		if (!etag.empty() && !entry.etag.empty() && etag != entry.etag) return nullptr;
+
+		// Fields in the 304 replace the stored ones, except those describing the body
+		auto updated = std::make_shared<HttpResponse>(*entry.response);
+		for (const auto& [name, value] : not_modified.headers.entries()) {
+			if (detail::iequals(name, "Content-Length") || detail::iequals(name, "Transfer-Encoding")
+				|| detail::iequals(name, "Content-Encoding") || detail::iequals(name, "Content-Range")) {
+				continue;
+			}
+			updated->headers.set(name, value);
+		}
+		entry.response = std::move(updated);
+		stamp(entry, request_time, response_time);
+		memory_used_ -= entry.bytes;
+		entry.bytes = resident_bytes(entry);
+		memory_used_ += entry.bytes;
+		++revalidated_;
+		auto result = entry.response;
+		make_room();
+		return result;
+	}
+
+	/**
+	 * @brief Drop every variant stored for req's URL (after an unsafe request to it succeeds)
+	 */
+	void invalidate(const Url& url, const HttpRequest& req) {
+		std::lock_guard lock(mutex_);
+		auto found = index_.find(primary_key(url, req));
+		if (found == index_.end()) return;
+		auto variants = found->second;
+		for (auto it : variants) erase(it);
+	}
+
+	/// Drop every entry and remove the disk tier's files
+	void clear() {
+		std::lock_guard lock(mutex_);
+		while (!memory_.empty()) erase(memory_.begin());
+		while (!disk_.empty()) erase(disk_.begin());
+	}
+
+	/// Entries stored, in memory and on disk
+	size_t size() const { std::lock_guard lock(mutex_); return memory_.size() + disk_.size(); }
+	/// Entries on disk
+	size_t disk_entries() const { std::lock_guard lock(mutex_); return disk_.size(); }
+	/// Bytes accounted against memory_bytes
+	size_t memory_used() const { std::lock_guard lock(mutex_); return memory_used_; }
+	/// Bytes of the disk tier's files
+	size_t disk_used() const { std::lock_guard lock(mutex_); return disk_used_; }
+	/// Lookups answered with a fresh response
+	uint64_t hit_count() const { std::lock_guard lock(mutex_); return hits_; }
+	/// Lookups that found only a stale response
+	uint64_t stale_count() const { std::lock_guard lock(mutex_); return stale_; }
+	/// Lookups that found nothing
+	uint64_t miss_count() const { std::lock_guard lock(mutex_); return misses_; }
+	/// Entries read back from the disk tier
+	uint64_t disk_read_count() const { std::lock_guard lock(mutex_); return disk_reads_; }
+	/// Stale entries refreshed by a 304
+	uint64_t revalidated_count() const { std::lock_guard lock(mutex_); return revalidated_; }
+
+	const HttpCacheOptions& options() const noexcept { return options_; }
+
+	/**
+	 * @brief Whether resp to req may be stored (RFC 9111 §3)
+	 */
+	static bool storable(const HttpRequest& req, const HttpResponse& resp) noexcept {
+		if (req.method != HttpMethod::Get || req.headers.has("Range")) return false;
+		auto code = static_cast<uint16_t>(resp.status);
+		if (code < 200 || code == 206 || code == 304) return false;
+		auto cc = resp.headers.get("Cache-Control");
+		if (ResponseCache::directive(req.headers.get("Cache-Control"), "no-store") || ResponseCache::directive(cc, "no-store")) {
+			return false;
+		}
+		if (detail::trim(resp.headers.get("Vary")) == "*") return false;
+		return heuristically_cacheable(resp.status) || ResponseCache::directive(cc, "public")
+			|| ResponseCache::directive(cc, "max-age") || resp.headers.has("Expires");
+	}
+
+	/**
+	 * @brief Parse an HTTP-date: IMF-fixdate, or the obsolete RFC 850 and asctime forms
+	 */
+	static std::optional<TimePoint> parse_date(std::string_view s) noexcept {
+		using namespace std::chrono;
+		s = detail::trim(s);
+		auto number = [](std::string_view& in, size_t width) -> std::optional<int> {
+			while (!in.empty() && in.front() == ' ') in.remove_prefix(1);
+			int v = 0;
+			auto [end, ec] = std::from_chars(in.data(), in.data() + std::min(width, in.size()), v);
+			if (ec != std::errc{} || end == in.data()) return std::nullopt;
+			in.remove_prefix(static_cast<size_t>(end - in.data()));
+			return v;
+		};
+		auto month = [](std::string_view& in) -> std::optional<unsigned> {
+			static constexpr std::string_view names[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+				"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+			if (in.size() < 3) return std::nullopt;
+			for (unsigned i = 0; i < 12; ++i) {
+				if (in.substr(0, 3) == names[i]) { in.remove_prefix(3); return i + 1; }
+			}
+			return std::nullopt;
+		};
+		auto expect = [](std::string_view& in, char c) {
+			if (in.empty() || in.front() != c) return false;
+			in.remove_prefix(1);
+			return true;
+		};
+		auto clock = [&](std::string_view& in) -> std::optional<seconds> {
+			auto h = number(in, 2);
+			if (!h || !expect(in, ':')) return std::nullopt;
+			auto m = number(in, 2);
+			if (!m || !expect(in, ':')) return std::nullopt;
+			auto sec = number(in, 2);
+			if (!sec || *h > 23 || *m > 59 || *sec > 60) return std::nullopt;
+			return hours(*h) + minutes(*m) + seconds(*sec);
+		};
+
+		auto comma = s.find(',');
+		std::optional<int> day, year;
+		std::optional<unsigned> mon;
+		std::optional<seconds> time;
+		if (comma == std::string_view::npos) {
+			// asctime: "Sun Nov  6 08:49:37 1994"
+			if (s.size() < 4) return std::nullopt;
+			s.remove_prefix(4);
+			mon = month(s);
+			day = number(s, 2);
+			if (!expect(s, ' ')) return std::nullopt;
+			time = clock(s);
+			year = number(s, 4);
+		} else {
+			s.remove_prefix(comma + 1);
+			day = number(s, 2);
+			if (s.empty()) return std::nullopt;
+			if (s.front() == '-') {
+				// RFC 850: "Sunday, 06-Nov-94 08:49:37 GMT"
+				s.remove_prefix(1);
+				mon = month(s);
+				if (!expect(s, '-')) return std::nullopt;
+				year = number(s, 2);
+				if (year) *year += *year < 70 ? 2000 : 1900;
+			} else {
+				// IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+				if (!expect(s, ' ')) return std::nullopt;
+				mon = month(s);
+				year = number(s, 4);
+			}
+			if (!expect(s, ' ')) return std::nullopt;
+			time = clock(s);
+			if (detail::trim(s) != "GMT") return std::nullopt;
+		}
+		if (!day || !mon || !year || !time) return std::nullopt;
+		year_month_day date{std::chrono::year(*year), std::chrono::month(*mon), std::chrono::day(static_cast<unsigned>(*day))};
+		if (!date.ok()) return std::nullopt;
+		return TimePoint(sys_days(date)) + *time;
+	}
+
+private:
+	struct Entry {
+		std::string key;
+		std::vector<std::pair<std::string, std::string>> selecting;  // Vary field -> value in the storing request
+		Response response;       // Null while the entry lives on disk
+		std::string file;        // Disk copy, while on disk
+		size_t bytes = 0;        // Accounted against memory_bytes while resident
+		size_t file_bytes = 0;
+		TimePoint response_time;
+		std::chrono::seconds initial_age{0};  // Corrected initial age (RFC 9111 §4.2.3)
+		std::chrono::seconds lifetime{0};
+		bool no_cache = false;
+		bool must_revalidate = false;
+		std::string etag;
+		std::string last_modified;
+	};
+	using List = std::list<Entry>;
+
+	static constexpr char DISK_MAGIC[4] = {'E', 'Z', 'C', '1'};
+
+	HttpCacheOptions options_;
+	mutable std::mutex mutex_;
+	List memory_;  // Most recently used first
+	List disk_;
+	std::unordered_map<std::string, std::vector<List::iterator>> index_;
+	size_t memory_used_ = 0;
+	size_t disk_used_ = 0;
+	uint64_t file_seq_ = 0;
+	uint64_t hits_ = 0;
+	uint64_t stale_ = 0;
+	uint64_t misses_ = 0;
+	uint64_t disk_reads_ = 0;
+	uint64_t revalidated_ = 0;
+
+	/// Statuses a cache may assign a heuristic lifetime to (RFC 9110 §15.1)
+	static bool heuristically_cacheable(HttpStatus status) noexcept {
+		switch (static_cast<uint16_t>(status)) {
+			case 200: case 203: case 204: case 206: case 300: case 301: case 308:
+			case 404: case 405: case 410: case 414: case 501:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	/// Vary field names of resp with req's values for them
+	static std::vector<std::pair<std::string, std::string>> selecting_fields(const HttpRequest& req, const HttpResponse& resp) {
+		std::vector<std::pair<std::string, std::string>> fields;
+		auto vary = resp.headers.get("Vary");
+		while (!vary.empty()) {
+			auto comma = vary.find(',');
+			auto name = detail::trim(vary.substr(0, comma));
+			if (!name.empty()) fields.emplace_back(std::string(name), std::string(detail::trim(req.headers.get(name))));
+			vary = comma == std::string_view::npos ? std::string_view{} : vary.substr(comma + 1);
+		}
+		return fields;
+	}
+
+	/// Freshness lifetime, corrected initial age and validators of entry's response (RFC 9111 §4.2)
+	void stamp(Entry& entry, TimePoint request_time, TimePoint response_time) const {
+		using std::chrono::seconds;
+		using std::chrono::duration_cast;
+		const auto& resp = *entry.response;
+		auto cc = resp.headers.get("Cache-Control");
+		auto date = parse_date(resp.headers.get("Date")).value_or(response_time);
+
+		auto apparent_age = std::max(seconds(0), duration_cast<seconds>(response_time - date));
+		seconds age_value{0};
+		auto age = detail::trim(resp.headers.get("Age"));
+		int64_t parsed = 0;
+		if (std::from_chars(age.data(), age.data() + age.size(), parsed).ec == std::errc{} && parsed > 0) age_value = seconds(parsed);
+		auto response_delay = std::max(seconds(0), duration_cast<seconds>(response_time - request_time));
+		entry.initial_age = std::max(apparent_age, age_value + response_delay);
+		entry.response_time = response_time;
+
+		if (auto max_age = ResponseCache::seconds(cc, "max-age")) {
+			entry.lifetime = seconds(static_cast<int64_t>(std::min<uint64_t>(*max_age, INT32_MAX)));
+		} else if (resp.headers.has("Expires")) {
+			// An invalid Expires, such as "0", means already expired
+			auto expires = parse_date(resp.headers.get("Expires"));
+			entry.lifetime = expires ? std::max(seconds(0), duration_cast<seconds>(*expires - date)) : seconds(0);
+		} else if (auto modified = parse_date(resp.headers.get("Last-Modified"));
+			modified && *modified < date && heuristically_cacheable(resp.status)) {
+			auto since = duration_cast<seconds>(date - *modified);
+			entry.lifetime = std::min(options_.heuristic_max,
+				seconds(static_cast<int64_t>(static_cast<double>(since.count()) * options_.heuristic_fraction)));
+		} else {
+			entry.lifetime = seconds(0);
+		}
+		entry.no_cache = ResponseCache::directive(cc, "no-cache");
+		entry.must_revalidate = ResponseCache::directive(cc, "must-revalidate")
+			|| ResponseCache::directive(cc, "proxy-revalidate");
+		entry.etag = std::string(resp.headers.get("ETag"));
+		entry.last_modified = std::string(resp.headers.get("Last-Modified"));
+	}
+
+	/// Memory an entry holds while resident, roughly: body, fields, key and node overhead
+	static size_t resident_bytes(const Entry& entry) noexcept {
+		size_t n = sizeof(Entry) + sizeof(HttpResponse) + 2 * sizeof(void*) + entry.key.size()
+			+ entry.etag.size() + entry.last_modified.size();
+		for (const auto& [name, value] : entry.selecting) n += sizeof(std::pair<std::string, std::string>) + name.size() + value.size();
+		n += entry.response->body.size();
+		for (const auto& [name, value] : entry.response->headers.entries()) n += sizeof(HttpHeaders::Entry) + name.size() + value.size();
+		return n;
+	}
+
+	/// The variant stored under key that req selects; mutex_ held
+	std::optional<List::iterator> find(const std::string& key, const HttpRequest& req) {
+		auto found = index_.find(key);
+		if (found == index_.end()) return std::nullopt;
+		for (auto it : found->second) {
+			bool match = std::all_of(it->selecting.begin(), it->selecting.end(), [&](const auto& field) {
+				return detail::trim(req.headers.get(field.first)) == field.second;
+			});
+			if (match) return it;
+		}
+		return std::nullopt;
+	}
+
+	/// Mark it most recently used, reading it back from disk if spilled; false if that fails; mutex_ held
+	bool touch(List::iterator it) {
+		if (it->response) {
+			memory_.splice(memory_.begin(), memory_, it);
+			return true;
+		}
+		auto resp = read_file(it->file);
+		if (!resp) { erase(it); return false; }
+		++disk_reads_;
+		remove_file(*it);
+		it->response = std::move(resp);
+		memory_.splice(memory_.begin(), disk_, it);
+		memory_used_ += it->bytes;
+		make_room();
+		// make_room() never evicts the front entry while it fits on its own
+		return static_cast<bool>(it->response);
+	}
+
+	/// Bring memory and disk use back under budget; mutex_ held
+	void make_room() {
+		while (memory_used_ > options_.memory_bytes && memory_.size() > 1) {
+			auto victim = std::prev(memory_.end());
+			if (!options_.disk_path.empty() && write_file(*victim)) {
+				memory_used_ -= victim->bytes;
+				victim->response.reset();
+				disk_.splice(disk_.begin(), memory_, victim);
+			} else {
+				erase(victim);
+			}
+		}
+		while (disk_used_ > options_.disk_bytes && !disk_.empty()) erase(std::prev(disk_.end()));
+	}
+
+	/// Remove it from its list, the index and the disk; mutex_ held
+	void erase(List::iterator it) {
+		auto found = index_.find(it->key);
+		if (found != index_.end()) {
+			std::erase(found->second, it);
+			if (found->second.empty()) index_.erase(found);
+		}
+		if (it->response) {
+			memory_used_ -= it->bytes;
+			memory_.erase(it);
+		} else {
+			remove_file(*it);
+			disk_.erase(it);
+		}
+	}
+
+	void remove_file(Entry& entry) {
+		if (entry.file.empty()) return;
+		std::error_code ec;
+		std::filesystem::remove(entry.file, ec);
+		disk_used_ -= entry.file_bytes;
+		entry.file.clear();
+		entry.file_bytes = 0;
+	}
+
+	/// Spill entry's response to a new file: magic, status, fields and body, each length-prefixed
+	bool write_file(Entry& entry) {
+		const auto& resp = *entry.response;
+		std::string record(DISK_MAGIC, sizeof(DISK_MAGIC));
+		auto put = [&record](uint64_t n, size_t width) {
+			char bytes[8];
+			std::memcpy(bytes, &n, sizeof(n));
+			record.append(bytes, width);
+		};
+		put(static_cast<uint16_t>(resp.status), 2);
+		put(resp.headers.size(), 4);
+		for (const auto& [name, value] : resp.headers.entries()) {
+			put(name.size(), 4);
+			record += name;
+			put(value.size(), 4);
+			record += value;
+		}
+		put(resp.body.size(), 8);
+
+		auto path = std::format("{}/{:016x}.ezc", options_.disk_path, ++file_seq_);
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.write(record.data(), static_cast<std::streamsize>(record.size()));
+		out.write(resp.body.data(), static_cast<std::streamsize>(resp.body.size()));
+		if (!out) {
+			out.close();
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+			return false;
+		}
+		entry.file = std::move(path);
+		entry.file_bytes = record.size() + resp.body.size();
+		disk_used_ += entry.file_bytes;
+		return true;
+	}
+
+	/// Decode a spilled response, mapping the file in where mmap is available
+	static Response read_file(const std::string& path) {
+#ifndef _WIN32
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) return nullptr;
+		struct stat st{};
+		if (::fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return nullptr; }
+		auto size = static_cast<size_t>(st.st_size);
+		void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (map == MAP_FAILED) return nullptr;
+		auto resp = decode({static_cast<const char*>(map), size});
+		::munmap(map, size);
+		return resp;
+#else
+		std::ifstream in(path, std::ios::binary);
+		if (!in) return nullptr;
+		std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		return decode(data);
+#endif
+	}
+
+	static Response decode(std::string_view data) {
+		auto get = [&data](size_t width) -> std::optional<uint64_t> {
+			if (data.size() < width) return std::nullopt;
+			uint64_t n = 0;
+			std::memcpy(&n, data.data(), width);
+			data.remove_prefix(width);
+			return n;
+		};
+		auto bytes = [&data](uint64_t n) -> std::optional<std::string_view> {
+			if (data.size() < n) return std::nullopt;
+			auto s = data.substr(0, n);
+			data.remove_prefix(n);
+			return s;
+		};
+		auto magic = bytes(sizeof(DISK_MAGIC));
+		if (!magic || *magic != std::string_view(DISK_MAGIC, sizeof(DISK_MAGIC))) return nullptr;
+		auto resp = std::make_shared<HttpResponse>();
+		auto status = get(2);
+		auto count = get(4);
+		if (!status || !count) return nullptr;
+		resp->status = static_cast<HttpStatus>(*status);
+		for (uint64_t i = 0; i < *count; ++i) {
+			auto name_size = get(4);
+			auto name = name_size ? bytes(*name_size) : std::nullopt;
+			auto value_size = get(4);
+			auto value = value_size ? bytes(*value_size) : std::nullopt;
+			if (!name || !value) return nullptr;
+			resp->headers.set(std::string(*name), std::string(*value));
+		}
+		auto body_size = get(8);
+		auto body = body_size ? bytes(*body_size) : std::nullopt;
+		if (!body) return nullptr;
+		resp->body.assign(body->data(), body->size());
+		return resp;
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
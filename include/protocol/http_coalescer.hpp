@@ -0,0 +1,164 @@
+/**
+ * @file http_coalescer.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Single-flight coalescing of identical concurrent client requests
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <expected>
+#include <atomic>
+#include <format>
+
+#include "url.hpp"
+#include "http.hpp"
+#include "../core/error.hpp"
+
+namespace etherz {
+namespace protocol {
+
+/// A response shared by every caller of one flight; never copied
+using SharedHttpResult = std::expected<std::shared_ptr<const HttpResponse>, core::Error>;
+
+/**
+ * @brief Which requests count as identical
+ */
+struct RequestCoalescerOptions {
+	/// Request headers whose values are part of the key; requests differing in any other header still share
+	std::vector<std::string> vary = {"Accept", "Accept-Encoding", "Accept-Language", "Authorization", "Cookie", "Range"};
+};
+
+/**
+ * @brief Lets identical GET / HEAD requests in flight at the same time share one round trip
+ *
+ * The first caller for a key (the leader) sends the request; callers that
+ * arrive with the same key before it completes block and then receive the
+ * leader's result, the same immutable response object. Nothing is cached:
+ * once a flight lands, the next caller starts a new one. Safe to share
+ * between threads and between HttpClient instances.
+ */
+class RequestCoalescer {
+public:
+	explicit RequestCoalescer(RequestCoalescerOptions options = {}) : options_(std::move(options)) {}
+
+	RequestCoalescer(const RequestCoalescer&) = delete;
+	RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+	/// Only safe, side-effect free methods are coalesced
+	static bool coalescable(const HttpRequest& req) noexcept {
+		return (req.method == HttpMethod::Get || req.method == HttpMethod::Head) && req.body.empty();
+	}
+
+	/**
+	 * @brief Key of a request to url: method, origin, path, the vary header values and any conditions
+	 *
+	 * Conditional headers are always part of the key, whatever vary says, so
+	 * a plain GET never gets the 304 answered to a revalidation.
+	 */
+	std::string make_key(const Url& url, const HttpRequest& req) const {
+		auto key = std::format("{} {}://{}:{}{}", method_string(req.method), url.scheme, url.host, url.port, req.path);
+		for (const auto& name : options_.vary) {
+			key += '\n';
+			key += req.headers.get(name);
+		}
+		for (std::string_view name : {"If-None-Match", "If-Modified-Since", "If-Match", "If-Unmodified-Since", "If-Range"}) {
+			key += '\n';
+			key += req.headers.get(name);
+		}
+		return key;
+	}
+
+	/**
+	 * @brief Run send() for key, or wait for the run already in flight and share its result
+	 */
+	template <typename Send>
+	SharedHttpResult run(const std::string& key, Send&& send) {
+		std::shared_ptr<Flight> flight;
+		bool leader = false;
+		{
+			std::lock_guard lock(mutex_);
+			auto [it, inserted] = flights_.try_emplace(key);
+			if (inserted) it->second = std::make_shared<Flight>();
+			flight = it->second;
+			leader = inserted;
+		}
+		if (!leader) {
+			coalesced_.fetch_add(1, std::memory_order_relaxed);
+			return flight->wait();
+		}
+
+		leaders_.fetch_add(1, std::memory_order_relaxed);
+		SharedHttpResult result = std::unexpected(core::Error::ReceiveFailed);
+		try {
+			result = send();
+		} catch (...) {
+			land(key, *flight, result);
+			throw;
+		}
+		land(key, *flight, result);
+		return result;
+	}
+
+	/// Flights in progress
+	size_t in_flight() const { std::lock_guard lock(mutex_); return flights_.size(); }
+	/// Requests actually sent
+	uint64_t leader_count() const noexcept { return leaders_.load(std::memory_order_relaxed); }
+	/// Requests that shared another one's response instead of being sent
+	uint64_t coalesced_count() const noexcept { return coalesced_.load(std::memory_order_relaxed); }
+
+	const RequestCoalescerOptions& options() const noexcept { return options_; }
+
+private:
+	/**
+	 * @brief A request in progress that other callers for its key wait on
+	 */
+	struct Flight {
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool done = false;
+		SharedHttpResult result = std::unexpected(core::Error::ReceiveFailed);
+
+		SharedHttpResult wait() {
+			std::unique_lock lock(mutex);
+			cv.wait(lock, [this] { return done; });
+			return result;
+		}
+	};
+
+	RequestCoalescerOptions options_;
+	mutable std::mutex mutex_;
+	std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+	std::atomic<uint64_t> leaders_{0};
+	std::atomic<uint64_t> coalesced_{0};
+
+	/**
+	 * @brief Retire the flight so later callers start afresh, then wake its waiters
+	 */
+	void land(const std::string& key, Flight& flight, const SharedHttpResult& result) {
+		{
+			std::lock_guard lock(mutex_);
+			flights_.erase(key);
+		}
+		{
+			std::lock_guard lock(flight.mutex);
+			flight.done = true;
+			flight.result = result;
+		}
+		flight.cv.notify_all();
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
@@ -0,0 +1,521 @@
+/**
+ * @file http_compression.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief gzip/deflate content coding and a precompressed response cache
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <expected>
+
+#include "http.hpp"
+#include "../core/error.hpp"
+
+// zlib is optional: define ETHERZ_HAS_ZLIB (CMake: -DETHERZ_WITH_ZLIB=ON)
+// and link against zlib to enable compression. Without it every encoder
+// reports FeatureNotSupported and responses are sent as identity.
+#if defined(ETHERZ_HAS_ZLIB)
+	#include <zlib.h>
+#endif
+
+namespace etherz {
+namespace protocol {
+
+// ═══════════════════════════════════════════════
+//  Content Encoding
+// ═══════════════════════════════════════════════
+
+enum class ContentEncoding : uint8_t {
+	Identity, Gzip, Deflate
+};
+
+inline constexpr std::string_view encoding_name(ContentEncoding e) noexcept {
+	switch (e) {
+		case ContentEncoding::Gzip:    return "gzip";
+		case ContentEncoding::Deflate: return "deflate";
+		default:                       return "identity";
+	}
+}
+
+/**
+ * @brief Check if gzip/deflate support was compiled in
+ */
+inline constexpr bool compression_available() noexcept {
+#if defined(ETHERZ_HAS_ZLIB)
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Tuning knobs for response compression
+ */
+struct CompressionOptions {
+	size_t min_size    = 1024;              // Smaller bodies are sent as identity
+	int    level       = 6;                 // zlib level (1 = fastest, 9 = smallest)
+	size_t chunk_size  = 16 * 1024;         // Input slice fed to the encoder per step
+	size_t cache_bytes = 8 * 1024 * 1024;   // Precompressed cache budget (0 = disabled)
+};
+
+namespace detail {
+	/**
+	 * @brief Parse a qvalue ("q=0.5") into thousandths (0..1000)
+	 */
+	inline int parse_qvalue(std::string_view params) noexcept {
+		auto pos = params.find("q=");
+		if (pos == std::string_view::npos) return 1000;
+		auto v = params.substr(pos + 2);
+		int whole = 0, frac = 0, digits = 0;
+		size_t i = 0;
+		if (i < v.size() && v[i] >= '0' && v[i] <= '9') whole = v[i++] - '0';
+		if (i < v.size() && v[i] == '.') {
+			++i;
+			while (i < v.size() && digits < 3 && v[i] >= '0' && v[i] <= '9') {
+				frac = frac * 10 + (v[i++] - '0');
+				++digits;
+			}
+		}
+		while (digits++ < 3) frac *= 10;
+		int q = whole * 1000 + frac;
+		return q > 1000 ? 1000 : q;
+	}
+
+	/**
+	 * @brief 64-bit FNV-1a, used to key cached encodings of identical bodies
+	 */
+	inline uint64_t fnv1a(std::string_view data) noexcept {
+		uint64_t h = 14695981039346656037ull;
+		for (char c : data) {
+			h ^= static_cast<uint8_t>(c);
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+} // namespace detail
+
+/**
+ * @brief Choose a response coding from an Accept-Encoding header
+ *
+ * Honors q-values (q=0 refuses a coding) and the "*" wildcard.
+ * Prefers gzip over deflate when both are equally acceptable.
+ */
+inline ContentEncoding negotiate_encoding(std::string_view accept_encoding) noexcept {
+	int gzip_q = -1, deflate_q = -1, star_q = -1;
+
+	while (!accept_encoding.empty()) {
+		auto comma = accept_encoding.find(',');
+		auto item = accept_encoding.substr(0, comma);
+		accept_encoding = (comma == std::string_view::npos)
+			? std::string_view{} : accept_encoding.substr(comma + 1);
+
+		auto semi = item.find(';');
+		auto coding = detail::trim(item.substr(0, semi));
+		int q = (semi == std::string_view::npos) ? 1000 : detail::parse_qvalue(item.substr(semi + 1));
+
+		if (detail::iequals(coding, "gzip") || detail::iequals(coding, "x-gzip")) gzip_q = q;
+		else if (detail::iequals(coding, "deflate")) deflate_q = q;
+		else if (coding == "*") star_q = q;
+	}
+
+	if (gzip_q < 0) gzip_q = star_q;
+	if (deflate_q < 0) deflate_q = star_q;
+
+	if (gzip_q > 0 && gzip_q >= deflate_q) return ContentEncoding::Gzip;
+	if (deflate_q > 0) return ContentEncoding::Deflate;
+	return ContentEncoding::Identity;
+}
+
+/**
+ * @brief Check if a Content-Type benefits from compression
+ *
+ * Text formats compress well; images, video and archives are already compressed.
+ */
+inline bool is_compressible_type(std::string_view content_type) noexcept {
+	auto semi = content_type.find(';');
+	auto mime = detail::trim(content_type.substr(0, semi));
+	if (mime.empty()) return false;
+	if (mime.size() >= 5 && detail::iequals(mime.substr(0, 5), "text/")) return true;
+	constexpr std::string_view compressible[] = {
+		"json", "javascript", "xml", "svg", "wasm", "x-www-form-urlencoded", "graphql"
+	};
+	for (auto token : compressible) {
+		if (detail::icontains(mime, token)) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Check if a response may be encoded once and reused
+ *
+ * A 200 response is cacheable when it carries an ETag or a Cache-Control
+ * that allows shared reuse (public / max-age) and does not forbid storage.
+ */
+inline bool is_cacheable_response(const HttpResponse& resp) noexcept {
+	if (resp.status != HttpStatus::OK) return false;
+	auto cc = resp.headers.get("Cache-Control");
+	if (detail::icontains(cc, "no-store") || detail::icontains(cc, "no-cache")
+		|| detail::icontains(cc, "private")) return false;
+	return resp.headers.has("ETag")
+		|| detail::icontains(cc, "public") || detail::icontains(cc, "max-age");
+}
+
+// ═══════════════════════════════════════════════
+//  Streaming Compressor
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Incremental gzip/deflate encoder
+ *
+ * Feed input with write() as it becomes available and call finish() once.
+ * Output is appended to a caller-owned string, so memory stays bounded by
+ * the compressed size plus zlib's fixed window.
+ */
+class Compressor {
+public:
+	explicit Compressor(ContentEncoding encoding, int level = 6) noexcept {
+#if defined(ETHERZ_HAS_ZLIB)
+		if (encoding == ContentEncoding::Identity) return;
+		// windowBits 15 = zlib wrapper (HTTP "deflate"), +16 = gzip wrapper
+		int window_bits = (encoding == ContentEncoding::Gzip) ? 15 + 16 : 15;
+		ok_ = deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+#else
+		(void)encoding;
+		(void)level;
+#endif
+	}
+
+	~Compressor() noexcept {
+#if defined(ETHERZ_HAS_ZLIB)
+		if (ok_) deflateEnd(&stream_);
+#endif
+	}
+
+	// z_stream points back into itself, so the encoder stays in place
+	Compressor(const Compressor&) = delete;
+	Compressor& operator=(const Compressor&) = delete;
+
+	/**
+	 * @brief Compress a slice of input, appending output to out
+	 */
+	core::Error write(std::string_view input, std::string& out) noexcept {
+#if defined(ETHERZ_HAS_ZLIB)
+		// avail_in is a uInt: hand zlib inputs of 4 GiB and more in pieces
+		constexpr size_t MAX_IN = std::numeric_limits<uInt>::max();
+		while (input.size() > MAX_IN) {
+			if (auto err = run(input.substr(0, MAX_IN), out, 0); core::is_error(err)) return err;
+			input.remove_prefix(MAX_IN);
+		}
+#endif
+		return run(input, out, 0);
+	}
+
+	/**
+	 * @brief Emit all pending output on a byte boundary (Z_SYNC_FLUSH)
+	 */
+	core::Error flush(std::string& out) noexcept {
+		return run({}, out, 1);
+	}
+
+	/**
+	 * @brief Terminate the stream and append the trailer
+	 */
+	core::Error finish(std::string& out) noexcept {
+		return run({}, out, 2);
+	}
+
+	bool is_valid() const noexcept { return ok_; }
+
+private:
+	bool ok_ = false;
+#if defined(ETHERZ_HAS_ZLIB)
+	z_stream stream_{};
+#endif
+
+	core::Error run(std::string_view input, std::string& out, int mode) noexcept {
+		if (!ok_) return core::Error::FeatureNotSupported;
+#if defined(ETHERZ_HAS_ZLIB)
+		constexpr size_t OUT_STEP = 16 * 1024;
+		int flush = (mode == 0) ? Z_NO_FLUSH : (mode == 1) ? Z_SYNC_FLUSH : Z_FINISH;
+
+		stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+		stream_.avail_in = static_cast<uInt>(input.size());
+
+		try {
+			while (true) {
+				size_t old_size = out.size();
+				out.resize(old_size + OUT_STEP);
+				stream_.next_out = reinterpret_cast<Bytef*>(out.data() + old_size);
+				stream_.avail_out = static_cast<uInt>(OUT_STEP);
+
+				int rc = deflate(&stream_, flush);
+				out.resize(old_size + (OUT_STEP - stream_.avail_out));
+
+				if (rc == Z_STREAM_END) break;
+				if (rc != Z_OK && rc != Z_BUF_ERROR) return core::Error::Unknown;
+				// Done once all input is consumed and zlib had room to spare
+				if (stream_.avail_in == 0 && stream_.avail_out != 0 && mode != 2) break;
+			}
+		} catch (...) {
+			return core::Error::Unknown;
+		}
+		return core::Error::None;
+#else
+		(void)input;
+		(void)out;
+		(void)mode;
+		return core::Error::FeatureNotSupported;
+#endif
+	}
+};
+
+/**
+ * @brief Compress a whole buffer, feeding the encoder chunk_size bytes at a time
+ */
+inline std::expected<std::string, core::Error> compress(std::string_view input,
+	ContentEncoding encoding, int level = 6, size_t chunk_size = 16 * 1024) {
+	Compressor enc(encoding, level);
+	if (!enc.is_valid()) return std::unexpected(core::Error::FeatureNotSupported);
+	if (chunk_size == 0) chunk_size = input.size();
+
+	std::string out;
+	out.reserve(input.size() / 4 + 64);
+	for (size_t pos = 0; pos < input.size(); pos += chunk_size) {
+		if (auto err = enc.write(input.substr(pos, chunk_size), out); core::is_error(err))
+			return std::unexpected(err);
+	}
+	if (auto err = enc.finish(out); core::is_error(err)) return std::unexpected(err);
+	return out;
+}
+
+/**
+ * @brief Decode a gzip or deflate body
+ */
+inline std::expected<std::string, core::Error> decompress(std::string_view input, ContentEncoding encoding) {
+#if defined(ETHERZ_HAS_ZLIB)
+	if (encoding == ContentEncoding::Identity) return std::string(input);
+
+	z_stream stream{};
+	// +32 lets zlib auto-detect the gzip or zlib header
+	if (inflateInit2(&stream, 15 + 32) != Z_OK) return std::unexpected(core::Error::Unknown);
+
+	std::string out;
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	size_t remaining = input.size();
+
+	int rc = Z_OK;
+	while (rc != Z_STREAM_END) {
+		constexpr size_t OUT_STEP = 32 * 1024;
+		if (stream.avail_in == 0 && remaining > 0) {
+			// avail_in is a uInt: feed inputs of 4 GiB and more in pieces
+			auto step = std::min<size_t>(remaining, std::numeric_limits<uInt>::max());
+			stream.avail_in = static_cast<uInt>(step);
+			remaining -= step;
+		}
+		size_t old_size = out.size();
+		out.resize(old_size + OUT_STEP);
+		stream.next_out = reinterpret_cast<Bytef*>(out.data() + old_size);
+		stream.avail_out = static_cast<uInt>(OUT_STEP);
+		rc = inflate(&stream, Z_NO_FLUSH);
+		out.resize(old_size + (OUT_STEP - stream.avail_out));
+		if (rc != Z_OK && rc != Z_STREAM_END) break;
+		if (rc == Z_OK && stream.avail_in == 0 && remaining == 0 && stream.avail_out != 0) break; // Truncated
+	}
+	inflateEnd(&stream);
+
+	if (rc != Z_STREAM_END) return std::unexpected(core::Error::ReceiveFailed);
+	return out;
+#else
+	(void)input;
+	(void)encoding;
+	return std::unexpected(core::Error::FeatureNotSupported);
+#endif
+}
+
+// ═══════════════════════════════════════════════
+//  Precompressed Cache
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Byte-bounded LRU of encoded bodies
+ *
+ * Entries are keyed on path, coding and body identity (the ETag when the
+ * response has one, otherwise a hash of the body), so a cacheable response
+ * is compressed once and every later request reuses the encoded bytes.
+ * An empty body marks a response whose encoding did not come out smaller.
+ */
+class PrecompressedCache {
+public:
+	using Body = std::shared_ptr<const std::string>;
+
+	explicit PrecompressedCache(size_t capacity_bytes = 8 * 1024 * 1024) noexcept
+		: capacity_(capacity_bytes) {}
+
+	/**
+	 * @brief Build the cache key for a response body
+	 */
+	static std::string make_key(std::string_view path, ContentEncoding encoding,
+		std::string_view etag, std::string_view body) {
+		std::string key;
+		key.reserve(path.size() + etag.size() + 24);
+		key += path;
+		key += '\n';
+		key += encoding_name(encoding);
+		key += '\n';
+		if (!etag.empty()) {
+			key += etag;
+		} else {
+			key += std::to_string(detail::fnv1a(body));
+			key += ':';
+			key += std::to_string(body.size());
+		}
+		return key;
+	}
+
+	Body find(const std::string& key) {
+		std::lock_guard lock(mutex_);
+		auto it = index_.find(key);
+		if (it == index_.end()) {
+			++misses_;
+			return nullptr;
+		}
+		lru_.splice(lru_.begin(), lru_, it->second);
+		++hits_;
+		return it->second->body;
+	}
+
+	void insert(std::string key, Body body) {
+		if (!body || body->size() > capacity_) return;
+		std::lock_guard lock(mutex_);
+		if (auto it = index_.find(key); it != index_.end()) {
+			bytes_ -= it->second->body->size();
+			lru_.erase(it->second);
+			index_.erase(it);
+		}
+		bytes_ += body->size();
+		lru_.push_front({key, std::move(body)});
+		index_.emplace(std::move(key), lru_.begin());
+
+		while (bytes_ > capacity_ && !lru_.empty()) {
+			auto& victim = lru_.back();
+			bytes_ -= victim.body->size();
+			index_.erase(victim.key);
+			lru_.pop_back();
+		}
+	}
+
+	void clear() noexcept {
+		std::lock_guard lock(mutex_);
+		lru_.clear();
+		index_.clear();
+		bytes_ = 0;
+	}
+
+	size_t size() const noexcept { std::lock_guard lock(mutex_); return index_.size(); }
+	size_t bytes() const noexcept { std::lock_guard lock(mutex_); return bytes_; }
+	size_t capacity() const noexcept { return capacity_; }
+	uint64_t hits() const noexcept { std::lock_guard lock(mutex_); return hits_; }
+	uint64_t misses() const noexcept { std::lock_guard lock(mutex_); return misses_; }
+
+private:
+	struct Entry {
+		std::string key;
+		Body body;
+	};
+
+	size_t capacity_;
+	size_t bytes_ = 0;
+	uint64_t hits_ = 0;
+	uint64_t misses_ = 0;
+	std::list<Entry> lru_;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+	mutable std::mutex mutex_;
+};
+
+// ═══════════════════════════════════════════════
+//  Response Encoding
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Encode a response body according to the request's Accept-Encoding
+ *
+ * Leaves the response untouched when the body is small, already encoded,
+ * not a compressible type, or the client only accepts identity. Cacheable
+ * responses are looked up in / stored to the given cache.
+ *
+ * @return true if the body was replaced with an encoded representation
+ */
+inline bool compress_response(const HttpRequest& req, HttpResponse& resp,
+	const CompressionOptions& options, PrecompressedCache* cache = nullptr) {
+	if (resp.headers.has("Content-Encoding")) return false;
+	if (req.method == HttpMethod::Head) return false;
+	auto code = static_cast<uint16_t>(resp.status);
+	if (code < 200 || code == 204 || code == 304) return false;
+	if (resp.body.size() < options.min_size) return false;
+	if (!is_compressible_type(resp.headers.get("Content-Type"))) return false;
+	if (!compression_available()) return false;
+
+	// The representation now depends on Accept-Encoding, even if identity wins
+	auto vary = resp.headers.get("Vary");
+	if (vary.empty()) {
+		resp.headers.set("Vary", "Accept-Encoding");
+	} else if (!detail::icontains(vary, "Accept-Encoding") && vary != "*") {
+		resp.headers.set("Vary", std::string(vary) + ", Accept-Encoding");
+	}
+
+	auto encoding = negotiate_encoding(req.headers.get("Accept-Encoding"));
+	if (encoding == ContentEncoding::Identity) return false;
+
+	std::string key;
+	bool cacheable = cache && cache->capacity() > 0 && is_cacheable_response(resp);
+	if (cacheable) {
+		key = PrecompressedCache::make_key(req.path, encoding, resp.headers.get("ETag"), resp.body);
+		if (auto hit = cache->find(key)) {
+			if (hit->empty()) return false; // Known not to shrink
+			resp.body.assign(*hit);
+			cacheable = false;
+		}
+	}
+
+	if (cacheable || key.empty()) {
+		auto encoded = compress(resp.body, encoding, options.level, options.chunk_size);
+		if (!encoded) return false;
+		if (encoded->size() >= resp.body.size()) {
+			// Not worth it; remember that so the next request skips the attempt
+			if (cacheable) cache->insert(std::move(key), std::make_shared<const std::string>());
+			return false;
+		}
+		if (cacheable) {
+			auto shared = std::make_shared<const std::string>(*encoded);
+			cache->insert(std::move(key), std::move(shared));
+		}
+		resp.body = std::move(*encoded);
+	}
+
+	resp.headers.set("Content-Encoding", std::string(encoding_name(encoding)));
+	if (resp.headers.has("Content-Length")) {
+		resp.headers.set("Content-Length", std::to_string(resp.body.size()));
+	}
+	// A strong validator must not match a different representation
+	auto etag = resp.headers.get("ETag");
+	if (!etag.empty() && !etag.starts_with("W/")) {
+		resp.headers.set("ETag", "W/" + std::string(etag));
+	}
+	return true;
+}
+
+} // namespace protocol
+} // namespace etherz
@@ -0,0 +1,435 @@
+/**
+ * @file http_metrics.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Lock-free server metrics: counters, gauges and HDR-style latency histograms
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <bit>
+#include <format>
+#include <algorithm>
+
+#include "http.hpp"
+
+namespace etherz {
+namespace protocol {
+
+// ═══════════════════════════════════════════════
+//  Per-thread Shards
+// ═══════════════════════════════════════════════
+
+namespace metrics_detail {
+
+inline constexpr size_t SHARDS = 16;
+
+/// Which shard indices are owned by a live thread
+inline std::array<std::atomic<bool>, SHARDS> shard_owned{};
+
+/**
+ * @brief A thread's claim on a shard index
+ *
+ * The first SHARDS - 1 concurrently live recording threads each own an
+ * index outright and may update its counters with plain load + store;
+ * any further threads share the last index and use atomic adds. The
+ * claim is released when the thread exits.
+ */
+struct ShardClaim {
+	size_t index = SHARDS - 1;
+	bool exclusive = false;
+
+	ShardClaim() noexcept {
+		for (size_t i = 0; i + 1 < SHARDS; ++i) {
+			if (!shard_owned[i].exchange(true, std::memory_order_acquire)) {
+				index = i;
+				exclusive = true;
+				return;
+			}
+		}
+	}
+
+	~ShardClaim() {
+		if (exclusive) shard_owned[index].store(false, std::memory_order_release);
+	}
+};
+
+inline const ShardClaim& this_thread_shard() noexcept {
+	thread_local ShardClaim claim;
+	return claim;
+}
+
+/// Add to a counter; single-writer shards skip the locked read-modify-write
+template <typename T>
+inline void bump(std::atomic<T>& counter, T n, bool exclusive) noexcept {
+	if (exclusive) counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	else counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+} // namespace metrics_detail
+
+// ═══════════════════════════════════════════════
+//  Latency Histogram
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Log-linear (HDR-style) histogram of nanosecond values
+ *
+ * Each power of two is split into 16 linear sub-buckets, bounding the
+ * relative error at 1/16 from 16ns up to ~18 minutes (larger values land
+ * in the top bucket). Recording is a relaxed add on two counters;
+ * pass exclusive = true when only the calling thread ever records here.
+ */
+class LatencyHistogram {
+public:
+	static constexpr uint32_t SUB_BITS = 4;
+	static constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+	static constexpr uint32_t MAX_EXPONENT = 40;
+	static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_COUNT;
+
+	static constexpr size_t bucket_index(uint64_t ns) noexcept {
+		if (ns < SUB_COUNT) return static_cast<size_t>(ns);
+		auto exponent = static_cast<uint32_t>(std::bit_width(ns)) - 1;
+		if (exponent > MAX_EXPONENT) return BUCKETS - 1;
+		auto mantissa = static_cast<size_t>(ns >> (exponent - SUB_BITS));
+		return (exponent - SUB_BITS + 1) * SUB_COUNT + (mantissa - SUB_COUNT);
+	}
+
+	/// Largest value that maps to bucket index
+	static constexpr uint64_t bucket_upper(size_t index) noexcept {
+		if (index < SUB_COUNT) return index;
+		auto exponent = static_cast<uint32_t>(index / SUB_COUNT) + SUB_BITS - 1;
+		auto mantissa = static_cast<uint64_t>(index % SUB_COUNT) + SUB_COUNT;
+		return ((mantissa + 1) << (exponent - SUB_BITS)) - 1;
+	}
+
+	void record(uint64_t ns, bool exclusive = false) noexcept {
+		metrics_detail::bump<uint64_t>(counts_[bucket_index(ns)], 1, exclusive);
+		metrics_detail::bump<uint64_t>(sum_, ns, exclusive);
+	}
+
+	/**
+	 * @brief Point-in-time copy, mergeable across shards
+	 */
+	struct Snapshot {
+		std::array<uint64_t, BUCKETS> counts{};
+		uint64_t count = 0;
+		uint64_t sum_ns = 0;
+
+		void merge(const Snapshot& other) noexcept {
+			for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+			count += other.count;
+			sum_ns += other.sum_ns;
+		}
+
+		/// Number of values <= ns (exact at bucket boundaries)
+		uint64_t count_at_or_below(uint64_t ns) const noexcept {
+			uint64_t n = 0;
+			for (size_t i = 0; i < BUCKETS && bucket_upper(i) <= ns; ++i) n += counts[i];
+			return n;
+		}
+
+		/// Value at quantile q in [0, 1] (bucket upper bound), 0 if empty
+		uint64_t percentile(double q) const noexcept {
+			if (count == 0) return 0;
+			auto rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count));
+			uint64_t seen = 0;
+			for (size_t i = 0; i < BUCKETS; ++i) {
+				seen += counts[i];
+				if (seen > rank || seen == count) return bucket_upper(i);
+			}
+			return bucket_upper(BUCKETS - 1);
+		}
+	};
+
+	void snapshot_into(Snapshot& out) const noexcept {
+		for (size_t i = 0; i < BUCKETS; ++i) {
+			auto c = counts_[i].load(std::memory_order_relaxed);
+			out.counts[i] += c;
+			out.count += c;
+		}
+		out.sum_ns += sum_.load(std::memory_order_relaxed);
+	}
+
+	Snapshot snapshot() const noexcept {
+		Snapshot s;
+		snapshot_into(s);
+		return s;
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+	std::atomic<uint64_t> sum_{0};
+};
+
+// ═══════════════════════════════════════════════
+//  Server Metrics
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Request metrics for HttpServer, sharded per recording thread
+ *
+ * Each recording thread owns a cache-line-aligned shard, so recording
+ * never contends and needs neither locks nor locked instructions; readers
+ * sum the shards. Route slots must be added before the server starts
+ * recording for them.
+ */
+class ServerMetrics {
+public:
+	static constexpr size_t SHARDS = metrics_detail::SHARDS;
+	static constexpr size_t STATUS_CODES = 600;
+
+	/// Slot for requests that matched no route
+	static constexpr size_t UNMATCHED = 0;
+
+	ServerMetrics() { add_route("", "unmatched"); }
+
+	ServerMetrics(const ServerMetrics&) = delete;
+	ServerMetrics& operator=(const ServerMetrics&) = delete;
+
+	/**
+	 * @brief Register a route and return its slot
+	 */
+	size_t add_route(std::string method, std::string path) {
+		routes_.push_back(std::make_unique<RouteStats>());
+		routes_.back()->method = std::move(method);
+		routes_.back()->path = std::move(path);
+		return routes_.size() - 1;
+	}
+
+	size_t route_count() const noexcept { return routes_.size(); }
+
+	// ─── Recording (any thread) ─────────
+
+	void request_started(size_t route) noexcept {
+		const auto& claim = metrics_detail::this_thread_shard();
+		metrics_detail::bump<int64_t>(routes_[route]->shards[claim.index].in_flight, 1, claim.exclusive);
+	}
+
+	void request_finished(size_t route, HttpStatus status, uint64_t latency_ns,
+		uint64_t body_in, uint64_t body_out) noexcept {
+		using metrics_detail::bump;
+		const auto& claim = metrics_detail::this_thread_shard();
+		auto& s = routes_[route]->shards[claim.index];
+		bump<int64_t>(s.in_flight, -1, claim.exclusive);
+		auto code = static_cast<size_t>(status);
+		if (code >= 100 && code < STATUS_CODES) {
+			bump<uint64_t>(s.by_class[code / 100 - 1], 1, claim.exclusive);
+			bump<uint64_t>(status_shards_[claim.index].codes[code], 1, claim.exclusive);
+		}
+		bump(s.body_in, body_in, claim.exclusive);
+		bump(s.body_out, body_out, claim.exclusive);
+		s.latency.record(latency_ns, claim.exclusive);
+	}
+
+	/// A request that ended without a response (client went away)
+	void request_aborted(size_t route, uint64_t body_in) noexcept {
+		using metrics_detail::bump;
+		const auto& claim = metrics_detail::this_thread_shard();
+		auto& s = routes_[route]->shards[claim.index];
+		bump<int64_t>(s.in_flight, -1, claim.exclusive);
+		bump<uint64_t>(s.aborted, 1, claim.exclusive);
+		bump(s.body_in, body_in, claim.exclusive);
+	}
+
+	void add_network_io(uint64_t received, uint64_t sent) noexcept {
+		const auto& claim = metrics_detail::this_thread_shard();
+		auto& s = status_shards_[claim.index];
+		if (received) metrics_detail::bump(s.net_in, received, claim.exclusive);
+		if (sent) metrics_detail::bump(s.net_out, sent, claim.exclusive);
+	}
+
+	void connection_opened() noexcept { add_connections(1); }
+	void connection_closed() noexcept { add_connections(-1); }
+
+	// ─── Reading ────────────────
+
+	struct RouteSnapshot {
+		std::string_view method;
+		std::string_view path;
+		std::array<uint64_t, 5> by_class{};    // 1xx .. 5xx
+		uint64_t aborted = 0;
+		int64_t in_flight = 0;
+		uint64_t body_in = 0;
+		uint64_t body_out = 0;
+		LatencyHistogram::Snapshot latency;
+
+		uint64_t requests() const noexcept {
+			uint64_t n = 0;
+			for (auto c : by_class) n += c;
+			return n;
+		}
+	};
+
+	RouteSnapshot route(size_t slot) const noexcept {
+		RouteSnapshot out;
+		const auto& r = *routes_[slot];
+		out.method = r.method;
+		out.path = r.path;
+		for (const auto& s : r.shards) {
+			for (size_t c = 0; c < 5; ++c) out.by_class[c] += s.by_class[c].load(std::memory_order_relaxed);
+			out.aborted += s.aborted.load(std::memory_order_relaxed);
+			out.in_flight += s.in_flight.load(std::memory_order_relaxed);
+			out.body_in += s.body_in.load(std::memory_order_relaxed);
+			out.body_out += s.body_out.load(std::memory_order_relaxed);
+			s.latency.snapshot_into(out.latency);
+		}
+		return out;
+	}
+
+	uint64_t status_count(HttpStatus status) const noexcept {
+		auto code = static_cast<size_t>(status);
+		if (code >= STATUS_CODES) return 0;
+		uint64_t n = 0;
+		for (const auto& s : status_shards_) n += s.codes[code].load(std::memory_order_relaxed);
+		return n;
+	}
+
+	uint64_t network_received() const noexcept { return sum(&StatusShard::net_in); }
+	uint64_t network_sent() const noexcept { return sum(&StatusShard::net_out); }
+
+	int64_t open_connections() const noexcept {
+		int64_t n = 0;
+		for (const auto& s : status_shards_) n += s.connections.load(std::memory_order_relaxed);
+		return n;
+	}
+
+	/**
+	 * @brief Render everything in the Prometheus text exposition format
+	 */
+	std::string prometheus() const {
+		std::string out;
+		std::vector<RouteSnapshot> snaps;
+		snaps.reserve(routes_.size());
+		for (size_t i = 0; i < routes_.size(); ++i) snaps.push_back(route(i));
+
+		auto labels = [](const RouteSnapshot& r) {
+			return std::format("method=\"{}\",route=\"{}\"", r.method, escape(r.path));
+		};
+
+		out += "# HELP etherz_http_requests_total Requests answered, by route and status class.\n"
+			"# TYPE etherz_http_requests_total counter\n";
+		for (const auto& r : snaps) {
+			for (size_t c = 0; c < 5; ++c) {
+				if (r.by_class[c] == 0) continue;
+				out += std::format("etherz_http_requests_total{{{},code=\"{}xx\"}} {}\n", labels(r), c + 1, r.by_class[c]);
+			}
+		}
+
+		out += "# HELP etherz_http_responses_total Responses by status code.\n"
+			"# TYPE etherz_http_responses_total counter\n";
+		for (size_t code = 100; code < STATUS_CODES; ++code) {
+			auto n = status_count(static_cast<HttpStatus>(code));
+			if (n) out += std::format("etherz_http_responses_total{{code=\"{}\"}} {}\n", code, n);
+		}
+
+		out += "# HELP etherz_http_requests_aborted_total Requests whose client went away before the response.\n"
+			"# TYPE etherz_http_requests_aborted_total counter\n";
+		for (const auto& r : snaps) {
+			if (r.aborted) out += std::format("etherz_http_requests_aborted_total{{{}}} {}\n", labels(r), r.aborted);
+		}
+
+		out += "# HELP etherz_http_requests_in_flight Requests being handled.\n"
+			"# TYPE etherz_http_requests_in_flight gauge\n";
+		for (const auto& r : snaps) {
+			out += std::format("etherz_http_requests_in_flight{{{}}} {}\n", labels(r), r.in_flight);
+		}
+
+		out += "# HELP etherz_http_request_body_bytes_total Request body bytes received.\n"
+			"# TYPE etherz_http_request_body_bytes_total counter\n";
+		for (const auto& r : snaps) {
+			if (r.body_in) out += std::format("etherz_http_request_body_bytes_total{{{}}} {}\n", labels(r), r.body_in);
+		}
+		out += "# HELP etherz_http_response_body_bytes_total Response body bytes produced by handlers.\n"
+			"# TYPE etherz_http_response_body_bytes_total counter\n";
+		for (const auto& r : snaps) {
+			if (r.body_out) out += std::format("etherz_http_response_body_bytes_total{{{}}} {}\n", labels(r), r.body_out);
+		}
+
+		out += "# HELP etherz_http_request_duration_seconds Time spent producing the response.\n"
+			"# TYPE etherz_http_request_duration_seconds histogram\n";
+		static constexpr std::array<double, 14> bounds{
+			0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5};
+		for (const auto& r : snaps) {
+			if (r.latency.count == 0) continue;
+			auto l = labels(r);
+			for (double b : bounds) {
+				auto n = r.latency.count_at_or_below(static_cast<uint64_t>(b * 1e9));
+				out += std::format("etherz_http_request_duration_seconds_bucket{{{},le=\"{}\"}} {}\n", l, b, n);
+			}
+			out += std::format("etherz_http_request_duration_seconds_bucket{{{},le=\"+Inf\"}} {}\n", l, r.latency.count);
+			out += std::format("etherz_http_request_duration_seconds_sum{{{}}} {:.9f}\n", l,
+				static_cast<double>(r.latency.sum_ns) / 1e9);
+			out += std::format("etherz_http_request_duration_seconds_count{{{}}} {}\n", l, r.latency.count);
+		}
+
+		out += "# HELP etherz_network_bytes_total Bytes moved on client connections.\n"
+			"# TYPE etherz_network_bytes_total counter\n";
+		out += std::format("etherz_network_bytes_total{{direction=\"in\"}} {}\n", network_received());
+		out += std::format("etherz_network_bytes_total{{direction=\"out\"}} {}\n", network_sent());
+		out += "# HELP etherz_connections_open Client connections currently open.\n"
+			"# TYPE etherz_connections_open gauge\n";
+		out += std::format("etherz_connections_open {}\n", open_connections());
+		return out;
+	}
+
+private:
+	struct alignas(64) RouteShard {
+		std::array<std::atomic<uint64_t>, 5> by_class{};
+		std::atomic<uint64_t> aborted{0};
+		std::atomic<int64_t> in_flight{0};
+		std::atomic<uint64_t> body_in{0};
+		std::atomic<uint64_t> body_out{0};
+		LatencyHistogram latency;
+	};
+
+	struct RouteStats {
+		std::string method;
+		std::string path;
+		std::array<RouteShard, SHARDS> shards;
+	};
+
+	struct alignas(64) StatusShard {
+		std::array<std::atomic<uint64_t>, STATUS_CODES> codes{};
+		std::atomic<uint64_t> net_in{0};
+		std::atomic<uint64_t> net_out{0};
+		std::atomic<int64_t> connections{0};
+	};
+
+	std::vector<std::unique_ptr<RouteStats>> routes_;
+	std::array<StatusShard, SHARDS> status_shards_;
+
+	void add_connections(int64_t n) noexcept {
+		const auto& claim = metrics_detail::this_thread_shard();
+		metrics_detail::bump(status_shards_[claim.index].connections, n, claim.exclusive);
+	}
+
+	uint64_t sum(std::atomic<uint64_t> StatusShard::* field) const noexcept {
+		uint64_t n = 0;
+		for (const auto& s : status_shards_) n += (s.*field).load(std::memory_order_relaxed);
+		return n;
+	}
+
+	static std::string escape(std::string_view v) {
+		std::string out;
+		for (char c : v) {
+			if (c == '"' || c == '\\') out += '\\';
+			if (c == '\n') { out += "\\n"; continue; }
+			out += c;
+		}
+		return out;
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
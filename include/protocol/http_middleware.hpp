@@ -0,0 +1,411 @@
+/**
+ * @file http_middleware.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Compile-time middleware chains with a per-request arena
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+#include <array>
+
+#include "http.hpp"
+
+namespace etherz {
+namespace protocol {
+
+// ═══════════════════════════════════════════════
+//  Request Arena
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Bump allocator for per-request scratch memory
+ *
+ * Allocation is a pointer bump; deallocation is a no-op. reset() rewinds
+ * to the first block but keeps every block, so after warm-up a request
+ * served through the same arena never touches the heap. Usable as a
+ * std::pmr::memory_resource for pmr containers.
+ */
+class RequestArena final : public std::pmr::memory_resource {
+public:
+	explicit RequestArena(size_t block_size = 4096) : block_size_(std::max<size_t>(block_size, 64)) {}
+
+	RequestArena(const RequestArena&) = delete;
+	RequestArena& operator=(const RequestArena&) = delete;
+
+	/// Rewind to empty, keeping allocated blocks for reuse
+	void reset() noexcept {
+		current_ = 0;
+		offset_ = 0;
+	}
+
+	/// Copy s into the arena
+	std::string_view copy(std::string_view s) {
+		if (s.empty()) return {};
+		auto* p = static_cast<char*>(allocate(s.size(), 1));
+		std::memcpy(p, s.data(), s.size());
+		return {p, s.size()};
+	}
+
+	/**
+	 * @brief Construct a T in the arena (never destroyed, so T must be trivially destructible)
+	 */
+	template <typename T, typename... Args>
+	T* make(Args&&... args) {
+		static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+		return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/// Bytes handed out since the last reset
+	size_t used() const noexcept {
+		size_t n = offset_;
+		for (size_t i = 0; i < current_ && i < blocks_.size(); ++i) n += blocks_[i].size;
+		return n;
+	}
+
+	/// Bytes held across all blocks
+	size_t capacity() const noexcept {
+		size_t n = 0;
+		for (const auto& b : blocks_) n += b.size;
+		return n;
+	}
+
+private:
+	struct Block {
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+	};
+
+	size_t block_size_;
+	std::vector<Block> blocks_;
+	size_t current_ = 0;  // Block being filled
+	size_t offset_ = 0;   // Bytes used in the current block
+
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		// Fill retained blocks in order before growing
+		for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+			if (auto* p = carve(blocks_[current_], bytes, alignment)) return p;
+		}
+		// Doubling keeps the block count logarithmic in peak usage
+		size_t size = std::max(bytes + alignment, blocks_.empty() ? block_size_ : blocks_.back().size * 2);
+		blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+		current_ = blocks_.size() - 1;
+		offset_ = 0;
+		return carve(blocks_.back(), bytes, alignment);
+	}
+
+	void* carve(Block& b, size_t bytes, size_t alignment) noexcept {
+		auto base = reinterpret_cast<uintptr_t>(b.data.get());
+		auto aligned = (base + offset_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		if (aligned + bytes > base + b.size) return nullptr;
+		offset_ = aligned + bytes - base;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	void do_deallocate(void*, size_t, size_t) override {}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// ═══════════════════════════════════════════════
+//  Request Context
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Per-request state shared along a middleware chain
+ *
+ * Values set here (request id, authenticated user, ...) are copied into
+ * the request arena and live until the request finishes. Keys are not
+ * copied and must outlive the request (string literals in practice).
+ */
+class RequestContext {
+public:
+	explicit RequestContext(RequestArena& arena) noexcept : arena_(arena) {}
+
+	RequestContext(const RequestContext&) = delete;
+	RequestContext& operator=(const RequestContext&) = delete;
+
+	RequestArena& arena() noexcept { return arena_; }
+
+	void set(std::string_view key, std::string_view value) {
+		auto v = arena_.copy(value);
+		for (size_t i = 0; i < size_; ++i) {
+			if (values_[i].first == key) { values_[i].second = v; return; }
+		}
+		if (size_ == capacity_) grow();
+		values_[size_++] = {key, v};
+	}
+
+	std::string_view get(std::string_view key) const noexcept {
+		for (size_t i = 0; i < size_; ++i) {
+			if (values_[i].first == key) return values_[i].second;
+		}
+		return {};
+	}
+
+private:
+	using Entry = std::pair<std::string_view, std::string_view>;
+	static constexpr size_t INLINE_VALUES = 8;
+
+	RequestArena& arena_;
+	std::array<Entry, INLINE_VALUES> inline_{};
+	Entry* values_ = inline_.data();
+	size_t size_ = 0;
+	size_t capacity_ = INLINE_VALUES;
+
+	void grow() {
+		auto* bigger = static_cast<Entry*>(arena_.allocate(sizeof(Entry) * capacity_ * 2, alignof(Entry)));
+		std::copy(values_, values_ + size_, bigger);
+		values_ = bigger;
+		capacity_ *= 2;
+	}
+};
+
+/**
+ * @brief Handler shape at the end of a middleware chain
+ */
+using ContextHandler = std::function<HttpResponse(const HttpRequest&, RequestContext&)>;
+
+// ═══════════════════════════════════════════════
+//  Middleware Chain
+// ═══════════════════════════════════════════════
+
+namespace middleware_detail {
+
+struct ArenaSlot {
+	RequestArena arena;
+	int depth = 0;   // Chains entered on this thread and not yet returned
+};
+
+inline ArenaSlot& thread_arena() {
+	thread_local ArenaSlot slot;
+	return slot;
+}
+
+} // namespace middleware_detail
+
+/**
+ * @brief A fixed sequence of middlewares composed at compile time
+ *
+ * A middleware is any callable taking (const HttpRequest&, RequestContext&,
+ * Next&& next) and returning HttpResponse; calling next() runs the rest of
+ * the chain, not calling it short-circuits. Because every link is a
+ * concrete type, the whole chain inlines into the wrapping handler: the
+ * only indirect call per request is the HttpHandler itself.
+ *
+ * @code
+ * auto chain = make_middleware(RequestIdMiddleware{}, CorsMiddleware{"*"});
+ * server.get("/users", chain.wrap([](const HttpRequest& req, RequestContext& ctx) { ... }));
+ * @endcode
+ */
+template <typename... Middlewares>
+class MiddlewareChain {
+public:
+	explicit MiddlewareChain(Middlewares... mws) : mws_(std::move(mws)...) {}
+
+	/**
+	 * @brief Run the chain around handler(req, ctx)
+	 */
+	template <typename Handler>
+	HttpResponse operator()(const HttpRequest& req, RequestContext& ctx, Handler& handler) {
+		return invoke<0>(req, ctx, handler);
+	}
+
+	/**
+	 * @brief Append more middlewares, producing a new chain type
+	 */
+	template <typename... More>
+	MiddlewareChain<Middlewares..., More...> then(More... more) const {
+		return std::apply([&](const auto&... mine) {
+			return MiddlewareChain<Middlewares..., More...>(mine..., std::move(more)...);
+		}, mws_);
+	}
+
+	/**
+	 * @brief Bind the chain to a (request, context) handler as an HttpHandler
+	 *
+	 * Each call borrows the calling thread's arena, reset between requests
+	 * (nested chains on the same thread share it without resetting).
+	 */
+	template <typename Handler>
+	std::function<HttpResponse(const HttpRequest&)> wrap(Handler handler) const {
+		return [chain = *this, handler = std::move(handler)](const HttpRequest& req) mutable {
+			auto& slot = middleware_detail::thread_arena();
+			if (slot.depth == 0) slot.arena.reset();
+			// Left even when the chain throws, so the next request resets the arena
+			struct Leave {
+				int& depth;
+				~Leave() { --depth; }
+			} leave{++slot.depth};
+			RequestContext ctx(slot.arena);
+			return chain(req, ctx, handler);
+		};
+	}
+
+	static constexpr size_t size() noexcept { return sizeof...(Middlewares); }
+
+private:
+	std::tuple<Middlewares...> mws_;
+
+	template <size_t I, typename Handler>
+	HttpResponse invoke(const HttpRequest& req, RequestContext& ctx, Handler& handler) {
+		if constexpr (I == sizeof...(Middlewares)) {
+			return handler(req, ctx);
+		} else {
+			return std::get<I>(mws_)(req, ctx, [&]() -> HttpResponse {
+				return invoke<I + 1>(req, ctx, handler);
+			});
+		}
+	}
+};
+
+/**
+ * @brief Compose middlewares into a chain, outermost first
+ */
+template <typename... Middlewares>
+MiddlewareChain<std::decay_t<Middlewares>...> make_middleware(Middlewares&&... mws) {
+	return MiddlewareChain<std::decay_t<Middlewares>...>(std::forward<Middlewares>(mws)...);
+}
+
+// ═══════════════════════════════════════════════
+//  Built-in Middlewares
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Propagate or assign X-Request-ID (context key "request_id")
+ */
+struct RequestIdMiddleware {
+	std::string header = "X-Request-ID";
+
+	template <typename Next>
+	HttpResponse operator()(const HttpRequest& req, RequestContext& ctx, Next&& next) {
+		auto id = req.headers.get(header);
+		if (id.empty()) {
+			static thread_local uint64_t counter = 0;
+			char buf[32];
+			auto tid = std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xffff;
+			auto n = std::snprintf(buf, sizeof(buf), "%04zx-%012llx", static_cast<size_t>(tid),
+				static_cast<unsigned long long>(++counter));
+			id = std::string_view(buf, static_cast<size_t>(n));
+		}
+		ctx.set("request_id", id);
+		auto resp = next();
+		resp.headers.set(header, std::string(ctx.get("request_id")));
+		return resp;
+	}
+};
+
+/**
+ * @brief CORS: answer preflight OPTIONS requests and tag responses for allowed origins
+ */
+struct CorsMiddleware {
+	std::string allow_origin = "*";            ///< "*" or one exact origin
+	std::string allow_methods = "GET, POST, PUT, PATCH, DELETE, OPTIONS";
+	std::string allow_headers = "Content-Type, Authorization";
+	uint32_t max_age = 600;
+
+	template <typename Next>
+	HttpResponse operator()(const HttpRequest& req, RequestContext&, Next&& next) {
+		auto origin = req.headers.get("Origin");
+		bool allowed = !origin.empty() && (allow_origin == "*" || origin == allow_origin);
+		if (req.method == HttpMethod::Options && allowed && req.headers.has("Access-Control-Request-Method")) {
+			HttpResponse resp;
+			resp.status = HttpStatus::NoContent;
+			tag(resp);
+			resp.headers.set("Access-Control-Allow-Methods", allow_methods);
+			resp.headers.set("Access-Control-Allow-Headers", allow_headers);
+			resp.headers.set("Access-Control-Max-Age", std::to_string(max_age));
+			return resp;
+		}
+		auto resp = next();
+		if (allowed) tag(resp);
+		return resp;
+	}
+
+private:
+	void tag(HttpResponse& resp) const {
+		resp.headers.set("Access-Control-Allow-Origin", allow_origin);
+		if (allow_origin == "*") return;
+		// Add to what the handler or an inner middleware already varies on
+		auto vary = resp.headers.get("Vary");
+		if (vary.empty()) {
+			resp.headers.set("Vary", "Origin");
+		} else if (!detail::icontains(vary, "Origin") && vary != "*") {
+			resp.headers.set("Vary", std::string(vary) + ", Origin");
+		}
+	}
+};
+
+/**
+ * @brief Reject requests whose "Authorization: Bearer <token>" fails check (context key "principal")
+ *
+ * Check is any callable (std::string_view token) -> std::optional-like or
+ * bool; a truthy result admits the request.
+ */
+template <typename Check>
+struct BearerAuthMiddleware {
+	Check check;
+
+	template <typename Next>
+	HttpResponse operator()(const HttpRequest& req, RequestContext& ctx, Next&& next) {
+		auto auth = detail::trim(req.headers.get("Authorization"));
+		constexpr std::string_view scheme = "Bearer ";
+		if (auth.size() > scheme.size() && detail::iequals(auth.substr(0, scheme.size()), scheme)) {
+			auto token = detail::trim(auth.substr(scheme.size()));
+			if (check(token)) {
+				ctx.set("principal", token);
+				return next();
+			}
+		}
+		HttpResponse resp;
+		resp.status = HttpStatus::Unauthorized;
+		resp.headers.set("WWW-Authenticate", "Bearer");
+		resp.headers.set("Content-Type", "text/plain");
+		resp.body = "401 Unauthorized";
+		return resp;
+	}
+};
+
+template <typename Check>
+BearerAuthMiddleware(Check) -> BearerAuthMiddleware<Check>;
+
+/**
+ * @brief Call sink(req, resp, elapsed) after every request
+ */
+template <typename Sink>
+struct AccessLogMiddleware {
+	Sink sink;
+
+	template <typename Next>
+	HttpResponse operator()(const HttpRequest& req, RequestContext&, Next&& next) {
+		auto start = std::chrono::steady_clock::now();
+		auto resp = next();
+		sink(req, resp, std::chrono::steady_clock::now() - start);
+		return resp;
+	}
+};
+
+template <typename Sink>
+AccessLogMiddleware(Sink) -> AccessLogMiddleware<Sink>;
+
+} // namespace protocol
+} // namespace etherz
@@ -0,0 +1,877 @@
+/**
+ * @file http_proxy.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Reverse-proxy building blocks: upstream connection pool and streaming exchange
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <optional>
+#include <chrono>
+#include <format>
+#include <algorithm>
+
+#include "http.hpp"
+#include "../async/event_loop.hpp"
+#include "../async/timer_wheel.hpp"
+#include "../net/socket.hpp"
+#include "../net/socket_address.hpp"
+#include "../net/internet_protocol.hpp"
+#include "../net/splice.hpp"
+#include "../core/error.hpp"
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief Set of interchangeable upstream servers behind one proxied prefix
+ */
+struct UpstreamCluster {
+	std::vector<net::SocketAddress<net::Ip<4>>> endpoints;
+	/// Kept-alive connections held per endpoint between requests
+	size_t max_idle_per_endpoint = 32;
+	/// Idle connections older than this are closed instead of reused
+	std::chrono::milliseconds idle_timeout{30'000};
+};
+
+/**
+ * @brief How a proxied route forwards requests
+ *
+ * The buffer sizes are high-water marks, not allocations: once this many
+ * bytes wait for the slower side, reading from the faster side stops until
+ * half of them are sent. A large response_buffer lets a fast upstream hand
+ * off a whole response and go back to the pool while a slow client is
+ * still reading it.
+ */
+struct ProxyOptions {
+	/// Remove the route prefix from the path sent upstream
+	bool strip_prefix = false;
+	/// Request body bytes queued for the upstream before the client is paused
+	size_t request_buffer = 64 * 1024;
+	/// Response bytes queued for the client before the upstream is paused
+	size_t response_buffer = 64 * 1024;
+	/// Move Content-Length response bodies with splice(2) where available
+	bool splice = true;
+	/// Longest upstream silence while a response is awaited or streamed (504 before the head)
+	std::chrono::milliseconds response_timeout{30'000};
+	/// Add X-Forwarded-For and X-Forwarded-Proto
+	bool forwarded_headers = true;
+};
+
+namespace proxy_detail {
+	/// Fields that describe one connection rather than the message (RFC 9110 §7.6.1)
+	inline bool hop_by_hop(std::string_view name) noexcept {
+		constexpr std::string_view names[] = {
+			"Connection", "Keep-Alive", "Proxy-Connection", "Proxy-Authenticate",
+			"Proxy-Authorization", "TE", "Trailer", "Transfer-Encoding", "Upgrade",
+		};
+		for (auto n : names) {
+			if (detail::iequals(name, n)) return true;
+		}
+		return false;
+	}
+
+	/// name appears as a token of a Connection field value
+	inline bool listed(std::string_view connection, std::string_view name) noexcept {
+		while (!connection.empty()) {
+			auto comma = connection.find(',');
+			auto token = detail::trim(connection.substr(0, comma));
+			if (detail::iequals(token, name)) return true;
+			if (comma == std::string_view::npos) break;
+			connection.remove_prefix(comma + 1);
+		}
+		return false;
+	}
+
+	/// Calls f(name, value, line) for each field line of a message head (after the start line)
+	template <typename F>
+	void for_each_field(std::string_view head, F&& f) {
+		auto pos = head.find("\r\n");
+		while (pos != std::string_view::npos) {
+			pos += 2;
+			auto eol = head.find("\r\n", pos);
+			auto line = head.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+			auto colon = line.find(':');
+			if (colon != std::string_view::npos) f(line.substr(0, colon), detail::trim(line.substr(colon + 1)), line);
+			pos = eol;
+		}
+	}
+} // namespace proxy_detail
+
+// ═══════════════════════════════════════════════
+//  Upstream Pool
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief One connection to an upstream endpoint
+ */
+struct UpstreamConnection {
+	net::Socket<net::Ip<4>> socket;
+	size_t endpoint = 0;
+	bool reused = false;                          ///< Came from the idle list rather than a fresh connect
+	std::chrono::steady_clock::time_point idle_since;
+	net::SplicePipe pipe;                         ///< Opened on first splice, kept with the connection
+};
+
+/**
+ * @brief Kept-alive connections to the endpoints of an UpstreamCluster
+ *
+ * Endpoints are taken in turn; each keeps a LIFO list of idle connections
+ * so the warmest one is reused first. Idle connections stay registered on
+ * the loop, and one that turns readable (the upstream closed it or sent
+ * something unasked) is dropped on the spot, so a request is rarely sent
+ * down a dead connection. Event-loop thread only.
+ */
+class UpstreamPool {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	UpstreamPool(UpstreamCluster cluster, async::EventLoop& loop)
+		: cluster_(std::move(cluster)), loop_(loop), idle_(cluster_.endpoints.size()) {}
+
+	~UpstreamPool() {
+		for (auto& list : idle_) {
+			for (auto& c : list) loop_.remove(c->socket.native_handle());
+		}
+	}
+
+	UpstreamPool(const UpstreamPool&) = delete;
+	UpstreamPool& operator=(const UpstreamPool&) = delete;
+
+	/**
+	 * @brief An idle connection to the next endpoint, or a new one (possibly still connecting)
+	 * @return nullptr if the cluster is empty or the connect failed outright
+	 */
+	std::unique_ptr<UpstreamConnection> acquire() {
+		if (cluster_.endpoints.empty()) return nullptr;
+		auto endpoint = next_++ % cluster_.endpoints.size();
+		auto& list = idle_[endpoint];
+		auto now = Clock::now();
+		while (!list.empty()) {
+			auto conn = std::move(list.back());
+			list.pop_back();
+			if (now - conn->idle_since > cluster_.idle_timeout) {
+				loop_.remove(conn->socket.native_handle());
+				continue;
+			}
+			// Still registered with the pool's callback; the new owner replaces it
+			conn->reused = true;
+			++reused_;
+			return conn;
+		}
+		return connect(endpoint);
+	}
+
+	/**
+	 * @brief A fresh connection to endpoint, skipping idle ones
+	 */
+	std::unique_ptr<UpstreamConnection> connect(size_t endpoint) {
+		if (endpoint >= cluster_.endpoints.size()) return nullptr;
+		auto conn = std::make_unique<UpstreamConnection>();
+		conn->endpoint = endpoint;
+		if (core::is_error(conn->socket.create())) return nullptr;
+		if (core::is_error(conn->socket.set_nonblocking(true))) return nullptr;
+		conn->socket.set_no_delay(true); // Request pieces are forwarded as they arrive
+		auto err = conn->socket.connect(cluster_.endpoints[endpoint]);
+		if (core::is_error(err) && err != core::Error::WouldBlock) return nullptr;
+		++connected_;
+		return conn;
+	}
+
+	/**
+	 * @brief Keep a connection whose last exchange ended cleanly
+	 */
+	void release(std::unique_ptr<UpstreamConnection> conn) {
+		auto fd = conn->socket.native_handle();
+		auto& list = idle_[conn->endpoint];
+		if (list.size() >= cluster_.max_idle_per_endpoint) {
+			loop_.remove(fd);
+			return;
+		}
+		conn->idle_since = Clock::now();
+		conn->reused = false;
+		loop_.add(fd, async::PollEvent::ReadReady,
+			[this](net::impl::socket_t ready, async::PollEvent) { drop_idle(ready); });
+		list.push_back(std::move(conn));
+	}
+
+	size_t idle_count() const noexcept {
+		size_t n = 0;
+		for (const auto& list : idle_) n += list.size();
+		return n;
+	}
+
+	/// Connections opened so far
+	uint64_t connect_count() const noexcept { return connected_; }
+	/// Requests sent over an idle connection instead of a new one
+	uint64_t reuse_count() const noexcept { return reused_; }
+
+	const UpstreamCluster& cluster() const noexcept { return cluster_; }
+
+private:
+	UpstreamCluster cluster_;
+	async::EventLoop& loop_;
+	std::vector<std::vector<std::unique_ptr<UpstreamConnection>>> idle_;
+	size_t next_ = 0;
+	uint64_t connected_ = 0;
+	uint64_t reused_ = 0;
+
+	/// An idle connection spoke or hung up, so it cannot carry another request
+	void drop_idle(net::impl::socket_t fd) {
+		for (auto& list : idle_) {
+			auto it = std::find_if(list.begin(), list.end(),
+				[fd](const auto& c) { return c->socket.native_handle() == fd; });
+			if (it == list.end()) continue;
+			// Only ours to remove while idle: a callback from an older poll may name a reused fd
+			loop_.remove(fd);
+			list.erase(it);
+			return;
+		}
+	}
+};
+
+// ═══════════════════════════════════════════════
+//  Exchange
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief How a proxied exchange ended
+ */
+struct ProxyResult {
+	/// Answer for the client when the upstream failed before its response began
+	std::optional<HttpResponse> error;
+	HttpStatus status = HttpStatus::OK;
+	/// The client connection may carry another request
+	bool keep_alive = true;
+	/// Failed after the response began: close the client connection
+	bool broken = false;
+	uint64_t bytes_up = 0;   ///< Request body bytes forwarded
+	uint64_t bytes_down = 0; ///< Response bytes forwarded (head and body)
+};
+
+/**
+ * @brief Client side of an exchange, supplied by the server
+ */
+struct ProxyDownstream {
+	net::impl::socket_t fd = net::impl::invalid_socket; ///< Spliced into once nothing else is queued
+	std::function<void(std::string_view)> write;        ///< Queue bytes for the client and send what it takes
+	std::function<void()> flush;                        ///< Send queued (and spliced) bytes
+	std::function<size_t()> queued;                     ///< Bytes queued for the client, not yet sent
+	std::function<void()> resume_request;               ///< The client body may be read again
+	std::function<void(ProxyResult)> done;              ///< Called once, unless cancelled
+};
+
+/**
+ * @brief One request forwarded upstream and its response streamed back
+ *
+ * The request head is rewritten (hop-by-hop fields dropped, forwarding
+ * fields added) and sent as soon as it is parsed; body pieces follow as
+ * the client sends them, re-chunked if they arrived chunked. The response
+ * is passed through with its own framing: Content-Length and chunked
+ * bodies are forwarded as received, so nothing is decoded or buffered
+ * whole. Content-Length bodies that start on a fresh read are spliced
+ * socket to socket where the platform allows.
+ *
+ * A request that finds its reused connection already closed is retried
+ * once on a new one, provided no body byte has been sent. Otherwise an
+ * upstream failure before the response head becomes 502 (504 on timeout);
+ * after it, the client connection is broken off. Event-loop thread only.
+ */
+class ProxyExchange : public std::enable_shared_from_this<ProxyExchange> {
+public:
+	ProxyExchange(std::shared_ptr<UpstreamPool> pool, ProxyOptions options, async::EventLoop& loop,
+		ProxyDownstream downstream)
+		: pool_(std::move(pool)), options_(options), loop_(loop), downstream_(std::move(downstream)) {}
+
+	~ProxyExchange() { close_upstream(); }
+
+	ProxyExchange(const ProxyExchange&) = delete;
+	ProxyExchange& operator=(const ProxyExchange&) = delete;
+
+	/**
+	 * @brief Send the request head upstream
+	 * @param target     Request target for the upstream (path and query)
+	 * @param chunked    The body arrives decoded from chunked coding and is re-chunked
+	 * @param keep_alive The client wants its connection kept open
+	 * @param client     Client address, for X-Forwarded-For
+	 */
+	void start(const HttpRequest& req, std::string_view target, bool chunked, bool keep_alive, std::string_view client) {
+		head_only_ = req.method == HttpMethod::Head;
+		client_http10_ = req.version == "HTTP/1.0";
+		client_keep_alive_ = keep_alive;
+		chunked_ = chunked;
+		timer_.callback = [weak = weak_from_this()] {
+			if (auto self = weak.lock()) self->on_timeout();
+		};
+
+		auto connection = req.headers.get("Connection");
+		std::string_view forwarded_for;
+		auto& head = request_head_;
+		head = std::format("{} {} HTTP/1.1\r\n", method_string(req.method), target);
+		for (const auto& [name, value] : req.headers.entries()) {
+			if (proxy_detail::hop_by_hop(name) || proxy_detail::listed(connection, name)) continue;
+			if (detail::iequals(name, "Expect")) continue; // Already answered with 100 Continue
+			if (chunked && detail::iequals(name, "Content-Length")) continue;
+			if (options_.forwarded_headers && detail::iequals(name, "X-Forwarded-For")) {
+				forwarded_for = value;
+				continue;
+			}
+			head += name;
+			head += ": ";
+			head += value;
+			head += "\r\n";
+		}
+		if (options_.forwarded_headers) {
+			head += "X-Forwarded-For: ";
+			if (!forwarded_for.empty()) {
+				head += forwarded_for;
+				head += ", ";
+			}
+			head += client;
+			head += "\r\nX-Forwarded-Proto: http\r\n";
+		}
+		if (chunked) head += "Transfer-Encoding: chunked\r\n";
+		head += "\r\n";
+
+		up_out_ = head;
+		attach(pool_->acquire());
+	}
+
+	/**
+	 * @brief Forward a piece of the request body
+	 * @return true if the client should be paused until resume_request()
+	 */
+	bool send_body(std::string_view data) {
+		if (finished_ || data.empty()) return false;
+		compact_output();
+		if (chunked_) {
+			up_out_ += std::format("{:x}\r\n", data.size());
+			up_out_.append(data);
+			up_out_ += "\r\n";
+		} else {
+			up_out_.append(data);
+		}
+		bytes_up_ += data.size();
+		body_started_ = true;
+		if (!connecting_) flush_upstream();
+		if (finished_ || upstream_queued() < options_.request_buffer) return false;
+		request_paused_ = true;
+		return true;
+	}
+
+	/**
+	 * @brief The whole request body has been forwarded
+	 */
+	void end_request() {
+		if (finished_ || request_done_) return;
+		request_done_ = true;
+		if (chunked_) {
+			compact_output();
+			up_out_ += "0\r\n\r\n";
+		}
+		if (!connecting_) flush_upstream();
+		maybe_complete();
+	}
+
+	/**
+	 * @brief The client went away: drop the upstream connection, report nothing
+	 */
+	void cancel() noexcept {
+		finished_ = true;
+		loop_.timers().cancel(timer_);
+		close_upstream();
+	}
+
+	/// Spliced response bytes wait for the client socket
+	bool pending_splice() const noexcept { return upstream_ && upstream_->pipe.size() > 0; }
+
+	/**
+	 * @brief Move spliced bytes to the client; the server calls this once its own queue is empty
+	 * @return Bytes moved, -1 on a hard error
+	 */
+	int64_t drain_splice() {
+		if (!pending_splice()) return 0;
+		auto n = upstream_->pipe.drain(downstream_.fd);
+		if (n < 0) return core::last_platform_error() == core::Error::WouldBlock ? 0 : -1;
+		bytes_down_ += static_cast<uint64_t>(n);
+		if (!pending_splice()) maybe_complete();
+		return n;
+	}
+
+	/**
+	 * @brief The client took some bytes: resume reading the upstream once below the low-water mark
+	 */
+	void client_progress() {
+		if (!read_paused_ || finished_) return;
+		if (client_backlog() > options_.response_buffer / 2) return;
+		read_paused_ = false;
+		loop_.timers().schedule(timer_, options_.response_timeout);
+		update_interest();
+	}
+
+	bool finished() const noexcept { return finished_; }
+
+private:
+	enum class Framing : uint8_t { None, Length, Chunked, Close };
+
+	std::shared_ptr<UpstreamPool> pool_;
+	ProxyOptions options_;
+	async::EventLoop& loop_;
+	ProxyDownstream downstream_;
+	std::unique_ptr<UpstreamConnection> upstream_;
+	async::Timer timer_;
+	async::PollEvent interest_ = async::PollEvent::None;
+
+	// Request direction
+	std::string request_head_;      // Kept for one retry on a stale connection
+	std::string up_out_;
+	size_t up_out_offset_ = 0;
+	bool chunked_ = false;
+	bool connecting_ = false;
+	bool body_started_ = false;
+	bool request_done_ = false;
+	bool request_paused_ = false;
+	bool retried_ = false;
+
+	// Response direction
+	std::string up_in_;
+	std::string staged_;            // Response head waiting for the body bytes read with it
+	bool head_only_ = false;
+	bool client_http10_ = false;
+	bool client_keep_alive_ = true;
+	bool head_parsed_ = false;
+	bool head_sent_ = false;
+	bool body_done_ = false;
+	bool upstream_keep_alive_ = true;
+	bool dechunk_ = false;          // HTTP/1.0 client: forward chunk data only
+	bool read_paused_ = false;
+	bool finished_ = false;
+	Framing framing_ = Framing::None;
+	uint64_t remaining_ = 0;
+	http_parser::ChunkedDecoder decoder_;
+	HttpStatus status_ = HttpStatus::Unknown;
+	uint64_t bytes_up_ = 0;
+	uint64_t bytes_down_ = 0;
+
+	static constexpr size_t MAX_RESPONSE_HEAD = 64 * 1024;
+	static constexpr size_t READ_CHUNK = 16 * 1024;
+	static constexpr size_t READ_BATCH = 64 * 1024;
+
+	size_t upstream_queued() const noexcept { return up_out_.size() - up_out_offset_; }
+
+	size_t client_backlog() const {
+		return downstream_.queued() + (upstream_ ? upstream_->pipe.size() : 0);
+	}
+
+	void compact_output() {
+		if (up_out_offset_ == 0) return;
+		up_out_.erase(0, up_out_offset_);
+		up_out_offset_ = 0;
+	}
+
+	// ─── Upstream connection ────────────────
+
+	void attach(std::unique_ptr<UpstreamConnection> conn) {
+		if (!conn) {
+			fail(HttpStatus::BadGateway);
+			return;
+		}
+		upstream_ = std::move(conn);
+		// A fresh non-blocking connect is writable once established
+		connecting_ = !upstream_->reused;
+		interest_ = async::PollEvent::None;
+		update_interest();
+		loop_.timers().schedule(timer_, options_.response_timeout);
+		if (!connecting_) flush_upstream();
+	}
+
+	void close_upstream() noexcept {
+		if (!upstream_) return;
+		loop_.remove(upstream_->socket.native_handle());
+		upstream_.reset();
+	}
+
+	void update_interest() {
+		if (!upstream_) return;
+		auto interest = read_paused_ ? async::PollEvent::None : async::PollEvent::ReadReady;
+		if (connecting_ || upstream_queued() > 0) interest |= async::PollEvent::WriteReady;
+		if (interest == interest_) return;
+		interest_ = interest;
+		if (interest == async::PollEvent::None) {
+			// poll() still reports a hang-up for an fd with no interest; let it wait until resumed
+			loop_.remove(upstream_->socket.native_handle());
+			return;
+		}
+		loop_.add(upstream_->socket.native_handle(), interest,
+			[weak = weak_from_this()](net::impl::socket_t fd, async::PollEvent events) {
+				if (auto self = weak.lock()) self->on_upstream_event(fd, events);
+			});
+	}
+
+	void on_upstream_event(net::impl::socket_t fd, async::PollEvent events) {
+		// A callback from an older poll may name a connection handed back to the pool
+		if (finished_ || !upstream_ || upstream_->socket.native_handle() != fd) return;
+		auto self = shared_from_this();
+		if (has_event(events, async::PollEvent::WriteReady) || (connecting_ && events != async::PollEvent::None)) {
+			connecting_ = false;
+			flush_upstream();
+			if (finished_) return;
+		}
+		if (has_event(events, async::PollEvent::ReadReady) || has_event(events, async::PollEvent::HangUp)
+			|| has_event(events, async::PollEvent::Error)) {
+			read_upstream();
+		}
+	}
+
+	void flush_upstream() {
+		while (upstream_queued() > 0) {
+			auto data = std::string_view(up_out_).substr(up_out_offset_);
+			int n = upstream_->socket.send(std::span<const uint8_t>(
+				reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+			if (n > 0) {
+				up_out_offset_ += static_cast<size_t>(n);
+				continue;
+			}
+			if (n < 0 && core::last_platform_error() == core::Error::WouldBlock) break;
+			upstream_failed();
+			return;
+		}
+		if (upstream_queued() == 0) {
+			up_out_.clear();
+			up_out_offset_ = 0;
+		}
+		update_interest();
+		if (request_paused_ && upstream_queued() <= options_.request_buffer / 2) {
+			request_paused_ = false;
+			downstream_.resume_request();
+		}
+	}
+
+	void read_upstream() {
+		bool fresh = false; // Bytes read since the last process_response()
+		while (!finished_ && !read_paused_) {
+			if (can_splice()) {
+				splice_body();
+				return;
+			}
+			size_t old_size = up_in_.size();
+			up_in_.resize(old_size + READ_CHUNK);
+			int n = upstream_->socket.recv(std::span<uint8_t>(
+				reinterpret_cast<uint8_t*>(up_in_.data() + old_size), READ_CHUNK));
+			up_in_.resize(old_size + static_cast<size_t>(n > 0 ? n : 0));
+			if (n > 0) {
+				loop_.timers().schedule(timer_, options_.response_timeout);
+				fresh = true;
+				// A full read means more is waiting: forward it in one larger write
+				if (static_cast<size_t>(n) == READ_CHUNK && up_in_.size() < READ_BATCH) continue;
+				fresh = false;
+				process_response();
+				continue;
+			}
+			bool would_block = n < 0 && core::last_platform_error() == core::Error::WouldBlock;
+			if (fresh) process_response();
+			if (would_block || finished_) return;
+			upstream_eof();
+			return;
+		}
+	}
+
+	/**
+	 * @brief The upstream closed (or reset) the connection
+	 */
+	void upstream_eof() {
+		if (head_sent_ && framing_ == Framing::Close) {
+			body_done_ = true;
+			upstream_keep_alive_ = false;
+			maybe_complete();
+			return;
+		}
+		upstream_failed();
+	}
+
+	void upstream_failed() {
+		if (finished_) return;
+		bool untouched = !head_parsed_ && up_in_.empty() && !body_started_;
+		if (upstream_ && upstream_->reused && untouched && !retried_) {
+			// Most likely closed by the upstream while idle: one retry on a new connection
+			retried_ = true;
+			auto endpoint = upstream_->endpoint;
+			close_upstream();
+			up_out_ = request_head_;
+			up_out_offset_ = 0;
+			if (request_done_ && chunked_) up_out_ += "0\r\n\r\n";
+			attach(pool_->connect(endpoint));
+			return;
+		}
+		if (!head_sent_) fail(HttpStatus::BadGateway);
+		else abort_response();
+	}
+
+	void on_timeout() {
+		if (finished_) return;
+		if (!head_sent_) fail(HttpStatus::GatewayTimeout);
+		else abort_response();
+	}
+
+	// ─── Response ────────────────
+
+	void process_response() {
+		while (!finished_) {
+			if (!head_parsed_) {
+				auto end = up_in_.find("\r\n\r\n");
+				if (end == std::string::npos) {
+					if (up_in_.size() > MAX_RESPONSE_HEAD) fail(HttpStatus::BadGateway);
+					return;
+				}
+				bool interim = false;
+				std::string client_head;
+				if (!parse_head(std::string_view(up_in_).substr(0, end + 2), interim, client_head)) {
+					fail(HttpStatus::BadGateway);
+					return;
+				}
+				up_in_.erase(0, end + 4);
+				if (interim) continue; // 1xx: the final response follows
+				head_parsed_ = true;
+				head_sent_ = true;
+				bytes_down_ += client_head.size();
+				staged_ = std::move(client_head); // Leaves with the first body bytes
+			}
+			forward_body();
+			return;
+		}
+	}
+
+	/**
+	 * @brief Parse the upstream's response head and build the one sent to the client
+	 * @param head Status line and fields, ending with the last field's CRLF
+	 */
+	bool parse_head(std::string_view head, bool& interim, std::string& out) {
+		if (head.size() < 12 || !head.starts_with("HTTP/1.")) return false;
+		int code = 0;
+		for (char c : head.substr(9, 3)) {
+			if (c < '0' || c > '9') return false;
+			code = code * 10 + (c - '0');
+		}
+		interim = code / 100 == 1;
+		if (interim) return true;
+		status_ = static_cast<HttpStatus>(code);
+		upstream_keep_alive_ = head[7] != '0';
+
+		std::string_view connection;
+		bool chunked = false;
+		std::optional<uint64_t> length;
+		proxy_detail::for_each_field(head, [&](std::string_view name, std::string_view value, std::string_view) {
+			if (detail::iequals(name, "Connection")) connection = value;
+			else if (detail::iequals(name, "Transfer-Encoding")) chunked = detail::icontains(value, "chunked");
+			else if (detail::iequals(name, "Content-Length")) {
+				uint64_t n = 0;
+				for (char c : value) {
+					if (c < '0' || c > '9') return;
+					n = n * 10 + static_cast<uint64_t>(c - '0');
+				}
+				length = n;
+			}
+		});
+		if (proxy_detail::listed(connection, "close")) upstream_keep_alive_ = false;
+		else if (proxy_detail::listed(connection, "keep-alive")) upstream_keep_alive_ = true;
+
+		if (head_only_ || code == 204 || code == 304) framing_ = Framing::None;
+		else if (chunked) framing_ = Framing::Chunked;
+		else if (length) framing_ = *length > 0 ? Framing::Length : Framing::None;
+		else framing_ = Framing::Close;
+		remaining_ = framing_ == Framing::Length ? *length : 0;
+		dechunk_ = framing_ == Framing::Chunked && client_http10_;
+		if (framing_ == Framing::Close || dechunk_ || !request_done_) client_keep_alive_ = false;
+
+		auto line_end = head.find("\r\n");
+		out = "HTTP/1.1";
+		out.append(head.substr(8, line_end - 8));
+		out += "\r\n";
+		proxy_detail::for_each_field(head, [&](std::string_view name, std::string_view, std::string_view line) {
+			if (proxy_detail::hop_by_hop(name) || proxy_detail::listed(connection, name)) return;
+			out.append(line);
+			out += "\r\n";
+		});
+		if (framing_ == Framing::Chunked && !dechunk_) out += "Transfer-Encoding: chunked\r\n";
+		if (!client_keep_alive_) out += "Connection: close\r\n";
+		out += "\r\n";
+		return true;
+	}
+
+	void forward_body() {
+		std::string_view in = up_in_;
+		size_t used = 0;
+		switch (framing_) {
+			case Framing::None:
+				body_done_ = true;
+				break;
+			case Framing::Length: {
+				used = static_cast<size_t>(std::min<uint64_t>(remaining_, in.size()));
+				remaining_ -= used;
+				body_done_ = remaining_ == 0;
+				if (used > 0) write_body(in.substr(0, used));
+				break;
+			}
+			case Framing::Chunked: {
+				std::string_view data;
+				while (used < in.size() && !decoder_.done()) {
+					size_t n = decoder_.decode(in.substr(used), data);
+					if (decoder_.failed() || n == 0) break;
+					if (dechunk_ && !data.empty()) write_body(data);
+					used += n;
+				}
+				if (decoder_.failed()) {
+					abort_response();
+					return;
+				}
+				if (!dechunk_ && used > 0) write_body(in.substr(0, used));
+				body_done_ = decoder_.done();
+				break;
+			}
+			case Framing::Close:
+				used = in.size();
+				if (used > 0) write_body(in);
+				break;
+		}
+		if (finished_) return;
+		emit();
+		if (finished_) return;
+		up_in_.erase(0, used);
+		// Bytes past the end of the response: the connection is out of step
+		if (body_done_ && !up_in_.empty()) upstream_keep_alive_ = false;
+		maybe_complete();
+		if (!finished_ && client_backlog() >= options_.response_buffer) pause_reading();
+	}
+
+	/**
+	 * @brief Stop reading the upstream until the client catches up; its silence is not a timeout meanwhile
+	 */
+	void pause_reading() {
+		read_paused_ = true;
+		loop_.timers().cancel(timer_);
+		update_interest();
+	}
+
+	void write_body(std::string_view data) {
+		bytes_down_ += data.size();
+		if (!staged_.empty()) staged_.append(data);
+		else downstream_.write(data);
+	}
+
+	/**
+	 * @brief Send the staged response head, and whatever body joined it, in one write
+	 *
+	 * Separate small writes of head and body would meet Nagle's algorithm
+	 * at the client and wait out its delayed ACK.
+	 */
+	void emit() {
+		if (staged_.empty()) return;
+		auto data = std::move(staged_);
+		staged_.clear();
+		downstream_.write(data);
+	}
+
+	/**
+	 * @brief The rest of a Content-Length body can go socket to socket
+	 */
+	bool can_splice() const noexcept {
+		return options_.splice && net::SplicePipe::supported() && head_sent_
+			&& framing_ == Framing::Length && remaining_ > 0 && up_in_.empty();
+	}
+
+	void splice_body() {
+		auto& pipe = upstream_->pipe;
+		if (!pipe.open()) {
+			options_.splice = false; // Copy instead; read_upstream() picks it up next time
+			return;
+		}
+		auto fd = upstream_->socket.native_handle();
+		while (remaining_ > 0 && !finished_) {
+			if (client_backlog() >= options_.response_buffer) break;
+			auto n = pipe.fill(fd, static_cast<size_t>(remaining_));
+			if (n > 0) {
+				remaining_ -= static_cast<uint64_t>(n);
+				loop_.timers().schedule(timer_, options_.response_timeout);
+				downstream_.flush();
+				continue;
+			}
+			if (n < 0 && core::last_platform_error() == core::Error::WouldBlock) {
+				// An empty socket waits for readiness; a full pipe waits for the client
+				if (pipe.size() == 0) return;
+				break;
+			}
+			abort_response(); // The upstream ended the body early
+			return;
+		}
+		if (finished_) return;
+		body_done_ = remaining_ == 0;
+		maybe_complete();
+		if (!finished_ && !body_done_) pause_reading();
+	}
+
+	// ─── Completion ────────────────
+
+	void maybe_complete() {
+		if (finished_ || !body_done_ || pending_splice()) return;
+		if (!request_done_) {
+			// Answered before the request body was read: neither connection can be reused
+			client_keep_alive_ = false;
+			upstream_keep_alive_ = false;
+		}
+		ProxyResult result;
+		result.status = status_;
+		result.keep_alive = client_keep_alive_;
+		finish(std::move(result));
+	}
+
+	void fail(HttpStatus status) {
+		upstream_keep_alive_ = false;
+		HttpResponse resp;
+		resp.status = status;
+		resp.headers.set("Content-Type", "text/plain");
+		resp.body = std::to_string(static_cast<uint16_t>(status)) + " " + std::string(status_text(status));
+		ProxyResult result;
+		result.status = status;
+		result.error = std::move(resp);
+		result.keep_alive = request_done_ && client_keep_alive_;
+		finish(std::move(result));
+	}
+
+	void abort_response() {
+		upstream_keep_alive_ = false;
+		ProxyResult result;
+		result.status = status_;
+		result.keep_alive = false;
+		result.broken = true;
+		finish(std::move(result));
+	}
+
+	void finish(ProxyResult result) {
+		finished_ = true;
+		loop_.timers().cancel(timer_);
+		bool reusable = upstream_ && upstream_keep_alive_ && body_done_ && request_done_
+			&& framing_ != Framing::Close && upstream_queued() == 0 && up_in_.empty() && !pending_splice();
+		if (reusable) {
+			interest_ = async::PollEvent::None;
+			pool_->release(std::move(upstream_));
+		} else {
+			close_upstream();
+		}
+		result.bytes_up = bytes_up_;
+		result.bytes_down = bytes_down_;
+		if (downstream_.done) downstream_.done(std::move(result));
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
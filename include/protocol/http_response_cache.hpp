@@ -0,0 +1,423 @@
+/**
+ * @file http_response_cache.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Sharded in-memory cache of serialized server responses
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <span>
+#include <atomic>
+
+#include "http.hpp"
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief How responses of one cached route are keyed and how long they live
+ */
+struct ResponseCachePolicy {
+	/// Lifetime of a response that carries no max-age / s-maxage
+	std::chrono::milliseconds ttl{1'000};
+	/// Upper bound on any lifetime, including one from Cache-Control (zero: none)
+	std::chrono::milliseconds max_ttl{0};
+	/// Request headers whose values select a variant (part of the key)
+	std::vector<std::string> vary;
+};
+
+/**
+ * @brief Sizing of a ResponseCache
+ */
+struct ResponseCacheOptions {
+	size_t capacity_bytes = 32 * 1024 * 1024;  ///< Split evenly across shards
+	size_t shards = 16;
+};
+
+/**
+ * @brief Byte-bounded, sharded LRU of fully serialized responses
+ *
+ * Every entry holds the response both as wire bytes (status line, headers
+ * with Content-Length, body), so an HTTP/1.1 hit is queued for sending as
+ * is, and as an HttpResponse for HTTP/2 streams. Keys hash to a shard with
+ * its own lock and LRU list. fetch() is single-flight: concurrent misses on
+ * one key wait for the first caller's fill instead of producing the
+ * response again.
+ */
+class ResponseCache {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry {
+		std::string wire;
+		HttpResponse response;
+		Clock::time_point expires;
+
+		size_t bytes() const noexcept { return wire.size() + response.body.size(); }
+	};
+
+	using Handle = std::shared_ptr<const Entry>;
+
+	explicit ResponseCache(ResponseCacheOptions options = {})
+		: shards_(std::max<size_t>(options.shards, 1)),
+		  shard_capacity_(options.capacity_bytes / std::max<size_t>(options.shards, 1)),
+		  capacity_(options.capacity_bytes) {}
+
+	ResponseCache(const ResponseCache&) = delete;
+	ResponseCache& operator=(const ResponseCache&) = delete;
+
+	// ─── Policy ────────────────
+
+	/**
+	 * @brief Build the key for a request: method, path, vary values, coding
+	 * @param encoding Negotiated content coding, when responses are compressed
+	 */
+	static std::string make_key(const HttpRequest& req, const ResponseCachePolicy& policy,
+		std::string_view encoding = {}) {
+		auto method = method_string(req.method);
+		std::string key;
+		key.reserve(method.size() + req.path.size() + encoding.size() + 8);
+		key += method;
+		key += ' ';
+		key += req.path;
+		for (const auto& name : policy.vary) {
+			key += '\n';
+			key += req.headers.get(name);
+		}
+		key += '\n';
+		key += encoding;
+		return key;
+	}
+
+	/**
+	 * @brief How a request may use the cache, from its Cache-Control
+	 */
+	enum class Lookup : uint8_t {
+		Use,      ///< Serve a fresh entry or fill one
+		Refresh,  ///< no-cache / max-age=0: produce anew, then store
+		Bypass    ///< no-store or credentials: do not touch the cache
+	};
+
+	static Lookup request_lookup(const HttpRequest& req) noexcept {
+		if (req.headers.has("Authorization")) return Lookup::Bypass;
+		auto cc = req.headers.get("Cache-Control");
+		if (cc.empty()) {
+			return detail::icontains(req.headers.get("Pragma"), "no-cache") ? Lookup::Refresh : Lookup::Use;
+		}
+		if (directive(cc, "no-store")) return Lookup::Bypass;
+		if (directive(cc, "no-cache") || seconds(cc, "max-age") == 0) return Lookup::Refresh;
+		return Lookup::Use;
+	}
+
+	/**
+	 * @brief Lifetime of a response, or nullopt if it must not be stored
+	 *
+	 * Only statuses that are cacheable by default qualify. no-store,
+	 * no-cache and private responses, responses setting cookies, and a
+	 * Vary on a header the policy does not key on (other than
+	 * Accept-Encoding, which the server keys on itself) are not stored.
+	 * s-maxage wins over max-age; otherwise the policy TTL applies.
+	 */
+	static std::optional<std::chrono::milliseconds> freshness(const HttpResponse& resp,
+		const ResponseCachePolicy& policy) noexcept {
+		switch (resp.status) {
+			case HttpStatus::OK: case HttpStatus::NoContent: case HttpStatus::MovedPermanently:
+			case HttpStatus::NotFound: case HttpStatus::MethodNotAllowed: case HttpStatus::NotImplemented:
+				break;
+			default:
+				return std::nullopt;
+		}
+		if (resp.headers.has("Set-Cookie")) return std::nullopt;
+
+		auto cc = resp.headers.get("Cache-Control");
+		if (directive(cc, "no-store") || directive(cc, "no-cache") || directive(cc, "private")) return std::nullopt;
+		if (!vary_covered(resp.headers.get("Vary"), policy)) return std::nullopt;
+
+		std::chrono::milliseconds ttl = policy.ttl;
+		if (auto s = seconds(cc, "s-maxage")) ttl = std::chrono::seconds(*s);
+		else if (auto m = seconds(cc, "max-age")) ttl = std::chrono::seconds(*m);
+		if (policy.max_ttl.count() > 0) ttl = std::min(ttl, policy.max_ttl);
+		if (ttl.count() <= 0) return std::nullopt;
+		return ttl;
+	}
+
+	/**
+	 * @brief Serialize a response the way a kept-alive HTTP/1.1 connection sends it
+	 */
+	static Handle make_entry(HttpResponse resp, Clock::time_point expires) {
+		auto code = static_cast<uint16_t>(resp.status);
+		if (!resp.headers.has("Content-Length") && code >= 200 && code != 204 && code != 304) {
+			resp.headers.set("Content-Length", std::to_string(resp.body.size()));
+		}
+		auto entry = std::make_shared<Entry>();
+		entry->wire = resp.serialize();
+		entry->response = std::move(resp);
+		entry->expires = expires;
+		return entry;
+	}
+
+	// ─── Lookup and fill ────────────────
+
+	/**
+	 * @brief Fresh entry for key, or nullptr
+	 */
+	Handle find(const std::string& key, Clock::time_point now) {
+		auto& shard = shard_for(key);
+		std::lock_guard lock(shard.mutex);
+		auto hit = find_locked(shard, key, now);
+		if (hit) hits_.fetch_add(1, std::memory_order_relaxed);
+		return hit;
+	}
+
+	/**
+	 * @brief Store an entry unless it is already stale or larger than a shard
+	 */
+	void insert(std::string key, Handle entry, Clock::time_point now) {
+		if (!entry || entry->expires <= now || entry->bytes() > shard_capacity_) return;
+		auto& shard = shard_for(key);
+		std::lock_guard lock(shard.mutex);
+		insert_locked(shard, std::move(key), std::move(entry));
+	}
+
+	/**
+	 * @brief Return a fresh entry for key, calling fill() on a miss
+	 *
+	 * fill() returns a non-null entry; it is stored only if its expiry lies
+	 * in the future. While one caller fills a key, other callers for the
+	 * same key block and then share its entry, or, if the entry turned out
+	 * not to be storable, run fill() themselves.
+	 */
+	template <typename Fill>
+	Handle fetch(const std::string& key, Clock::time_point now, Fill&& fill) {
+		auto& shard = shard_for(key);
+		std::shared_ptr<Flight> flight;
+		bool leader = false;
+		{
+			std::lock_guard lock(shard.mutex);
+			if (auto hit = find_locked(shard, key, now)) {
+				hits_.fetch_add(1, std::memory_order_relaxed);
+				return hit;
+			}
+			auto [it, inserted] = shard.flights.try_emplace(key);
+			if (inserted) it->second = std::make_shared<Flight>();
+			flight = it->second;
+			leader = inserted;
+		}
+
+		if (!leader) {
+			if (auto shared = flight->wait()) {
+				coalesced_.fetch_add(1, std::memory_order_relaxed);
+				return shared;
+			}
+			misses_.fetch_add(1, std::memory_order_relaxed);
+			return fill();
+		}
+
+		misses_.fetch_add(1, std::memory_order_relaxed);
+		Handle entry;
+		try {
+			entry = fill();
+		} catch (...) {
+			land(shard, key, *flight, nullptr, now);
+			throw;
+		}
+		land(shard, key, *flight, entry, now);
+		return entry;
+	}
+
+	void clear() {
+		for (auto& shard : shards_) {
+			std::lock_guard lock(shard.mutex);
+			shard.lru.clear();
+			shard.index.clear();
+			shard.bytes = 0;
+		}
+	}
+
+	// ─── Introspection ────────────────
+
+	size_t size() const {
+		size_t n = 0;
+		for (auto& shard : shards_) { std::lock_guard lock(shard.mutex); n += shard.index.size(); }
+		return n;
+	}
+
+	size_t bytes() const {
+		size_t n = 0;
+		for (auto& shard : shards_) { std::lock_guard lock(shard.mutex); n += shard.bytes; }
+		return n;
+	}
+
+	size_t capacity() const noexcept { return capacity_; }
+	size_t shard_count() const noexcept { return shards_.size(); }
+	uint64_t hits() const noexcept { return hits_.load(std::memory_order_relaxed); }
+	uint64_t misses() const noexcept { return misses_.load(std::memory_order_relaxed); }
+	/// Misses answered by another caller's fill
+	uint64_t coalesced() const noexcept { return coalesced_.load(std::memory_order_relaxed); }
+
+	// ─── Cache-Control parsing ────────────────
+
+	/**
+	 * @brief Whether a comma-separated directive list contains name
+	 */
+	static bool directive(std::string_view list, std::string_view name) noexcept {
+		return find_directive(list, name).has_value();
+	}
+
+	/**
+	 * @brief Delta-seconds argument of a directive ("max-age=60")
+	 */
+	static std::optional<uint64_t> seconds(std::string_view list, std::string_view name) noexcept {
+		auto arg = find_directive(list, name);
+		if (!arg) return std::nullopt;
+		auto v = *arg;
+		if (v.size() >= 2 && v.front() == '"' && v.back() == '"') v = v.substr(1, v.size() - 2);
+		if (v.empty() || v.size() > 10) return std::nullopt;
+		uint64_t n = 0;
+		for (char c : v) {
+			if (c < '0' || c > '9') return std::nullopt;
+			n = n * 10 + static_cast<uint64_t>(c - '0');
+		}
+		return n;
+	}
+
+private:
+	/**
+	 * @brief A fill in progress that other callers for its key wait on
+	 */
+	struct Flight {
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool done = false;
+		Handle result;
+
+		Handle wait() {
+			std::unique_lock lock(mutex);
+			cv.wait(lock, [this] { return done; });
+			return result;
+		}
+	};
+
+	struct Node {
+		std::string key;
+		Handle entry;
+	};
+
+	struct Shard {
+		mutable std::mutex mutex;
+		std::list<Node> lru;
+		std::unordered_map<std::string, std::list<Node>::iterator> index;
+		std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+		size_t bytes = 0;
+	};
+
+	std::vector<Shard> shards_;
+	size_t shard_capacity_;
+	size_t capacity_;
+	std::atomic<uint64_t> hits_{0};
+	std::atomic<uint64_t> misses_{0};
+	std::atomic<uint64_t> coalesced_{0};
+
+	Shard& shard_for(const std::string& key) noexcept {
+		return shards_[std::hash<std::string>{}(key) % shards_.size()];
+	}
+
+	Handle find_locked(Shard& shard, const std::string& key, Clock::time_point now) {
+		auto it = shard.index.find(key);
+		if (it == shard.index.end()) return nullptr;
+		if (it->second->entry->expires <= now) {
+			shard.bytes -= it->second->entry->bytes();
+			shard.lru.erase(it->second);
+			shard.index.erase(it);
+			return nullptr;
+		}
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+		return it->second->entry;
+	}
+
+	void insert_locked(Shard& shard, std::string key, Handle entry) {
+		if (auto it = shard.index.find(key); it != shard.index.end()) {
+			shard.bytes -= it->second->entry->bytes();
+			shard.lru.erase(it->second);
+			shard.index.erase(it);
+		}
+		shard.bytes += entry->bytes();
+		shard.lru.push_front({key, std::move(entry)});
+		shard.index.emplace(std::move(key), shard.lru.begin());
+
+		while (shard.bytes > shard_capacity_ && !shard.lru.empty()) {
+			auto& victim = shard.lru.back();
+			shard.bytes -= victim.entry->bytes();
+			shard.index.erase(victim.key);
+			shard.lru.pop_back();
+		}
+	}
+
+	/**
+	 * @brief Finish a fill: store the entry, retire the flight, wake waiters
+	 */
+	void land(Shard& shard, const std::string& key, Flight& flight, Handle entry, Clock::time_point now) {
+		bool storable = entry && entry->expires > now && entry->bytes() <= shard_capacity_;
+		{
+			std::lock_guard lock(shard.mutex);
+			if (storable) insert_locked(shard, key, entry);
+			shard.flights.erase(key);
+		}
+		{
+			std::lock_guard lock(flight.mutex);
+			flight.done = true;
+			if (storable) flight.result = std::move(entry);
+		}
+		flight.cv.notify_all();
+	}
+
+	static std::optional<std::string_view> find_directive(std::string_view list, std::string_view name) noexcept {
+		while (!list.empty()) {
+			auto comma = list.find(',');
+			auto item = detail::trim(list.substr(0, comma));
+			list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+			auto eq = item.find('=');
+			auto key = detail::trim(item.substr(0, eq));
+			if (!detail::iequals(key, name)) continue;
+			return eq == std::string_view::npos ? std::string_view{} : detail::trim(item.substr(eq + 1));
+		}
+		return std::nullopt;
+	}
+
+	/**
+	 * @brief Whether every header in a response Vary is part of the key
+	 */
+	static bool vary_covered(std::string_view vary, const ResponseCachePolicy& policy) noexcept {
+		while (!vary.empty()) {
+			auto comma = vary.find(',');
+			auto name = detail::trim(vary.substr(0, comma));
+			vary = comma == std::string_view::npos ? std::string_view{} : vary.substr(comma + 1);
+			if (name.empty() || detail::iequals(name, "Accept-Encoding")) continue;
+			if (name == "*") return false;
+			bool keyed = false;
+			for (const auto& v : policy.vary) keyed = keyed || detail::iequals(v, name);
+			if (!keyed) return false;
+		}
+		return true;
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
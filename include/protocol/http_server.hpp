@@ -17,9 +17,29 @@
 #include <functional>
 #include <print>
 #include <array>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <algorithm>
+#include <span>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
 
 #include "http.hpp"
+#include "http2.hpp"
+#include "http_admission.hpp"
+#include "http_compression.hpp"
+#include "http_metrics.hpp"
+#include "http_proxy.hpp"
+#include "http_response_cache.hpp"
+#include "sse.hpp"
+#include "../async/event_loop.hpp"
+#include "../async/worker_pool.hpp"
 #include "../net/socket.hpp"
+#include "../net/listener_handoff.hpp"
 #include "../net/socket_address.hpp"
 #include "../net/internet_protocol.hpp"
 #include "../core/error.hpp"
@@ -32,13 +52,248 @@ namespace protocol {
  */
 using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
 
+class HttpServer;
+
+/**
+ * @brief Connection timeouts enforced in event-loop mode (zero disables a rule)
+ *
+ * Deadlines are checked on the loop's coarse timer wheel, so they fire up
+ * to one tick late. The minimum-rate rule applies while a request head or
+ * body is being read and while a response is being written: a connection
+ * moving fewer than min_bytes_per_second on average over rate_window is
+ * reaped, which catches clients that trickle just enough to dodge the gap
+ * timeouts.
+ */
+struct ServerTimeouts {
+	std::chrono::milliseconds header_read{10'000};     ///< First byte of a request head to its end
+	std::chrono::milliseconds body_read{30'000};       ///< Longest gap between body reads
+	std::chrono::milliseconds write{30'000};           ///< Longest gap between send progress
+	std::chrono::milliseconds keep_alive_idle{5'000};  ///< Between requests on a kept-alive connection
+	uint32_t min_bytes_per_second = 240;
+	std::chrono::milliseconds rate_window{5'000};
+};
+
+/**
+ * @brief Flow-control handle for a request body delivered in pieces
+ *
+ * Passed to every HttpStreamHandler callback. pause() stops the server from
+ * reading the connection, so TCP back-pressure reaches the client while the
+ * handler catches up; resume() (on the event-loop thread) delivers whatever
+ * is already buffered and re-arms reading. The stream stays valid until
+ * on_complete or on_abort has returned.
+ */
+class BodyStream {
+public:
+	void pause() noexcept { paused_ = true; }
+
+	void resume() {
+		paused_ = false;
+		if (in_callback_ || !on_resume_) return; // Picked up when the callback returns
+		auto hook = on_resume_; // The stream may be destroyed by the hook
+		hook();
+	}
+
+	bool is_paused() const noexcept { return paused_; }
+
+	/// Body bytes delivered so far (after chunked decoding)
+	uint64_t bytes_received() const noexcept { return received_; }
+
+	/// Declared Content-Length, or nullopt for a chunked body
+	std::optional<uint64_t> content_length() const noexcept { return content_length_; }
+
+	/**
+	 * @brief Stop reading the body and answer with resp; the connection is closed afterwards
+	 */
+	void reject(HttpResponse resp) { rejection_ = std::move(resp); }
+
+private:
+	friend class HttpServer;
+
+	bool paused_ = false;
+	bool in_callback_ = false;
+	uint64_t received_ = 0;
+	std::optional<uint64_t> content_length_;
+	std::optional<HttpResponse> rejection_;
+	std::function<void()> on_resume_;
+};
+
+/**
+ * @brief Handler for a route whose request body is streamed
+ *
+ * on_headers runs once the request head is parsed, on_data for each body
+ * piece as it arrives (slices point into the receive buffer and are only
+ * valid during the call), and on_complete after the last byte to produce
+ * the response. on_abort runs instead if the connection drops mid-body.
+ */
+struct HttpStreamHandler {
+	std::function<void(const HttpRequest&, BodyStream&)> on_headers;
+	std::function<void(std::string_view, BodyStream&)> on_data;
+	std::function<HttpResponse(const HttpRequest&, BodyStream&)> on_complete;
+	std::function<void(const HttpRequest&)> on_abort;
+};
+
+/**
+ * @brief Completes a deferred request, from any thread
+ *
+ * Copies share one request. The first send() wins; later calls are
+ * ignored. If every copy is destroyed without a send(), the client gets
+ * 500 Internal Server Error instead of hanging.
+ */
+class HttpResponder {
+public:
+	HttpResponder() = default;
+
+	void send(HttpResponse resp) const {
+		if (!state_ || state_->sent.exchange(true, std::memory_order_acq_rel)) return;
+		state_->deliver(std::move(resp));
+	}
+
+	/// send() was called on some copy
+	bool done() const noexcept { return !state_ || state_->sent.load(std::memory_order_acquire); }
+
+private:
+	friend class HttpServer;
+
+	struct State {
+		std::atomic<bool> sent{false};
+		std::function<void(HttpResponse)> deliver;
+
+		explicit State(std::function<void(HttpResponse)> d) : deliver(std::move(d)) {}
+
+		~State() {
+			if (sent.load(std::memory_order_acquire) || !deliver) return;
+			HttpResponse resp;
+			resp.status = HttpStatus::InternalServerError;
+			resp.headers.set("Content-Type", "text/plain");
+			resp.body = "500 Internal Server Error";
+			deliver(std::move(resp));
+		}
+	};
+
+	explicit HttpResponder(std::function<void(HttpResponse)> deliver)
+		: state_(std::make_shared<State>(std::move(deliver))) {}
+
+	std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Handler that answers later through an HttpResponder
+ */
+using AsyncHttpHandler = std::function<void(const HttpRequest&, HttpResponder)>;
+
+/**
+ * @brief Behaviour of Server-Sent Events routes
+ */
+struct SseOptions {
+	/// Comment sent after this much silence, so proxies keep the stream open (zero: never)
+	std::chrono::milliseconds heartbeat{15'000};
+	/// A subscriber with more unsent bytes than this is disconnected
+	size_t max_queued_bytes = 1024 * 1024;
+};
+
+/**
+ * @brief One open text/event-stream response
+ *
+ * Handed to an SseHandler, which may keep it and write events as they
+ * happen. All members are for the event-loop thread (from elsewhere, go
+ * through EventLoop::post()). Writes fail once the client is gone;
+ * on_close then runs from the loop shortly after the disconnect.
+ */
+class SseStream {
+public:
+	/// Serialize and queue one event
+	bool send(const SseEvent& event) { return send_raw(std::make_shared<const std::string>(event.serialize())); }
+
+	/// Queue already serialized bytes, shared rather than copied
+	bool send_raw(std::shared_ptr<const std::string> serialized);
+
+	bool comment(std::string_view text) { return send_raw(std::make_shared<const std::string>(sse_comment(text))); }
+
+	/// End the stream once queued events are flushed
+	void close();
+
+	bool is_open() const noexcept { return server_ != nullptr; }
+
+	std::function<void()> on_close;
+
+private:
+	friend class HttpServer;
+
+	HttpServer* server_ = nullptr;
+	net::impl::socket_t fd_ = net::impl::invalid_socket;
+	uint64_t connection_id_ = 0;
+	size_t metrics_slot_ = 0;
+	std::chrono::steady_clock::time_point started_;
+};
+
+/**
+ * @brief Fan-out of events to many SseStreams
+ *
+ * publish() serializes an event once; every subscriber's write queue holds
+ * a reference to the same buffer. Closed streams are dropped as they are
+ * found. Event-loop thread only, like SseStream.
+ */
+class SseBroadcaster {
+public:
+	void subscribe(std::shared_ptr<SseStream> stream) {
+		if (stream && stream->is_open()) subscribers_.push_back(std::move(stream));
+	}
+
+	/**
+	 * @return Number of subscribers the event was queued for
+	 */
+	size_t publish(const SseEvent& event) {
+		return publish_raw(std::make_shared<const std::string>(event.serialize()));
+	}
+
+	size_t publish_raw(const std::shared_ptr<const std::string>& serialized) {
+		size_t delivered = 0;
+		for (size_t i = 0; i < subscribers_.size();) {
+			if (subscribers_[i]->send_raw(serialized)) {
+				++delivered;
+				++i;
+			} else {
+				subscribers_[i] = std::move(subscribers_.back());
+				subscribers_.pop_back();
+			}
+		}
+		return delivered;
+	}
+
+	/// Subscribers, including any that closed since the last publish()
+	size_t size() const noexcept { return subscribers_.size(); }
+
+private:
+	std::vector<std::shared_ptr<SseStream>> subscribers_;
+};
+
+/**
+ * @brief Handler for a Server-Sent Events route
+ */
+using SseHandler = std::function<void(const HttpRequest&, std::shared_ptr<SseStream>)>;
+
 /**
- * @brief Lightweight synchronous HTTP/1.1 server
+ * @brief Lightweight HTTP/1.1 server with optional HTTP/2 cleartext
  * 
- * Registers route handlers and processes one request per accept cycle.
+ * Registers route handlers and either processes one request per accept
+ * cycle (handle_one) or serves keep-alive connections on an EventLoop
+ * (attach), where h2c can multiplex many requests over one connection.
  */
 class HttpServer {
+	friend class SseStream;
+
 public:
+	/// Upper bound on a buffered request (headers + body)
+	static constexpr size_t MAX_REQUEST_SIZE = 1024 * 1024;
+	/// Upper bound on the request line + headers in event-loop mode
+	static constexpr size_t MAX_HEADER_SIZE = 64 * 1024;
+
+	HttpServer() = default;
+	~HttpServer() { stop(); }
+
+	HttpServer(const HttpServer&) = delete;
+	HttpServer& operator=(const HttpServer&) = delete;
+
 	/**
 	 * @brief Register a route handler
 	 * @param method HTTP method to match
@@ -46,12 +301,238 @@ public:
 	 * @param handler Function to handle the request
 	 */
 	void route(HttpMethod method, std::string path, HttpHandler handler) {
-		routes_.push_back({method, std::move(path), std::move(handler)});
+		auto slot = metrics_slot(method, path);
+		routes_.push_back({method, std::move(path), std::move(handler), slot});
+	}
+
+	/**
+	 * @brief Register a route that receives its request body incrementally
+	 *
+	 * In event-loop mode over HTTP/1.1 the body is never buffered whole:
+	 * Content-Length and chunked bodies are handed to on_data as they are
+	 * read, "Expect: 100-continue" is answered after on_headers, and
+	 * BodyStream::pause() applies back-pressure. Over HTTP/2 and in
+	 * handle_one() the body is delivered in one piece.
+	 */
+	void stream(HttpMethod method, std::string path, HttpStreamHandler handler) {
+		auto slot = metrics_slot(method, path);
+		stream_routes_.push_back({method, std::move(path),
+			std::make_shared<HttpStreamHandler>(std::move(handler)), slot});
+	}
+
+	/**
+	 * @brief Register a route whose handler responds later
+	 *
+	 * The handler starts the work and returns; any thread may then call
+	 * HttpResponder::send(). In event-loop mode over HTTP/1.1 the server
+	 * keeps serving other connections meanwhile and writes the response
+	 * when it arrives (pipelined requests behind it wait their turn).
+	 * Over HTTP/2 and in handle_one() the server thread blocks until
+	 * send(), so the work must not depend on that thread.
+	 */
+	void route_async(HttpMethod method, std::string path, AsyncHttpHandler handler) {
+		auto slot = metrics_slot(method, path);
+		async_routes_.push_back({method, std::move(path), std::move(handler), slot});
+	}
+
+	/**
+	 * @brief Register a GET route answered with a text/event-stream
+	 *
+	 * The response head goes out at once and the connection stays open;
+	 * the handler gets the SseStream to write events to, now or later.
+	 * Idle streams get a heartbeat comment per SseOptions. Event streams
+	 * are served over HTTP/1.1 in event-loop mode only.
+	 */
+	void sse(std::string path, SseHandler handler) {
+		auto slot = metrics_slot(HttpMethod::Get, path);
+		sse_routes_.push_back({std::move(path), std::move(handler), slot});
+	}
+
+	void set_sse_options(const SseOptions& options) noexcept { sse_options_ = options; }
+	const SseOptions& sse_options() const noexcept { return sse_options_; }
+
+	/**
+	 * @brief Forward every request under prefix to an upstream cluster
+	 *
+	 * Matches the prefix itself and paths below it ("/api" covers "/api",
+	 * "/api/users" and "/api?x=1", not "/apix"), any method; exact routes
+	 * win. Request and response bodies are streamed, with back-pressure
+	 * bounded by ProxyOptions, and upstream connections are kept alive in a
+	 * per-route UpstreamPool. Proxied routes are served over HTTP/1.1 in
+	 * event-loop mode only.
+	 */
+	void proxy(std::string prefix, UpstreamCluster cluster, ProxyOptions options = {}) {
+		auto slot = metrics_ ? metrics_->add_route("*", prefix) : ServerMetrics::UNMATCHED;
+		proxy_routes_.push_back({std::move(prefix), std::move(cluster), options, nullptr, slot});
+		if (loop_) proxy_routes_.back().pool = std::make_shared<UpstreamPool>(proxy_routes_.back().cluster, *loop_);
+	}
+
+	/**
+	 * @brief Connection pool of a proxied prefix (nullptr before attach())
+	 */
+	const UpstreamPool* upstream_pool(std::string_view prefix) const noexcept {
+		for (const auto& r : proxy_routes_) {
+			if (r.prefix == prefix) return r.pool.get();
+		}
+		return nullptr;
 	}
 
 	/// Shorthand route helpers
 	void get(std::string path, HttpHandler handler)  { route(HttpMethod::Get, std::move(path), std::move(handler)); }
 	void post(std::string path, HttpHandler handler) { route(HttpMethod::Post, std::move(path), std::move(handler)); }
+	void get_async(std::string path, AsyncHttpHandler handler) { route_async(HttpMethod::Get, std::move(path), std::move(handler)); }
+
+	/**
+	 * @brief Enable gzip/deflate response encoding negotiated via Accept-Encoding
+	 *
+	 * Cacheable responses (ETag / public Cache-Control) are compressed once
+	 * and served from a byte-bounded precompressed cache afterwards.
+	 * Has no effect unless built with ETHERZ_HAS_ZLIB.
+	 */
+	void enable_compression(CompressionOptions options = {}) {
+		compression_ = options;
+		compression_cache_ = options.cache_bytes > 0
+			? std::make_unique<PrecompressedCache>(options.cache_bytes) : nullptr;
+	}
+
+	void disable_compression() noexcept {
+		compression_.reset();
+		compression_cache_.reset();
+	}
+
+	/**
+	 * @brief Precompressed cache (nullptr if compression or caching is off)
+	 */
+	const PrecompressedCache* compression_cache() const noexcept { return compression_cache_.get(); }
+
+	/**
+	 * @brief Accept HTTP/2 cleartext connections in event-loop mode
+	 *
+	 * Both prior-knowledge (client starts with the HTTP/2 preface) and
+	 * "Upgrade: h2c" from an HTTP/1.1 request are supported. Requests on
+	 * every stream go through the same routes as HTTP/1.1.
+	 */
+	void enable_http2(H2Settings settings = {}) { http2_ = settings; }
+	void disable_http2() noexcept { http2_.reset(); }
+
+	/**
+	 * @brief Record per-route request metrics
+	 *
+	 * Counts requests by route and status, in-flight requests, body and
+	 * network bytes, and handler latency in HDR-style histograms. Recording
+	 * is lock-free and sharded per thread. If endpoint is non-empty a GET
+	 * route serving the Prometheus text format is registered there.
+	 * Call before attach() so connection gauges start from zero.
+	 */
+	void enable_metrics(std::string endpoint = "/metrics") {
+		if (metrics_) return;
+		metrics_ = std::make_unique<ServerMetrics>();
+		for (auto& r : routes_) r.metrics_slot = metrics_->add_route(std::string(method_string(r.method)), r.path);
+		for (auto& r : stream_routes_) r.metrics_slot = metrics_->add_route(std::string(method_string(r.method)), r.path);
+		for (auto& r : async_routes_) r.metrics_slot = metrics_->add_route(std::string(method_string(r.method)), r.path);
+		for (auto& r : sse_routes_) r.metrics_slot = metrics_->add_route("GET", r.path);
+		for (auto& r : proxy_routes_) r.metrics_slot = metrics_->add_route("*", r.prefix);
+		if (!endpoint.empty()) {
+			get(std::move(endpoint), [this](const HttpRequest&) {
+				HttpResponse resp;
+				resp.headers.set("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+				resp.body = metrics_->prometheus();
+				return resp;
+			});
+		}
+	}
+
+	/**
+	 * @brief Recorded metrics (nullptr unless enable_metrics() was called)
+	 */
+	const ServerMetrics* metrics() const noexcept { return metrics_.get(); }
+
+	/**
+	 * @brief Serve GET responses of routes marked with cache() from memory
+	 *
+	 * A hit skips the handler and, over HTTP/1.1 in event-loop mode, is
+	 * sent straight from the cached bytes. Concurrent misses on one key run
+	 * the handler once. Requests with Authorization or "no-store" bypass
+	 * the cache; "no-cache" refreshes the entry. Hits are not counted in
+	 * the per-route metrics, only in response_cache().
+	 */
+	void enable_response_cache(ResponseCacheOptions options = {}) {
+		response_cache_ = std::make_unique<ResponseCache>(options);
+	}
+
+	void disable_response_cache() noexcept { response_cache_.reset(); }
+
+	/**
+	 * @brief Cache GET responses for path (the route may be registered before or after)
+	 */
+	void cache(std::string path, ResponseCachePolicy policy = {}) {
+		cached_routes_.push_back({std::move(path), std::move(policy)});
+	}
+
+	/**
+	 * @brief Response cache (nullptr unless enable_response_cache() was called)
+	 */
+	const ResponseCache* response_cache() const noexcept { return response_cache_.get(); }
+
+	/**
+	 * @brief Replace the event-loop connection timeouts
+	 *
+	 * Requests that time out while being read get 408 Request Timeout;
+	 * idle and stalled-write connections are closed silently.
+	 */
+	void set_timeouts(const ServerTimeouts& timeouts) noexcept { timeouts_ = timeouts; }
+	const ServerTimeouts& timeouts() const noexcept { return timeouts_; }
+
+	/**
+	 * @brief Shed requests that queued too long, CoDel-style
+	 *
+	 * In event-loop mode each request's queue delay, from when the loop
+	 * estimates its bytes became readable (EventLoop::pending_since()) to
+	 * its dispatch, is fed to an AdmissionController. A shed request gets
+	 * 503 Service Unavailable with Retry-After before its handler (or a
+	 * streamed body) is touched; the connection stays open unless a
+	 * request body would have to be skipped.
+	 */
+	void enable_admission_control(AdmissionOptions options = {}) {
+		admission_ = std::make_unique<AdmissionController>(options);
+	}
+
+	void disable_admission_control() noexcept { admission_.reset(); }
+
+	/**
+	 * @brief Shedding priority of requests for path (any method)
+	 */
+	void prioritize(std::string path, RequestPriority priority) {
+		for (auto& p : route_priorities_) {
+			if (p.path == path) { p.priority = priority; return; }
+		}
+		route_priorities_.push_back({std::move(path), priority});
+	}
+
+	/**
+	 * @brief Admission controller (nullptr unless enable_admission_control() was called)
+	 */
+	const AdmissionController* admission() const noexcept { return admission_.get(); }
+
+	/**
+	 * @brief Run route handlers on a pool of worker threads
+	 *
+	 * For handlers that block (file I/O, database drivers). The event-loop
+	 * thread keeps accepting, parsing and writing; each HTTP/1.1 request for
+	 * a route() handler is handed to a worker through a lock-free queue and
+	 * its response written when the worker is done. A connection always
+	 * maps to the same worker, and its next request is not read until the
+	 * current one is answered, so keep-alive and pipelined requests stay in
+	 * order. When the worker's queue is full the request gets 503. Stream,
+	 * async and SSE routes, HTTP/2 and handle_one() still run handlers on
+	 * the calling thread. Call before attach().
+	 */
+	void enable_workers(size_t threads, size_t queue_capacity = 256) {
+		workers_ = std::make_unique<async::WorkerPool>(threads, queue_capacity);
+	}
+
+	/// Number of handler threads (0: handlers run on the event-loop thread)
+	size_t worker_count() const noexcept { return workers_ ? workers_->size() : 0; }
 
 	/**
 	 * @brief Bind and listen on the given address
@@ -70,6 +551,79 @@ public:
 		return core::Error::None;
 	}
 
+	/**
+	 * @brief Serve on an already-listening socket instead of calling listen()
+	 *
+	 * Takes ownership of fd, typically one from net::inherited_listeners()
+	 * or a net::HandoffTicket, so a restarted process keeps the bound port
+	 * and the connections waiting in its accept backlog.
+	 */
+	core::Error adopt(net::impl::socket_t fd) noexcept {
+		if (fd == net::impl::invalid_socket) return core::Error::SocketClosed;
+		if (loop_ && listening_) loop_->remove(listener_.native_handle());
+		listener_ = net::Socket<net::Ip<4>>::adopt(fd);
+		listening_ = true;
+		draining_ = false;
+		return core::Error::None;
+	}
+
+	/**
+	 * @brief Offer the listener to a successor process over a Unix socket
+	 *
+	 * In event-loop mode a new process that calls HandoffTicket::request(path)
+	 * receives the listening fd; once it confirms that it is accepting,
+	 * this server drains. Until then it keeps serving, so a successor that
+	 * dies mid-handoff costs nothing. Not available on Windows.
+	 */
+	core::Error enable_handoff(std::string path) {
+		auto err = handoff_.listen(std::move(path));
+		if (core::is_error(err)) return err;
+		if (loop_) watch_handoff();
+		return core::Error::None;
+	}
+
+	/**
+	 * @brief Stop accepting and let open connections finish
+	 *
+	 * Closes this process's copy of the listener (one that adopted it keeps
+	 * accepting), closes idle keep-alive connections, answers requests in
+	 * progress with "Connection: close" and sends GOAWAY on HTTP/2.
+	 * Connections accepted but still silent are kept until their first
+	 * request or the header timeout. drained() turns true once the last
+	 * connection is gone.
+	 */
+	void drain() {
+		if (draining_) return;
+		draining_ = true;
+		if (loop_) loop_->remove(listener_.native_handle());
+		listener_.close();
+		listening_ = false;
+		close_handoff();
+
+		std::vector<net::impl::socket_t> idle, goaway;
+		for (auto& [fd, conn] : connections_) {
+			if (conn->h2) {
+				conn->h2->shutdown();
+				conn->out.append(conn->h2->output());
+				conn->h2->output().clear();
+				if (conn->h2->active_streams() == 0) conn->close_after_write = true;
+				goaway.push_back(fd);
+			} else if (conn->sse) {
+				conn->close_after_write = true;
+				goaway.push_back(fd);
+			} else if (current_phase(*conn) == Phase::Idle) {
+				idle.push_back(fd);
+			}
+		}
+		for (auto fd : idle) close_connection(fd);
+		for (auto fd : goaway) finish_io(fd, *connections_.at(fd));
+	}
+
+	bool is_draining() const noexcept { return draining_; }
+
+	/// Draining and every connection has closed
+	bool drained() const noexcept { return draining_ && connections_.empty(); }
+
 	/**
 	 * @brief Accept and handle a single request (blocking)
 	 * @return Error if accept/recv/send fails
@@ -86,7 +640,6 @@ public:
 		// Receive request (loop until headers are complete)
 		std::string request_data;
 		std::array<uint8_t, 8192> buffer{};
-		constexpr size_t MAX_REQUEST_SIZE = 1024 * 1024; // 1MB limit
 
 		while (request_data.size() < MAX_REQUEST_SIZE) {
 			int received = client_sock.recv(buffer);
@@ -105,7 +658,7 @@ public:
 
 		// Parse and route
 		auto req = http_parser::parse_request(request_data);
-		auto resp = dispatch(req);
+		auto resp = respond(req);
 
 		// Send response
 		auto raw = resp.serialize();
@@ -118,44 +671,1466 @@ public:
 	}
 
 	/**
-	 * @brief Stop the server
+	 * @brief Serve connections on an event loop
+	 *
+	 * Switches the listener to non-blocking mode and registers it with
+	 * loop; drive the server with loop.run() / run_once(). Connections are
+	 * kept alive, pipelined requests are answered in order, chunked request
+	 * bodies are decoded, and h2c is accepted when enable_http2() was called.
+	 *
+	 * @return Error if the server is not listening
+	 */
+	core::Error attach(async::EventLoop& loop) {
+		if (!listening_) return core::Error::SocketClosed;
+		auto err = listener_.set_nonblocking(true);
+		if (core::is_error(err)) return err;
+		loop_ = &loop;
+		async_hub_ = std::make_shared<AsyncHub>();
+		async_hub_->server = this;
+		async_hub_->loop = &loop;
+		for (auto& r : proxy_routes_) r.pool = std::make_shared<UpstreamPool>(r.cluster, loop);
+		loop.add(listener_.native_handle(), async::PollEvent::ReadReady,
+			[this](net::impl::socket_t, async::PollEvent) { accept_ready(); });
+		if (handoff_.is_open()) watch_handoff();
+		return core::Error::None;
+	}
+
+	/**
+	 * @brief Stop the server and close all event-loop connections
 	 */
 	void stop() noexcept {
+		workers_.reset(); // Joins; requests still queued are dropped and their connections closed below
+		close_handoff();
+		if (auto hub = std::move(async_hub_)) {
+			std::lock_guard lock(hub->mutex); // No responder may post past this point
+			hub->server = nullptr;
+		}
+		if (loop_) {
+			loop_->remove(listener_.native_handle());
+			for (auto& [fd, conn] : connections_) {
+				loop_->remove(fd);
+				if (conn->proxy) conn->proxy->cancel();
+				abort_body(*conn);
+				abandon_async(*conn);
+				if (auto stream = end_stream(*conn); stream && stream->on_close) stream->on_close();
+				if (metrics_) metrics_->connection_closed();
+			}
+			for (auto& r : proxy_routes_) r.pool.reset(); // Idle upstream connections leave the loop
+			loop_ = nullptr;
+		}
+		connections_.clear();
 		listening_ = false;
 		listener_.close();
 	}
 
 	bool is_listening() const noexcept { return listening_; }
-	size_t route_count() const noexcept { return routes_.size(); }
+	size_t route_count() const noexcept {
+		return routes_.size() + stream_routes_.size() + async_routes_.size() + sse_routes_.size() + proxy_routes_.size();
+	}
+	size_t connection_count() const noexcept { return connections_.size(); }
+
+	/// Connections closed by a timeout or the minimum-rate rule
+	uint64_t timed_out_count() const noexcept { return timed_out_; }
+
+	/**
+	 * @brief Memory held by connection I/O buffers (walks all connections)
+	 */
+	size_t buffered_bytes() const noexcept {
+		size_t total = 0;
+		for (const auto& [fd, conn] : connections_) total += conn->in.capacity() + conn->out.capacity();
+		return total;
+	}
 
 private:
 	struct Route {
 		HttpMethod method;
 		std::string path;
 		HttpHandler handler;
+		size_t metrics_slot = ServerMetrics::UNMATCHED;
+	};
+
+	struct StreamRoute {
+		HttpMethod method;
+		std::string path;
+		std::shared_ptr<HttpStreamHandler> handler;
+		size_t metrics_slot = ServerMetrics::UNMATCHED;
+	};
+
+	struct AsyncRoute {
+		HttpMethod method;
+		std::string path;
+		AsyncHttpHandler handler;
+		size_t metrics_slot = ServerMetrics::UNMATCHED;
+	};
+
+	/**
+	 * @brief Link from responders on other threads back to the event loop
+	 *
+	 * stop() clears server under the mutex, so a late send() is dropped
+	 * instead of posting to a loop the server no longer runs on.
+	 */
+	struct AsyncHub {
+		std::mutex mutex;
+		HttpServer* server = nullptr;
+		async::EventLoop* loop = nullptr;
+	};
+
+	struct SseRoute {
+		std::string path;
+		SseHandler handler;
+		size_t metrics_slot = ServerMetrics::UNMATCHED;
+	};
+
+	struct ProxyRoute {
+		std::string prefix;
+		UpstreamCluster cluster;
+		ProxyOptions options;
+		std::shared_ptr<UpstreamPool> pool; // Created on attach(): it lives on the loop
+		size_t metrics_slot = ServerMetrics::UNMATCHED;
+	};
+
+	struct CachedRoute {
+		std::string path;
+		ResponseCachePolicy policy;
+	};
+
+	struct RoutePriority {
+		std::string path;
+		RequestPriority priority;
 	};
 
 	std::vector<Route> routes_;
+	std::vector<StreamRoute> stream_routes_;
+	std::vector<AsyncRoute> async_routes_;
+	std::vector<SseRoute> sse_routes_;
+	SseOptions sse_options_;
+	std::vector<ProxyRoute> proxy_routes_;
+	std::vector<CachedRoute> cached_routes_;
+	std::vector<RoutePriority> route_priorities_;
+	std::unique_ptr<AdmissionController> admission_;
+	std::unique_ptr<async::WorkerPool> workers_;
+	std::shared_ptr<AsyncHub> async_hub_;
+	uint64_t next_connection_id_ = 0;
 	net::Socket<net::Ip<4>> listener_;
 	bool listening_ = false;
+	std::optional<CompressionOptions> compression_;
+	std::unique_ptr<PrecompressedCache> compression_cache_;
+	std::optional<H2Settings> http2_;
+	ServerTimeouts timeouts_;
+	uint64_t timed_out_ = 0;
+	std::unique_ptr<ServerMetrics> metrics_;
+	std::unique_ptr<ResponseCache> response_cache_;
+	net::UnixListener handoff_;
+	net::UnixChannel handoff_peer_;
+	bool handed_off_ = false;
+	bool draining_ = false;
 
 	/**
-	 * @brief Find and call matching route handler
+	 * @brief Request whose head is parsed and whose body is still being read
 	 */
-	HttpResponse dispatch(const HttpRequest& req) {
-		for (const auto& r : routes_) {
-			if (r.method == req.method && r.path == req.path) {
-				return r.handler(req);
-			}
-		}
-		// 404 Not Found
-		HttpResponse resp;
-		resp.status = HttpStatus::NotFound;
-		resp.headers.set("Content-Type", "text/plain");
-		resp.body = "404 Not Found";
+	struct InboundBody {
+		HttpRequest req;
+		std::shared_ptr<HttpStreamHandler> handler; // nullptr: buffer into req.body
+		size_t metrics_slot = ServerMetrics::UNMATCHED;
+		std::chrono::steady_clock::time_point started;
+		std::unique_ptr<BodyStream> stream;
+		bool chunked = false;
+		uint64_t remaining = 0;                     // Content-Length bytes left
+		http_parser::ChunkedDecoder decoder;
+		bool keep_alive = true;
+		bool pooled = false;                        // The worker records metrics and finalizes
+		bool proxied = false;                       // Forwarded by ClientConnection::proxy
+	};
+
+	/**
+	 * @brief What a connection is waiting for, which decides its timeout
+	 */
+	enum class Phase : uint8_t { None, Idle, Head, Body, Paused, Write, Stream };
+
+	/**
+	 * @brief Per-connection state in event-loop mode
+	 */
+	struct ClientConnection {
+		net::Socket<net::Ip<4>> socket;
+		std::string in;                       // Bytes received, not yet parsed
+		std::deque<std::shared_ptr<const std::string>> shared_out; // Shared buffers, sent before out
+		size_t shared_offset = 0;
+		size_t shared_bytes = 0;
+		std::string out;                      // Bytes queued for sending
+		size_t out_offset = 0;
+		async::PollEvent interest = async::PollEvent::None;
+		bool peer_closed = false;
+		bool close_after_write = false;
+		std::unique_ptr<Http2Session> h2;     // Set once the connection speaks HTTP/2
+		std::unique_ptr<InboundBody> body;    // Request body in progress
+		std::unique_ptr<InboundBody> awaiting; // Request handed to an async handler
+		uint64_t id = 0;                      // Tells a reused fd apart
+		std::shared_ptr<SseStream> sse;       // Set once the response is an event stream
+		std::shared_ptr<ProxyExchange> proxy; // Request being forwarded upstream
+		net::Ip<4> peer;                      // Client address, for X-Forwarded-For
+		bool no_delay = false;                // TCP_NODELAY set for proxied responses
+		bool broken = false;                  // Closing; no more writes
+
+		// Timeout bookkeeping, in timer-wheel ticks
+		async::Timer timer;
+		Phase phase = Phase::None;
+		bool served = false;                  // At least one request answered
+		uint64_t phase_tick = 0;
+		uint64_t progress_tick = 0;           // Last read or send progress
+		uint64_t window_tick = 0;             // Start of the current rate window
+		uint64_t window_bytes = 0;
+		uint64_t stream_tick = 0;             // Last event-stream write
+		uint64_t bytes_in = 0;
+		uint64_t bytes_out = 0;
+		std::chrono::steady_clock::time_point received; // Estimated arrival of the last read
+	};
+
+	/// Stop reading once this much unparsed input is buffered
+	static constexpr size_t MAX_INPUT_BUFFER = 256 * 1024;
+
+	async::EventLoop* loop_ = nullptr;
+	std::unordered_map<net::impl::socket_t, std::unique_ptr<ClientConnection>> connections_;
+
+	/**
+	 * @brief Final response for a request, from the response cache if possible
+	 */
+	HttpResponse respond(const HttpRequest& req) {
+		if (auto entry = cached(req)) return entry->response;
+		return produce(req);
+	}
+
+	/**
+	 * @brief Produce the final response: dispatch, then apply content coding
+	 */
+	HttpResponse produce(const HttpRequest& req) {
+		auto resp = dispatch(req);
+		finalize(req, resp);
 		return resp;
 	}
-};
+
+	/**
+	 * @brief Cache entry for a GET on a cached route, filling it on a miss
+	 * @return nullptr if the request does not go through the cache
+	 */
+	ResponseCache::Handle cached(const HttpRequest& req) {
+		if (!response_cache_ || req.method != HttpMethod::Get) return nullptr;
+		const ResponseCachePolicy* policy = nullptr;
+		for (const auto& c : cached_routes_) {
+			if (c.path == req.path) { policy = &c.policy; break; }
+		}
+		if (!policy) return nullptr;
+		auto lookup = ResponseCache::request_lookup(req);
+		if (lookup == ResponseCache::Lookup::Bypass) return nullptr;
+
+		// Compressed and identity representations are separate entries
+		std::string_view encoding;
+		if (compression_ && compression_available()) {
+			encoding = encoding_name(negotiate_encoding(req.headers.get("Accept-Encoding")));
+		}
+		auto key = ResponseCache::make_key(req, *policy, encoding);
+		auto now = ResponseCache::Clock::now();
+		auto fill = [&] {
+			auto resp = produce(req);
+			auto ttl = ResponseCache::freshness(resp, *policy);
+			return ResponseCache::make_entry(std::move(resp), ttl ? now + *ttl : now);
+		};
+
+		if (lookup == ResponseCache::Lookup::Refresh) {
+			auto entry = fill();
+			response_cache_->insert(std::move(key), entry, now);
+			return entry;
+		}
+		return response_cache_->fetch(key, now, fill);
+	}
+
+	void finalize(const HttpRequest& req, HttpResponse& resp) {
+		if (compression_) {
+			compress_response(req, resp, *compression_, compression_cache_.get());
+		}
+	}
+
+	// ─── Event-loop mode ────────────────
+
+	void accept_ready() {
+		while (true) {
+			auto accepted = listener_.accept();
+			if (!accepted) return; // WouldBlock or transient error: wait for next readiness
+
+			auto conn = std::make_unique<ClientConnection>();
+			conn->socket = std::move(accepted->socket);
+			conn->peer = accepted->address.address();
+			if (core::is_error(conn->socket.set_nonblocking(true))) continue;
+
+			auto fd = conn->socket.native_handle();
+			conn->id = ++next_connection_id_;
+			conn->timer.callback = [this, fd] { on_timeout(fd); };
+			if (metrics_) metrics_->connection_opened();
+			auto& ref = *conn;
+			connections_[fd] = std::move(conn);
+			refresh_timer(ref);
+			update_interest(fd, ref);
+		}
+	}
+
+	void on_client_event(net::impl::socket_t fd, async::PollEvent events) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end()) return;
+		auto& conn = *it->second;
+
+		if (has_event(events, async::PollEvent::ReadReady) || has_event(events, async::PollEvent::HangUp)) {
+			if (!body_paused(conn)) read_available(conn);
+			process_input(conn);
+		} else if (has_event(events, async::PollEvent::Error)) {
+			close_connection(fd);
+			return;
+		}
+		finish_io(fd, conn);
+	}
+
+	/**
+	 * @brief Flush output, then close the connection or re-arm its interest
+	 */
+	void finish_io(net::impl::socket_t fd, ClientConnection& conn) {
+		if (!flush_output(conn)) {
+			close_connection(fd);
+			return;
+		}
+		if (conn.proxy) conn.proxy->client_progress();
+
+		// A paused body may still have buffered input to deliver after a half-close
+		bool drained = !has_output(conn);
+		// A half-closed client may still be waiting for an async response
+		if (drained && (conn.close_after_write || (conn.peer_closed && !body_paused(conn) && !conn.awaiting))) {
+			close_connection(fd);
+			return;
+		}
+		refresh_timer(conn);
+		update_interest(fd, conn);
+	}
+
+	/**
+	 * @brief BodyStream::resume() outside a callback: deliver buffered input
+	 */
+	void resume_body(net::impl::socket_t fd) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end()) return;
+		auto& conn = *it->second;
+		process_input(conn);
+		finish_io(fd, conn);
+	}
+
+	static bool body_paused(const ClientConnection& conn) noexcept {
+		return conn.body && conn.body->stream && conn.body->stream->paused_;
+	}
+
+	void read_available(ClientConnection& conn) {
+		constexpr size_t READ_CHUNK = 16 * 1024;
+		while (!conn.peer_closed && conn.in.size() < MAX_INPUT_BUFFER) {
+			size_t old_size = conn.in.size();
+			conn.in.resize(old_size + READ_CHUNK);
+			int n = conn.socket.recv(std::span<uint8_t>(
+				reinterpret_cast<uint8_t*>(conn.in.data() + old_size), READ_CHUNK));
+			conn.in.resize(old_size + static_cast<size_t>(n > 0 ? n : 0));
+
+			if (n > 0) {
+				if (metrics_) metrics_->add_network_io(static_cast<size_t>(n), 0);
+				conn.bytes_in += static_cast<size_t>(n);
+				conn.progress_tick = loop_->timers().now_tick();
+				conn.received = loop_->pending_since();
+				if (static_cast<size_t>(n) < READ_CHUNK) return; // Drained the socket
+				continue;
+			}
+			if (n < 0 && core::last_platform_error() == core::Error::WouldBlock) return;
+			conn.peer_closed = true; // EOF or hard error
+		}
+	}
+
+	void process_input(ClientConnection& conn) {
+		if (conn.h2) {
+			feed_http2(conn);
+			return;
+		}
+		if (conn.sse) {
+			conn.in.clear(); // Nothing more is expected from an event-stream client
+			return;
+		}
+
+		while (!conn.close_after_write && !conn.awaiting && !conn.sse) {
+			if (conn.body) {
+				if (!pump_body(conn)) return;
+				continue;
+			}
+			if (conn.in.empty()) return;
+
+			// HTTP/2 with prior knowledge starts with the connection preface
+			if (http2_ && conn.in[0] == 'P') {
+				size_t n = std::min(conn.in.size(), h2_preface.size());
+				if (std::string_view(conn.in).substr(0, n) == h2_preface.substr(0, n)) {
+					if (n < h2_preface.size()) return;
+					start_http2(conn);
+					conn.h2->start();
+					feed_http2(conn);
+					return;
+				}
+			}
+
+			auto header_end = conn.in.find("\r\n\r\n");
+			if (header_end == std::string::npos) {
+				if (conn.in.size() > MAX_HEADER_SIZE) reject(conn, HttpStatus::BadRequest);
+				return;
+			}
+			size_t body_start = header_end + 4;
+
+			auto req = http_parser::parse_request(std::string_view(conn.in).substr(0, body_start));
+			conn.in.erase(0, body_start);
+			begin_body(conn, std::move(req));
+		}
+	}
+
+	/**
+	 * @brief Work out body framing for a parsed request head
+	 */
+	void begin_body(ClientConnection& conn, HttpRequest req) {
+		auto body = std::make_unique<InboundBody>();
+		auto transfer_encoding = detail::trim(req.headers.get("Transfer-Encoding"));
+		if (!transfer_encoding.empty()) {
+			if (!detail::iequals(transfer_encoding, "chunked")) {
+				reject(conn, HttpStatus::NotImplemented);
+				return;
+			}
+			body->chunked = true;
+		} else {
+			auto content_length = parse_content_length(req.headers.get("Content-Length"));
+			if (!content_length) {
+				reject(conn, HttpStatus::BadRequest);
+				return;
+			}
+			body->remaining = *content_length;
+		}
+
+		const ProxyRoute* proxy_route = nullptr;
+		if (auto route = find_stream_route(req)) {
+			body->handler = route->handler;
+			body->metrics_slot = route->metrics_slot;
+		} else if ((proxy_route = find_proxy_route(req))) {
+			body->proxied = true;
+			body->metrics_slot = proxy_route->metrics_slot;
+		}
+		body->keep_alive = wants_keep_alive(req);
+		if (admission_ && !admit(conn, req)) {
+			// Skipping an unread body is not worth it for a request being shed
+			bool has_body = body->chunked || body->remaining > 0;
+			auto resp = overloaded_response();
+			write_response(conn, req, resp, body->keep_alive && !has_body);
+			if (has_body) conn.in.clear();
+			return;
+		}
+		if (!body->handler && !body->proxied && body->remaining > MAX_REQUEST_SIZE) {
+			reject(conn, HttpStatus::PayloadTooLarge);
+			return;
+		}
+
+		if (body->handler) {
+			if (metrics_) {
+				body->started = std::chrono::steady_clock::now();
+				metrics_->request_started(body->metrics_slot);
+			}
+			body->stream = std::make_unique<BodyStream>();
+			if (!body->chunked) body->stream->content_length_ = body->remaining;
+			auto fd = conn.socket.native_handle();
+			body->stream->on_resume_ = [this, fd] { resume_body(fd); };
+			if (body->handler->on_headers) {
+				body->stream->in_callback_ = true;
+				body->handler->on_headers(req, *body->stream);
+				body->stream->in_callback_ = false;
+			}
+		}
+		body->req = std::move(req);
+		conn.body = std::move(body);
+		if (proxy_route) start_proxy(conn, *proxy_route);
+		if (conn.body->stream && conn.body->stream->rejection_) {
+			reject_stream(conn);
+			return;
+		}
+
+		bool expects_body = conn.body->chunked || conn.body->remaining > 0;
+		if (expects_body && conn.body->req.version == "HTTP/1.1"
+			&& detail::iequals(detail::trim(conn.body->req.headers.get("Expect")), "100-continue")) {
+			conn.out += "HTTP/1.1 100 Continue\r\n\r\n";
+		}
+	}
+
+	/**
+	 * @brief Move buffered input into the body in progress
+	 * @return true once the request completed and input processing may go on
+	 */
+	bool pump_body(ClientConnection& conn) {
+		auto& b = *conn.body;
+		size_t offset = 0;
+		bool finished = b.chunked ? b.decoder.done() : b.remaining == 0;
+
+		while (!finished && !(b.stream && b.stream->paused_)) {
+			auto avail = std::string_view(conn.in).substr(offset);
+			std::string_view data;
+			if (b.chunked) {
+				size_t used = b.decoder.decode(avail, data);
+				if (b.decoder.failed()) {
+					abort_body(conn);
+					reject(conn, HttpStatus::BadRequest);
+					return false;
+				}
+				if (used == 0) break;
+				offset += used;
+				finished = b.decoder.done();
+			} else {
+				size_t n = static_cast<size_t>(std::min<uint64_t>(b.remaining, avail.size()));
+				if (n == 0) break;
+				data = avail.substr(0, n);
+				offset += n;
+				b.remaining -= n;
+				finished = b.remaining == 0;
+			}
+			if (!data.empty() && !deliver(conn, data)) return false;
+		}
+		conn.in.erase(0, offset);
+
+		if (!finished || (b.stream && b.stream->paused_)) return false;
+		complete_body(conn);
+		return true;
+	}
+
+	/**
+	 * @brief Hand one body piece to its consumer
+	 * @return false if the request was rejected (conn.body is gone)
+	 */
+	bool deliver(ClientConnection& conn, std::string_view data) {
+		auto& b = *conn.body;
+		if (!b.stream) {
+			if (b.req.body.size() + data.size() > MAX_REQUEST_SIZE) {
+				conn.body.reset();
+				reject(conn, HttpStatus::PayloadTooLarge);
+				return false;
+			}
+			b.req.body.append(data);
+			return true;
+		}
+
+		b.stream->received_ += data.size();
+		if (b.proxied) {
+			if (conn.proxy->send_body(data)) b.stream->paused_ = true;
+			return true;
+		}
+		if (b.handler->on_data) {
+			b.stream->in_callback_ = true;
+			b.handler->on_data(data, *b.stream);
+			b.stream->in_callback_ = false;
+		}
+		if (b.stream->rejection_) {
+			reject_stream(conn);
+			return false;
+		}
+		return true;
+	}
+
+	void complete_body(ClientConnection& conn) {
+		auto body = std::move(conn.body);
+		auto& req = body->req;
+
+		if (!body->stream && http2_ && is_h2c_upgrade(req)) {
+			conn.out += "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+			start_http2(conn);
+			if (!conn.h2->start_upgraded(req, req.headers.get("HTTP2-Settings"))) {
+				conn.close_after_write = true;
+				return;
+			}
+			feed_http2(conn);
+			return;
+		}
+
+		HttpResponse resp;
+		if (body->proxied) {
+			conn.awaiting = std::move(body);
+			conn.proxy->end_request();
+			return;
+		}
+		if (body->stream) {
+			body->stream->in_callback_ = true;
+			if (body->handler->on_complete) resp = body->handler->on_complete(req, *body->stream);
+			body->stream->in_callback_ = false;
+			if (metrics_) {
+				metrics_->request_finished(body->metrics_slot, resp.status, elapsed_ns(body->started),
+					body->stream->received_, resp.body.size());
+			}
+			finalize(req, resp);
+		} else if (auto route = find_async_route(req)) {
+			start_async(conn, std::move(body), *route);
+			return;
+		} else if (auto sse_route = find_sse_route(req)) {
+			start_sse(conn, std::move(body), *sse_route);
+			return;
+		} else if (workers_ && find_route(req)) {
+			start_pooled(conn, std::move(body));
+			return;
+		} else if (auto entry = cached(req)) {
+			write_cached(conn, entry, body->keep_alive);
+			return;
+		} else {
+			resp = produce(req);
+		}
+		write_response(conn, req, resp, body->keep_alive);
+	}
+
+	/**
+	 * @brief Hand a request to an async handler; the response comes via finish_async()
+	 */
+	void start_async(ClientConnection& conn, std::unique_ptr<InboundBody> body, const AsyncRoute& route) {
+		body->metrics_slot = route.metrics_slot;
+		if (metrics_) {
+			body->started = std::chrono::steady_clock::now();
+			metrics_->request_started(body->metrics_slot);
+		}
+		auto& req = body->req;
+		conn.awaiting = std::move(body);
+
+		route.handler(req, responder_for(conn));
+	}
+
+	/**
+	 * @brief Run a route handler on the connection's worker; the response comes via finish_async()
+	 */
+	void start_pooled(ClientConnection& conn, std::unique_ptr<InboundBody> body) {
+		body->pooled = true;
+		auto req = std::make_shared<const HttpRequest>(std::move(body->req));
+		body->req.method = req->method; // All write_response() needs of it
+		conn.awaiting = std::move(body);
+		auto responder = responder_for(conn);
+		async::WorkerPool::Task task = [this, req, responder] { responder.send(respond(*req)); };
+		if (workers_->submit(conn.id, task)) return;
+		responder.send(overloaded_response());
+	}
+
+	/**
+	 * @brief Responder that completes the connection's awaited request from any thread
+	 */
+	HttpResponder responder_for(const ClientConnection& conn) {
+		auto fd = conn.socket.native_handle();
+		return HttpResponder([hub = async_hub_, fd, id = conn.id](HttpResponse resp) {
+			std::lock_guard lock(hub->mutex);
+			if (!hub->server) return;
+			hub->loop->post([hub, fd, id, resp = std::move(resp)]() mutable {
+				if (hub->server) hub->server->finish_async(fd, id, std::move(resp));
+			});
+		});
+	}
+
+	void finish_async(net::impl::socket_t fd, uint64_t id, HttpResponse resp) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end() || it->second->id != id || !it->second->awaiting) return;
+		auto& conn = *it->second;
+		auto body = std::move(conn.awaiting);
+		if (!body->pooled) {
+			if (metrics_) {
+				metrics_->request_finished(body->metrics_slot, resp.status, elapsed_ns(body->started),
+					body->req.body.size(), resp.body.size());
+			}
+			finalize(body->req, resp);
+		}
+		write_response(conn, body->req, resp, body->keep_alive);
+		process_input(conn); // Pipelined requests queued behind this one
+		finish_io(fd, conn);
+	}
+
+	// ─── Reverse proxy ────────────────
+
+	/**
+	 * @brief Start forwarding conn.body upstream; the outcome comes via finish_proxy()
+	 */
+	void start_proxy(ClientConnection& conn, const ProxyRoute& route) {
+		auto& body = *conn.body;
+		if (metrics_) {
+			body.started = std::chrono::steady_clock::now();
+			metrics_->request_started(body.metrics_slot);
+		}
+		auto fd = conn.socket.native_handle();
+		auto id = conn.id;
+		if (!conn.no_delay) {
+			// Responses are forwarded piece by piece; the tail of each must not wait for an ACK
+			conn.socket.set_no_delay(true);
+			conn.no_delay = true;
+		}
+		// A stream only for pause(): the proxy holds the client back while the upstream is slow
+		body.stream = std::make_unique<BodyStream>();
+		if (!body.chunked) body.stream->content_length_ = body.remaining;
+
+		ProxyDownstream downstream;
+		downstream.fd = fd;
+		downstream.write = [this, fd, id](std::string_view data) {
+			auto* c = proxied_connection(fd, id);
+			if (!c || c->broken) return;
+			c->out.append(data);
+			if (!flush_output(*c)) {
+				break_connection(*c);
+				return;
+			}
+			refresh_timer(*c);
+			update_interest(fd, *c);
+		};
+		downstream.flush = [this, fd, id] {
+			auto* c = proxied_connection(fd, id);
+			if (!c || c->broken) return;
+			if (!flush_output(*c)) {
+				break_connection(*c);
+				return;
+			}
+			refresh_timer(*c);
+			update_interest(fd, *c);
+		};
+		downstream.queued = [this, fd, id]() -> size_t {
+			auto* c = proxied_connection(fd, id);
+			return c ? c->shared_bytes + (c->out.size() - c->out_offset) : 0;
+		};
+		downstream.resume_request = [this, fd, id] {
+			auto* c = proxied_connection(fd, id);
+			if (!c || !c->body || !c->body->stream) return;
+			c->body->stream->paused_ = false;
+			// From the loop: the exchange is in the middle of a send
+			async_hub_->loop->post([hub = async_hub_, fd, id] {
+				if (hub->server && hub->server->proxied_connection(fd, id)) hub->server->resume_body(fd);
+			});
+		};
+		downstream.done = [hub = async_hub_, fd, id](ProxyResult result) {
+			hub->loop->post([hub, fd, id, result = std::move(result)]() mutable {
+				if (hub->server) hub->server->finish_proxy(fd, id, std::move(result));
+			});
+		};
+
+		auto target = body.req.path;
+		if (route.options.strip_prefix) {
+			target.erase(0, route.prefix.ends_with('/') ? route.prefix.size() - 1 : route.prefix.size());
+			if (target.empty() || target[0] != '/') target.insert(0, 1, '/');
+		}
+		const auto& ip = conn.peer.bytes();
+		auto client = std::format("{}.{}.{}.{}", ip[0], ip[1], ip[2], ip[3]);
+
+		conn.proxy = std::make_shared<ProxyExchange>(route.pool, route.options, *loop_, std::move(downstream));
+		conn.proxy->start(body.req, target, body.chunked, body.keep_alive && !draining_, client);
+	}
+
+	ClientConnection* proxied_connection(net::impl::socket_t fd, uint64_t id) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end() || it->second->id != id || !it->second->proxy) return nullptr;
+		return it->second.get();
+	}
+
+	void finish_proxy(net::impl::socket_t fd, uint64_t id, ProxyResult result) {
+		auto* c = proxied_connection(fd, id);
+		if (!c) return;
+		auto& conn = *c;
+		std::unique_ptr<InboundBody> body;
+		if (conn.awaiting && conn.awaiting->proxied) {
+			body = std::move(conn.awaiting);
+		} else if (conn.body && conn.body->proxied) {
+			// Answered before the request body was read: the rest of it is not worth reading
+			body = std::move(conn.body);
+			conn.in.clear();
+			result.keep_alive = false;
+		} else {
+			return;
+		}
+		conn.proxy.reset();
+		if (metrics_) {
+			metrics_->request_finished(body->metrics_slot, result.status, elapsed_ns(body->started),
+				result.bytes_up, result.bytes_down);
+		}
+
+		if (result.broken) {
+			break_connection(conn);
+			return;
+		}
+		if (result.error) {
+			write_response(conn, body->req, *result.error, result.keep_alive && body->keep_alive);
+		} else {
+			conn.served = true;
+			conn.phase = Phase::None;
+			if (!result.keep_alive || draining_) conn.close_after_write = true;
+		}
+		process_input(conn); // Pipelined requests queued behind this one
+		finish_io(fd, conn);
+	}
+
+	void reject_stream(ClientConnection& conn) {
+		auto body = std::move(conn.body);
+		auto resp = std::move(*body->stream->rejection_);
+		if (metrics_) {
+			metrics_->request_finished(body->metrics_slot, resp.status, elapsed_ns(body->started),
+				body->stream->received_, resp.body.size());
+		}
+		write_response(conn, body->req, resp, false);
+		conn.in.clear();
+	}
+
+	/**
+	 * @brief Tell a stream handler its request will never complete
+	 */
+	void abort_body(ClientConnection& conn) {
+		auto body = std::move(conn.body);
+		if (!body || !body->stream) return;
+		if (metrics_) metrics_->request_aborted(body->metrics_slot, body->stream->received_);
+		if (body->proxied) {
+			if (auto exchange = std::move(conn.proxy)) exchange->cancel();
+			return;
+		}
+		if (body->handler->on_abort) body->handler->on_abort(body->req);
+	}
+
+	// ─── Server-Sent Events ────────────────
+
+	void start_sse(ClientConnection& conn, std::unique_ptr<InboundBody> body, const SseRoute& route) {
+		auto stream = std::make_shared<SseStream>();
+		stream->server_ = this;
+		stream->fd_ = conn.socket.native_handle();
+		stream->connection_id_ = conn.id;
+		stream->metrics_slot_ = route.metrics_slot;
+		if (metrics_) {
+			stream->started_ = std::chrono::steady_clock::now();
+			metrics_->request_started(route.metrics_slot);
+		}
+
+		conn.out += "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n";
+		conn.sse = stream;
+		conn.served = true;
+		conn.phase = Phase::None;
+		conn.stream_tick = loop_->timers().now_tick();
+		if (draining_) conn.close_after_write = true;
+		route.handler(body->req, std::move(stream));
+	}
+
+	/**
+	 * @brief Queue a shared buffer on an event stream
+	 *
+	 * The bytes go out when the socket next polls writable, so events
+	 * published in one loop turn leave in one vectored write. Never closes
+	 * the connection on the spot (callers may be iterating over streams);
+	 * a backed-up stream is marked broken and closed from the loop.
+	 */
+	bool sse_write(net::impl::socket_t fd, uint64_t id, std::shared_ptr<const std::string> buf) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end() || it->second->id != id || !it->second->sse) return false;
+		auto& conn = *it->second;
+		if (conn.broken) return false;
+		if (conn.shared_bytes + buf->size() > sse_options_.max_queued_bytes) {
+			break_connection(conn);
+			return false;
+		}
+		queue_shared(conn, std::move(buf));
+		conn.stream_tick = loop_->timers().now_tick();
+		refresh_timer(conn);
+		update_interest(fd, conn);
+		return true;
+	}
+
+	void sse_close(net::impl::socket_t fd, uint64_t id) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end() || it->second->id != id) return;
+		it->second->close_after_write = true;
+		settle_later(*it->second);
+	}
+
+	void break_connection(ClientConnection& conn) {
+		conn.broken = true;
+		conn.close_after_write = true;
+		conn.shared_out.clear();
+		conn.shared_bytes = 0;
+		conn.out.clear();
+		conn.out_offset = 0;
+		settle_later(conn);
+	}
+
+	/**
+	 * @brief Run finish_io for a connection from the loop, outside the current call stack
+	 */
+	void settle_later(ClientConnection& conn) {
+		if (!async_hub_) return;
+		auto fd = conn.socket.native_handle();
+		async_hub_->loop->post([hub = async_hub_, fd, id = conn.id] {
+			if (hub->server) hub->server->settle(fd, id);
+		});
+	}
+
+	void settle(net::impl::socket_t fd, uint64_t id) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end() || it->second->id != id) return;
+		finish_io(fd, *it->second);
+	}
+
+	/**
+	 * @brief Send a heartbeat comment if the stream has been quiet long enough
+	 */
+	void heartbeat(net::impl::socket_t fd, ClientConnection& conn) {
+		if (elapsed_since(conn.stream_tick) < sse_options_.heartbeat) {
+			arm_timer(conn);
+			return;
+		}
+		static const auto ping = std::make_shared<const std::string>(sse_comment("ping"));
+		if (!sse_write(fd, conn.id, ping)) return;
+		if (conn.phase == Phase::Stream) arm_timer(conn); // Fired and still idle: refresh_timer left it unarmed
+	}
+
+	/**
+	 * @brief Detach a closing connection's event stream, recording its metrics
+	 */
+	std::shared_ptr<SseStream> end_stream(ClientConnection& conn) {
+		auto stream = std::move(conn.sse);
+		if (!stream) return nullptr;
+		stream->server_ = nullptr;
+		if (metrics_) {
+			metrics_->request_finished(stream->metrics_slot_, HttpStatus::OK, elapsed_ns(stream->started_),
+				0, conn.bytes_out);
+		}
+		return stream;
+	}
+
+	/**
+	 * @brief The connection closed before its async handler responded
+	 */
+	void abandon_async(ClientConnection& conn) {
+		auto waiting = std::move(conn.awaiting);
+		if (waiting && !waiting->pooled && metrics_) metrics_->request_aborted(waiting->metrics_slot, waiting->req.body.size());
+	}
+
+	void start_http2(ClientConnection& conn) {
+		conn.h2 = std::make_unique<Http2Session>(
+			[this, &conn](const HttpRequest& r) {
+				if (admission_ && !admit(conn, r)) return overloaded_response();
+				return respond(r);
+			}, *http2_);
+	}
+
+	// ─── Admission control ────────────────
+
+	bool admit(const ClientConnection& conn, const HttpRequest& req) {
+		auto priority = admission_->options().default_priority;
+		for (const auto& p : route_priorities_) {
+			if (p.path == req.path) { priority = p.priority; break; }
+		}
+		auto now = std::chrono::steady_clock::now();
+		return admission_->admit(now - conn.received, priority, now);
+	}
+
+	/// 503 for a shed request or a full worker queue; Retry-After is 1 s without admission control
+	HttpResponse overloaded_response() const {
+		HttpResponse resp;
+		resp.status = HttpStatus::ServiceUnavailable;
+		resp.headers.set("Content-Type", "text/plain");
+		auto ms = admission_ ? admission_->options().retry_after.count() : 1000;
+		resp.headers.set("Retry-After", std::to_string(std::max<int64_t>((ms + 999) / 1000, 1)));
+		resp.body = "503 Service Unavailable";
+		return resp;
+	}
+
+	void feed_http2(ClientConnection& conn) {
+		bool ok = conn.h2->feed(conn.in);
+		conn.in.clear();
+		auto& h2_out = conn.h2->output();
+		conn.out.append(h2_out);
+		h2_out.clear();
+		if (!ok) conn.close_after_write = true;
+	}
+
+	void write_response(ClientConnection& conn, const HttpRequest& req, HttpResponse& resp, bool keep_alive) {
+		keep_alive = keep_alive && !draining_;
+		if (!keep_alive) resp.headers.set("Connection", "close");
+		auto code = static_cast<uint16_t>(resp.status);
+		if (!resp.headers.has("Content-Length") && code >= 200 && code != 204 && code != 304) {
+			resp.headers.set("Content-Length", std::to_string(resp.body.size()));
+		}
+		if (req.method == HttpMethod::Head) resp.body.clear();
+		conn.out += resp.serialize();
+		if (!keep_alive) conn.close_after_write = true;
+		conn.served = true;
+		conn.phase = Phase::None; // The next request head gets a fresh deadline
+	}
+
+	/**
+	 * @brief Queue a cached response; on a kept-alive connection without copying it
+	 */
+	void write_cached(ClientConnection& conn, const ResponseCache::Handle& entry, bool keep_alive) {
+		if (keep_alive && !draining_) {
+			queue_shared(conn, std::shared_ptr<const std::string>(entry, &entry->wire));
+		} else {
+			std::string_view wire = entry->wire;
+			auto line_end = wire.find("\r\n") + 2;
+			conn.out.append(wire.substr(0, line_end));
+			conn.out += "Connection: close\r\n";
+			conn.out.append(wire.substr(line_end));
+			conn.close_after_write = true;
+		}
+		conn.served = true;
+		conn.phase = Phase::None;
+	}
+
+	void reject(ClientConnection& conn, HttpStatus status) {
+		HttpResponse resp;
+		resp.status = status;
+		resp.headers.set("Content-Type", "text/plain");
+		resp.body = std::to_string(static_cast<uint16_t>(status)) + " " + std::string(status_text(status));
+		HttpRequest req;
+		write_response(conn, req, resp, false);
+		conn.in.clear();
+	}
+
+	/**
+	 * @brief Write queued output until the socket would block
+	 * @return false on a hard send error
+	 */
+	bool flush_output(ClientConnection& conn) {
+		while (has_queued(conn)) {
+			std::array<std::span<const uint8_t>, 16> parts;
+			size_t count = 0;
+			size_t skip = conn.shared_offset;
+			for (const auto& buf : conn.shared_out) {
+				if (count == parts.size()) break;
+				parts[count++] = as_bytes(std::string_view(*buf).substr(skip));
+				skip = 0;
+			}
+			if (count < parts.size() && conn.out_offset < conn.out.size()) {
+				parts[count++] = as_bytes(std::string_view(conn.out).substr(conn.out_offset));
+			}
+
+			int sent = count == 1 ? conn.socket.send(parts[0])
+				: conn.socket.send_vectored(std::span(parts.data(), count));
+			if (sent > 0) {
+				consume_output(conn, static_cast<size_t>(sent));
+				conn.bytes_out += static_cast<size_t>(sent);
+				if (metrics_) metrics_->add_network_io(0, static_cast<size_t>(sent));
+				conn.progress_tick = loop_->timers().now_tick();
+				continue;
+			}
+			if (sent < 0 && core::last_platform_error() == core::Error::WouldBlock) return true;
+			return false;
+		}
+		conn.out.clear();
+		conn.out_offset = 0;
+		if (conn.proxy && !conn.broken && conn.proxy->pending_splice()) {
+			// Spliced response bytes follow whatever was queued before them
+			auto moved = conn.proxy->drain_splice();
+			if (moved < 0) return false;
+			if (moved > 0) {
+				conn.bytes_out += static_cast<uint64_t>(moved);
+				if (metrics_) metrics_->add_network_io(0, static_cast<size_t>(moved));
+				conn.progress_tick = loop_->timers().now_tick();
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Queue a buffer for sending without copying it
+	 */
+	static void queue_shared(ClientConnection& conn, std::shared_ptr<const std::string> buf) {
+		if (conn.out_offset < conn.out.size()) { // Earlier output goes first
+			auto rest = std::make_shared<const std::string>(conn.out.substr(conn.out_offset));
+			conn.shared_bytes += rest->size();
+			conn.shared_out.push_back(std::move(rest));
+		}
+		conn.out.clear();
+		conn.out_offset = 0;
+		conn.shared_bytes += buf->size();
+		conn.shared_out.push_back(std::move(buf));
+	}
+
+	static bool has_output(const ClientConnection& conn) noexcept {
+		return has_queued(conn) || (conn.proxy && conn.proxy->pending_splice());
+	}
+
+	/// Output in the connection's own buffers (spliced proxy bytes excluded)
+	static bool has_queued(const ClientConnection& conn) noexcept {
+		return !conn.shared_out.empty() || conn.out_offset < conn.out.size();
+	}
+
+	static void consume_output(ClientConnection& conn, size_t n) noexcept {
+		while (n > 0 && !conn.shared_out.empty()) {
+			size_t left = conn.shared_out.front()->size() - conn.shared_offset;
+			if (n < left) {
+				conn.shared_offset += n;
+				return;
+			}
+			n -= left;
+			conn.shared_bytes -= conn.shared_out.front()->size();
+			conn.shared_out.pop_front();
+			conn.shared_offset = 0;
+		}
+		conn.out_offset += n;
+	}
+
+	static std::span<const uint8_t> as_bytes(std::string_view data) noexcept {
+		return {reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+	}
+
+	void update_interest(net::impl::socket_t fd, ClientConnection& conn) {
+		auto interest = (conn.peer_closed || body_paused(conn))
+			? async::PollEvent::None : async::PollEvent::ReadReady;
+		if (has_output(conn)) interest |= async::PollEvent::WriteReady;
+		if (interest == conn.interest) return;
+		conn.interest = interest;
+		loop_->add(fd, interest, [this](net::impl::socket_t cfd, async::PollEvent events) {
+			on_client_event(cfd, events);
+		});
+	}
+
+	// ─── Timeouts ────────────────
+
+	static Phase current_phase(const ClientConnection& conn) noexcept {
+		if (has_output(conn)) return Phase::Write;
+		if (conn.sse) return Phase::Stream;
+		if (conn.awaiting) return Phase::None; // The handler owns the deadline
+		if (conn.body) return body_paused(conn) ? Phase::Paused : Phase::Body;
+		if (conn.h2) return Phase::Idle;
+		if (!conn.in.empty() || !conn.served) return Phase::Head;
+		return Phase::Idle;
+	}
+
+	/**
+	 * @brief Re-arm the connection timer when its phase changed
+	 *
+	 * Steady-state reads and writes only bump counters; the wheel is
+	 * touched on phase changes and when a check fires.
+	 */
+	void refresh_timer(ClientConnection& conn) {
+		auto phase = current_phase(conn);
+		if (phase == conn.phase) return;
+		conn.phase = phase;
+		auto now = loop_->timers().now_tick();
+		conn.phase_tick = conn.progress_tick = conn.window_tick = now;
+		conn.window_bytes = phase_bytes(conn);
+		arm_timer(conn);
+	}
+
+	std::chrono::milliseconds elapsed_since(uint64_t tick) noexcept {
+		auto& timers = loop_->timers();
+		return timers.tick() * static_cast<int64_t>(timers.now_tick() - tick);
+	}
+
+	void arm_timer(ClientConnection& conn) {
+		auto& timers = loop_->timers();
+		std::chrono::milliseconds next{0};
+		auto consider = [&](std::chrono::milliseconds limit, uint64_t since) {
+			if (limit.count() <= 0) return;
+			auto left = std::max(limit - elapsed_since(since), timers.tick());
+			if (next.count() == 0 || left < next) next = left;
+		};
+
+		switch (conn.phase) {
+			case Phase::Idle:  consider(timeouts_.keep_alive_idle, conn.progress_tick); break;
+			case Phase::Head:  consider(timeouts_.header_read, conn.phase_tick); break;
+			case Phase::Body:  consider(timeouts_.body_read, conn.progress_tick); break;
+			case Phase::Write: consider(timeouts_.write, conn.progress_tick); break;
+			case Phase::Stream: consider(sse_options_.heartbeat, conn.stream_tick); break;
+			default: break;
+		}
+		if (rate_limited(conn.phase)) consider(timeouts_.rate_window, conn.window_tick);
+
+		if (next.count() == 0) timers.cancel(conn.timer);
+		else timers.schedule(conn.timer, next);
+	}
+
+	bool rate_limited(Phase phase) const noexcept {
+		return timeouts_.min_bytes_per_second > 0
+			&& (phase == Phase::Head || phase == Phase::Body || phase == Phase::Write);
+	}
+
+	static uint64_t phase_bytes(const ClientConnection& conn) noexcept {
+		return conn.phase == Phase::Write ? conn.bytes_out : conn.bytes_in;
+	}
+
+	void on_timeout(net::impl::socket_t fd) {
+		auto it = connections_.find(fd);
+		if (it == connections_.end()) return;
+		auto& conn = *it->second;
+		if (conn.phase == Phase::Stream) {
+			heartbeat(fd, conn);
+			return;
+		}
+		auto over = [&](std::chrono::milliseconds limit, uint64_t since) {
+			return limit.count() > 0 && elapsed_since(since) >= limit;
+		};
+
+		bool expired = false;
+		switch (conn.phase) {
+			case Phase::Idle:  expired = over(timeouts_.keep_alive_idle, conn.progress_tick); break;
+			case Phase::Head:  expired = over(timeouts_.header_read, conn.phase_tick); break;
+			case Phase::Body:  expired = over(timeouts_.body_read, conn.progress_tick); break;
+			case Phase::Write: expired = over(timeouts_.write, conn.progress_tick); break;
+			default: break;
+		}
+
+		if (!expired && rate_limited(conn.phase) && over(timeouts_.rate_window, conn.window_tick)) {
+			auto seconds = std::chrono::duration<double>(elapsed_since(conn.window_tick)).count();
+			auto moved = static_cast<double>(phase_bytes(conn) - conn.window_bytes);
+			if (moved < timeouts_.min_bytes_per_second * seconds) {
+				expired = true;
+			} else {
+				conn.window_tick = loop_->timers().now_tick();
+				conn.window_bytes = phase_bytes(conn);
+			}
+		}
+
+		if (!expired) {
+			arm_timer(conn);
+			return;
+		}
+
+		++timed_out_;
+		if (conn.phase == Phase::Head || conn.phase == Phase::Body) {
+			// Tell the client why, then close once that is flushed (or the write times out)
+			abort_body(conn);
+			reject(conn, HttpStatus::RequestTimeout);
+			finish_io(fd, conn);
+			return;
+		}
+		close_connection(fd);
+	}
+
+	// ─── Listener handoff ────────────────
+
+	void watch_handoff() {
+		loop_->add(handoff_.native_handle(), async::PollEvent::ReadReady,
+			[this](net::impl::socket_t, async::PollEvent) { offer_listener(); });
+	}
+
+	/**
+	 * @brief A successor connected: send it the listener and await READY
+	 */
+	void offer_listener() {
+		while (true) {
+			auto peer = handoff_.accept();
+			if (!peer) return;
+			if (handoff_peer_.is_open() || !listening_) continue; // One handoff at a time
+
+			// The offer is tiny; a short blocking send keeps this simple
+			peer->set_timeout(std::chrono::seconds(1));
+			auto fd = listener_.native_handle();
+			if (core::is_error(peer->send_fds(std::span(&fd, 1), net::handoff::OFFER))) continue;
+			if (core::is_error(peer->set_nonblocking(true))) continue;
+			handoff_peer_ = std::move(*peer);
+			loop_->add(handoff_peer_.native_handle(), async::PollEvent::ReadReady,
+				[this](net::impl::socket_t, async::PollEvent) { handoff_reply(); });
+		}
+	}
+
+	void handoff_reply() {
+		std::array<char, 16> buf{};
+		int n = handoff_peer_.recv(buf);
+		if (n < 0 && core::last_platform_error() == core::Error::WouldBlock) return;
+		bool ready = n > 0 && std::string_view(buf.data(), static_cast<size_t>(n)).starts_with(net::handoff::READY);
+		loop_->remove(handoff_peer_.native_handle());
+		handoff_peer_.close();
+		if (!ready) return; // The successor gave up; keep serving
+		handed_off_ = true;
+		drain();
+	}
+
+	/**
+	 * @brief Stop offering the listener; the path is left for a successor that took it
+	 */
+	void close_handoff() {
+		if (loop_) {
+			if (handoff_.is_open()) loop_->remove(handoff_.native_handle());
+			if (handoff_peer_.is_open()) loop_->remove(handoff_peer_.native_handle());
+		}
+		handoff_peer_.close();
+		if (handed_off_) handoff_.close();
+		else handoff_.remove();
+	}
+
+	void close_connection(net::impl::socket_t fd) {
+		if (loop_) loop_->remove(fd);
+		auto it = connections_.find(fd);
+		if (it == connections_.end()) return;
+		auto conn = std::move(it->second);
+		connections_.erase(it);
+		if (conn->proxy) conn->proxy->cancel();
+		abort_body(*conn);
+		abandon_async(*conn);
+		if (auto stream = end_stream(*conn); stream && stream->on_close && async_hub_) {
+			// Deferred: the close may come from inside a publish() over this stream
+			async_hub_->loop->post([hub = async_hub_, stream] {
+				if (hub->server) stream->on_close();
+			});
+		}
+		if (metrics_) metrics_->connection_closed();
+	}
+
+	static bool wants_keep_alive(const HttpRequest& req) noexcept {
+		auto connection = req.headers.get("Connection");
+		if (req.version == "HTTP/1.0") return detail::icontains(connection, "keep-alive");
+		return !detail::icontains(connection, "close");
+	}
+
+	static bool is_h2c_upgrade(const HttpRequest& req) noexcept {
+		return detail::icontains(req.headers.get("Upgrade"), "h2c")
+			&& detail::icontains(req.headers.get("Connection"), "upgrade")
+			&& req.headers.has("HTTP2-Settings");
+	}
+
+	static std::optional<uint64_t> parse_content_length(std::string_view value) noexcept {
+		value = detail::trim(value);
+		if (value.size() > 18) return std::nullopt; // Would overflow
+		uint64_t n = 0;
+		for (char c : value) {
+			if (c < '0' || c > '9') return std::nullopt;
+			n = n * 10 + static_cast<uint64_t>(c - '0');
+		}
+		return n;
+	}
+
+	/**
+	 * @brief Find and call matching route handler
+	 */
+	HttpResponse dispatch(const HttpRequest& req) {
+		for (const auto& r : routes_) {
+			if (r.method == req.method && r.path == req.path) {
+				return measured(r.metrics_slot, req, [&] { return r.handler(req); });
+			}
+		}
+		if (auto route = find_stream_route(req)) {
+			return measured(route->metrics_slot, req, [&] { return replay_stream(*route->handler, req); });
+		}
+		if (auto route = find_async_route(req)) {
+			return measured(route->metrics_slot, req, [&] { return await_async(route->handler, req); });
+		}
+		if (auto route = find_sse_route(req)) {
+			return measured(route->metrics_slot, req, [] {
+				HttpResponse resp;
+				resp.status = HttpStatus::NotImplemented;
+				resp.headers.set("Content-Type", "text/plain");
+				resp.body = "Event streams are served over HTTP/1.1 only";
+				return resp;
+			});
+		}
+		if (auto route = find_proxy_route(req)) {
+			return measured(route->metrics_slot, req, [] {
+				HttpResponse resp;
+				resp.status = HttpStatus::NotImplemented;
+				resp.headers.set("Content-Type", "text/plain");
+				resp.body = "Proxied routes are served over HTTP/1.1 in event-loop mode only";
+				return resp;
+			});
+		}
+
+		return measured(ServerMetrics::UNMATCHED, req, [] {
+			// 404 Not Found
+			HttpResponse resp;
+			resp.status = HttpStatus::NotFound;
+			resp.headers.set("Content-Type", "text/plain");
+			resp.body = "404 Not Found";
+			return resp;
+		});
+	}
+
+	/**
+	 * @brief Run produce() and record it against a metrics slot
+	 */
+	template <typename Produce>
+	HttpResponse measured(size_t slot, const HttpRequest& req, Produce&& produce) {
+		if (!metrics_) return produce();
+		auto start = std::chrono::steady_clock::now();
+		metrics_->request_started(slot);
+		auto resp = produce();
+		metrics_->request_finished(slot, resp.status, elapsed_ns(start), req.body.size(), resp.body.size());
+		return resp;
+	}
+
+	static uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) noexcept {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - since).count());
+	}
+
+	size_t metrics_slot(HttpMethod method, std::string_view path) {
+		return metrics_ ? metrics_->add_route(std::string(method_string(method)), std::string(path))
+			: ServerMetrics::UNMATCHED;
+	}
+
+	const Route* find_route(const HttpRequest& req) const {
+		for (const auto& r : routes_) {
+			if (r.method == req.method && r.path == req.path) return &r;
+		}
+		return nullptr;
+	}
+
+	const StreamRoute* find_stream_route(const HttpRequest& req) const {
+		for (const auto& r : stream_routes_) {
+			if (r.method == req.method && r.path == req.path) return &r;
+		}
+		return nullptr;
+	}
+
+	const AsyncRoute* find_async_route(const HttpRequest& req) const {
+		for (const auto& r : async_routes_) {
+			if (r.method == req.method && r.path == req.path) return &r;
+		}
+		return nullptr;
+	}
+
+	const SseRoute* find_sse_route(const HttpRequest& req) const {
+		if (req.method != HttpMethod::Get) return nullptr;
+		for (const auto& r : sse_routes_) {
+			if (r.path == req.path) return &r;
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief Proxy route whose prefix covers the request path, unless an exact route takes it
+	 */
+	const ProxyRoute* find_proxy_route(const HttpRequest& req) const {
+		if (proxy_routes_.empty() || find_route(req) || find_async_route(req) || find_sse_route(req)) return nullptr;
+		for (const auto& r : proxy_routes_) {
+			if (!req.path.starts_with(r.prefix)) continue;
+			if (req.path.size() == r.prefix.size() || r.prefix.ends_with('/')) return &r;
+			char next = req.path[r.prefix.size()];
+			if (next == '/' || next == '?') return &r;
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief Run an async handler and block until it responds
+	 */
+	static HttpResponse await_async(const AsyncHttpHandler& handler, const HttpRequest& req) {
+		auto promise = std::make_shared<std::promise<HttpResponse>>();
+		auto result = promise->get_future();
+		handler(req, HttpResponder([promise](HttpResponse resp) { promise->set_value(std::move(resp)); }));
+		return result.get();
+	}
+
+	/**
+	 * @brief Run a stream handler over a body that is already in memory
+	 */
+	static HttpResponse replay_stream(const HttpStreamHandler& handler, const HttpRequest& req) {
+		BodyStream stream;
+		stream.content_length_ = req.body.size();
+		stream.in_callback_ = true; // Nothing to resume: the whole body is here
+		if (handler.on_headers) handler.on_headers(req, stream);
+		if (!stream.rejection_ && !req.body.empty()) {
+			stream.received_ = req.body.size();
+			if (handler.on_data) handler.on_data(req.body, stream);
+		}
+		if (stream.rejection_) return std::move(*stream.rejection_);
+		return handler.on_complete ? handler.on_complete(req, stream) : HttpResponse{};
+	}
+};
+
+// ─── SseStream ────────────────
+
+inline bool SseStream::send_raw(std::shared_ptr<const std::string> serialized) {
+	if (!server_ || !serialized) return false;
+	return server_->sse_write(fd_, connection_id_, std::move(serialized));
+}
+
+inline void SseStream::close() {
+	if (server_) server_->sse_close(fd_, connection_id_);
+}
 
 } // namespace protocol
 } // namespace etherz
@@ -0,0 +1,337 @@
+/**
+ * @file multipart.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Incremental multipart/form-data parser (RFC 7578 / RFC 2046)
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "http.hpp"
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief Boyer–Moore–Horspool search for one fixed needle
+ *
+ * The skip table is built once per boundary; each mismatch then moves
+ * the window by up to the needle length, so long boundaries are found
+ * while touching only a fraction of the body bytes.
+ */
+class BoundaryFinder {
+public:
+	BoundaryFinder() = default;
+
+	explicit BoundaryFinder(std::string needle) : needle_(std::move(needle)) {
+		skip_.fill(needle_.size());
+		for (size_t i = 0; i + 1 < needle_.size(); ++i) {
+			skip_[static_cast<uint8_t>(needle_[i])] = needle_.size() - 1 - i;
+		}
+	}
+
+	/**
+	 * @return Offset of the first match at or after from, or npos
+	 */
+	size_t find(std::string_view haystack, size_t from = 0) const noexcept {
+		const size_t n = needle_.size();
+		if (n == 0 || haystack.size() < n) return std::string_view::npos;
+		const char* h = haystack.data();
+		const char* nd = needle_.data();
+		const char last = nd[n - 1];
+		size_t pos = from;
+		const size_t end = haystack.size() - n;
+		while (pos <= end) {
+			char c = h[pos + n - 1];
+			if (c == last && std::memcmp(h + pos, nd, n - 1) == 0) return pos;
+			pos += skip_[static_cast<uint8_t>(c)];
+		}
+		return std::string_view::npos;
+	}
+
+	/**
+	 * @brief Length of the longest tail of haystack that is a proper prefix of the needle
+	 *
+	 * Those bytes might be the start of a match split across two inputs.
+	 */
+	size_t partial_tail(std::string_view haystack) const noexcept {
+		size_t max = std::min(haystack.size(), needle_.size() - 1);
+		for (size_t k = max; k > 0; --k) {
+			if (haystack.substr(haystack.size() - k) == std::string_view(needle_).substr(0, k)) return k;
+		}
+		return 0;
+	}
+
+	const std::string& needle() const noexcept { return needle_; }
+
+private:
+	std::string needle_;
+	std::array<size_t, 256> skip_{};
+};
+
+/**
+ * @brief Headers of one body part
+ */
+struct MultipartPart {
+	HttpHeaders headers;
+	std::string name;          ///< Content-Disposition name (the form field)
+	std::string filename;      ///< Content-Disposition filename, empty for plain fields
+	std::string content_type;  ///< Defaults to text/plain per RFC 7578
+
+	bool is_file() const noexcept { return !filename.empty(); }
+};
+
+/**
+ * @brief Callbacks for MultipartParser
+ *
+ * on_data slices point into the caller's input (or a small internal
+ * window) and are valid only during the call.
+ */
+struct MultipartHandler {
+	std::function<void(const MultipartPart&)> on_part_begin;
+	std::function<void(std::string_view)> on_data;
+	std::function<void()> on_part_end;
+};
+
+/**
+ * @brief Limits guarding MultipartParser memory use
+ */
+struct MultipartLimits {
+	size_t max_header_bytes = 16 * 1024;  ///< Per part header block
+	size_t max_parts = 1024;
+};
+
+/**
+ * @brief Boundary parameter of a multipart Content-Type, if present
+ */
+inline std::optional<std::string> multipart_boundary(std::string_view content_type) {
+	auto semi = content_type.find(';');
+	auto type = detail::trim(content_type.substr(0, semi));
+	if (type.size() < 10 || !detail::iequals(type.substr(0, 10), "multipart/")) return std::nullopt;
+
+	while (semi != std::string_view::npos) {
+		auto rest = content_type.substr(semi + 1);
+		auto next = rest.find(';');
+		auto param = detail::trim(rest.substr(0, next));
+		semi = next == std::string_view::npos ? next : semi + 1 + next;
+		auto eq = param.find('=');
+		if (eq == std::string_view::npos || !detail::iequals(param.substr(0, eq), "boundary")) continue;
+		auto value = param.substr(eq + 1);
+		if (value.size() >= 2 && value.front() == '"' && value.back() == '"') value = value.substr(1, value.size() - 2);
+		if (value.empty() || value.size() > 70) return std::nullopt;
+		return std::string(value);
+	}
+	return std::nullopt;
+}
+
+/**
+ * @brief Streaming multipart/form-data parser
+ *
+ * Feed body bytes as they arrive, e.g. from an HttpStreamHandler's
+ * on_data. Part data is handed to the callbacks as slices of the input;
+ * only a partial boundary or an unfinished header block is ever copied,
+ * so memory stays bounded by MultipartLimits whatever the body size.
+ */
+class MultipartParser {
+public:
+	MultipartParser(std::string_view boundary, MultipartHandler handler, MultipartLimits limits = {})
+		: finder_("\r\n--" + std::string(boundary))
+		, handler_(std::move(handler))
+		, limits_(limits) {}
+
+	/**
+	 * @brief Consume the next piece of the body
+	 * @return false once the body is malformed or over a limit
+	 */
+	bool feed(std::string_view chunk) {
+		if (state_ == State::Error) return false;
+		while (!carry_.empty() && !chunk.empty()) {
+			// Top up the window just enough to settle what it holds
+			size_t take = std::min(chunk.size(), std::max<size_t>(finder_.needle().size(), TOP_UP));
+			carry_.append(chunk.substr(0, take));
+			chunk.remove_prefix(take);
+			carry_.erase(0, process(carry_));
+			if (state_ == State::Error) return false;
+		}
+		if (chunk.empty()) return state_ != State::Error;
+		size_t used = process(chunk);
+		if (state_ == State::Error) return false;
+		carry_.assign(chunk.substr(used));
+		return true;
+	}
+
+	/// The closing boundary was seen
+	bool done() const noexcept { return state_ == State::Epilogue; }
+	bool failed() const noexcept { return state_ == State::Error; }
+	size_t parts() const noexcept { return parts_; }
+
+	/// Bytes held back between feed() calls
+	size_t buffered() const noexcept { return carry_.size(); }
+
+private:
+	enum class State : uint8_t { Preamble, AfterBoundary, Headers, Data, Epilogue, Error };
+	static constexpr size_t TOP_UP = 256;
+
+	BoundaryFinder finder_;
+	MultipartHandler handler_;
+	MultipartLimits limits_;
+	State state_ = State::Preamble;
+	std::string carry_;
+	size_t parts_ = 0;
+	bool at_start_ = true;
+
+	/**
+	 * @return Number of input bytes consumed; the rest must be offered again with more data
+	 */
+	size_t process(std::string_view in) {
+		const auto& delim = finder_.needle();
+		size_t pos = 0;
+		while (pos < in.size()) {
+			switch (state_) {
+				case State::Preamble: {
+					if (at_start_) {
+						// The first boundary may open the body without a leading CRLF
+						auto first = std::string_view(delim).substr(2);
+						if (in.size() < first.size() && first.starts_with(in)) return 0;
+						at_start_ = false;
+						if (in.starts_with(first)) {
+							pos = first.size();
+							state_ = State::AfterBoundary;
+							break;
+						}
+					}
+					auto at = finder_.find(in, pos);
+					if (at == std::string_view::npos) return in.size() - finder_.partial_tail(in.substr(pos));
+					pos = at + delim.size();
+					state_ = State::AfterBoundary;
+					break;
+				}
+				case State::AfterBoundary: {
+					if (in.size() - pos < 2) return pos;
+					if (in[pos] == '-' && in[pos + 1] == '-') {
+						state_ = State::Epilogue;
+						return in.size();
+					}
+					auto eol = in.find("\r\n", pos);
+					if (eol == std::string_view::npos) {
+						if (in.size() - pos > 256) return fail();
+						return pos;
+					}
+					// Transport padding only before the CRLF
+					for (size_t i = pos; i < eol; ++i) {
+						if (in[i] != ' ' && in[i] != '\t') return fail();
+					}
+					pos = eol + 2;
+					state_ = State::Headers;
+					break;
+				}
+				case State::Headers: {
+					size_t end;
+					if (in.substr(pos).starts_with("\r\n")) {
+						end = pos;
+					} else {
+						end = in.find("\r\n\r\n", pos);
+						if (end == std::string_view::npos) {
+							if (in.size() - pos > limits_.max_header_bytes) return fail();
+							return pos;
+						}
+						end += 2;
+					}
+					if (end - pos > limits_.max_header_bytes || ++parts_ > limits_.max_parts) return fail();
+					MultipartPart part;
+					if (!parse_headers(in.substr(pos, end - pos), part)) return fail();
+					pos = end + 2;
+					state_ = State::Data;
+					if (handler_.on_part_begin) handler_.on_part_begin(part);
+					break;
+				}
+				case State::Data: {
+					auto at = finder_.find(in, pos);
+					if (at == std::string_view::npos) {
+						size_t safe = in.size() - finder_.partial_tail(in.substr(pos));
+						if (safe > pos && handler_.on_data) handler_.on_data(in.substr(pos, safe - pos));
+						return safe;
+					}
+					if (at > pos && handler_.on_data) handler_.on_data(in.substr(pos, at - pos));
+					if (handler_.on_part_end) handler_.on_part_end();
+					pos = at + delim.size();
+					state_ = State::AfterBoundary;
+					break;
+				}
+				case State::Epilogue:
+					return in.size();
+				default:
+					return pos;
+			}
+		}
+		return pos;
+	}
+
+	size_t fail() noexcept {
+		state_ = State::Error;
+		carry_.clear();
+		return 0;
+	}
+
+	/**
+	 * @param block Header lines, each ending in CRLF
+	 */
+	static bool parse_headers(std::string_view block, MultipartPart& part) {
+		while (!block.empty()) {
+			auto eol = block.find("\r\n");
+			auto line = block.substr(0, eol);
+			block.remove_prefix(eol + 2);
+			auto colon = line.find(':');
+			if (colon == std::string_view::npos || colon == 0) return false;
+			part.headers.set(std::string(line.substr(0, colon)), std::string(detail::trim(line.substr(colon + 1))));
+		}
+
+		auto type = part.headers.get("Content-Type");
+		part.content_type = type.empty() ? "text/plain" : std::string(type);
+		auto disposition = part.headers.get("Content-Disposition");
+		auto semi = disposition.find(';');
+		while (semi != std::string_view::npos) {
+			auto rest = disposition.substr(semi + 1);
+			auto eq = rest.find('=');
+			if (eq == std::string_view::npos) break;
+			auto key = detail::trim(rest.substr(0, eq));
+			rest.remove_prefix(eq + 1);
+			while (!rest.empty() && (rest.front() == ' ' || rest.front() == '\t')) rest.remove_prefix(1);
+
+			std::string value;
+			size_t used = 0;
+			if (!rest.empty() && rest.front() == '"') {
+				// Quoted string with backslash escapes
+				size_t i = 1;
+				for (; i < rest.size() && rest[i] != '"'; ++i) {
+					if (rest[i] == '\\' && i + 1 < rest.size()) ++i;
+					value += rest[i];
+				}
+				used = std::min(i + 1, rest.size());
+			} else {
+				used = std::min(rest.find(';'), rest.size());
+				value = std::string(detail::trim(rest.substr(0, used)));
+			}
+			if (detail::iequals(key, "name")) part.name = std::move(value);
+			else if (detail::iequals(key, "filename")) part.filename = std::move(value);
+
+			auto next = rest.find(';', used);
+			semi = next == std::string_view::npos ? next
+				: static_cast<size_t>(rest.data() - disposition.data()) + next;
+		}
+		return true;
+	}
+};
+
+} // namespace protocol
+} // namespace etherz
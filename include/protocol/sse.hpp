@@ -0,0 +1,75 @@
+/**
+ * @file sse.hpp
+ * @author zuudevs (zuudevs@gmail.com)
+ * @brief Server-Sent Events (text/event-stream) framing
+ * @version 1.0.0
+ * @date 2026-02-19
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <optional>
+
+namespace etherz {
+namespace protocol {
+
+/**
+ * @brief One event of a text/event-stream
+ */
+struct SseEvent {
+	std::string data;                  ///< Multi-line data becomes several data: fields
+	std::string event;                 ///< Event type (empty: "message")
+	std::string id;                    ///< Last-Event-ID the client resumes from
+	std::optional<uint32_t> retry;     ///< Reconnection delay in milliseconds
+
+	/**
+	 * @brief Wire form, terminated by the blank line that dispatches it
+	 *
+	 * CR, LF and CRLF in data all start a new data line; line breaks in
+	 * event and id would end the field early, so those are cut there.
+	 */
+	std::string serialize() const {
+		std::string s;
+		s.reserve(data.size() + event.size() + id.size() + 32);
+		auto field = [&](std::string_view name, std::string_view value) {
+			s += name;
+			s += ": ";
+			s += value.substr(0, value.find_first_of("\r\n"));
+			s += '\n';
+		};
+		if (!id.empty()) field("id", id);
+		if (!event.empty()) field("event", event);
+		if (retry) field("retry", std::to_string(*retry));
+
+		std::string_view rest = data;
+		while (true) {
+			auto eol = rest.find_first_of("\r\n");
+			s += "data: ";
+			s += rest.substr(0, eol);
+			s += '\n';
+			if (eol == std::string_view::npos) break;
+			size_t skip = (rest[eol] == '\r' && eol + 1 < rest.size() && rest[eol + 1] == '\n') ? 2 : 1;
+			rest.remove_prefix(eol + skip);
+		}
+		s += '\n';
+		return s;
+	}
+};
+
+/**
+ * @brief A comment line: ignored by clients, keeps idle connections alive
+ */
+inline std::string sse_comment(std::string_view text) {
+	std::string s(": ");
+	s += text.substr(0, text.find_first_of("\r\n"));
+	s += "\n\n";
+	return s;
+}
+
+} // namespace protocol
+} // namespace etherz
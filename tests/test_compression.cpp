@@ -0,0 +1,112 @@
+#include "test_framework.hpp"
+#include "protocol/http_compression.hpp"
+
+namespace etp = etherz::protocol;
+
+TEST_CASE(compression_negotiate) {
+	CHECK_EQ(etp::negotiate_encoding("gzip, deflate, br"), etp::ContentEncoding::Gzip);
+	CHECK_EQ(etp::negotiate_encoding("deflate"), etp::ContentEncoding::Deflate);
+	CHECK_EQ(etp::negotiate_encoding("gzip;q=0.5, deflate;q=0.8"), etp::ContentEncoding::Deflate);
+	CHECK_EQ(etp::negotiate_encoding("gzip;q=0, deflate;q=0"), etp::ContentEncoding::Identity);
+	CHECK_EQ(etp::negotiate_encoding("*"), etp::ContentEncoding::Gzip);
+	CHECK_EQ(etp::negotiate_encoding(""), etp::ContentEncoding::Identity);
+	CHECK_EQ(etp::negotiate_encoding("br"), etp::ContentEncoding::Identity);
+}
+
+TEST_CASE(compression_compressible_types) {
+	CHECK_TRUE(etp::is_compressible_type("application/json"));
+	CHECK_TRUE(etp::is_compressible_type("text/html; charset=utf-8"));
+	CHECK_FALSE(etp::is_compressible_type("image/png"));
+	CHECK_FALSE(etp::is_compressible_type(""));
+}
+
+TEST_CASE(compression_response_threshold) {
+	etp::HttpRequest req;
+	req.headers.set("Accept-Encoding", "gzip");
+	etp::HttpResponse resp;
+	resp.headers.set("Content-Type", "application/json");
+	resp.body = "{\"ok\":true}";
+	CHECK_FALSE(etp::compress_response(req, resp, etp::CompressionOptions{}));
+	CHECK_FALSE(resp.headers.has("Content-Encoding"));
+}
+
+TEST_CASE(compression_precompressed_cache_lru) {
+	etp::PrecompressedCache cache(10);
+	cache.insert("a", std::make_shared<const std::string>("12345"));
+	cache.insert("b", std::make_shared<const std::string>("12345"));
+	CHECK_TRUE(cache.find("a") != nullptr);
+	cache.insert("c", std::make_shared<const std::string>("12345"));
+	CHECK_TRUE(cache.find("b") == nullptr);
+	CHECK_TRUE(cache.find("a") != nullptr);
+	CHECK_EQ(cache.bytes(), 10u);
+}
+
+#if defined(ETHERZ_HAS_ZLIB)
+TEST_CASE(compression_gzip_roundtrip) {
+	std::string body;
+	for (int i = 0; i < 500; ++i) body += "{\"id\":" + std::to_string(i) + ",\"name\":\"etherz\"},";
+	auto encoded = etp::compress(body, etp::ContentEncoding::Gzip, 6, 512);
+	CHECK_TRUE(encoded.has_value());
+	CHECK_TRUE(encoded->size() < body.size());
+	auto decoded = etp::decompress(*encoded, etp::ContentEncoding::Gzip);
+	CHECK_TRUE(decoded.has_value());
+	CHECK_EQ(*decoded, body);
+}
+
+TEST_CASE(compression_response_cached) {
+	etp::HttpRequest req;
+	req.path = "/app.js";
+	req.headers.set("Accept-Encoding", "deflate");
+	etp::PrecompressedCache cache;
+
+	for (int i = 0; i < 2; ++i) {
+		etp::HttpResponse resp;
+		resp.headers.set("Content-Type", "application/javascript");
+		resp.headers.set("ETag", "\"v1\"");
+		resp.body = std::string(4096, 'x');
+		CHECK_TRUE(etp::compress_response(req, resp, etp::CompressionOptions{}, &cache));
+		CHECK_EQ(resp.headers.get("Content-Encoding"), std::string_view("deflate"));
+		CHECK_EQ(resp.headers.get("ETag"), std::string_view("W/\"v1\""));
+	}
+	CHECK_EQ(cache.hits(), 1u);
+	CHECK_EQ(cache.size(), 1u);
+}
+
+TEST_CASE(compression_incompressible_body_remembered) {
+	etp::HttpRequest req;
+	req.path = "/random.json";
+	req.headers.set("Accept-Encoding", "gzip");
+	etp::PrecompressedCache cache;
+	std::string noise(4096, '\0');
+	uint64_t x = 0x9e3779b97f4a7c15ull;
+	for (auto& c : noise) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		c = static_cast<char>(x);
+	}
+
+	for (int i = 0; i < 2; ++i) {
+		etp::HttpResponse resp;
+		resp.headers.set("Content-Type", "application/json");
+		resp.headers.set("ETag", "\"r1\"");
+		resp.body = noise;
+		CHECK_FALSE(etp::compress_response(req, resp, etp::CompressionOptions{}, &cache));
+		CHECK_EQ(resp.body, noise);
+		CHECK_FALSE(resp.headers.has("Content-Encoding"));
+		CHECK_EQ(resp.headers.get("Vary"), std::string_view("Accept-Encoding"));
+	}
+	// The second request hit the marker instead of compressing again
+	CHECK_EQ(cache.hits(), 1u);
+	CHECK_EQ(cache.size(), 1u);
+	CHECK_EQ(cache.bytes(), 0u);
+}
+#else
+TEST_CASE(compression_no_vary_without_zlib) {
+	etp::HttpRequest req;
+	req.headers.set("Accept-Encoding", "gzip");
+	etp::HttpResponse resp;
+	resp.headers.set("Content-Type", "application/json");
+	resp.body = std::string(4096, 'x');
+	CHECK_FALSE(etp::compress_response(req, resp, etp::CompressionOptions{}));
+	CHECK_FALSE(resp.headers.has("Vary"));
+}
+#endif
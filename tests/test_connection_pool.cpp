@@ -0,0 +1,141 @@
+#include "test_framework.hpp"
+#include "net/connection_pool.hpp"
+#include <chrono>
+#include <thread>
+
+namespace etn = etherz::net;
+
+namespace {
+
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+Address local(uint16_t port) { return Address(etn::Ip<4>(127, 0, 0, 1), port); }
+
+etn::PoolKey key_of(uint16_t port) { return {"http", "127.0.0.1", port}; }
+
+/// Listening socket whose backlog completes connects without accepting them
+struct Listener {
+	etn::Socket<etn::Ip<4>> socket;
+
+	explicit Listener(uint16_t port) {
+		socket.create();
+		socket.set_reuse_addr(true);
+		socket.bind(local(port));
+		socket.listen();
+	}
+};
+
+} // namespace
+
+TEST_CASE(connection_pool_reuses_and_caps_per_host) {
+	constexpr uint16_t port = 18306;
+	Listener listener(port);
+	etn::ConnectionPoolOptions options;
+	options.max_per_host = 2;
+	options.acquire_timeout = std::chrono::milliseconds(50);
+	etn::ConnectionPool pool(options);
+
+	auto a = pool.acquire(key_of(port));
+	auto b = pool.acquire(key_of(port));
+	CHECK_TRUE(a.has_value() && b.has_value());
+	CHECK_FALSE(a->reused());
+	CHECK_EQ(pool.open_count(key_of(port)), size_t(2));
+
+	// Both slots are leased: the third caller waits out acquire_timeout
+	auto c = pool.acquire(key_of(port));
+	CHECK_FALSE(c.has_value());
+	CHECK_TRUE(c.error() == etherz::core::Error::Timeout);
+
+	// A kept lease goes back idle and is handed out again
+	auto fd = a->socket().native_handle();
+	a->keep();
+	a->reset();
+	CHECK_EQ(pool.idle_count(key_of(port)), size_t(1));
+	auto d = pool.acquire(key_of(port));
+	CHECK_TRUE(d.has_value());
+	CHECK_TRUE(d->reused());
+	CHECK_TRUE(d->socket().native_handle() == fd);
+
+	// A lease dropped without keep() closes its connection and frees the slot
+	b->reset();
+	CHECK_EQ(pool.open_count(key_of(port)), size_t(1));
+	CHECK_EQ(pool.idle_count(key_of(port)), size_t(0));
+	CHECK_EQ(pool.connect_count(), uint64_t(2));
+	CHECK_EQ(pool.reuse_count(), uint64_t(1));
+}
+
+TEST_CASE(connection_pool_wakes_waiter_of_the_freed_host) {
+	constexpr uint16_t port_a = 18326, port_b = 18327;
+	Listener listener_a(port_a), listener_b(port_b);
+	etn::ConnectionPoolOptions options;
+	options.max_per_host = 1;
+	options.acquire_timeout = std::chrono::milliseconds(2000);
+	etn::ConnectionPool pool(options);
+	auto a = pool.acquire(key_of(port_a));
+	auto b = pool.acquire(key_of(port_b));
+	CHECK_TRUE(a.has_value() && b.has_value());
+
+	// Both hosts are at max_per_host; A's waiter starts waiting first
+	using Clock = std::chrono::steady_clock;
+	std::atomic<int64_t> waited_a_ms{-1}, waited_b_ms{-1};
+	auto waiter = [&pool](uint16_t port, std::atomic<int64_t>& waited) {
+		return std::thread([&pool, port, &waited] {
+			auto begin = Clock::now();
+			auto conn = pool.acquire(key_of(port));
+			if (conn) waited = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count();
+		});
+	};
+	auto thread_a = waiter(port_a, waited_a_ms);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	auto thread_b = waiter(port_b, waited_b_ms);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	// Freeing B's slot must reach B's waiter, not A's
+	b->keep();
+	b->reset();
+	thread_b.join();
+	CHECK_TRUE(waited_b_ms.load() >= 0 && waited_b_ms.load() < 1000);
+	a->reset();
+	thread_a.join();
+	CHECK_TRUE(waited_a_ms.load() >= 0 && waited_a_ms.load() < 2000);
+}
+
+TEST_CASE(connection_pool_prewarms_and_expires_idle) {
+	constexpr uint16_t port = 18307;
+	Listener listener(port);
+	etn::ConnectionPoolOptions options;
+	options.max_idle_per_host = 3;
+	options.idle_timeout = std::chrono::milliseconds(20);
+	etn::ConnectionPool pool(options);
+
+	CHECK_EQ(pool.prewarm(key_of(port), 5), size_t(3)); // Capped by max_idle_per_host
+	CHECK_EQ(pool.idle_count(key_of(port)), size_t(3));
+	CHECK_EQ(pool.prewarm(key_of(port), 3), size_t(0)); // Already warm
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+	CHECK_EQ(pool.evict_expired(), size_t(3));
+	CHECK_EQ(pool.open_count(key_of(port)), size_t(0));
+	CHECK_EQ(pool.eviction_count(), uint64_t(3));
+}
+
+TEST_CASE(connection_pool_drops_idle_connection_closed_by_server) {
+	constexpr uint16_t port = 18308;
+	Listener listener(port);
+	etn::ConnectionPool pool;
+
+	auto first = pool.acquire(key_of(port));
+	CHECK_TRUE(first.has_value());
+	auto accepted = listener.socket.accept();
+	CHECK_TRUE(accepted.has_value());
+	first->keep();
+	first->reset();
+
+	// The server hangs up while the connection sits idle: checkout must notice the EOF
+	accepted->socket.close();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	auto second = pool.acquire(key_of(port));
+	CHECK_TRUE(second.has_value());
+	CHECK_FALSE(second->reused());
+	CHECK_EQ(pool.connect_count(), uint64_t(2));
+	CHECK_EQ(pool.eviction_count(), uint64_t(1));
+}
@@ -0,0 +1,169 @@
+#include "test_framework.hpp"
+#include "net/dns_cache.hpp"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace etn = etherz::net;
+
+namespace {
+
+/// Answers "good.test" with 10.0.0.<n> (n counts lookups) and fails everything else
+struct StubResolver {
+	std::shared_ptr<std::atomic<int>> calls = std::make_shared<std::atomic<int>>(0);
+	std::chrono::milliseconds delay{0};
+
+	etn::DnsResult operator()(std::string_view host) const {
+		int n = ++*calls;
+		if (delay.count() > 0) std::this_thread::sleep_for(delay);
+		etn::DnsResult result;
+		if (host != "good.test") return result;
+		result.ipv4_addresses.emplace_back(10, 0, 0, static_cast<uint8_t>(n));
+		result.success = true;
+		return result;
+	}
+};
+
+template <typename Pred>
+bool wait_for(Pred pred) {
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+	while (!pred() && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	return pred();
+}
+
+} // namespace
+
+TEST_CASE(dns_cache_hits_and_caches_failures) {
+	StubResolver stub;
+	etn::DnsCacheOptions options;
+	options.negative_ttl = std::chrono::milliseconds(50);
+	etn::DnsCache cache(options, stub);
+
+	for (int i = 0; i < 5; ++i) {
+		auto ip = cache.resolve_ipv4("good.test");
+		CHECK_TRUE(ip.has_value() && *ip == etn::Ip<4>(10, 0, 0, 1));
+	}
+	CHECK_EQ(stub.calls->load(), 1);
+	CHECK_EQ(cache.hit_count(), uint64_t(4));
+
+	// Failures are remembered for negative_ttl, then tried again
+	CHECK_FALSE(cache.resolve("bad.test").success);
+	CHECK_TRUE(cache.resolve_ipv4("bad.test").error() == etherz::core::Error::InvalidAddress);
+	CHECK_EQ(stub.calls->load(), 2);
+	std::this_thread::sleep_for(std::chrono::milliseconds(70));
+	CHECK_FALSE(cache.resolve("bad.test").success);
+	CHECK_EQ(stub.calls->load(), 3);
+
+	// Literal addresses never reach the resolver
+	CHECK_TRUE(cache.resolve_ipv4("127.0.0.1").has_value());
+	CHECK_TRUE(cache.resolve_ipv4("localhost").has_value());
+	CHECK_EQ(stub.calls->load(), 3);
+
+	cache.invalidate("good.test");
+	CHECK_TRUE(cache.resolve_ipv4("good.test").value() == etn::Ip<4>(10, 0, 0, 4));
+}
+
+TEST_CASE(dns_cache_honors_reported_ttl_and_max_ttl) {
+	auto calls = std::make_shared<std::atomic<int>>(0);
+	etn::DnsCacheOptions options;
+	options.max_ttl = std::chrono::milliseconds(40);
+	options.refresh_min_hits = 1000; // No refresh-ahead here
+	etn::DnsCache cache(options, [calls](std::string_view) {
+		++*calls;
+		etn::DnsResult result;
+		result.ipv4_addresses.emplace_back(10, 0, 0, 1);
+		result.ttl = std::chrono::seconds(3600); // Capped by max_ttl
+		result.success = true;
+		return result;
+	});
+	cache.resolve("a.test");
+	cache.resolve("a.test");
+	CHECK_EQ(calls->load(), 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	cache.resolve("a.test");
+	CHECK_EQ(calls->load(), 2);
+}
+
+TEST_CASE(dns_cache_coalesces_concurrent_lookups) {
+	StubResolver stub;
+	stub.delay = std::chrono::milliseconds(50);
+	etn::DnsCache cache({}, stub);
+	std::atomic<int> ok{0};
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 8; ++i) {
+		threads.emplace_back([&] {
+			if (cache.resolve_ipv4("good.test").value_or(etn::Ip<4>{}) == etn::Ip<4>(10, 0, 0, 1)) ++ok;
+		});
+	}
+	for (auto& t : threads) t.join();
+	CHECK_EQ(ok.load(), 8);
+	CHECK_EQ(stub.calls->load(), 1);
+	CHECK_EQ(cache.miss_count() + cache.coalesced_count() + cache.hit_count(), uint64_t(8));
+}
+
+TEST_CASE(dns_cache_refreshes_popular_entries_ahead_of_expiry) {
+	StubResolver stub;
+	stub.delay = std::chrono::milliseconds(30);
+	etn::DnsCacheOptions options;
+	options.max_ttl = std::chrono::milliseconds(200);
+	options.refresh_ahead = 0.25;
+	options.refresh_min_hits = 2;
+	etn::DnsCache cache(options, stub);
+
+	CHECK_TRUE(cache.resolve_ipv4("good.test").value() == etn::Ip<4>(10, 0, 0, 1));
+	std::this_thread::sleep_for(std::chrono::milliseconds(70));
+	// Past the refresh point: both hits still get the cached answer without waiting
+	auto start = std::chrono::steady_clock::now();
+	CHECK_TRUE(cache.resolve_ipv4("good.test").value() == etn::Ip<4>(10, 0, 0, 1));
+	CHECK_TRUE(cache.resolve_ipv4("good.test").value() == etn::Ip<4>(10, 0, 0, 1));
+	CHECK_TRUE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20));
+
+	CHECK_TRUE(wait_for([&] { return cache.refresh_count() == 1; }));
+	CHECK_TRUE(cache.resolve_ipv4("good.test").value() == etn::Ip<4>(10, 0, 0, 2));
+	CHECK_EQ(cache.miss_count(), uint64_t(1));
+}
+
+TEST_CASE(dns_cache_survives_a_throwing_resolver) {
+	auto calls = std::make_shared<std::atomic<int>>(0);
+	etn::DnsCacheOptions options;
+	options.max_ttl = std::chrono::milliseconds(200);
+	options.refresh_ahead = 0.1;
+	options.refresh_min_hits = 1;
+	etn::DnsCache cache(options, [calls](std::string_view) {
+		int n = ++*calls;
+		std::this_thread::sleep_for(std::chrono::milliseconds(30));
+		if (n == 1 || n == 3) throw std::runtime_error("resolver down");
+		etn::DnsResult result;
+		result.ipv4_addresses.emplace_back(10, 0, 0, static_cast<uint8_t>(n));
+		result.success = true;
+		return result;
+	});
+
+	// The first lookup throws to its caller; a caller waiting on it looks the name up again
+	std::atomic<bool> waiter_ok{false};
+	std::thread waiter;
+	bool threw = false;
+	try {
+		waiter = std::thread([&] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			waiter_ok = cache.resolve_ipv4("flaky.test").value_or(etn::Ip<4>{}) == etn::Ip<4>(10, 0, 0, 2);
+		});
+		cache.resolve("flaky.test");
+	} catch (const std::runtime_error&) {
+		threw = true;
+	}
+	waiter.join();
+	CHECK_TRUE(threw);
+	CHECK_TRUE(waiter_ok.load());
+	CHECK_EQ(cache.coalesced_count(), uint64_t(1));
+
+	// A throwing background refresh keeps the old answer instead of terminating
+	std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	CHECK_TRUE(cache.resolve_ipv4("flaky.test").value() == etn::Ip<4>(10, 0, 0, 2));
+	CHECK_TRUE(wait_for([&] { return calls->load() == 3; }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+	CHECK_TRUE(cache.resolve_ipv4("flaky.test").value() == etn::Ip<4>(10, 0, 0, 2));
+	CHECK_EQ(cache.refresh_count(), uint64_t(0));
+}
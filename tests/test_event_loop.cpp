@@ -0,0 +1,51 @@
+#include "test_framework.hpp"
+#include "async/event_loop.hpp"
+#include <thread>
+
+namespace eta = etherz::async;
+namespace etn = etherz::net;
+using namespace std::chrono_literals;
+
+TEST_CASE(event_loop_post_wakes_blocked_poll) {
+	eta::EventLoop loop;
+	etn::Socket<etn::Ip<4>> idle; // A listener nobody connects to: only the waker ends the poll
+	idle.create();
+	idle.bind(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), 0));
+	idle.listen();
+	loop.add(idle.native_handle(), eta::PollEvent::ReadReady, {});
+
+	std::thread::id ran_on;
+	std::thread poster([&] {
+		std::this_thread::sleep_for(20ms);
+		loop.post([&] { ran_on = std::this_thread::get_id(); });
+	});
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < 10 && ran_on == std::thread::id{}; ++i) loop.run_once(5000);
+	auto waited = std::chrono::steady_clock::now() - start;
+	poster.join();
+
+	CHECK_TRUE(ran_on == std::this_thread::get_id());
+	CHECK_TRUE(waited < 2s);
+}
+
+TEST_CASE(event_loop_post_from_loop_thread_keeps_order) {
+	eta::EventLoop loop;
+	etn::Socket<etn::Ip<4>> idle;
+	idle.create();
+	idle.bind(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), 0));
+	idle.listen();
+	loop.add(idle.native_handle(), eta::PollEvent::ReadReady, {});
+
+	std::string order;
+	loop.post([&] {
+		order += 'a';
+		loop.post([&] { order += 'c'; }); // Next cycle, without waiting out the poll
+	});
+	loop.post([&] { order += 'b'; });
+	auto start = std::chrono::steady_clock::now();
+	loop.run_once(5000);
+	CHECK_EQ(order, std::string("ab"));
+	loop.run_once(5000);
+	CHECK_EQ(order, std::string("abc"));
+	CHECK_TRUE(std::chrono::steady_clock::now() - start < 2s);
+}
@@ -1,5 +1,6 @@
 #include "test_framework.hpp"
 #include "protocol/http.hpp"
+#include "protocol/sse.hpp"
 
 namespace etp = etherz::protocol;
 
@@ -47,3 +48,107 @@ TEST_CASE(http_request_parse) {
 	CHECK_EQ(req.path, std::string("/api"));
 	CHECK_EQ(req.body, std::string("test"));
 }
+
+TEST_CASE(http_chunked_decoder_split_input) {
+	std::string raw = "4\r\nWiki\r\n7;ext=1\r\npedia i\r\nB\r\nn chunks.\r\n\r\n0\r\nX-Trailer: 1\r\n\r\n";
+	etp::http_parser::ChunkedDecoder decoder;
+	std::string body, pending;
+	// Feed one byte at a time to exercise every state boundary
+	for (char c : raw) {
+		pending += c;
+		while (true) {
+			std::string_view data;
+			size_t used = decoder.decode(pending, data);
+			body.append(data);
+			pending.erase(0, used);
+			if (used == 0) break;
+		}
+	}
+	CHECK_TRUE(decoder.done());
+	CHECK_FALSE(decoder.failed());
+	CHECK_EQ(body, std::string("Wikipedia in chunks.\r\n"));
+	CHECK_TRUE(pending.empty());
+}
+
+TEST_CASE(http_chunked_decoder_rejects_bad_size) {
+	etp::http_parser::ChunkedDecoder decoder;
+	std::string_view data;
+	decoder.decode("zz\r\nhello\r\n", data);
+	CHECK_TRUE(decoder.failed());
+
+	etp::http_parser::ChunkedDecoder missing_crlf;
+	std::string_view raw = "3\r\nabcXY";
+	size_t used = missing_crlf.decode(raw, data);
+	CHECK_EQ(data, std::string_view("abc"));
+	missing_crlf.decode(raw.substr(used), data);
+	CHECK_TRUE(missing_crlf.failed());
+}
+
+TEST_CASE(http_response_parser_byte_at_a_time) {
+	std::string raw = "HTTP/1.1 100 Continue\r\n\r\n"
+		"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+		"4\r\nWiki\r\n7;ext=1\r\npedia i\r\nB\r\nn chunks.\r\n\r\n0\r\nX-Trailer: 1\r\n\r\n"
+		"HTTP/1.1 204 No Content\r\n\r\n";
+	etp::http_parser::ResponseParser parser;
+	size_t consumed = 0;
+	for (char c : raw) {
+		if (parser.done()) break;
+		consumed += parser.feed(std::string_view(&c, 1));
+	}
+	CHECK_TRUE(parser.done());
+	CHECK_TRUE(parser.keep_alive());
+	CHECK_EQ(static_cast<uint16_t>(parser.response().status), static_cast<uint16_t>(200));
+	CHECK_EQ(parser.response().body, std::string("Wikipedia in chunks.\r\n"));
+	// Stops at the end of the message: the next response is left unconsumed
+	CHECK_EQ(raw.substr(consumed), std::string("HTTP/1.1 204 No Content\r\n\r\n"));
+}
+
+TEST_CASE(http_response_parser_framing) {
+	etp::http_parser::ResponseParser sized;
+	std::string_view two = "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabcHTTP/1.1";
+	CHECK_EQ(sized.feed(two), two.size() - 8);
+	CHECK_TRUE(sized.done());
+	CHECK_EQ(sized.response().body, std::string("abc"));
+
+	// HEAD responses carry Content-Length but no body
+	etp::http_parser::ResponseParser head(true);
+	head.feed("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n");
+	CHECK_TRUE(head.done());
+
+	// No length: the body runs to the end of the stream, which ends the connection
+	etp::http_parser::ResponseParser until_close;
+	until_close.feed("HTTP/1.1 200 OK\r\n\r\npartial");
+	CHECK_FALSE(until_close.done());
+	until_close.finish();
+	CHECK_TRUE(until_close.done());
+	CHECK_FALSE(until_close.keep_alive());
+	CHECK_EQ(until_close.response().body, std::string("partial"));
+
+	etp::http_parser::ResponseParser http10;
+	http10.feed("HTTP/1.0 200 OK\r\nContent-Length: 0\r\n\r\n");
+	CHECK_TRUE(http10.done());
+	CHECK_FALSE(http10.keep_alive());
+
+	etp::http_parser::ResponseParser truncated;
+	truncated.feed("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nab");
+	truncated.finish();
+	CHECK_TRUE(truncated.failed());
+
+	etp::http_parser::ResponseParser limited;
+	limited.set_body_limit(4);
+	limited.feed("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n");
+	CHECK_TRUE(limited.failed());
+}
+
+TEST_CASE(sse_event_serialize) {
+	etp::SseEvent ev;
+	ev.data = "first\nsecond\r\nthird";
+	ev.event = "update";
+	ev.id = "42";
+	CHECK_EQ(ev.serialize(), std::string("id: 42\nevent: update\ndata: first\ndata: second\ndata: third\n\n"));
+
+	etp::SseEvent bare;
+	bare.retry = 3000;
+	CHECK_EQ(bare.serialize(), std::string("retry: 3000\ndata: \n\n"));
+	CHECK_EQ(etp::sse_comment("ping\nx"), std::string(": ping\n\n"));
+}
@@ -0,0 +1,262 @@
+#include "test_framework.hpp"
+#include "protocol/hpack.hpp"
+#include "protocol/http2.hpp"
+
+namespace etp = etherz::protocol;
+
+static std::string from_hex(std::string_view hex) {
+	std::string out;
+	for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+		out.push_back(static_cast<char>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+	}
+	return out;
+}
+
+TEST_CASE(hpack_integer_coding) {
+	std::string out;
+	etp::hpack::encode_integer(out, 10, 5);
+	CHECK_EQ(out, from_hex("0a"));
+	out.clear();
+	etp::hpack::encode_integer(out, 1337, 5);
+	CHECK_EQ(out, from_hex("1f9a0a"));
+
+	size_t pos = 0;
+	uint64_t value = 0;
+	CHECK_TRUE(etp::hpack::decode_integer(out, pos, 5, value));
+	CHECK_EQ(value, 1337u);
+}
+
+TEST_CASE(hpack_huffman_roundtrip) {
+	std::string out;
+	etp::hpack::huffman_encode("www.example.com", out);
+	CHECK_EQ(out, from_hex("f1e3c2e5f23a6ba0ab90f4ff"));
+
+	std::string decoded;
+	CHECK_TRUE(etp::hpack::huffman_decode(out, decoded));
+	CHECK_EQ(decoded, std::string("www.example.com"));
+}
+
+TEST_CASE(hpack_decode_rfc_requests) {
+	// RFC 7541 C.4.1 / C.4.2 — Huffman-coded requests sharing a dynamic table
+	etp::HpackDecoder decoder;
+	std::vector<etp::HpackHeader> headers;
+	CHECK_TRUE(decoder.decode(from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), headers));
+	CHECK_EQ(headers.size(), 4u);
+	CHECK_EQ(headers[3].value, std::string("www.example.com"));
+	CHECK_EQ(decoder.table().size(), 57u);
+
+	headers.clear();
+	CHECK_TRUE(decoder.decode(from_hex("828684be5886a8eb10649cbf"), headers));
+	CHECK_EQ(headers.size(), 5u);
+	CHECK_EQ(headers[3].value, std::string("www.example.com"));
+	CHECK_EQ(headers[4].name, std::string("cache-control"));
+	CHECK_EQ(headers[4].value, std::string("no-cache"));
+}
+
+TEST_CASE(hpack_encoder_decoder_roundtrip) {
+	etp::HpackEncoder encoder;
+	etp::HpackDecoder decoder;
+	std::vector<etp::HpackHeader> fields = {
+		{":status", "200"}, {"content-type", "application/json"}, {"x-request-id", "abc123"}
+	};
+	for (int round = 0; round < 2; ++round) {
+		std::string block;
+		encoder.encode(fields, block);
+		std::vector<etp::HpackHeader> decoded;
+		CHECK_TRUE(decoder.decode(block, decoded));
+		CHECK_EQ(decoded.size(), 3u);
+		CHECK_EQ(decoded[2].value, std::string("abc123"));
+		// Second block is fully indexed: one byte per field
+		if (round == 1) CHECK_EQ(block.size(), 3u);
+	}
+}
+
+TEST_CASE(h2_frame_header_roundtrip) {
+	std::string out;
+	etp::h2_write_frame(out, etp::H2FrameType::Headers,
+		etp::h2_flags::EndHeaders | etp::h2_flags::EndStream, 3, "abc");
+	CHECK_EQ(out.size(), 12u);
+	auto h = etp::h2_read_frame_header(out);
+	CHECK_TRUE(h.has_value());
+	CHECK_EQ(h->length, 3u);
+	CHECK_EQ(h->type, etp::H2FrameType::Headers);
+	CHECK_EQ(h->stream_id, 3u);
+	CHECK_TRUE(h->has(etp::h2_flags::EndStream));
+}
+
+TEST_CASE(h2_session_multiplexed_requests) {
+	etp::Http2Session session([](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.body = "path=" + req.path;
+		return resp;
+	});
+	session.start();
+
+	etp::HpackEncoder encoder;
+	std::string client = std::string(etp::h2_preface);
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0);
+	for (uint32_t id : {1u, 3u, 5u}) {
+		std::string block;
+		encoder.encode({{":method", "GET"}, {":scheme", "http"},
+			{":path", "/s" + std::to_string(id)}, {":authority", "localhost"}}, block);
+		etp::h2_write_frame(client, etp::H2FrameType::Headers,
+			etp::h2_flags::EndHeaders | etp::h2_flags::EndStream, id, block);
+	}
+	CHECK_TRUE(session.feed(client));
+	CHECK_EQ(session.completed_streams(), 3u);
+	CHECK_EQ(session.active_streams(), 0u);
+
+	// Walk the server's frames: SETTINGS, SETTINGS ACK, then HEADERS + DATA per stream
+	std::string_view out = session.output();
+	int headers = 0, data = 0, settings = 0;
+	std::string last_body;
+	while (auto h = etp::h2_read_frame_header(out)) {
+		auto payload = out.substr(etp::H2_FRAME_HEADER_SIZE, h->length);
+		if (h->type == etp::H2FrameType::Headers) ++headers;
+		if (h->type == etp::H2FrameType::Settings) ++settings;
+		if (h->type == etp::H2FrameType::Data) {
+			++data;
+			last_body = std::string(payload);
+			CHECK_TRUE(h->has(etp::h2_flags::EndStream));
+		}
+		out.remove_prefix(etp::H2_FRAME_HEADER_SIZE + h->length);
+	}
+	CHECK_EQ(settings, 2);
+	CHECK_EQ(headers, 3);
+	CHECK_EQ(data, 3);
+	CHECK_EQ(last_body, std::string("path=/s5"));
+}
+
+TEST_CASE(h2_session_rejects_bad_preface) {
+	etp::Http2Session session([](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	CHECK_FALSE(session.feed("GET / HTTP/1.1\r\n\r\n"));
+	CHECK_TRUE(session.is_closing());
+}
+
+namespace {
+
+/// Frames of type t the session has written so far, as (stream id, payload)
+std::vector<std::pair<uint32_t, std::string>> h2_frames(etp::Http2Session& session, etp::H2FrameType t) {
+	std::vector<std::pair<uint32_t, std::string>> found;
+	std::string_view out = session.output();
+	while (auto h = etp::h2_read_frame_header(out)) {
+		if (h->type == t) found.emplace_back(h->stream_id, std::string(out.substr(etp::H2_FRAME_HEADER_SIZE, h->length)));
+		out.remove_prefix(etp::H2_FRAME_HEADER_SIZE + h->length);
+	}
+	return found;
+}
+
+/// GET / on stream id, headers not indexed so the peer's dynamic table stays empty
+std::string h2_plain_get(uint32_t id, uint8_t flags) {
+	std::string frame;
+	etp::h2_write_frame(frame, etp::H2FrameType::Headers, flags, id, from_hex("828486") + from_hex("0109") + "localhost");
+	return frame;
+}
+
+} // namespace
+
+TEST_CASE(h2_session_decodes_headers_ignored_after_goaway) {
+	int served = 0;
+	etp::Http2Session session([&](const etp::HttpRequest&) {
+		++served;
+		return etp::HttpResponse{};
+	});
+	session.start();
+	std::string client = std::string(etp::h2_preface);
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0);
+	client += h2_plain_get(1, etp::h2_flags::EndHeaders);
+	CHECK_TRUE(session.feed(client));
+	session.shutdown();
+
+	// Stream 3 comes after the GOAWAY; its block adds "x-new: v" to the dynamic table
+	std::string block = from_hex("4005") + "x-new" + from_hex("01") + "v";
+	client.clear();
+	etp::h2_write_frame(client, etp::H2FrameType::Headers, 0, 3, std::string_view(block).substr(0, 4));
+	etp::h2_write_frame(client, etp::H2FrameType::Continuation, etp::h2_flags::EndHeaders, 3, std::string_view(block).substr(4));
+	// Trailers on stream 1 refer to that entry (index 62): only decodable if the block above was
+	etp::h2_write_frame(client, etp::H2FrameType::Headers,
+		etp::h2_flags::EndHeaders | etp::h2_flags::EndStream, 1, from_hex("be"));
+	// Stream 1 was the last one, so the session is done: closing, but without an error
+	CHECK_FALSE(session.feed(client));
+	CHECK_EQ(served, 1);
+	CHECK_EQ(session.completed_streams(), 1u);
+	auto goaways = h2_frames(session, etp::H2FrameType::GoAway);
+	CHECK_EQ(goaways.size(), size_t(1));
+	CHECK_EQ(static_cast<uint8_t>(goaways[0].second[7]), uint8_t(0x0));
+	CHECK_TRUE(h2_frames(session, etp::H2FrameType::RstStream).empty());
+}
+
+TEST_CASE(h2_session_connection_window_ignores_initial_window_size) {
+	etp::H2Settings local;
+	local.initial_window_size = 1000;
+	etp::Http2Session session([](const etp::HttpRequest&) { return etp::HttpResponse{}; }, local);
+	session.start();
+	std::string client = std::string(etp::h2_preface);
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0);
+	client += h2_plain_get(1, etp::h2_flags::EndHeaders);
+	client += h2_plain_get(3, etp::h2_flags::EndHeaders);
+	// 1600 bytes over two streams: within each stream's 1000, and well within the connection's 65535
+	etp::h2_write_frame(client, etp::H2FrameType::Data, 0, 1, std::string(800, 'a'));
+	etp::h2_write_frame(client, etp::H2FrameType::Data, 0, 3, std::string(800, 'b'));
+	CHECK_TRUE(session.feed(client));
+	CHECK_FALSE(session.is_closing());
+	for (const auto& [id, payload] : h2_frames(session, etp::H2FrameType::WindowUpdate)) CHECK_TRUE(id != 0);
+}
+
+TEST_CASE(h2_session_initial_window_overflow_is_flow_control_error) {
+	etp::Http2Session session([](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	session.start();
+	std::string client = std::string(etp::h2_preface);
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0);
+	client += h2_plain_get(1, etp::h2_flags::EndHeaders);
+	// Stream 1's send window to 2^31-1, then one more through INITIAL_WINDOW_SIZE
+	etp::h2_write_frame(client, etp::H2FrameType::WindowUpdate, 0, 1, from_hex("7fff0000"));
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0, from_hex("000400010000"));
+	CHECK_FALSE(session.feed(client));
+	auto goaways = h2_frames(session, etp::H2FrameType::GoAway);
+	CHECK_EQ(goaways.size(), size_t(1));
+	CHECK_EQ(static_cast<uint8_t>(goaways[0].second[7]), uint8_t(0x3));
+}
+
+TEST_CASE(h2_session_drops_data_after_early_response) {
+	etp::Http2Session session([](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	session.start();
+	std::string client = std::string(etp::h2_preface);
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0);
+	std::string post;
+	etp::h2_write_frame(post, etp::H2FrameType::Headers, etp::h2_flags::EndHeaders, 1,
+		from_hex("838486") + from_hex("0109") + "localhost");
+	client += post;
+	// 70 × 16 KiB: past the 1 MiB body limit at the 65th frame
+	std::string chunk(16384, 'x');
+	for (int i = 0; i < 70; ++i) etp::h2_write_frame(client, etp::H2FrameType::Data, 0, 1, chunk);
+	CHECK_TRUE(session.feed(client));
+	CHECK_EQ(session.completed_streams(), 1u);
+
+	// More than a connection window of leftovers: dropped, but still credited to the connection
+	client.clear();
+	for (int i = 0; i < 10; ++i) {
+		etp::h2_write_frame(client, etp::H2FrameType::Data, i == 9 ? etp::h2_flags::EndStream : 0, 1, chunk);
+	}
+	CHECK_TRUE(session.feed(client));
+	CHECK_FALSE(session.is_closing());
+
+	CHECK_EQ(h2_frames(session, etp::H2FrameType::Headers).size(), size_t(1));
+	auto resets = h2_frames(session, etp::H2FrameType::RstStream);
+	CHECK_EQ(resets.size(), size_t(1));
+	CHECK_EQ(resets[0].first, 1u);
+	CHECK_EQ(static_cast<uint8_t>(resets[0].second[3]), uint8_t(0x0));
+}
+
+TEST_CASE(h2_session_rst_on_idle_stream_is_protocol_error) {
+	etp::Http2Session session([](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	session.start();
+	std::string client = std::string(etp::h2_preface);
+	etp::h2_write_frame(client, etp::H2FrameType::Settings, 0, 0);
+	client += h2_plain_get(1, etp::h2_flags::EndHeaders | etp::h2_flags::EndStream);
+	etp::h2_write_frame(client, etp::H2FrameType::RstStream, 0, 5, from_hex("00000008"));
+	CHECK_FALSE(session.feed(client));
+	auto goaways = h2_frames(session, etp::H2FrameType::GoAway);
+	CHECK_EQ(goaways.size(), size_t(1));
+	CHECK_EQ(static_cast<uint8_t>(goaways[0].second[7]), uint8_t(0x1));
+}
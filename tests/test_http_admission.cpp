@@ -0,0 +1,51 @@
+#include "test_framework.hpp"
+#include "protocol/http_admission.hpp"
+
+namespace etp = etherz::protocol;
+using Clock = etp::AdmissionController::Clock;
+using namespace std::chrono_literals;
+
+TEST_CASE(admission_caps_delay_when_not_overloaded) {
+	etp::AdmissionController ac({.target = 5ms, .interval = 100ms, .retry_after = 1000ms,
+		.default_priority = etp::RequestPriority::Normal});
+	auto t0 = Clock::now();
+	CHECK_TRUE(ac.admit(40ms, etp::RequestPriority::Normal, t0));
+	CHECK_TRUE(ac.admit(100ms, etp::RequestPriority::Low, t0 + 1ms));
+	CHECK_FALSE(ac.admit(101ms, etp::RequestPriority::Normal, t0 + 2ms));
+	CHECK_TRUE(ac.admit(500ms, etp::RequestPriority::Critical, t0 + 3ms));
+	CHECK_FALSE(ac.overloaded());
+	CHECK_EQ(ac.admitted_count(), static_cast<uint64_t>(3));
+	CHECK_EQ(ac.shed_count(), static_cast<uint64_t>(1));
+}
+
+TEST_CASE(admission_detects_standing_queue) {
+	etp::AdmissionController ac({.target = 5ms, .interval = 100ms, .retry_after = 1000ms,
+		.default_priority = etp::RequestPriority::Normal});
+	auto t = Clock::now();
+	// A burst that drains within the interval is not overload
+	ac.admit(50ms, etp::RequestPriority::Normal, t);
+	ac.admit(1ms, etp::RequestPriority::Normal, t + 50ms);
+	ac.admit(50ms, etp::RequestPriority::Normal, t + 100ms);
+	CHECK_FALSE(ac.overloaded());
+
+	// Every request in the next interval waited longer than target
+	for (int i = 1; i <= 10; ++i) ac.admit(20ms, etp::RequestPriority::Normal, t + 100ms + i * 10ms);
+	CHECK_TRUE(ac.overloaded());
+	CHECK_TRUE(ac.admit(4ms, etp::RequestPriority::Normal, t + 205ms));
+	CHECK_FALSE(ac.admit(6ms, etp::RequestPriority::Normal, t + 206ms));
+	CHECK_FALSE(ac.admit(0ms, etp::RequestPriority::Low, t + 207ms));
+	CHECK_TRUE(ac.admit(1s, etp::RequestPriority::Critical, t + 208ms));
+
+	// Shedding drained the queue: the next interval clears the state
+	for (int i = 1; i <= 10; ++i) ac.admit(1ms, etp::RequestPriority::Normal, t + 200ms + i * 10ms);
+	CHECK_FALSE(ac.overloaded());
+}
+
+TEST_CASE(admission_ignores_idle_gaps) {
+	etp::AdmissionController ac({.target = 5ms, .interval = 100ms, .retry_after = 1000ms,
+		.default_priority = etp::RequestPriority::Normal});
+	auto t = Clock::now();
+	ac.admit(20ms, etp::RequestPriority::Normal, t);
+	ac.admit(20ms, etp::RequestPriority::Normal, t + 5s);
+	CHECK_FALSE(ac.overloaded());
+}
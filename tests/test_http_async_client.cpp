@@ -0,0 +1,151 @@
+#include "test_framework.hpp"
+#include "protocol/http_async_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <chrono>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+namespace {
+
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+Address local(uint16_t port) { return Address(etn::Ip<4>(127, 0, 0, 1), port); }
+
+/// Run the loop until pred() holds or ~3s pass
+template <typename Pred>
+bool run_until(eta::EventLoop& loop, Pred pred) {
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+	while (!pred() && std::chrono::steady_clock::now() < deadline) loop.run_once(5);
+	return pred();
+}
+
+} // namespace
+
+TEST_CASE(async_http_client_runs_requests_concurrently) {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	server.get("/item", [](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.body = req.path;
+		return resp;
+	});
+	server.post("/echo", [](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.body = req.body;
+		return resp;
+	});
+	CHECK_FALSE(etherz::core::is_error(server.listen(local(18312))));
+	server.attach(loop);
+
+	etp::AsyncHttpClientOptions options;
+	options.max_per_host = 4;
+	etp::AsyncHttpClient client(loop, options);
+	constexpr int requests = 50;
+	int ok = 0, done = 0;
+	auto echo = etp::Url::parse("http://127.0.0.1:18312/echo");
+	for (int i = 0; i < requests; ++i) {
+		auto body = "n=" + std::to_string(i);
+		client.post(echo, body, "text/plain", [&, body](etp::AsyncHttpResult res) {
+			++done;
+			if (res && res->body == body) ++ok;
+		});
+	}
+	std::string got;
+	client.get(etp::Url::parse("http://127.0.0.1:18312/item"), [&](etp::AsyncHttpResult res) {
+		++done;
+		if (res) got = res->body;
+	});
+	// Capped per host: the rest wait their turn
+	CHECK_TRUE(client.queued() >= size_t(requests + 1 - 4));
+
+	CHECK_TRUE(run_until(loop, [&] { return done == requests + 1; }));
+	CHECK_EQ(ok, requests);
+	CHECK_EQ(got, std::string("/item"));
+	CHECK_EQ(client.in_flight(), size_t(0));
+	CHECK_TRUE(client.connect_count() <= 4);
+	CHECK_EQ(client.connect_count() + client.reuse_count(), uint64_t(requests + 1));
+	CHECK_EQ(client.idle_count(), size_t(client.connect_count()));
+	server.stop();
+}
+
+TEST_CASE(async_http_client_enforces_deadline) {
+	eta::EventLoop loop(std::chrono::milliseconds(5));
+	// Accepts connections into its backlog and never answers
+	etn::Socket<etn::Ip<4>> silent;
+	silent.create();
+	silent.set_reuse_addr(true);
+	silent.bind(local(18313));
+	silent.listen();
+
+	etp::AsyncHttpClientOptions options;
+	options.max_per_host = 1;
+	options.timeout = std::chrono::milliseconds(40);
+	etp::AsyncHttpClient client(loop, options);
+	std::vector<etherz::core::Error> errors;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < 2; ++i) {
+		client.get(etp::Url::parse("http://127.0.0.1:18313/"), [&](etp::AsyncHttpResult res) {
+			if (res) errors.push_back(etherz::core::Error::None);
+			else errors.push_back(res.error());
+		});
+	}
+	CHECK_TRUE(run_until(loop, [&] { return errors.size() == 2; }));
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	// The queued request's deadline runs from send() too
+	CHECK_TRUE(errors.size() == 2 && errors[0] == etherz::core::Error::Timeout && errors[1] == etherz::core::Error::Timeout);
+	CHECK_TRUE(elapsed < std::chrono::milliseconds(500));
+	CHECK_EQ(client.timeout_count(), uint64_t(2));
+	CHECK_EQ(client.in_flight(), size_t(0));
+}
+
+TEST_CASE(async_http_client_reports_failures_from_the_loop) {
+	eta::EventLoop loop;
+	etp::AsyncHttpClient client(loop);
+	bool called = false;
+	etherz::core::Error error = etherz::core::Error::None;
+	client.get(etp::Url::parse("https://127.0.0.1:18314/"), [&](etp::AsyncHttpResult res) {
+		called = true;
+		if (!res) error = res.error();
+	});
+	CHECK_FALSE(called); // Never from inside send()
+	CHECK_TRUE(run_until(loop, [&] { return called; }));
+	CHECK_TRUE(error == etherz::core::Error::FeatureNotSupported);
+
+	// Nothing listens on this port
+	bool refused = false;
+	client.get(etp::Url::parse("http://127.0.0.1:18314/"), [&](etp::AsyncHttpResult res) { refused = !res; });
+	CHECK_TRUE(run_until(loop, [&] { return refused; }));
+	CHECK_EQ(client.in_flight(), size_t(0));
+}
+
+TEST_CASE(async_http_client_replaces_connection_closed_while_idle) {
+	eta::EventLoop loop(std::chrono::milliseconds(10));
+	etp::HttpServer server;
+	server.get("/", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "hi";
+		return resp;
+	});
+	etp::ServerTimeouts timeouts;
+	timeouts.keep_alive_idle = std::chrono::milliseconds(30);
+	server.set_timeouts(timeouts);
+	CHECK_FALSE(etherz::core::is_error(server.listen(local(18315))));
+	server.attach(loop);
+
+	etp::AsyncHttpClient client(loop);
+	auto url = etp::Url::parse("http://127.0.0.1:18315/");
+	int ok = 0;
+	client.get(url, [&](etp::AsyncHttpResult res) { if (res && res->body == "hi") ++ok; });
+	CHECK_TRUE(run_until(loop, [&] { return ok == 1; }));
+	CHECK_EQ(client.idle_count(), size_t(1));
+
+	// The server times the idle connection out; the client notices and drops it
+	CHECK_TRUE(run_until(loop, [&] { return client.idle_count() == 0; }));
+	client.get(url, [&](etp::AsyncHttpResult res) { if (res && res->body == "hi") ++ok; });
+	CHECK_TRUE(run_until(loop, [&] { return ok == 2; }));
+	CHECK_EQ(client.connect_count(), uint64_t(2));
+	server.stop();
+}
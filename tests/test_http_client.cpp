@@ -0,0 +1,593 @@
+#include "test_framework.hpp"
+#include "protocol/http_client.hpp"
+#include "net/connection_pool.hpp"
+#include "net/dns_cache.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+namespace {
+
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+Address local(uint16_t port) { return Address(etn::Ip<4>(127, 0, 0, 1), port); }
+
+etn::PoolKey key_of(uint16_t port) { return {"http", "127.0.0.1", port}; }
+
+/// Listening socket whose backlog completes connects without accepting them
+struct Listener {
+	etn::Socket<etn::Ip<4>> socket;
+
+	explicit Listener(uint16_t port) {
+		socket.create();
+		socket.set_reuse_addr(true);
+		socket.bind(local(port));
+		socket.listen();
+	}
+};
+
+/**
+ * @brief HttpServer on its own loop thread, for the blocking HttpClient
+ */
+struct ServerThread {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::atomic<bool> running{true};
+	std::thread thread;
+
+	bool start(uint16_t port) { return start(local(port)); }
+
+	bool start(const Address& address) {
+		if (etherz::core::is_error(server.listen(address))) return false;
+		server.attach(loop);
+		thread = std::thread([this] {
+			while (running.load(std::memory_order_relaxed)) loop.run_once(10);
+		});
+		return true;
+	}
+
+	~ServerThread() {
+		running = false;
+		if (thread.joinable()) thread.join();
+		server.stop();
+	}
+};
+
+/**
+ * @brief Answers requests on one accepted connection with scripted replies, then closes it
+ */
+struct ScriptedServer {
+	Listener listener;
+	std::vector<std::string> replies;
+	std::thread thread;
+
+	ScriptedServer(uint16_t port, std::vector<std::string> script) : listener(port), replies(std::move(script)) {
+		thread = std::thread([this] {
+			auto conn = listener.socket.accept();
+			if (!conn) return;
+			std::string in;
+			std::array<uint8_t, 4096> buf{};
+			for (auto& reply : replies) {
+				size_t end;
+				while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+					int n = conn->socket.recv(buf);
+					if (n <= 0) return;
+					in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				}
+				in.erase(0, end + 4);
+				conn->socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(reply.data()), reply.size()));
+			}
+		});
+	}
+
+	~ScriptedServer() { thread.join(); }
+};
+
+} // namespace
+
+TEST_CASE(http_client_reuses_keep_alive_connections) {
+	constexpr uint16_t port = 18309;
+	ServerThread st;
+	st.server.get("/ping", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "pong";
+		return resp;
+	});
+	st.server.post("/echo", [](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.body = req.body;
+		return resp;
+	});
+	CHECK_TRUE(st.start(port));
+
+	etp::HttpClient client;
+	auto url = etp::Url::parse("http://127.0.0.1:18309/ping");
+	for (int i = 0; i < 5; ++i) {
+		auto res = client.get(url);
+		CHECK_TRUE(res.has_value());
+		if (res) CHECK_EQ(res->body, std::string("pong"));
+	}
+	auto echoed = client.post(etp::Url::parse("http://127.0.0.1:18309/echo"), "hello", "text/plain");
+	CHECK_TRUE(echoed.has_value());
+	if (echoed) CHECK_EQ(echoed->body, std::string("hello"));
+
+	CHECK_EQ(client.pool()->connect_count(), uint64_t(1));
+	CHECK_EQ(client.pool()->reuse_count(), uint64_t(5));
+	CHECK_EQ(client.pool()->idle_count(key_of(port)), size_t(1));
+
+	// Without a pool every request opens (and closes) its own connection
+	etp::HttpClient unpooled(nullptr);
+	auto res = unpooled.get(url);
+	CHECK_TRUE(res.has_value());
+	if (res) CHECK_EQ(res->body, std::string("pong"));
+}
+
+TEST_CASE(http_client_replaces_connection_closed_while_idle) {
+	constexpr uint16_t port = 18310;
+	ServerThread st;
+	st.server.get("/ping", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "pong";
+		return resp;
+	});
+	etp::ServerTimeouts timeouts;
+	timeouts.keep_alive_idle = std::chrono::milliseconds(50);
+	st.server.set_timeouts(timeouts);
+	CHECK_TRUE(st.start(port));
+
+	etp::HttpClient client;
+	auto url = etp::Url::parse("http://127.0.0.1:18310/ping");
+	CHECK_TRUE(client.get(url).has_value());
+	std::this_thread::sleep_for(std::chrono::milliseconds(400));
+	auto res = client.get(url);
+	CHECK_TRUE(res.has_value());
+	if (res) CHECK_EQ(res->body, std::string("pong"));
+	CHECK_EQ(client.pool()->connect_count(), uint64_t(2));
+}
+
+TEST_CASE(http_client_reads_responses_by_framing) {
+	constexpr uint16_t port = 18311;
+	ScriptedServer server(port, {
+		"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n",
+		"HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc",
+		"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n",
+		"HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n\r\nok",
+	});
+
+	etp::HttpClient client;
+	auto url = etp::Url::parse("http://127.0.0.1:18311/");
+	auto chunked = client.get(url);
+	CHECK_TRUE(chunked.has_value());
+	if (chunked) CHECK_EQ(chunked->body, std::string("hello world"));
+
+	auto after_continue = client.get(url);
+	CHECK_TRUE(after_continue.has_value());
+	if (after_continue) CHECK_EQ(after_continue->body, std::string("abc"));
+
+	// HEAD carries Content-Length but no body
+	etp::HttpRequest head;
+	head.method = etp::HttpMethod::Head;
+	head.path = "/";
+	head.headers.set("Host", "127.0.0.1");
+	auto head_res = client.send_request(url, head);
+	CHECK_TRUE(head_res.has_value());
+	if (head_res) CHECK_TRUE(head_res->body.empty());
+
+	auto closing = client.get(url);
+	CHECK_TRUE(closing.has_value());
+	if (closing) CHECK_EQ(closing->body, std::string("ok"));
+
+	// All four shared one connection; the last one said close, so it was not kept
+	CHECK_EQ(client.pool()->connect_count(), uint64_t(1));
+	CHECK_EQ(client.pool()->reuse_count(), uint64_t(3));
+	CHECK_EQ(client.pool()->idle_count(key_of(port)), size_t(0));
+}
+
+namespace {
+
+/**
+ * @brief Answers pipelined requests with their paths; connection i answers answers[i] of them, then closes
+ */
+struct PipelineServer {
+	Listener listener;
+	std::vector<size_t> answers;
+	std::thread thread;
+
+	PipelineServer(uint16_t port, std::vector<size_t> per_connection) : listener(port), answers(std::move(per_connection)) {
+		thread = std::thread([this] {
+			for (auto count : answers) {
+				auto conn = listener.socket.accept();
+				if (!conn) return;
+				std::string in, out;
+				std::array<uint8_t, 4096> buf{};
+				for (size_t answered = 0; answered < count;) {
+					auto end = in.find("\r\n\r\n");
+					if (end == std::string::npos) {
+						int n = conn->socket.recv(buf);
+						if (n <= 0) break;
+						in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+						continue;
+					}
+					auto head = etp::http_parser::parse_request(std::string_view(in).substr(0, end + 4));
+					auto length = static_cast<size_t>(std::atoi(std::string(head.headers.get("Content-Length")).c_str()));
+					if (in.size() < end + 4 + length) {
+						int n = conn->socket.recv(buf);
+						if (n <= 0) break;
+						in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+						continue;
+					}
+					in.erase(0, end + 4 + length);
+					out = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(head.path.size()) + "\r\n\r\n" + head.path;
+					conn->socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(out.data()), out.size()));
+					++answered;
+				}
+			}
+		});
+	}
+
+	~PipelineServer() { thread.join(); }
+};
+
+} // namespace
+
+TEST_CASE(http_client_pipelines_batches_in_order) {
+	constexpr uint16_t port = 18316;
+	ServerThread st;
+	std::vector<std::string> paths;
+	for (int i = 0; i < 20; ++i) {
+		paths.push_back("/item" + std::to_string(i));
+		st.server.get(paths.back(), [](const etp::HttpRequest& req) {
+			etp::HttpResponse resp;
+			resp.body = req.path;
+			return resp;
+		});
+	}
+	CHECK_TRUE(st.start(port));
+
+	etp::HttpClient client;
+	auto results = client.get_batch(etp::Url::parse("http://127.0.0.1:18316/"), paths);
+	CHECK_EQ(results.size(), paths.size());
+	size_t in_order = 0;
+	for (size_t i = 0; i < results.size(); ++i) {
+		if (results[i] && results[i]->body == paths[i]) ++in_order;
+	}
+	CHECK_EQ(in_order, paths.size());
+	CHECK_EQ(client.pool()->connect_count(), uint64_t(1));
+	CHECK_EQ(client.pool()->idle_count(key_of(port)), size_t(1));
+
+	// Unpooled: one connection for the batch, closed by the last request
+	etp::HttpClient unpooled(nullptr);
+	auto again = unpooled.get_batch(etp::Url::parse("http://127.0.0.1:18316/"), std::span(paths).first(3));
+	CHECK_TRUE(again.size() == 3 && again[2] && again[2]->body == paths[2]);
+}
+
+TEST_CASE(http_client_retries_unanswered_idempotent_requests) {
+	constexpr uint16_t port = 18317;
+	// The first connection answers two requests and hangs up; the second answers the rest
+	PipelineServer server(port, {2, 2});
+	std::vector<etp::HttpRequest> requests(5);
+	for (size_t i = 0; i < requests.size(); ++i) {
+		requests[i].method = i == 2 ? etp::HttpMethod::Post : etp::HttpMethod::Get;
+		requests[i].path = "/" + std::to_string(i);
+		requests[i].headers.set("Host", "127.0.0.1");
+		if (i == 2) requests[i].headers.set("Content-Length", "0");
+	}
+
+	etp::HttpClient client;
+	auto results = client.send_batch(etp::Url::parse("http://127.0.0.1:18317/"), requests);
+	CHECK_EQ(results.size(), size_t(5));
+	CHECK_TRUE(results[0] && results[0]->body == "/0");
+	CHECK_TRUE(results[1] && results[1]->body == "/1");
+	// Unanswered POST: the server may have acted on it, so it is not sent again
+	CHECK_FALSE(results[2].has_value());
+	CHECK_TRUE(results[3] && results[3]->body == "/3");
+	CHECK_TRUE(results[4] && results[4]->body == "/4");
+	CHECK_EQ(client.pool()->connect_count(), uint64_t(2));
+}
+
+TEST_CASE(http_client_streams_response_bodies) {
+	constexpr uint16_t port = 18318;
+	ServerThread st;
+	std::string big(1 << 20, '\0');
+	for (size_t i = 0; i < big.size(); ++i) big[i] = static_cast<char>('a' + i % 26);
+	st.server.get("/big", [&big](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = big;
+		return resp;
+	});
+	CHECK_TRUE(st.start(port));
+
+	etp::HttpClient client;
+	auto url = etp::Url::parse("http://127.0.0.1:18318/big");
+	std::string received;
+	size_t largest_piece = 0;
+	bool head_first = false;
+	etp::HttpClient::StreamHandler handler;
+	handler.on_head = [&](const etp::HttpResponse& head) {
+		head_first = received.empty() && head.headers.get("Content-Length") == std::to_string(big.size());
+		return true;
+	};
+	handler.on_body = [&](std::string_view piece) {
+		largest_piece = std::max(largest_piece, piece.size());
+		received.append(piece);
+		return true;
+	};
+	auto head = client.get_stream(url, handler);
+	CHECK_TRUE(head.has_value());
+	if (head) CHECK_TRUE(head->body.empty());
+	CHECK_TRUE(head_first);
+	CHECK_TRUE(received == big);
+	// Pieces come straight from the receive buffer
+	CHECK_TRUE(largest_piece <= 16 * 1024);
+	CHECK_EQ(client.pool()->idle_count(key_of(port)), size_t(1));
+
+	// Skipping the body leaves it on the wire: the connection is not reused
+	handler.on_head = [](const etp::HttpResponse&) { return false; };
+	received.clear();
+	auto skipped = client.get_stream(url, handler);
+	CHECK_TRUE(skipped.has_value());
+	CHECK_TRUE(received.empty());
+	CHECK_EQ(client.pool()->idle_count(key_of(port)), size_t(0));
+}
+
+TEST_CASE(http_client_downloads_to_file_descriptor) {
+	constexpr uint16_t port = 18319;
+	ScriptedServer server(port, {
+		"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n6\r\nchunk \r\n7\r\nencoded\r\n0\r\n\r\n",
+		"HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found",
+	});
+	auto* file = std::tmpfile();
+	CHECK_TRUE(file != nullptr);
+	if (!file) return;
+
+	etp::HttpClient client;
+	auto url = etp::Url::parse("http://127.0.0.1:18319/file");
+	auto head = client.download(url, fileno(file));
+	CHECK_TRUE(head.has_value());
+	if (head) CHECK_EQ(static_cast<uint16_t>(head->status), uint16_t(200));
+
+	// Errors are not written into the file
+	auto missing = client.download(url, fileno(file));
+	CHECK_TRUE(missing.has_value());
+	if (missing) CHECK_EQ(static_cast<uint16_t>(missing->status), uint16_t(404));
+
+	std::string contents(64, '\0');
+	std::rewind(file);
+	contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+	std::fclose(file);
+	CHECK_EQ(contents, std::string("chunk encoded"));
+}
+
+namespace {
+
+/// Two replicas of one host on 127.0.0.1 and 127.0.0.2: the first answers after delay, the second at once
+struct Replicas {
+	ServerThread slow;
+	ServerThread fast;
+	std::shared_ptr<etn::DnsCache> dns;
+
+	Replicas(uint16_t port, std::chrono::milliseconds delay) {
+		slow.server.get("/", [delay](const etp::HttpRequest&) {
+			std::this_thread::sleep_for(delay);
+			etp::HttpResponse resp;
+			resp.body = "slow";
+			return resp;
+		});
+		fast.server.get("/", [](const etp::HttpRequest&) {
+			etp::HttpResponse resp;
+			resp.body = "fast";
+			return resp;
+		});
+		slow.server.post("/", [delay](const etp::HttpRequest&) {
+			std::this_thread::sleep_for(delay);
+			etp::HttpResponse resp;
+			resp.body = "slow";
+			return resp;
+		});
+		slow.start(Address(etn::Ip<4>(127, 0, 0, 1), port));
+		fast.start(Address(etn::Ip<4>(127, 0, 0, 2), port));
+		dns = std::make_shared<etn::DnsCache>(etn::DnsCacheOptions{}, [](std::string_view) {
+			etn::DnsResult result;
+			result.ipv4_addresses = {etn::Ip<4>(127, 0, 0, 1), etn::Ip<4>(127, 0, 0, 2)};
+			result.success = true;
+			return result;
+		});
+	}
+};
+
+} // namespace
+
+TEST_CASE(http_client_hedges_to_another_replica) {
+	Replicas replicas(18320, std::chrono::milliseconds(200));
+	etp::HttpClient client;
+	client.set_dns_cache(replicas.dns);
+	etp::HedgingOptions hedging;
+	hedging.enabled = true;
+	hedging.initial_delay = std::chrono::milliseconds(30);
+	client.set_hedging(hedging);
+
+	auto url = etp::Url::parse("http://replicas.test:18320/");
+	CHECK_EQ(client.hedge_delay(url), std::chrono::milliseconds(30));
+	// Primaries alternate between the replicas; the slow one's requests are answered by the backup
+	for (int i = 0; i < 4; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		auto res = client.get(url);
+		CHECK_TRUE(res.has_value() && res->body == "fast");
+		CHECK_TRUE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(150));
+	}
+	CHECK_EQ(client.hedge_count(), uint64_t(2));
+	CHECK_EQ(client.hedge_win_count(), uint64_t(2));
+
+	// Not idempotent: never sent twice
+	auto posted = client.post(url, "x", "text/plain");
+	CHECK_TRUE(posted.has_value() && posted->body == "slow");
+	CHECK_EQ(client.hedge_count(), uint64_t(2));
+}
+
+TEST_CASE(http_client_hedges_within_budget) {
+	Replicas replicas(18321, std::chrono::milliseconds(100));
+	etp::HttpClient client;
+	client.set_dns_cache(replicas.dns);
+	etp::HedgingOptions hedging;
+	hedging.enabled = true;
+	hedging.initial_delay = std::chrono::milliseconds(30);
+	hedging.budget_burst = 1;
+	hedging.budget_ratio = 0;
+	client.set_hedging(hedging);
+
+	auto url = etp::Url::parse("http://replicas.test:18321/");
+	std::string bodies;
+	for (int i = 0; i < 4; ++i) {
+		auto res = client.get(url);
+		if (res) bodies += res->body + " ";
+	}
+	// One hedge in the budget: the second slow primary has to wait for its answer
+	CHECK_EQ(bodies, std::string("fast fast slow fast "));
+	CHECK_EQ(client.hedge_count(), uint64_t(1));
+	CHECK_EQ(client.hedge_denied_count(), uint64_t(1));
+}
+
+TEST_CASE(http_client_hedges_follow_load_balancing) {
+	Replicas replicas(18328, std::chrono::milliseconds(200));
+	etp::HttpClient client;
+	client.set_dns_cache(replicas.dns);
+	etp::HedgingOptions hedging;
+	hedging.enabled = true;
+	hedging.initial_delay = std::chrono::milliseconds(30);
+	hedging.budget_burst = 10;
+	client.set_hedging(hedging);
+	etp::LoadBalancingOptions maglev;
+	maglev.policy = etn::BalancePolicy::Maglev;
+	maglev.key_header = "X-User";
+	client.set_load_balancing(maglev);
+
+	auto url = etp::Url::parse("http://replicas.test:18328/");
+	CHECK_TRUE(client.get(url).has_value()); // Builds the host's balancer
+	auto balancer = client.load_balancer(url);
+	CHECK_TRUE(balancer != nullptr);
+	if (!balancer) return;
+	// A user whose requests Maglev sends to the slow replica
+	auto slow = Address(etn::Ip<4>(127, 0, 0, 1), 18328);
+	std::string user;
+	for (int i = 0; user.empty(); ++i) {
+		if (*balancer->for_key("user-" + std::to_string(i)) == slow) user = "user-" + std::to_string(i);
+	}
+	auto before = client.hedge_count();
+	auto req = etp::HttpRequest{};
+	req.path = "/";
+	req.headers.set("Host", url.host);
+	req.headers.set("X-User", user);
+	// Every primary goes to that replica, so every request is hedged to the other and won there
+	for (int i = 0; i < 3; ++i) {
+		auto res = client.send_request(url, req);
+		CHECK_TRUE(res.has_value() && res->body == "fast");
+	}
+	CHECK_EQ(client.hedge_count() - before, uint64_t(3));
+	// Both legs were leased from the balancer and given back
+	for (const auto& a : balancer->endpoints()) CHECK_EQ(balancer->outstanding(a), uint32_t(0));
+}
+
+TEST_CASE(http_client_downloads_ranges_in_parallel) {
+	constexpr uint16_t port = 18322;
+	std::string blob(300'000, '\0');
+	for (size_t i = 0; i < blob.size(); ++i) blob[i] = static_cast<char>(i % 251);
+	std::atomic<int> range_requests{0};
+	std::atomic<bool> failed_once{false};
+	std::atomic<bool> ranges{true};
+	std::atomic<bool> capitalized{false};
+
+	ServerThread st;
+	st.server.route(etp::HttpMethod::Head, "/blob", [&](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.headers.set("Content-Length", std::to_string(blob.size()));
+		if (ranges) resp.headers.set("Accept-Ranges", capitalized ? "none, Bytes" : "bytes");
+		return resp;
+	});
+	st.server.get("/blob", [&](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		auto range = req.headers.get("Range");
+		size_t first = 0, last = 0;
+		if (!ranges || std::sscanf(std::string(range).c_str(), "bytes=%zu-%zu", &first, &last) != 2) {
+			resp.body = blob;
+			return resp;
+		}
+		++range_requests;
+		// One part fails on its first try
+		if (first == 131072 && !failed_once.exchange(true)) {
+			resp.status = etp::HttpStatus::ServiceUnavailable;
+			return resp;
+		}
+		last = std::min(last, blob.size() - 1);
+		resp.status = etp::HttpStatus::PartialContent;
+		resp.headers.set("Content-Range", std::format("{} {}-{}/{}", capitalized ? "Bytes" : "bytes", first, last, blob.size()));
+		resp.body = blob.substr(first, last - first + 1);
+		return resp;
+	});
+	CHECK_TRUE(st.start(port));
+
+	auto read_back = [](std::FILE* file) {
+		std::string contents(400'000, '\0');
+		std::rewind(file);
+		contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+		return contents;
+	};
+	etp::HttpClient client;
+	auto url = etp::Url::parse("http://127.0.0.1:18322/blob");
+	etp::RangedDownloadOptions options;
+	options.connections = 3;
+	options.part_size = 64 * 1024;
+	bool verified = false;
+	options.verify = [&](int, uint64_t size) { return verified = size == blob.size(); };
+
+	auto* file = std::tmpfile();
+	CHECK_TRUE(file != nullptr);
+	if (!file) return;
+	auto head = client.download_ranges(url, fileno(file), options);
+	CHECK_TRUE(head.has_value());
+	CHECK_TRUE(verified);
+	CHECK_TRUE(read_back(file) == blob);
+	// Five parts, one of them asked for twice
+	CHECK_EQ(range_requests.load(), 6);
+	std::fclose(file);
+
+	// No range support: one stream
+	ranges = false;
+	file = std::tmpfile();
+	CHECK_TRUE(client.download_ranges(url, fileno(file), options).has_value());
+	CHECK_TRUE(read_back(file) == blob);
+	CHECK_EQ(range_requests.load(), 6);
+	std::fclose(file);
+
+	// Range units are case-insensitive tokens
+	ranges = true;
+	capitalized = true;
+	file = std::tmpfile();
+	CHECK_TRUE(client.download_ranges(url, fileno(file), options).has_value());
+	CHECK_TRUE(read_back(file) == blob);
+	CHECK_EQ(range_requests.load(), 11);
+	std::fclose(file);
+
+	// A part size of 0: one stream
+	auto single = options;
+	single.part_size = 0;
+	file = std::tmpfile();
+	CHECK_TRUE(client.download_ranges(url, fileno(file), single).has_value());
+	CHECK_TRUE(read_back(file) == blob);
+	CHECK_EQ(range_requests.load(), 11);
+	std::fclose(file);
+
+	// A checksum mismatch fails the download
+	options.verify = [](int, uint64_t) { return false; };
+	file = std::tmpfile();
+	auto rejected = client.download_ranges(url, fileno(file), options);
+	CHECK_TRUE(!rejected && rejected.error() == etherz::core::Error::ReceiveFailed);
+	std::fclose(file);
+}
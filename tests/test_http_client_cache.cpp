@@ -0,0 +1,258 @@
+#include "test_framework.hpp"
+#include "protocol/http_client_cache.hpp"
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+namespace {
+
+using Cache = etp::HttpClientCache;
+using std::chrono::seconds;
+
+const auto base_url = etp::Url::parse("http://127.0.0.1:8080/doc");
+const auto t0 = Cache::SysClock::time_point(std::chrono::sys_days(std::chrono::year(2026) / 2 / 19));
+
+etp::HttpRequest request(std::string path = "/doc") {
+	etp::HttpRequest req;
+	req.path = std::move(path);
+	return req;
+}
+
+Cache::Response response(std::string cache_control, std::string body = "payload") {
+	auto resp = std::make_shared<etp::HttpResponse>();
+	resp->headers.set("Date", "Thu, 19 Feb 2026 00:00:00 GMT");
+	if (!cache_control.empty()) resp->headers.set("Cache-Control", std::move(cache_control));
+	resp->body = std::move(body);
+	return resp;
+}
+
+} // namespace
+
+TEST_CASE(http_client_cache_parses_http_dates) {
+	auto imf = Cache::parse_date("Sun, 06 Nov 1994 08:49:37 GMT");
+	auto rfc850 = Cache::parse_date("Sunday, 06-Nov-94 08:49:37 GMT");
+	auto asctime = Cache::parse_date("Sun Nov  6 08:49:37 1994");
+	CHECK_TRUE(imf.has_value());
+	CHECK_EQ(std::chrono::duration_cast<seconds>(imf->time_since_epoch()).count(), int64_t(784111777));
+	CHECK_TRUE(rfc850 == imf);
+	CHECK_TRUE(asctime == imf);
+	CHECK_FALSE(Cache::parse_date("0").has_value());
+	CHECK_FALSE(Cache::parse_date("Sun, 31 Feb 1994 08:49:37 GMT").has_value());
+	CHECK_FALSE(Cache::parse_date("Sun, 06 Nov 1994 08:49:37 PST").has_value());
+}
+
+TEST_CASE(http_client_cache_computes_freshness) {
+	Cache cache;
+	auto req = request();
+	CHECK_TRUE(cache.store(base_url, req, response("max-age=60"), t0, t0));
+	auto hit = cache.lookup(base_url, req, t0 + seconds(30));
+	CHECK_TRUE(hit.fresh && hit.response && hit.response->body == "payload");
+	CHECK_FALSE(cache.lookup(base_url, req, t0 + seconds(61)).fresh);
+
+	// The Age header and the round trip count against the lifetime
+	auto aged = response("max-age=60");
+	std::const_pointer_cast<etp::HttpResponse>(aged)->headers.set("Age", "50");
+	CHECK_TRUE(cache.store(base_url, req, aged, t0, t0 + seconds(2)));
+	CHECK_TRUE(cache.lookup(base_url, req, t0 + seconds(9)).fresh);
+	CHECK_FALSE(cache.lookup(base_url, req, t0 + seconds(11)).fresh);
+
+	// Expires - Date, and an invalid Expires means already expired
+	auto expires = response("");
+	std::const_pointer_cast<etp::HttpResponse>(expires)->headers.set("Expires", "Thu, 19 Feb 2026 00:01:40 GMT");
+	CHECK_TRUE(cache.store(base_url, req, expires, t0, t0));
+	CHECK_TRUE(cache.lookup(base_url, req, t0 + seconds(99)).fresh);
+	CHECK_FALSE(cache.lookup(base_url, req, t0 + seconds(101)).fresh);
+	std::const_pointer_cast<etp::HttpResponse>(expires)->headers.set("Expires", "0");
+	CHECK_FALSE(cache.store(base_url, req, expires, t0, t0));
+
+	// Heuristic: a tenth of the time since Last-Modified
+	auto modified = response("");
+	std::const_pointer_cast<etp::HttpResponse>(modified)->headers.set("Last-Modified", "Wed, 18 Feb 2026 23:00:00 GMT");
+	CHECK_TRUE(cache.store(base_url, req, modified, t0, t0));
+	CHECK_TRUE(cache.lookup(base_url, req, t0 + seconds(359)).fresh);
+	auto stale = cache.lookup(base_url, req, t0 + seconds(361));
+	CHECK_FALSE(stale.fresh);
+	CHECK_EQ(stale.last_modified, std::string("Wed, 18 Feb 2026 23:00:00 GMT"));
+
+	// A response without freshness or validators is not worth storing
+	CHECK_FALSE(cache.store(base_url, req, response(""), t0, t0));
+	CHECK_EQ(cache.size(), size_t(1));
+}
+
+TEST_CASE(http_client_cache_honors_cache_control) {
+	Cache cache;
+	auto req = request();
+	CHECK_FALSE(cache.store(base_url, req, response("no-store, max-age=60"), t0, t0));
+	auto no_store = req;
+	no_store.headers.set("Cache-Control", "no-store");
+	CHECK_FALSE(cache.store(base_url, no_store, response("max-age=60"), t0, t0));
+	CHECK_EQ(cache.size(), size_t(0));
+
+	CHECK_TRUE(cache.store(base_url, req, response("max-age=60"), t0, t0));
+	auto no_cache = req;
+	no_cache.headers.set("Cache-Control", "no-cache");
+	CHECK_FALSE(cache.lookup(base_url, no_cache, t0).fresh);
+	auto max_age = req;
+	max_age.headers.set("Cache-Control", "max-age=10");
+	CHECK_FALSE(cache.lookup(base_url, max_age, t0 + seconds(20)).fresh);
+	auto max_stale = req;
+	max_stale.headers.set("Cache-Control", "max-stale=30");
+	CHECK_TRUE(cache.lookup(base_url, max_stale, t0 + seconds(80)).fresh);
+	CHECK_FALSE(cache.lookup(base_url, max_stale, t0 + seconds(100)).fresh);
+	CHECK_TRUE(cache.lookup(base_url, req, t0 + seconds(100)).stale_if_error);
+
+	// must-revalidate: never served stale, not even on request
+	CHECK_TRUE(cache.store(base_url, req, response("max-age=60, must-revalidate"), t0, t0));
+	CHECK_FALSE(cache.lookup(base_url, max_stale, t0 + seconds(80)).fresh);
+	CHECK_FALSE(cache.lookup(base_url, req, t0 + seconds(80)).stale_if_error);
+
+	// no-cache responses are stored but always revalidated
+	auto validated = response("no-cache");
+	std::const_pointer_cast<etp::HttpResponse>(validated)->headers.set("ETag", "\"v1\"");
+	CHECK_TRUE(cache.store(base_url, req, validated, t0, t0));
+	auto found = cache.lookup(base_url, req, t0);
+	CHECK_FALSE(found.fresh);
+	CHECK_EQ(found.etag, std::string("\"v1\""));
+
+	// A successful unsafe request drops the URL
+	cache.invalidate(base_url, req);
+	CHECK_FALSE(cache.lookup(base_url, req, t0).response);
+}
+
+TEST_CASE(http_client_cache_selects_vary_variants) {
+	Cache cache;
+	auto json = request();
+	json.headers.set("Accept", "application/json");
+	auto text = request();
+	text.headers.set("Accept", "text/plain");
+	auto a = response("max-age=60", "{}");
+	std::const_pointer_cast<etp::HttpResponse>(a)->headers.set("Vary", "Accept");
+	auto b = response("max-age=60", "text");
+	std::const_pointer_cast<etp::HttpResponse>(b)->headers.set("Vary", "Accept");
+	CHECK_TRUE(cache.store(base_url, json, a, t0, t0));
+	CHECK_TRUE(cache.store(base_url, text, b, t0, t0));
+	CHECK_EQ(cache.size(), size_t(2));
+	CHECK_EQ(cache.lookup(base_url, json, t0).response->body, std::string("{}"));
+	CHECK_EQ(cache.lookup(base_url, text, t0).response->body, std::string("text"));
+	CHECK_FALSE(cache.lookup(base_url, request(), t0).response);
+
+	auto any = response("max-age=60");
+	std::const_pointer_cast<etp::HttpResponse>(any)->headers.set("Vary", "*");
+	CHECK_FALSE(cache.store(base_url, json, any, t0, t0));
+}
+
+TEST_CASE(http_client_cache_evicts_least_recently_used) {
+	etp::HttpCacheOptions options;
+	options.memory_bytes = 16 * 1024;
+	Cache cache(options);
+	for (int i = 0; i < 8; ++i) {
+		CHECK_TRUE(cache.store(base_url, request("/" + std::to_string(i)), response("max-age=60", std::string(3000, 'x')), t0, t0));
+		if (i >= 1) cache.lookup(base_url, request("/0"), t0); // Keep /0 hot
+	}
+	CHECK_TRUE(cache.memory_used() <= options.memory_bytes);
+	CHECK_TRUE(cache.size() < 8);
+	CHECK_TRUE(cache.lookup(base_url, request("/0"), t0).fresh);
+	CHECK_FALSE(cache.lookup(base_url, request("/1"), t0).response);
+	CHECK_TRUE(cache.lookup(base_url, request("/7"), t0).fresh);
+}
+
+TEST_CASE(http_client_cache_spills_to_disk) {
+	auto dir = std::filesystem::temp_directory_path() / "etherz_client_cache_test";
+	std::filesystem::remove_all(dir);
+	{
+		etp::HttpCacheOptions options;
+		options.memory_bytes = 16 * 1024;
+		options.disk_path = dir.string();
+		Cache cache(options);
+		for (int i = 0; i < 8; ++i) {
+			auto resp = response("max-age=60", std::string(3000, static_cast<char>('a' + i)));
+			std::const_pointer_cast<etp::HttpResponse>(resp)->headers.set("ETag", "\"" + std::to_string(i) + "\"");
+			CHECK_TRUE(cache.store(base_url, request("/" + std::to_string(i)), resp, t0, t0));
+		}
+		CHECK_EQ(cache.size(), size_t(8));
+		CHECK_TRUE(cache.disk_entries() > 0);
+		CHECK_TRUE(cache.disk_used() > 0);
+
+		// Read back through mmap with its fields and body intact
+		auto hit = cache.lookup(base_url, request("/0"), t0);
+		CHECK_TRUE(hit.fresh);
+		CHECK_EQ(hit.response->body, std::string(3000, 'a'));
+		CHECK_EQ(hit.response->headers.get("ETag"), std::string_view("\"0\""));
+		CHECK_EQ(cache.disk_read_count(), uint64_t(1));
+		CHECK_TRUE(cache.memory_used() <= options.memory_bytes);
+	}
+	// The cache's files go with it
+	CHECK_TRUE(std::filesystem::is_empty(dir));
+	std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_client_serves_and_revalidates_from_cache) {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::atomic<int> fresh_calls{0}, etag_calls{0}, not_modified{0};
+	server.get("/fresh", [&](const etp::HttpRequest&) {
+		++fresh_calls;
+		etp::HttpResponse resp;
+		resp.headers.set("Cache-Control", "max-age=60");
+		resp.body = "fresh body";
+		return resp;
+	});
+	server.get("/etag", [&](const etp::HttpRequest& req) {
+		++etag_calls;
+		etp::HttpResponse resp;
+		resp.headers.set("Cache-Control", "no-cache");
+		resp.headers.set("ETag", "\"v1\"");
+		if (req.headers.get("If-None-Match") == "\"v1\"") {
+			++not_modified;
+			resp.status = etp::HttpStatus::NotModified;
+			return resp;
+		}
+		resp.body = "validated body";
+		return resp;
+	});
+	server.post("/fresh", [](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), 18324))));
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load()) loop.run_once(10);
+	});
+
+	auto cache = std::make_shared<Cache>();
+	etp::HttpClient client;
+	client.set_cache(cache);
+	auto fresh = etp::Url::parse("http://127.0.0.1:18324/fresh");
+	auto first = client.get(fresh);
+	auto second = client.get_shared(fresh);
+	auto third = client.get_shared(fresh);
+	CHECK_TRUE(first && first->body == "fresh body");
+	CHECK_TRUE(second && third && *second == *third); // The stored object itself
+	CHECK_EQ(fresh_calls.load(), 1);
+	CHECK_EQ(cache->hit_count(), uint64_t(2));
+
+	auto etag = etp::Url::parse("http://127.0.0.1:18324/etag");
+	auto full = client.get(etag);
+	auto revalidated = client.get(etag);
+	CHECK_TRUE(full && full->body == "validated body");
+	CHECK_TRUE(revalidated && revalidated->status == etp::HttpStatus::OK && revalidated->body == "validated body");
+	CHECK_EQ(etag_calls.load(), 2);
+	CHECK_EQ(not_modified.load(), 1);
+	CHECK_EQ(cache->revalidated_count(), uint64_t(1));
+
+	// A POST to the URL invalidates it
+	CHECK_TRUE(client.post(fresh, "x").has_value());
+	CHECK_TRUE(client.get(fresh).has_value());
+	CHECK_EQ(fresh_calls.load(), 2);
+
+	running = false;
+	server_thread.join();
+	server.stop();
+}
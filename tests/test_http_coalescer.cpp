@@ -0,0 +1,155 @@
+#include "test_framework.hpp"
+#include "protocol/http_coalescer.hpp"
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+TEST_CASE(request_coalescer_keys_on_vary_headers) {
+	etp::RequestCoalescer coalescer;
+	auto url = etp::Url::parse("http://127.0.0.1:8080/config");
+	etp::HttpRequest a;
+	a.path = "/config";
+	a.headers.set("Accept", "application/json");
+	a.headers.set("User-Agent", "one");
+	auto b = a;
+	b.headers.set("User-Agent", "two");
+	auto c = a;
+	c.headers.set("Accept", "text/plain");
+	CHECK_EQ(coalescer.make_key(url, a), coalescer.make_key(url, b));
+	CHECK_TRUE(coalescer.make_key(url, a) != coalescer.make_key(url, c));
+	CHECK_TRUE(coalescer.make_key(url, a) != coalescer.make_key(etp::Url::parse("http://127.0.0.1:8081/config"), a));
+	auto d = a;
+	d.headers.set("If-None-Match", "\"v1\"");
+	CHECK_TRUE(coalescer.make_key(url, a) != coalescer.make_key(url, d));
+
+	CHECK_TRUE(etp::RequestCoalescer::coalescable(a));
+	a.method = etp::HttpMethod::Post;
+	CHECK_FALSE(etp::RequestCoalescer::coalescable(a));
+}
+
+TEST_CASE(http_client_coalesces_identical_gets) {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::atomic<int> calls{0};
+	std::atomic<bool> gate{false};
+	server.get("/config", [&](const etp::HttpRequest&) {
+		++calls;
+		while (!gate.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		etp::HttpResponse resp;
+		resp.body = std::string(64 * 1024, 'c');
+		return resp;
+	});
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), 18323))));
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load()) loop.run_once(10);
+	});
+
+	auto coalescer = std::make_shared<etp::RequestCoalescer>();
+	auto url = etp::Url::parse("http://127.0.0.1:18323/config");
+	constexpr int threads = 8;
+	std::vector<std::shared_ptr<const etp::HttpResponse>> responses(threads);
+	std::vector<std::thread> callers;
+	for (int i = 0; i < threads; ++i) {
+		callers.emplace_back([&, i] {
+			etp::HttpClient client;
+			client.set_coalescer(coalescer);
+			if (auto res = client.get_shared(url)) responses[static_cast<size_t>(i)] = *res;
+		});
+	}
+	// Everyone but the leader is waiting on its flight before the server answers
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+	while (coalescer->coalesced_count() < threads - 1 && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	gate = true;
+	for (auto& t : callers) t.join();
+
+	CHECK_EQ(calls.load(), 1);
+	CHECK_EQ(coalescer->leader_count(), uint64_t(1));
+	CHECK_EQ(coalescer->in_flight(), size_t(0));
+	bool same = responses[0] != nullptr && responses[0]->body.size() == 64 * 1024;
+	for (auto& r : responses) same = same && r == responses[0];
+	CHECK_TRUE(same);
+
+	// Nothing is cached: a later request goes out again
+	etp::HttpClient client;
+	client.set_coalescer(coalescer);
+	auto again = client.get_shared(url);
+	CHECK_TRUE(again.has_value() && *again != responses[0]);
+	CHECK_EQ(calls.load(), 2);
+
+	running = false;
+	server_thread.join();
+	server.stop();
+}
+
+TEST_CASE(http_client_keeps_conditional_gets_apart) {
+	eta::EventLoop loop;
+	etp::HttpServer server;
+	std::atomic<int> calls{0};
+	std::atomic<bool> gate{false};
+	server.get("/config", [&](const etp::HttpRequest& req) {
+		++calls;
+		while (!gate.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		etp::HttpResponse resp;
+		resp.headers.set("ETag", "\"v1\"");
+		if (req.headers.get("If-None-Match") == "\"v1\"") {
+			resp.status = etp::HttpStatus::NotModified;
+		} else {
+			resp.body = "config";
+		}
+		return resp;
+	});
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), 18329))));
+	server.attach(loop);
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load()) loop.run_once(10);
+	});
+
+	auto coalescer = std::make_shared<etp::RequestCoalescer>();
+	auto url = etp::Url::parse("http://127.0.0.1:18329/config");
+	std::shared_ptr<const etp::HttpResponse> conditional_resp, plain_resp;
+	std::thread conditional([&] {
+		etp::HttpClient client;
+		client.set_coalescer(coalescer);
+		etp::HttpRequest req;
+		req.path = "/config";
+		req.headers.set("Host", url.host);
+		req.headers.set("If-None-Match", "\"v1\"");
+		if (auto res = client.send_shared(url, req)) conditional_resp = *res;
+	});
+	// The conditional GET is on the server before the plain one starts
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+	while (calls.load() < 1 && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	std::thread plain([&] {
+		etp::HttpClient client;
+		client.set_coalescer(coalescer);
+		if (auto res = client.get_shared(url)) plain_resp = *res;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	gate = true;
+	conditional.join();
+	plain.join();
+
+	CHECK_EQ(calls.load(), 2);
+	CHECK_EQ(coalescer->coalesced_count(), uint64_t(0));
+	CHECK_TRUE(conditional_resp != nullptr && conditional_resp->status == etp::HttpStatus::NotModified);
+	CHECK_TRUE(plain_resp != nullptr && plain_resp->status == etp::HttpStatus::OK && plain_resp->body == "config");
+
+	running = false;
+	server_thread.join();
+	server.stop();
+}
@@ -0,0 +1,60 @@
+#include "test_framework.hpp"
+#include "protocol/http_metrics.hpp"
+#include <thread>
+
+namespace etp = etherz::protocol;
+using Histogram = etp::LatencyHistogram;
+
+TEST_CASE(latency_histogram_bucket_bounds) {
+	// Every value maps to a bucket whose upper bound covers it within 1/16
+	bool ok = true;
+	for (uint64_t v : {0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 123456789ull, 1ull << 39}) {
+		auto i = Histogram::bucket_index(v);
+		auto upper = Histogram::bucket_upper(i);
+		if (upper < v || (i > 0 && Histogram::bucket_upper(i - 1) >= v)) ok = false;
+		if (static_cast<double>(upper - v) > static_cast<double>(v) / 16.0 + 1.0) ok = false;
+	}
+	CHECK_TRUE(ok);
+	CHECK_EQ(Histogram::bucket_index(~0ull), Histogram::BUCKETS - 1);
+}
+
+TEST_CASE(latency_histogram_percentiles) {
+	Histogram h;
+	for (uint64_t v = 1; v <= 10000; ++v) h.record(v * 1000); // 1us .. 10ms
+	auto s = h.snapshot();
+	CHECK_EQ(s.count, static_cast<uint64_t>(10000));
+	auto p50 = static_cast<double>(s.percentile(0.5));
+	auto p99 = static_cast<double>(s.percentile(0.99));
+	CHECK_TRUE(p50 >= 5'000'000 && p50 <= 5'000'000 * 1.07);
+	CHECK_TRUE(p99 >= 9'900'000 && p99 <= 9'900'000 * 1.07);
+	CHECK_EQ(s.count_at_or_below(~0ull), static_cast<uint64_t>(10000));
+}
+
+TEST_CASE(server_metrics_sharded_recording) {
+	etp::ServerMetrics metrics;
+	auto slot = metrics.add_route("GET", "/a");
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&] {
+			for (int i = 0; i < 1000; ++i) {
+				metrics.request_started(slot);
+				metrics.request_finished(slot, etp::HttpStatus::OK, 1000, 10, 20);
+			}
+		});
+	}
+	for (auto& t : threads) t.join();
+	metrics.request_started(slot); // Still in flight
+
+	auto r = metrics.route(slot);
+	CHECK_EQ(r.requests(), static_cast<uint64_t>(4000));
+	CHECK_EQ(r.by_class[1], static_cast<uint64_t>(4000));
+	CHECK_EQ(r.in_flight, static_cast<int64_t>(1));
+	CHECK_EQ(r.body_in, static_cast<uint64_t>(40000));
+	CHECK_EQ(r.latency.count, static_cast<uint64_t>(4000));
+	CHECK_EQ(metrics.status_count(etp::HttpStatus::OK), static_cast<uint64_t>(4000));
+
+	auto text = metrics.prometheus();
+	CHECK_TRUE(text.find("etherz_http_requests_total{method=\"GET\",route=\"/a\",code=\"2xx\"} 4000") != std::string::npos);
+	CHECK_TRUE(text.find("etherz_http_requests_in_flight{method=\"GET\",route=\"/a\"} 1") != std::string::npos);
+	CHECK_TRUE(text.find("etherz_http_request_duration_seconds_count{method=\"GET\",route=\"/a\"} 4000") != std::string::npos);
+}
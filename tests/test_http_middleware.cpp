@@ -0,0 +1,140 @@
+#include "test_framework.hpp"
+#include "protocol/http_middleware.hpp"
+#include <stdexcept>
+
+namespace etp = etherz::protocol;
+
+TEST_CASE(request_arena_reuses_blocks) {
+	etp::RequestArena arena(256);
+	auto a = arena.copy("hello");
+	auto* n = arena.make<uint64_t>(42);
+	CHECK_EQ(a, std::string_view("hello"));
+	CHECK_EQ(*n, static_cast<uint64_t>(42));
+	CHECK_EQ(reinterpret_cast<uintptr_t>(n) % alignof(uint64_t), static_cast<uintptr_t>(0));
+
+	// Outgrow the first block, then reset: capacity is kept and reused
+	std::pmr::vector<int> v(&arena);
+	for (int i = 0; i < 1000; ++i) v.push_back(i);
+	auto cap = arena.capacity();
+	CHECK_TRUE(cap > 256);
+	for (int round = 0; round < 10; ++round) {
+		arena.reset();
+		CHECK_EQ(arena.used(), static_cast<size_t>(0));
+		std::pmr::vector<int> w(&arena);
+		for (int i = 0; i < 1000; ++i) w.push_back(i);
+	}
+	CHECK_EQ(arena.capacity(), cap);
+}
+
+TEST_CASE(middleware_chain_order_and_short_circuit) {
+	std::string trace;
+	auto outer = [&](const etp::HttpRequest&, etp::RequestContext& ctx, auto&& next) {
+		trace += "outer>";
+		ctx.set("who", "outer");
+		auto resp = next();
+		trace += "<outer";
+		return resp;
+	};
+	auto gate = [&](const etp::HttpRequest& req, etp::RequestContext&, auto&& next) {
+		trace += "gate>";
+		if (req.path == "/blocked") {
+			etp::HttpResponse resp;
+			resp.status = etp::HttpStatus::Forbidden;
+			return resp;
+		}
+		return next();
+	};
+	auto handler = etp::make_middleware(outer, gate).wrap(
+		[&](const etp::HttpRequest&, etp::RequestContext& ctx) {
+			trace += "handler(" + std::string(ctx.get("who")) + ")";
+			return etp::HttpResponse{};
+		});
+
+	etp::HttpRequest req;
+	req.path = "/ok";
+	handler(req);
+	CHECK_EQ(trace, std::string("outer>gate>handler(outer)<outer"));
+
+	trace.clear();
+	req.path = "/blocked";
+	auto resp = handler(req);
+	CHECK_EQ(resp.status, etp::HttpStatus::Forbidden);
+	CHECK_EQ(trace, std::string("outer>gate><outer"));
+}
+
+TEST_CASE(builtin_middlewares) {
+	auto chain = etp::make_middleware(
+		etp::RequestIdMiddleware{},
+		etp::CorsMiddleware{.allow_origin = "https://app.example"},
+		etp::BearerAuthMiddleware{[](std::string_view token) { return token == "secret"; }});
+	auto handler = chain.wrap([](const etp::HttpRequest&, etp::RequestContext& ctx) {
+		etp::HttpResponse resp;
+		resp.body = std::string(ctx.get("principal"));
+		return resp;
+	});
+
+	etp::HttpRequest req;
+	req.headers.set("Origin", "https://app.example");
+	auto denied = handler(req);
+	CHECK_EQ(denied.status, etp::HttpStatus::Unauthorized);
+	CHECK_FALSE(denied.headers.get("X-Request-ID").empty());
+	CHECK_EQ(denied.headers.get("Access-Control-Allow-Origin"), std::string_view("https://app.example"));
+
+	req.headers.set("Authorization", "Bearer secret");
+	req.headers.set("X-Request-ID", "abc-123");
+	auto ok = handler(req);
+	CHECK_EQ(ok.status, etp::HttpStatus::OK);
+	CHECK_EQ(ok.body, std::string("secret"));
+	CHECK_EQ(ok.headers.get("X-Request-ID"), std::string_view("abc-123"));
+
+	etp::HttpRequest preflight;
+	preflight.method = etp::HttpMethod::Options;
+	preflight.headers.set("Origin", "https://app.example");
+	preflight.headers.set("Access-Control-Request-Method", "PUT");
+	auto pre = handler(preflight);
+	CHECK_EQ(pre.status, etp::HttpStatus::NoContent);
+	CHECK_FALSE(pre.headers.get("Access-Control-Allow-Methods").empty());
+}
+
+TEST_CASE(middleware_chain_leaves_arena_after_throw) {
+	auto pass = [](const etp::HttpRequest&, etp::RequestContext&, auto&& next) { return next(); };
+	auto handler = etp::make_middleware(pass).wrap(
+		[](const etp::HttpRequest& req, etp::RequestContext&) -> etp::HttpResponse {
+			if (req.path == "/throw") throw std::runtime_error("handler failed");
+			return etp::HttpResponse{};
+		});
+
+	etp::HttpRequest req;
+	req.path = "/throw";
+	bool threw = false;
+	try {
+		handler(req);
+	} catch (const std::runtime_error&) {
+		threw = true;
+	}
+	CHECK_TRUE(threw);
+	// The next request on this thread starts from a reset arena again
+	CHECK_EQ(etp::middleware_detail::thread_arena().depth, 0);
+	req.path = "/ok";
+	CHECK_EQ(handler(req).status, etp::HttpStatus::OK);
+	CHECK_EQ(etp::middleware_detail::thread_arena().depth, 0);
+}
+
+TEST_CASE(cors_middleware_appends_to_vary) {
+	auto handler = etp::make_middleware(etp::CorsMiddleware{.allow_origin = "https://app.example"}).wrap(
+		[](const etp::HttpRequest& req, etp::RequestContext&) {
+			etp::HttpResponse resp;
+			if (req.path == "/encoded") resp.headers.set("Vary", "Accept-Encoding");
+			if (req.path == "/any") resp.headers.set("Vary", "*");
+			return resp;
+		});
+
+	etp::HttpRequest req;
+	req.headers.set("Origin", "https://app.example");
+	req.path = "/encoded";
+	CHECK_EQ(handler(req).headers.get("Vary"), std::string_view("Accept-Encoding, Origin"));
+	req.path = "/any";
+	CHECK_EQ(handler(req).headers.get("Vary"), std::string_view("*"));
+	req.path = "/plain";
+	CHECK_EQ(handler(req).headers.get("Vary"), std::string_view("Origin"));
+}
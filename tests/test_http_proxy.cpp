@@ -0,0 +1,325 @@
+#include "test_framework.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <chrono>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+namespace {
+
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+Address local(uint16_t port) { return Address(etn::Ip<4>(127, 0, 0, 1), port); }
+
+etp::UpstreamCluster cluster_of(uint16_t port) {
+	etp::UpstreamCluster cluster;
+	cluster.endpoints.push_back(local(port));
+	return cluster;
+}
+
+/**
+ * @brief Keep-alive client driven from the test thread alongside the loop
+ */
+struct TestClient {
+	etn::Socket<etn::Ip<4>> socket;
+	std::string pending;
+	std::string reply;
+
+	bool connect(uint16_t port) {
+		socket.create();
+		if (etherz::core::is_error(socket.connect(local(port)))) return false;
+		socket.set_nonblocking(true);
+		return true;
+	}
+
+	void send(std::string_view data) { pending.append(data); }
+
+	/// Run the loop, sending and receiving, until pred(reply) holds or ~3s pass
+	template <typename Pred>
+	bool pump(eta::EventLoop& loop, Pred pred) {
+		std::array<uint8_t, 64 * 1024> buf{};
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+		while (std::chrono::steady_clock::now() < deadline) {
+			if (!pending.empty()) {
+				int n = socket.send(std::span<const uint8_t>(
+					reinterpret_cast<const uint8_t*>(pending.data()), pending.size()));
+				if (n > 0) pending.erase(0, static_cast<size_t>(n));
+			}
+			loop.run_once(5);
+			int n;
+			while ((n = socket.recv(buf)) > 0) reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+			if (pending.empty() && pred(reply)) return true;
+		}
+		return false;
+	}
+
+	bool pump_until(eta::EventLoop& loop, std::string_view until) {
+		return pump(loop, [until](const std::string& r) { return r.find(until) != std::string::npos; });
+	}
+};
+
+/**
+ * @brief Upstream that answers every request head with a canned reply (and maybe hangs up)
+ */
+struct RawUpstream {
+	etn::Socket<etn::Ip<4>> listener;
+	std::vector<std::unique_ptr<etn::Socket<etn::Ip<4>>>> conns;
+	std::string response;          // Empty: never answer
+	bool close_after = false;
+	size_t requests = 0;
+	std::string last_request;
+
+	void start(eta::EventLoop& loop, uint16_t port) {
+		listener.create();
+		listener.set_reuse_addr(true);
+		listener.bind(local(port));
+		listener.listen();
+		listener.set_nonblocking(true);
+		loop.add(listener.native_handle(), eta::PollEvent::ReadReady, [this, &loop](etn::impl::socket_t, eta::PollEvent) {
+			while (auto accepted = listener.accept()) {
+				auto sock = std::make_unique<etn::Socket<etn::Ip<4>>>(std::move(accepted->socket));
+				sock->set_nonblocking(true);
+				auto* raw = sock.get();
+				conns.push_back(std::move(sock));
+				loop.add(raw->native_handle(), eta::PollEvent::ReadReady,
+					[this, raw, &loop, in = std::string()](etn::impl::socket_t fd, eta::PollEvent) mutable {
+						std::array<uint8_t, 4096> buf{};
+						int n;
+						while ((n = raw->recv(buf)) > 0) in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+						if (n == 0) loop.remove(fd);
+						for (auto end = in.find("\r\n\r\n"); end != std::string::npos; end = in.find("\r\n\r\n")) {
+							++requests;
+							last_request = in.substr(0, end + 4);
+							in.erase(0, end + 4);
+							if (response.empty()) continue;
+							raw->send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(response.data()), response.size()));
+							if (close_after) {
+								loop.remove(fd);
+								raw->close();
+								return;
+							}
+						}
+					});
+			}
+		});
+	}
+
+	void stop(eta::EventLoop& loop) {
+		loop.remove(listener.native_handle());
+		for (auto& c : conns) {
+			if (c->native_handle() != etn::impl::invalid_socket) loop.remove(c->native_handle());
+		}
+	}
+};
+
+} // namespace
+
+TEST_CASE(http_proxy_forwards_and_reuses_upstream) {
+	eta::EventLoop loop;
+	etp::HttpServer upstream;
+	upstream.get("/api/users", [](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.headers.set("X-Seen-For", std::string(req.headers.get("X-Forwarded-For")));
+		resp.body = "users";
+		return resp;
+	});
+	constexpr uint16_t upstream_port = 18293, proxy_port = 18294;
+	CHECK_FALSE(etherz::core::is_error(upstream.listen(local(upstream_port))));
+	upstream.attach(loop);
+
+	etp::HttpServer proxy;
+	proxy.proxy("/api", cluster_of(upstream_port));
+	proxy.get("/api/local", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "local";
+		return resp;
+	});
+	CHECK_FALSE(etherz::core::is_error(proxy.listen(local(proxy_port))));
+	proxy.attach(loop);
+
+	TestClient client;
+	CHECK_TRUE(client.connect(proxy_port));
+	for (int i = 0; i < 3; ++i) {
+		client.reply.clear();
+		client.send("GET /api/users HTTP/1.1\r\nHost: x\r\n\r\n");
+		CHECK_TRUE(client.pump_until(loop, "\r\n\r\nusers"));
+		CHECK_TRUE(client.reply.starts_with("HTTP/1.1 200"));
+		CHECK_TRUE(client.reply.find("X-Seen-For: 127.0.0.1") != std::string::npos);
+	}
+	auto* pool = proxy.upstream_pool("/api");
+	CHECK_TRUE(pool != nullptr);
+	CHECK_EQ(pool->connect_count(), 1u);
+	CHECK_EQ(pool->reuse_count(), 2u);
+	CHECK_EQ(pool->idle_count(), static_cast<size_t>(1));
+
+	// Exact routes win; prefixes only match on a segment boundary
+	client.reply.clear();
+	client.send("GET /api/local HTTP/1.1\r\nHost: x\r\n\r\nGET /apix HTTP/1.1\r\nHost: x\r\n\r\n");
+	CHECK_TRUE(client.pump_until(loop, "404 Not Found"));
+	CHECK_TRUE(client.reply.find("\r\n\r\nlocal") != std::string::npos);
+}
+
+TEST_CASE(http_proxy_rewrites_hop_by_hop_fields) {
+	eta::EventLoop loop;
+	RawUpstream upstream;
+	upstream.response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nKeep-Alive: timeout=5\r\nX-Private: 1\r\n"
+		"Connection: X-Private\r\nX-Public: 1\r\n\r\nok";
+	constexpr uint16_t upstream_port = 18295, proxy_port = 18296;
+	upstream.start(loop, upstream_port);
+
+	etp::HttpServer proxy;
+	etp::ProxyOptions options;
+	options.strip_prefix = true;
+	proxy.proxy("/svc", cluster_of(upstream_port), options);
+	CHECK_FALSE(etherz::core::is_error(proxy.listen(local(proxy_port))));
+	proxy.attach(loop);
+
+	TestClient client;
+	CHECK_TRUE(client.connect(proxy_port));
+	client.send("GET /svc/items?id=7 HTTP/1.1\r\nHost: x\r\nConnection: keep-alive, X-Drop\r\nX-Drop: 1\r\n"
+		"X-Forwarded-For: 10.0.0.1\r\nX-Keep: 1\r\n\r\n");
+	CHECK_TRUE(client.pump_until(loop, "\r\n\r\nok"));
+
+	const auto& sent = upstream.last_request;
+	CHECK_TRUE(sent.starts_with("GET /items?id=7 HTTP/1.1\r\n"));
+	CHECK_TRUE(sent.find("X-Keep: 1") != std::string::npos);
+	CHECK_TRUE(sent.find("X-Drop") == std::string::npos);
+	CHECK_TRUE(sent.find("Connection") == std::string::npos);
+	CHECK_TRUE(sent.find("X-Forwarded-For: 10.0.0.1, 127.0.0.1\r\n") != std::string::npos);
+	CHECK_TRUE(sent.find("X-Forwarded-Proto: http\r\n") != std::string::npos);
+
+	const auto& got = client.reply;
+	CHECK_TRUE(got.starts_with("HTTP/1.1 200 OK\r\n"));
+	CHECK_TRUE(got.find("X-Public: 1") != std::string::npos);
+	CHECK_TRUE(got.find("Keep-Alive") == std::string::npos);
+	CHECK_TRUE(got.find("X-Private") == std::string::npos);
+	upstream.stop(loop);
+}
+
+TEST_CASE(http_proxy_streams_request_bodies) {
+	eta::EventLoop loop;
+	etp::HttpServer upstream;
+	upstream.post("/up/echo", [](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.body = std::to_string(req.body.size()) + ":" + req.body.substr(0, 5);
+		return resp;
+	});
+	constexpr uint16_t upstream_port = 18297, proxy_port = 18298;
+	CHECK_FALSE(etherz::core::is_error(upstream.listen(local(upstream_port))));
+	upstream.attach(loop);
+
+	etp::HttpServer proxy;
+	etp::ProxyOptions options;
+	options.request_buffer = 16 * 1024; // Forces the client to be paused and resumed
+	proxy.proxy("/up", cluster_of(upstream_port), options);
+	CHECK_FALSE(etherz::core::is_error(proxy.listen(local(proxy_port))));
+	proxy.attach(loop);
+
+	TestClient client;
+	CHECK_TRUE(client.connect(proxy_port));
+	client.send("POST /up/echo HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n"
+		"5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n");
+	CHECK_TRUE(client.pump_until(loop, "\r\n\r\n11:hello"));
+
+	std::string big(600 * 1024, 'b');
+	client.reply.clear();
+	client.send("POST /up/echo HTTP/1.1\r\nHost: x\r\nContent-Length: " + std::to_string(big.size()) + "\r\n\r\n" + big);
+	CHECK_TRUE(client.pump_until(loop, "\r\n\r\n614400:bbbbb"));
+	CHECK_EQ(proxy.upstream_pool("/up")->connect_count(), 1u);
+}
+
+TEST_CASE(http_proxy_passes_framing_through) {
+	eta::EventLoop loop;
+	constexpr uint16_t chunked_port = 18299, close_port = 18300, big_port = 18301, proxy_port = 18302;
+	RawUpstream chunked;
+	chunked.response = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+		"3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n";
+	chunked.start(loop, chunked_port);
+	RawUpstream closing;
+	closing.response = "HTTP/1.1 200 OK\r\n\r\nuntil-close";
+	closing.close_after = true;
+	closing.start(loop, close_port);
+
+	etp::HttpServer upstream;
+	std::string large(2 * 1024 * 1024 + 17, 'x');
+	upstream.get("/big/file", [&](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = large;
+		return resp;
+	});
+	CHECK_FALSE(etherz::core::is_error(upstream.listen(local(big_port))));
+	upstream.attach(loop);
+
+	etp::HttpServer proxy;
+	proxy.proxy("/chunked", cluster_of(chunked_port));
+	proxy.proxy("/close", cluster_of(close_port));
+	proxy.proxy("/big", cluster_of(big_port));
+	CHECK_FALSE(etherz::core::is_error(proxy.listen(local(proxy_port))));
+	proxy.attach(loop);
+
+	TestClient a;
+	CHECK_TRUE(a.connect(proxy_port));
+	a.send("GET /chunked HTTP/1.1\r\nHost: x\r\n\r\n");
+	CHECK_TRUE(a.pump_until(loop, "0\r\n\r\n"));
+	CHECK_TRUE(a.reply.starts_with("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n"));
+
+	// An HTTP/1.0 client gets the body de-chunked and delimited by close
+	TestClient b;
+	CHECK_TRUE(b.connect(proxy_port));
+	b.send("GET /chunked HTTP/1.0\r\n\r\n");
+	CHECK_TRUE(b.pump_until(loop, "\r\n\r\nabcde"));
+	CHECK_TRUE(b.reply.find("Transfer-Encoding") == std::string::npos);
+	CHECK_TRUE(b.reply.find("Connection: close") != std::string::npos);
+
+	TestClient c;
+	CHECK_TRUE(c.connect(proxy_port));
+	c.send("GET /close HTTP/1.1\r\nHost: x\r\n\r\n");
+	CHECK_TRUE(c.pump_until(loop, "until-close"));
+	CHECK_TRUE(c.reply.find("Connection: close") != std::string::npos);
+
+	// Large Content-Length bodies take the splice path where there is one
+	TestClient d;
+	CHECK_TRUE(d.connect(proxy_port));
+	d.send("GET /big/file HTTP/1.1\r\nHost: x\r\n\r\n");
+	bool complete = d.pump(loop, [&](const std::string& r) {
+		auto head = r.find("\r\n\r\n");
+		return head != std::string::npos && r.size() - head - 4 >= large.size();
+	});
+	CHECK_TRUE(complete);
+	CHECK_EQ(d.reply.size() - d.reply.find("\r\n\r\n") - 4, large.size());
+	CHECK_TRUE(d.reply.ends_with("xxxx"));
+
+	chunked.stop(loop);
+	closing.stop(loop);
+}
+
+TEST_CASE(http_proxy_reports_upstream_failures) {
+	eta::EventLoop loop;
+	constexpr uint16_t dead_port = 18303, silent_port = 18304, proxy_port = 18305;
+	RawUpstream silent; // Accepts and never answers
+	silent.start(loop, silent_port);
+
+	etp::HttpServer proxy;
+	proxy.proxy("/dead", cluster_of(dead_port));
+	etp::ProxyOptions options;
+	options.response_timeout = std::chrono::milliseconds(200);
+	proxy.proxy("/silent", cluster_of(silent_port), options);
+	CHECK_FALSE(etherz::core::is_error(proxy.listen(local(proxy_port))));
+	proxy.attach(loop);
+
+	TestClient client;
+	CHECK_TRUE(client.connect(proxy_port));
+	client.send("GET /dead HTTP/1.1\r\nHost: x\r\n\r\n");
+	CHECK_TRUE(client.pump_until(loop, "502 Bad Gateway"));
+	CHECK_TRUE(client.reply.starts_with("HTTP/1.1 502"));
+
+	// The client connection survives a 502 and can time out on the next one
+	client.reply.clear();
+	client.send("GET /silent HTTP/1.1\r\nHost: x\r\n\r\n");
+	CHECK_TRUE(client.pump_until(loop, "504 Gateway Timeout"));
+	CHECK_EQ(silent.requests, static_cast<size_t>(1));
+	CHECK_EQ(proxy.upstream_pool("/silent")->idle_count(), static_cast<size_t>(0));
+	silent.stop(loop);
+}
@@ -0,0 +1,118 @@
+#include "test_framework.hpp"
+#include "protocol/http_response_cache.hpp"
+#include <thread>
+#include <atomic>
+
+namespace etp = etherz::protocol;
+using Cache = etp::ResponseCache;
+using namespace std::chrono_literals;
+
+namespace {
+
+Cache::Handle entry_of(std::string body, Cache::Clock::time_point expires) {
+	etp::HttpResponse resp;
+	resp.body = std::move(body);
+	return Cache::make_entry(std::move(resp), expires);
+}
+
+} // namespace
+
+TEST_CASE(response_cache_key_and_entry) {
+	etp::HttpRequest req;
+	req.path = "/a";
+	req.headers.set("Accept-Language", "de");
+	etp::ResponseCachePolicy policy{.ttl = 1000ms, .max_ttl = 0ms, .vary = {"Accept-Language"}};
+	auto key = Cache::make_key(req, policy, "gzip");
+	CHECK_EQ(key, std::string("GET /a\nde\ngzip"));
+
+	auto entry = entry_of("hello", Cache::Clock::now());
+	CHECK_TRUE(entry->wire.starts_with("HTTP/1.1 200 OK\r\n"));
+	CHECK_TRUE(entry->wire.find("Content-Length: 5\r\n") != std::string::npos);
+	CHECK_TRUE(entry->wire.ends_with("\r\n\r\nhello"));
+	CHECK_EQ(entry->response.body, std::string("hello"));
+}
+
+TEST_CASE(response_cache_freshness_rules) {
+	etp::ResponseCachePolicy policy{.ttl = 2000ms, .max_ttl = 0ms, .vary = {}};
+	etp::HttpResponse resp;
+	CHECK_TRUE(Cache::freshness(resp, policy) == 2000ms);
+
+	resp.headers.set("Cache-Control", "public, max-age=60");
+	CHECK_TRUE(Cache::freshness(resp, policy) == 60'000ms);
+	resp.headers.set("Cache-Control", "max-age=60, s-maxage=\"5\"");
+	CHECK_TRUE(Cache::freshness(resp, policy) == 5'000ms);
+	policy.max_ttl = 1000ms;
+	CHECK_TRUE(Cache::freshness(resp, policy) == 1000ms);
+
+	for (auto cc : {"no-store", "private, max-age=10", "No-Cache", "max-age=0"}) {
+		resp.headers.set("Cache-Control", cc);
+		CHECK_FALSE(Cache::freshness(resp, policy).has_value());
+	}
+	resp.headers.set("Cache-Control", "max-age=10");
+	resp.headers.set("Vary", "Accept-Encoding");
+	CHECK_TRUE(Cache::freshness(resp, policy).has_value());
+	resp.headers.set("Vary", "Accept-Encoding, Cookie");
+	CHECK_FALSE(Cache::freshness(resp, policy).has_value());
+	policy.vary = {"cookie"};
+	CHECK_TRUE(Cache::freshness(resp, policy).has_value());
+
+	resp.status = etp::HttpStatus::InternalServerError;
+	CHECK_FALSE(Cache::freshness(resp, policy).has_value());
+
+	etp::HttpRequest req;
+	CHECK_TRUE(Cache::request_lookup(req) == Cache::Lookup::Use);
+	req.headers.set("Cache-Control", "max-age=0");
+	CHECK_TRUE(Cache::request_lookup(req) == Cache::Lookup::Refresh);
+	req.headers.set("Cache-Control", "no-store");
+	CHECK_TRUE(Cache::request_lookup(req) == Cache::Lookup::Bypass);
+	req.headers.set("Cache-Control", "max-stale");
+	req.headers.set("Authorization", "Bearer x");
+	CHECK_TRUE(Cache::request_lookup(req) == Cache::Lookup::Bypass);
+}
+
+TEST_CASE(response_cache_expiry_and_byte_bound) {
+	Cache cache({.capacity_bytes = 4096, .shards = 1});
+	auto now = Cache::Clock::now();
+	cache.insert("a", entry_of(std::string(1000, 'a'), now + 10s), now);
+	cache.insert("stale", entry_of("x", now), now); // Already expired: not stored
+	CHECK_EQ(cache.size(), static_cast<size_t>(1));
+	CHECK_TRUE(cache.find("a", now) != nullptr);
+	CHECK_TRUE(cache.find("a", now + 11s) == nullptr);
+	CHECK_EQ(cache.size(), static_cast<size_t>(0));
+
+	// Each entry is ~2 KiB (wire + body); the least recently used one goes
+	cache.insert("a", entry_of(std::string(900, 'a'), now + 10s), now);
+	cache.insert("b", entry_of(std::string(900, 'b'), now + 10s), now);
+	CHECK_TRUE(cache.find("a", now) != nullptr);
+	cache.insert("c", entry_of(std::string(900, 'c'), now + 10s), now);
+	CHECK_TRUE(cache.find("a", now) != nullptr);
+	CHECK_TRUE(cache.find("b", now) == nullptr);
+	CHECK_TRUE(cache.bytes() <= cache.capacity());
+}
+
+TEST_CASE(response_cache_single_flight) {
+	Cache cache;
+	std::atomic<int> fills{0};
+	std::atomic<bool> release{false};
+	auto now = Cache::Clock::now();
+	auto fill = [&] {
+		++fills;
+		while (!release) std::this_thread::yield();
+		return entry_of("shared", now + 10s);
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<Cache::Handle> got(4);
+	for (size_t i = 0; i < got.size(); ++i) {
+		threads.emplace_back([&, i] { got[i] = cache.fetch("k", now, fill); });
+	}
+	while (fills == 0) std::this_thread::yield();
+	std::this_thread::sleep_for(20ms); // Let the others queue up behind the fill
+	release = true;
+	for (auto& t : threads) t.join();
+
+	CHECK_EQ(fills.load(), 1);
+	for (auto& g : got) CHECK_TRUE(g == got[0]);
+	CHECK_EQ(cache.misses() + cache.coalesced() + cache.hits(), static_cast<uint64_t>(4));
+	CHECK_TRUE(cache.fetch("k", now, fill) == got[0]);
+}
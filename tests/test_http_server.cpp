@@ -0,0 +1,496 @@
+#include "test_framework.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <thread>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+namespace {
+
+/**
+ * @brief Send raw bytes to a server on loop and collect what comes back
+ *
+ * Drives the loop from the test thread; stops once `until` appears in the
+ * reply (or after ~2s).
+ */
+std::string exchange(eta::EventLoop& loop, uint16_t port, std::string_view request, std::string_view until) {
+	etn::Socket<etn::Ip<4>> client;
+	client.create();
+	if (etherz::core::is_error(client.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) return {};
+	client.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+	client.set_nonblocking(true);
+
+	std::string reply;
+	std::array<uint8_t, 4096> buf{};
+	for (int i = 0; i < 200 && reply.find(until) == std::string::npos; ++i) {
+		loop.run_once(10);
+		int n = client.recv(buf);
+		if (n > 0) reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+	}
+	return reply;
+}
+
+} // namespace
+
+TEST_CASE(http_server_streams_chunked_body) {
+	etp::HttpServer server;
+	size_t pieces = 0;
+	std::string received;
+	server.stream(etp::HttpMethod::Post, "/upload", {
+		.on_headers = {},
+		.on_data = [&](std::string_view data, etp::BodyStream&) { ++pieces; received.append(data); },
+		.on_complete = [&](const etp::HttpRequest&, etp::BodyStream& body) {
+			etp::HttpResponse resp;
+			resp.body = std::to_string(body.bytes_received());
+			return resp;
+		},
+		.on_abort = {},
+	});
+	constexpr uint16_t port = 18281;
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	auto reply = exchange(loop, port,
+		"POST /upload HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n"
+		"5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n", "\r\n\r\n11");
+	CHECK_TRUE(reply.starts_with("HTTP/1.1 200"));
+	CHECK_TRUE(reply.ends_with("\r\n\r\n11"));
+	CHECK_EQ(received, std::string("hello world"));
+	CHECK_EQ(pieces, static_cast<size_t>(2));
+}
+
+TEST_CASE(http_server_stream_pause_resume) {
+	etp::HttpServer server;
+	etp::BodyStream* paused = nullptr;
+	std::string received;
+	server.stream(etp::HttpMethod::Put, "/blob", {
+		.on_headers = [](const etp::HttpRequest&, etp::BodyStream& body) {
+			CHECK_TRUE(body.content_length() == 10u);
+		},
+		.on_data = [&](std::string_view data, etp::BodyStream& body) {
+			received.append(data);
+			body.pause();
+			paused = &body;
+		},
+		.on_complete = [](const etp::HttpRequest&, etp::BodyStream&) {
+			etp::HttpResponse resp;
+			resp.body = "done";
+			return resp;
+		},
+		.on_abort = {},
+	});
+	constexpr uint16_t port = 18282;
+	server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	etn::Socket<etn::Ip<4>> client;
+	client.create();
+	client.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	auto send = [&](std::string_view s) {
+		client.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(s.data()), s.size()));
+	};
+	send("PUT /blob HTTP/1.1\r\nHost: x\r\nContent-Length: 10\r\nExpect: 100-continue\r\n\r\n01234");
+	for (int i = 0; i < 100 && received.size() < 5; ++i) loop.run_once(10);
+	CHECK_EQ(received, std::string("01234"));
+
+	// Paused: the rest of the body stays in the socket
+	send("56789");
+	for (int i = 0; i < 5; ++i) loop.run_once(10);
+	CHECK_EQ(received, std::string("01234"));
+
+	client.set_nonblocking(true);
+	std::string reply;
+	std::array<uint8_t, 4096> buf{};
+	for (int i = 0; i < 200 && !reply.ends_with("done"); ++i) {
+		if (paused) std::exchange(paused, nullptr)->resume();
+		loop.run_once(10);
+		int n = client.recv(buf);
+		if (n > 0) reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+	}
+	CHECK_EQ(received, std::string("0123456789"));
+	CHECK_TRUE(reply.starts_with("HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200"));
+	CHECK_TRUE(reply.ends_with("done"));
+}
+
+TEST_CASE(http_server_buffered_route_accepts_chunked) {
+	etp::HttpServer server;
+	server.post("/echo", [](const etp::HttpRequest& req) {
+		etp::HttpResponse resp;
+		resp.body = req.body;
+		return resp;
+	});
+	constexpr uint16_t port = 18283;
+	server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	auto reply = exchange(loop, port,
+		"POST /echo HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n\r\n", "abc");
+	CHECK_TRUE(reply.starts_with("HTTP/1.1 200"));
+	CHECK_TRUE(reply.find("Content-Length: 3") != std::string::npos);
+	CHECK_TRUE(reply.ends_with("abc"));
+}
+
+TEST_CASE(http_server_reaps_silent_and_slow_clients) {
+	using namespace std::chrono_literals;
+	etp::HttpServer server;
+	server.get("/", [](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	etp::ServerTimeouts timeouts;
+	timeouts.header_read = 300ms;
+	timeouts.min_bytes_per_second = 0;
+	server.set_timeouts(timeouts);
+	constexpr uint16_t port = 18284;
+	server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	eta::EventLoop loop(20ms);
+	server.attach(loop);
+
+	// Half the flood sends nothing, half a partial request head
+	constexpr int flood = 64;
+	std::vector<etn::Socket<etn::Ip<4>>> clients(flood);
+	for (int i = 0; i < flood; ++i) {
+		clients[i].create();
+		clients[i].connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+		if (i % 2) {
+			std::string_view partial = "GET / HTTP/1.1\r\nHost: x\r\n";
+			clients[i].send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(partial.data()), partial.size()));
+		}
+	}
+	for (int i = 0; i < 10; ++i) loop.run_once(10);
+	CHECK_EQ(server.connection_count(), static_cast<size_t>(flood));
+	CHECK_TRUE(server.buffered_bytes() > 0);
+
+	auto start = std::chrono::steady_clock::now();
+	while (server.connection_count() > 0 && std::chrono::steady_clock::now() - start < 2s) loop.run_once(10);
+	CHECK_EQ(server.connection_count(), static_cast<size_t>(0));
+	CHECK_EQ(server.buffered_bytes(), static_cast<size_t>(0));
+	CHECK_EQ(server.timed_out_count(), static_cast<uint64_t>(flood));
+
+	std::array<uint8_t, 256> buf{};
+	int n = clients[1].recv(buf);
+	CHECK_TRUE(n > 0 && std::string_view(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n))
+		.starts_with("HTTP/1.1 408"));
+}
+
+TEST_CASE(http_server_min_rate_reaps_trickle) {
+	using namespace std::chrono_literals;
+	etp::HttpServer server;
+	server.get("/", [](const etp::HttpRequest&) { return etp::HttpResponse{}; });
+	etp::ServerTimeouts timeouts;
+	timeouts.min_bytes_per_second = 200;
+	timeouts.rate_window = 200ms;
+	timeouts.keep_alive_idle = 200ms;
+	server.set_timeouts(timeouts);
+	constexpr uint16_t port = 18285;
+	server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	eta::EventLoop loop(20ms);
+	server.attach(loop);
+
+	// One byte every 30ms (~33 B/s) stays under every gap timeout but not the rate
+	etn::Socket<etn::Ip<4>> slow;
+	slow.create();
+	slow.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	std::string_view head = "GET / HTTP/1.1\r\nHost: x\r\nX-Padding: aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\r\n\r\n";
+	size_t sent = 0;
+	auto start = std::chrono::steady_clock::now();
+	while (server.timed_out_count() == 0 && std::chrono::steady_clock::now() - start < 2s) {
+		if (sent < head.size()) {
+			slow.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(head.data() + sent), 1));
+			++sent;
+		}
+		auto next = std::chrono::steady_clock::now() + 30ms;
+		while (std::chrono::steady_clock::now() < next) loop.run_once(10);
+	}
+	CHECK_EQ(server.timed_out_count(), static_cast<uint64_t>(1));
+	CHECK_TRUE(sent < head.size());
+
+	// A well-behaved keep-alive client is served, then closed once idle
+	etn::Socket<etn::Ip<4>> client;
+	client.create();
+	client.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	std::string_view request = "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+	client.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+	start = std::chrono::steady_clock::now();
+	while (server.timed_out_count() < 2 && std::chrono::steady_clock::now() - start < 2s) loop.run_once(10);
+	CHECK_EQ(server.timed_out_count(), static_cast<uint64_t>(2));
+	CHECK_EQ(server.connection_count(), static_cast<size_t>(0));
+
+	std::string reply;
+	std::array<uint8_t, 1024> buf{};
+	int n = 0;
+	while ((n = client.recv(buf)) > 0) reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+	CHECK_TRUE(reply.starts_with("HTTP/1.1 200"));
+}
+
+TEST_CASE(http_server_metrics_endpoint) {
+	etp::HttpServer server;
+	server.get("/hello", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "hi";
+		return resp;
+	});
+	server.enable_metrics();
+	constexpr uint16_t port = 18286;
+	server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	exchange(loop, port, "GET /hello HTTP/1.1\r\nHost: x\r\n\r\n", "hi");
+	exchange(loop, port, "GET /missing HTTP/1.1\r\nHost: x\r\n\r\n", "Found");
+	auto reply = exchange(loop, port, "GET /metrics HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n", "etherz_connections_open");
+
+	CHECK_TRUE(reply.find("text/plain; version=0.0.4") != std::string::npos);
+	CHECK_TRUE(reply.find("etherz_http_requests_total{method=\"GET\",route=\"/hello\",code=\"2xx\"} 1") != std::string::npos);
+	CHECK_TRUE(reply.find("etherz_http_requests_total{method=\"\",route=\"unmatched\",code=\"4xx\"} 1") != std::string::npos);
+	CHECK_TRUE(reply.find("etherz_http_responses_total{code=\"404\"} 1") != std::string::npos);
+	CHECK_TRUE(reply.find("etherz_http_requests_in_flight{method=\"GET\",route=\"/metrics\"} 1") != std::string::npos);
+
+	auto hello = server.metrics()->route(1);
+	CHECK_EQ(hello.path, std::string_view("/hello"));
+	CHECK_EQ(hello.body_out, static_cast<uint64_t>(2));
+	CHECK_TRUE(server.metrics()->network_received() > 0);
+}
+
+TEST_CASE(http_server_response_cache) {
+	etp::HttpServer server;
+	int calls = 0;
+	server.get("/hot", [&](const etp::HttpRequest&) {
+		++calls;
+		etp::HttpResponse resp;
+		resp.body = "v" + std::to_string(calls);
+		return resp;
+	});
+	server.get("/private", [&](const etp::HttpRequest&) {
+		++calls;
+		etp::HttpResponse resp;
+		resp.headers.set("Cache-Control", "private");
+		resp.body = "p";
+		return resp;
+	});
+	server.enable_response_cache();
+	server.cache("/hot", {.ttl = std::chrono::seconds(30), .max_ttl = {}, .vary = {}});
+	server.cache("/private");
+	constexpr uint16_t port = 18287;
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	// Pipelined: the hit is queued between copied responses and stays in order
+	auto reply = exchange(loop, port,
+		"GET /hot HTTP/1.1\r\nHost: x\r\n\r\n"
+		"GET /private HTTP/1.1\r\nHost: x\r\n\r\n"
+		"GET /hot HTTP/1.1\r\nHost: x\r\n\r\n"
+		"GET /missing HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n", "404 Not Found");
+	CHECK_EQ(calls, 2);
+	auto first = reply.find("\r\n\r\nv1");
+	auto second = reply.find("\r\n\r\np");
+	auto third = reply.find("\r\n\r\nv1", first + 1);
+	CHECK_TRUE(first != std::string::npos && second > first && third > second && third != std::string::npos);
+	CHECK_EQ(server.response_cache()->hits(), static_cast<uint64_t>(1));
+
+	// no-cache refreshes the entry; later hits see the new body
+	reply = exchange(loop, port, "GET /hot HTTP/1.1\r\nHost: x\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n", "v3");
+	CHECK_TRUE(reply.find("Connection: close\r\n") != std::string::npos);
+	reply = exchange(loop, port, "GET /hot HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n", "\r\n\r\n");
+	CHECK_TRUE(reply.starts_with("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n"));
+	CHECK_TRUE(reply.ends_with("v3"));
+	CHECK_EQ(calls, 3);
+}
+
+TEST_CASE(http_server_async_handlers) {
+	etp::HttpServer server;
+	std::vector<std::thread> backends;
+	server.get_async("/slow", [&](const etp::HttpRequest& req, etp::HttpResponder responder) {
+		auto tag = std::string(req.headers.get("X-Tag"));
+		backends.emplace_back([responder, tag] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			etp::HttpResponse resp;
+			resp.body = "slow " + tag;
+			responder.send(std::move(resp));
+			responder.send(etp::HttpResponse{}); // Ignored
+		});
+	});
+	server.get_async("/dropped", [](const etp::HttpRequest&, etp::HttpResponder) {});
+	server.get("/fast", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "fast";
+		return resp;
+	});
+	constexpr uint16_t port = 18289;
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	// A pending async request does not hold up other connections
+	etn::Socket<etn::Ip<4>> waiting;
+	waiting.create();
+	CHECK_FALSE(etherz::core::is_error(waiting.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	std::string_view pipelined =
+		"GET /slow HTTP/1.1\r\nHost: x\r\nX-Tag: 1\r\n\r\n"
+		"GET /fast HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+	waiting.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(pipelined.data()), pipelined.size()));
+	waiting.set_nonblocking(true);
+
+	auto fast = exchange(loop, port, "GET /fast HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n", "fast");
+	CHECK_TRUE(fast.ends_with("fast"));
+	auto dropped = exchange(loop, port, "GET /dropped HTTP/1.1\r\nHost: x\r\n\r\n", "Error");
+	CHECK_TRUE(dropped.starts_with("HTTP/1.1 500"));
+
+	// Responses on the pipelined connection stay in request order
+	std::string reply;
+	std::array<uint8_t, 4096> buf{};
+	for (int i = 0; i < 200 && !reply.ends_with("fast"); ++i) {
+		loop.run_once(10);
+		int n = waiting.recv(buf);
+		if (n > 0) reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+	}
+	auto slow_at = reply.find("slow 1");
+	CHECK_TRUE(slow_at != std::string::npos && reply.find("fast") > slow_at);
+	for (auto& t : backends) t.join();
+}
+
+TEST_CASE(http_server_event_stream) {
+	etp::HttpServer server;
+	etp::SseBroadcaster hub;
+	size_t closed = 0;
+	server.set_sse_options({.heartbeat = std::chrono::milliseconds(50)});
+	server.sse("/events", [&](const etp::HttpRequest&, std::shared_ptr<etp::SseStream> stream) {
+		stream->on_close = [&] { ++closed; };
+		stream->send({.data = "hello"});
+		hub.subscribe(std::move(stream));
+	});
+	constexpr uint16_t port = 18290;
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	std::array<etn::Socket<etn::Ip<4>>, 2> clients;
+	std::array<std::string, 2> replies;
+	std::string_view request = "GET /events HTTP/1.1\r\nHost: x\r\n\r\n";
+	for (auto& c : clients) {
+		c.create();
+		CHECK_FALSE(etherz::core::is_error(c.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+		c.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+		c.set_nonblocking(true);
+	}
+	auto pump = [&](std::string_view until) {
+		std::array<uint8_t, 4096> buf{};
+		for (int i = 0; i < 200; ++i) {
+			loop.run_once(10);
+			for (size_t k = 0; k < clients.size(); ++k) {
+				int n = clients[k].recv(buf);
+				if (n > 0) replies[k].append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+			}
+			if (replies[0].ends_with(until) && replies[1].ends_with(until)) return;
+		}
+	};
+
+	pump("data: hello\n\n");
+	CHECK_EQ(hub.size(), static_cast<size_t>(2));
+	for (auto& r : replies) {
+		CHECK_TRUE(r.starts_with("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"));
+		CHECK_TRUE(r.find("Content-Length") == std::string::npos);
+	}
+
+	// One serialization, delivered to every subscriber
+	CHECK_EQ(hub.publish({.data = "tick", .event = "clock"}), static_cast<size_t>(2));
+	pump("event: clock\ndata: tick\n\n");
+
+	// Quiet streams get heartbeat comments
+	pump(": ping\n\n");
+	CHECK_TRUE(replies[0].ends_with(": ping\n\n"));
+
+	// A gone subscriber is dropped on the next publish
+	clients[0].close();
+	for (int i = 0; i < 20 && closed == 0; ++i) loop.run_once(10);
+	CHECK_EQ(closed, static_cast<size_t>(1));
+	CHECK_EQ(hub.publish({.data = "again"}), static_cast<size_t>(1));
+	CHECK_EQ(hub.size(), static_cast<size_t>(1));
+	server.stop();
+	CHECK_EQ(closed, static_cast<size_t>(2));
+}
+
+TEST_CASE(http_server_sheds_queued_requests) {
+	etp::HttpServer server;
+	server.get("/slow", [](const etp::HttpRequest&) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(30));
+		etp::HttpResponse resp;
+		resp.body = "slow";
+		return resp;
+	});
+	server.get("/health", [](const etp::HttpRequest&) {
+		etp::HttpResponse resp;
+		resp.body = "healthy";
+		return resp;
+	});
+	server.enable_admission_control({.target = std::chrono::milliseconds(5), .interval = std::chrono::milliseconds(75),
+		.retry_after = std::chrono::milliseconds(1500), .default_priority = etp::RequestPriority::Normal});
+	server.prioritize("/health", etp::RequestPriority::Critical);
+	constexpr uint16_t port = 18291;
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	// Pipelined requests all read in one loop turn: each waits for the ones before it
+	std::string pipeline;
+	for (int i = 0; i < 5; ++i) pipeline += "GET /slow HTTP/1.1\r\nHost: x\r\n\r\n";
+	pipeline += "GET /health HTTP/1.1\r\nHost: x\r\n\r\n";
+	auto reply = exchange(loop, port, pipeline, "healthy");
+
+	auto count = [&](std::string_view what) {
+		size_t n = 0;
+		for (auto at = reply.find(what); at != std::string::npos; at = reply.find(what, at + 1)) ++n;
+		return n;
+	};
+	CHECK_EQ(count("HTTP/1.1 200"), static_cast<size_t>(4)); // 0, 30 and 60 ms of delay, plus /health
+	CHECK_EQ(count("HTTP/1.1 503"), static_cast<size_t>(2));
+	CHECK_EQ(count("Retry-After: 2\r\n"), static_cast<size_t>(2));
+	CHECK_TRUE(reply.ends_with("healthy"));
+	CHECK_EQ(server.admission()->shed_count(), static_cast<uint64_t>(2));
+	CHECK_EQ(server.connection_count(), static_cast<size_t>(1)); // Shedding kept the connection
+}
+
+TEST_CASE(http_server_worker_pool) {
+	etp::HttpServer server;
+	std::mutex mutex;
+	std::vector<std::thread::id> handler_threads;
+	auto blocking = [&](std::string path, int delay_ms) {
+		return [&, path, delay_ms](const etp::HttpRequest&) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms)); // A blocking call
+			std::lock_guard lock(mutex);
+			handler_threads.push_back(std::this_thread::get_id());
+			etp::HttpResponse resp;
+			resp.body = "<" + path + ">";
+			return resp;
+		};
+	};
+	server.get("/a", blocking("/a", 30));
+	server.get("/b", blocking("/b", 10));
+	server.get("/c", blocking("/c", 0));
+	server.route(etp::HttpMethod::Head, "/c", blocking("/c", 0));
+	server.enable_workers(4);
+	CHECK_EQ(server.worker_count(), static_cast<size_t>(4));
+	constexpr uint16_t port = 18292;
+	CHECK_FALSE(etherz::core::is_error(server.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	eta::EventLoop loop;
+	server.attach(loop);
+
+	// Pipelined on one connection: answered in request order by one pinned worker
+	auto reply = exchange(loop, port,
+		"GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+		"GET /b HTTP/1.1\r\nHost: x\r\n\r\n"
+		"HEAD /c HTTP/1.1\r\nHost: x\r\n\r\n"
+		"GET /c HTTP/1.1\r\nHost: x\r\n\r\n", "</c>");
+	auto a = reply.find("</a>"), b = reply.find("</b>"), c = reply.find("</c>");
+	CHECK_TRUE(a != std::string::npos && b != std::string::npos && c != std::string::npos);
+	CHECK_TRUE(a < b && b < c);
+	CHECK_EQ(reply.find("</c>"), reply.rfind("</c>")); // No body for HEAD
+	std::lock_guard lock(mutex);
+	CHECK_EQ(handler_threads.size(), static_cast<size_t>(4));
+	bool pinned = true;
+	for (auto id : handler_threads) pinned = pinned && id == handler_threads[0] && id != std::this_thread::get_id();
+	CHECK_TRUE(pinned);
+}
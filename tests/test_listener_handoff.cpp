@@ -0,0 +1,170 @@
+#include "test_framework.hpp"
+#include "net/listener_handoff.hpp"
+#include "protocol/http_server.hpp"
+
+#ifndef _WIN32
+#include <atomic>
+#include <thread>
+#include <sys/wait.h>
+
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+namespace etp = etherz::protocol;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string socket_path(std::string_view tag) {
+	return "/tmp/etherz-" + std::string(tag) + "-" + std::to_string(::getpid()) + ".sock";
+}
+
+/**
+ * @brief One request on a fresh connection; the body, or "" on any failure
+ */
+std::string fetch_once(uint16_t port) {
+	etn::Socket<etn::Ip<4>> client;
+	client.create();
+	client.set_timeout(2000);
+	if (etherz::core::is_error(client.connect(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port)))) return {};
+	std::string_view request = "GET / HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+	client.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(request.data()), request.size()));
+
+	std::string reply;
+	std::array<uint8_t, 1024> buf{};
+	while (true) {
+		int n = client.recv(buf);
+		if (n <= 0) break;
+		reply.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+	}
+	if (!reply.starts_with("HTTP/1.1 200")) return {};
+	auto body = reply.find("\r\n\r\n");
+	return body == std::string::npos ? std::string{} : reply.substr(body + 4);
+}
+
+} // namespace
+
+TEST_CASE(unix_channel_passes_descriptors) {
+	auto path = socket_path("channel");
+	etn::UnixListener listener;
+	CHECK_FALSE(etherz::core::is_error(listener.listen(path)));
+	auto client = etn::UnixChannel::connect(path);
+	CHECK_TRUE(client.has_value());
+	auto server = listener.accept();
+	CHECK_TRUE(server.has_value());
+
+	int pipe_fds[2];
+	CHECK_EQ(::pipe(pipe_fds), 0);
+	CHECK_FALSE(etherz::core::is_error(server->send_fds(std::span(&pipe_fds[1], 1), "pipe\n")));
+	::close(pipe_fds[1]);
+
+	std::string message;
+	auto fds = client->recv_fds(message);
+	CHECK_TRUE(fds.has_value() && fds->size() == 1u);
+	CHECK_EQ(message, std::string("pipe\n"));
+	// The received descriptor is the same pipe, under a new number
+	CHECK_EQ(::write(fds->front(), "x", 1), static_cast<ssize_t>(1));
+	char c = 0;
+	CHECK_EQ(::read(pipe_fds[0], &c, 1), static_cast<ssize_t>(1));
+	CHECK_EQ(c, 'x');
+	::close(fds->front());
+	::close(pipe_fds[0]);
+	listener.remove();
+	CHECK_TRUE(::access(path.c_str(), F_OK) != 0);
+}
+
+TEST_CASE(inherited_listeners_from_environment) {
+	etn::Socket<etn::Ip<4>> listener;
+	listener.create();
+	int saved = ::dup(etn::LISTEN_FDS_START); // Park whatever fd 3 is
+	::dup2(listener.native_handle(), etn::LISTEN_FDS_START);
+
+	::setenv("LISTEN_PID", "1", 1); // Someone else's
+	::setenv("LISTEN_FDS", "1", 1);
+	CHECK_TRUE(etn::inherited_listeners().empty());
+	CHECK_TRUE(std::getenv("LISTEN_FDS") == nullptr);
+
+	::setenv("LISTEN_PID", std::to_string(::getpid()).c_str(), 1);
+	::setenv("LISTEN_FDS", "1", 1);
+	auto fds = etn::inherited_listeners();
+	CHECK_EQ(fds.size(), static_cast<size_t>(1));
+	CHECK_TRUE(fds.size() == 1 && fds[0] == etn::LISTEN_FDS_START);
+	CHECK_TRUE((::fcntl(etn::LISTEN_FDS_START, F_GETFD) & FD_CLOEXEC) != 0);
+
+	if (saved >= 0) {
+		::dup2(saved, etn::LISTEN_FDS_START);
+		::close(saved);
+	} else {
+		::close(etn::LISTEN_FDS_START);
+	}
+}
+
+TEST_CASE(http_server_restart_under_load) {
+	constexpr uint16_t port = 18288;
+	auto path = socket_path("handoff");
+	int go[2];
+	CHECK_EQ(::pipe(go), 0);
+
+	// The successor: waits for the signal, takes the listener over, serves until the pipe closes
+	pid_t child = ::fork();
+	if (child == 0) {
+		::close(go[1]);
+		char c;
+		if (::read(go[0], &c, 1) != 1) ::_exit(2);
+		auto ticket = etn::HandoffTicket::request(path);
+		if (!ticket) ::_exit(3);
+		etp::HttpServer next;
+		next.get("/", [](const etp::HttpRequest&) { etp::HttpResponse r; r.body = "new"; return r; });
+		eta::EventLoop loop;
+		if (etherz::core::is_error(next.adopt(ticket->take().front()))) ::_exit(4);
+		next.attach(loop);
+		if (etherz::core::is_error(ticket->confirm())) ::_exit(5);
+		::fcntl(go[0], F_SETFL, O_NONBLOCK);
+		while (::read(go[0], &c, 1) != 0) loop.run_once(10);
+		::_exit(0);
+	}
+	CHECK_TRUE(child > 0);
+	::close(go[0]);
+
+	etp::HttpServer old;
+	old.get("/", [](const etp::HttpRequest&) { etp::HttpResponse r; r.body = "old"; return r; });
+	CHECK_FALSE(etherz::core::is_error(old.listen(etn::SocketAddress<etn::Ip<4>>(etn::Ip<4>(127, 0, 0, 1), port))));
+	CHECK_FALSE(etherz::core::is_error(old.enable_handoff(path)));
+	eta::EventLoop loop;
+	old.attach(loop);
+
+	std::atomic<bool> running{true};
+	std::atomic<int> served_old{0}, served_new{0}, failed{0};
+	std::thread load([&] {
+		while (running) {
+			auto body = fetch_once(port);
+			if (body == "old") ++served_old;
+			else if (body == "new") ++served_new;
+			else ++failed;
+		}
+	});
+
+	auto run_for = [&](std::chrono::milliseconds span, auto until) {
+		auto end = std::chrono::steady_clock::now() + span;
+		while (std::chrono::steady_clock::now() < end && !until()) loop.run_once(5);
+	};
+	run_for(200ms, [] { return false; });
+	CHECK_EQ(::write(go[1], "g", 1), static_cast<ssize_t>(1));
+	run_for(5000ms, [&] { return old.drained(); });
+	CHECK_TRUE(old.drained());
+	int old_at_handoff = served_old;
+	std::this_thread::sleep_for(300ms); // Only the successor is accepting now
+
+	running = false;
+	load.join();
+	::close(go[1]);
+	int status = -1;
+	::waitpid(child, &status, 0);
+
+	CHECK_EQ(failed.load(), 0);
+	CHECK_TRUE(old_at_handoff > 0);
+	CHECK_TRUE(served_old <= old_at_handoff + 1); // A reply in flight at the drain
+	CHECK_TRUE(served_new > 0);
+	CHECK_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	::unlink(path.c_str());
+}
+#endif
@@ -0,0 +1,224 @@
+#include "test_framework.hpp"
+#include "net/load_balancer.hpp"
+#include "protocol/http_client.hpp"
+#include "protocol/http_server.hpp"
+#include "async/event_loop.hpp"
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+
+namespace {
+
+using Address = etn::SocketAddress<etn::Ip<4>>;
+
+std::vector<Address> endpoints(int n) {
+	std::vector<Address> out;
+	for (int i = 0; i < n; ++i) out.emplace_back(etn::Ip<4>(10, 0, 0, static_cast<uint8_t>(i + 1)), 80);
+	return out;
+}
+
+/// Where each of keys maps to
+std::vector<Address> assignment(const etn::LoadBalancer& lb, int keys) {
+	std::vector<Address> out;
+	for (int k = 0; k < keys; ++k) out.push_back(*lb.for_key("user-" + std::to_string(k)));
+	return out;
+}
+
+} // namespace
+
+TEST_CASE(load_balancer_round_robin_visits_every_endpoint) {
+	etn::LoadBalancer empty;
+	CHECK_FALSE(empty.next().has_value());
+	CHECK_FALSE(static_cast<bool>(empty.acquire()));
+	CHECK_FALSE(empty.for_key("k").has_value());
+
+	// Order and duplicates in the input do not matter
+	auto set = endpoints(3);
+	etn::LoadBalancer lb({set[2], set[0], set[1], set[0]});
+	CHECK_EQ(lb.size(), size_t(3));
+	std::map<Address, int> seen;
+	for (int i = 0; i < 9; ++i) ++seen[*lb.next()];
+	CHECK_EQ(seen.size(), size_t(3));
+	for (const auto& [address, count] : seen) CHECK_EQ(count, 3);
+}
+
+TEST_CASE(load_balancer_two_choices_avoid_busy_endpoints) {
+	auto set = endpoints(2);
+	etn::LoadBalancer lb(set);
+	std::vector<etn::LoadBalancer::Lease> busy;
+	for (int i = 0; i < 5; ++i) busy.push_back(lb.pick(etn::BalancePolicy::Maglev, "sticky"));
+	auto hot = busy.front().address();
+	CHECK_EQ(lb.outstanding(hot), uint32_t(5));
+	// With two endpoints both are always sampled: the idle one wins until they even out
+	for (int i = 0; i < 5; ++i) {
+		auto lease = lb.acquire();
+		CHECK_TRUE(lease.address() != hot);
+		busy.push_back(std::move(lease));
+	}
+	busy.clear();
+	for (const auto& a : set) CHECK_EQ(lb.outstanding(a), uint32_t(0));
+
+	// Many endpoints: leases stay spread out
+	etn::LoadBalancer wide(endpoints(16));
+	for (int i = 0; i < 160; ++i) busy.push_back(wide.acquire());
+	uint32_t most = 0;
+	for (const auto& a : endpoints(16)) most = std::max(most, wide.outstanding(a));
+	CHECK_TRUE(most <= 14);
+}
+
+TEST_CASE(load_balancer_acquires_another_endpoint) {
+	auto set = endpoints(3);
+	etn::LoadBalancer lb(set);
+	for (int i = 0; i < 50; ++i) {
+		auto lease = lb.acquire_other(set[1]);
+		CHECK_TRUE(static_cast<bool>(lease) && lease.address() != set[1]);
+	}
+	// Not in the set: any endpoint will do
+	CHECK_TRUE(static_cast<bool>(lb.acquire_other(Address(etn::Ip<4>(10, 9, 9, 9), 80))));
+
+	etn::LoadBalancer pair({set[0], set[1]});
+	auto other = pair.acquire_other(set[0]);
+	CHECK_TRUE(other.address() == set[1]);
+	CHECK_EQ(pair.outstanding(set[1]), uint32_t(1));
+	etn::LoadBalancer single({set[0]});
+	CHECK_FALSE(static_cast<bool>(single.acquire_other(set[0])));
+}
+
+TEST_CASE(load_balancer_maglev_is_even_and_stable) {
+	constexpr int keys = 20'000;
+	etn::LoadBalancer lb(endpoints(10));
+	CHECK_EQ(lb.table_size(), size_t(65'537));
+	auto before = assignment(lb, keys);
+	CHECK_TRUE(assignment(lb, keys) == before);
+	std::map<Address, int> load;
+	for (const auto& a : before) ++load[a];
+	CHECK_EQ(load.size(), size_t(10));
+	for (const auto& [address, count] : load) CHECK_TRUE(count > keys / 10 * 8 / 10 && count < keys / 10 * 12 / 10);
+
+	// Removing one endpoint moves its keys and hardly any others
+	auto fewer = endpoints(10);
+	auto removed = fewer[3];
+	fewer.erase(fewer.begin() + 3);
+	lb.set_endpoints(fewer);
+	auto after = assignment(lb, keys);
+	int moved = 0, collateral = 0;
+	for (int k = 0; k < keys; ++k) {
+		if (before[k] == after[k]) continue;
+		++moved;
+		if (before[k] != removed) ++collateral;
+	}
+	CHECK_TRUE(moved >= load[removed]);
+	CHECK_TRUE(collateral < keys / 50);
+
+	// Adding one takes about 1/11 of the keys
+	auto more = endpoints(11);
+	lb.set_endpoints(more);
+	auto grown = assignment(lb, keys);
+	moved = 0;
+	for (int k = 0; k < keys; ++k) moved += before[k] != grown[k];
+	CHECK_TRUE(moved < keys / 11 + keys / 50);
+}
+
+TEST_CASE(load_balancer_updates_while_picking) {
+	etn::LoadBalancer lb(endpoints(4));
+	auto kept = endpoints(4)[0];
+	auto lease = lb.pick(etn::BalancePolicy::Maglev, "k");
+	while (lease.address() != kept) lease = lb.acquire();
+	std::atomic<bool> stop{false};
+	std::atomic<int> bad{0};
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 4; ++t) {
+		readers.emplace_back([&, t] {
+			int i = 0;
+			while (!stop.load()) {
+				auto key = std::to_string(t * 1'000'000 + i++);
+				auto a = lb.for_key(key);
+				auto b = lb.next();
+				auto c = lb.acquire();
+				if (!a || !b || !c) ++bad;
+			}
+		});
+	}
+	for (int round = 0; round < 50; ++round) lb.set_endpoints(endpoints(round % 2 ? 4 : 6));
+	stop = true;
+	for (auto& r : readers) r.join();
+	CHECK_EQ(bad.load(), 0);
+	// Counts belong to the endpoint and survive set changes
+	CHECK_EQ(lb.outstanding(kept), uint32_t(1));
+	lease.release();
+	CHECK_EQ(lb.outstanding(kept), uint32_t(0));
+}
+
+TEST_CASE(http_client_spreads_requests_over_resolved_addresses) {
+	constexpr uint16_t port = 18325;
+	eta::EventLoop loop;
+	etp::HttpServer servers[3];
+	std::atomic<int> hits[3] = {0, 0, 0};
+	for (int i = 0; i < 3; ++i) {
+		servers[i].get("/item", [&hits, i](const etp::HttpRequest&) {
+			++hits[i];
+			etp::HttpResponse resp;
+			resp.body = std::to_string(i);
+			return resp;
+		});
+		auto ip = etn::Ip<4>(127, 0, 0, static_cast<uint8_t>(i + 1));
+		CHECK_FALSE(etherz::core::is_error(servers[i].listen(Address(ip, port))));
+		servers[i].attach(loop);
+	}
+	std::atomic<bool> running{true};
+	std::thread server_thread([&] {
+		while (running.load()) loop.run_once(10);
+	});
+	auto dns = std::make_shared<etn::DnsCache>(etn::DnsCacheOptions{}, [](std::string_view) {
+		etn::DnsResult result;
+		result.ipv4_addresses = {etn::Ip<4>(127, 0, 0, 1), etn::Ip<4>(127, 0, 0, 2), etn::Ip<4>(127, 0, 0, 3)};
+		result.success = true;
+		return result;
+	});
+	auto url = etp::Url::parse("http://replicas.test:18325/item");
+
+	// Round-robin by default
+	etp::HttpClient client;
+	client.set_dns_cache(dns);
+	for (int i = 0; i < 30; ++i) CHECK_TRUE(client.get(url).has_value());
+	for (auto& h : hits) CHECK_EQ(h.load(), 10);
+	CHECK_TRUE(client.load_balancer(url) != nullptr);
+	CHECK_EQ(client.load_balancer(url)->size(), size_t(3));
+
+	// Maglev on a header: one user, one replica
+	etp::LoadBalancingOptions maglev;
+	maglev.policy = etn::BalancePolicy::Maglev;
+	maglev.key_header = "X-User";
+	client.set_load_balancing(maglev);
+	auto req = etp::HttpRequest{};
+	req.path = "/item";
+	req.headers.set("Host", url.host);
+	req.headers.set("X-User", "alice");
+	std::string first;
+	bool sticky = true;
+	for (int i = 0; i < 10; ++i) {
+		auto res = client.send_request(url, req);
+		if (!res) { sticky = false; continue; }
+		if (first.empty()) first = res->body;
+		sticky = sticky && res->body == first;
+	}
+	CHECK_TRUE(sticky);
+
+	// Off: everything to the first address
+	etp::LoadBalancingOptions off;
+	off.enabled = false;
+	client.set_load_balancing(off);
+	int before = hits[0].load();
+	for (int i = 0; i < 5; ++i) CHECK_TRUE(client.get(url).has_value());
+	CHECK_EQ(hits[0].load(), before + 5);
+
+	running = false;
+	server_thread.join();
+	for (auto& s : servers) s.stop();
+}
@@ -0,0 +1,102 @@
+#include "test_framework.hpp"
+#include "protocol/multipart.hpp"
+#include <vector>
+
+namespace etp = etherz::protocol;
+using namespace std::string_view_literals;
+
+namespace {
+
+struct Collected {
+	std::vector<etp::MultipartPart> parts;
+	std::vector<std::string> bodies;
+	size_t slices = 0;
+};
+
+/**
+ * @brief Parse body fed in pieces of `step` bytes
+ */
+bool parse_in_steps(std::string_view body, size_t step, Collected& out, etp::MultipartLimits limits = {}) {
+	etp::MultipartParser parser("XyZ-42", {
+		.on_part_begin = [&](const etp::MultipartPart& part) { out.parts.push_back(part); out.bodies.emplace_back(); },
+		.on_data = [&](std::string_view data) { out.bodies.back().append(data); ++out.slices; },
+		.on_part_end = {},
+	}, limits);
+	for (size_t i = 0; i < body.size(); i += step) {
+		if (!parser.feed(body.substr(i, step))) return false;
+	}
+	return parser.done();
+}
+
+constexpr std::string_view FORM =
+	"preamble is ignored\r\n"
+	"--XyZ-42\r\n"
+	"Content-Disposition: form-data; name=\"title\"\r\n"
+	"\r\n"
+	"Hello\r\n--XyZ-4 not quite\r\n"
+	"--XyZ-42  \r\n"
+	"Content-Disposition: form-data; name=\"upload\"; filename=\"a \\\"b\\\".bin\"\r\n"
+	"Content-Type: application/octet-stream\r\n"
+	"\r\n"
+	"\r\n\r\n--\x00\xff binary\r\n"
+	"--XyZ-42--\r\n"
+	"epilogue"sv;
+
+} // namespace
+
+TEST_CASE(multipart_boundary_from_content_type) {
+	CHECK_EQ(etp::multipart_boundary("multipart/form-data; boundary=abc").value_or(""), std::string("abc"));
+	CHECK_EQ(etp::multipart_boundary("Multipart/Form-Data;charset=utf-8; BOUNDARY=\"a b\"").value_or(""), std::string("a b"));
+	CHECK_FALSE(etp::multipart_boundary("text/plain; boundary=abc").has_value());
+	CHECK_FALSE(etp::multipart_boundary("multipart/form-data").has_value());
+}
+
+TEST_CASE(multipart_parts_any_chunking) {
+	for (size_t step : {FORM.size(), size_t{1}, size_t{3}, size_t{7}, size_t{11}}) {
+		Collected c;
+		CHECK_TRUE(parse_in_steps(FORM, step, c));
+		CHECK_EQ(c.parts.size(), static_cast<size_t>(2));
+		if (c.parts.size() != 2) continue;
+		CHECK_EQ(c.parts[0].name, std::string("title"));
+		CHECK_FALSE(c.parts[0].is_file());
+		CHECK_EQ(c.parts[0].content_type, std::string("text/plain"));
+		CHECK_EQ(c.bodies[0], std::string("Hello\r\n--XyZ-4 not quite"));
+		CHECK_EQ(c.parts[1].name, std::string("upload"));
+		CHECK_EQ(c.parts[1].filename, std::string("a \"b\".bin"));
+		CHECK_EQ(c.parts[1].content_type, std::string("application/octet-stream"));
+		CHECK_EQ(c.bodies[1], std::string("\r\n\r\n--\x00\xff binary"sv));
+	}
+}
+
+TEST_CASE(multipart_streams_large_part_in_window) {
+	std::string body = "--XyZ-42\r\nContent-Disposition: form-data; name=\"f\"; filename=\"big\"\r\n\r\n";
+	std::string payload(1 << 20, 'x');
+	for (size_t i = 0; i < payload.size(); i += 997) payload[i] = '\r';
+	body += payload;
+	body += "\r\n--XyZ-42--\r\n";
+
+	Collected c;
+	etp::MultipartParser parser("XyZ-42", {
+		.on_part_begin = [&](const etp::MultipartPart& part) { c.parts.push_back(part); c.bodies.emplace_back(); },
+		.on_data = [&](std::string_view data) { c.bodies.back().append(data); },
+		.on_part_end = {},
+	});
+	size_t max_buffered = 0;
+	for (size_t i = 0; i < body.size(); i += 4096) {
+		CHECK_TRUE(parser.feed(std::string_view(body).substr(i, 4096)));
+		max_buffered = std::max(max_buffered, parser.buffered());
+	}
+	CHECK_TRUE(parser.done());
+	CHECK_TRUE(c.bodies.size() == 1 && c.bodies[0] == payload);
+	CHECK_TRUE(max_buffered < 64);
+}
+
+TEST_CASE(multipart_rejects_malformed) {
+	Collected c;
+	CHECK_FALSE(parse_in_steps("--XyZ-42\r\nno colon here\r\n\r\ndata\r\n--XyZ-42--", 5, c));
+	Collected big;
+	std::string huge = "--XyZ-42\r\nX-Pad: " + std::string(200, 'p') + "\r\n\r\nv\r\n--XyZ-42--";
+	CHECK_FALSE(parse_in_steps(huge, 16, big, {.max_header_bytes = 64, .max_parts = 8}));
+	Collected garbage;
+	CHECK_FALSE(parse_in_steps("--XyZ-42junk\r\n\r\n", 4, garbage));
+}
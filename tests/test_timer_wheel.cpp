@@ -0,0 +1,58 @@
+#include "test_framework.hpp"
+#include "async/timer_wheel.hpp"
+
+namespace eta = etherz::async;
+using namespace std::chrono_literals;
+
+TEST_CASE(timer_wheel_fires_in_order_of_ticks) {
+	eta::TimerWheel wheel(10ms, 8);
+	auto start = eta::TimerWheel::Clock::now();
+	std::string fired;
+	eta::Timer a([&] { fired += 'a'; });
+	eta::Timer b([&] { fired += 'b'; });
+	eta::Timer c([&] { fired += 'c'; });
+	wheel.schedule(a, 30ms);
+	wheel.schedule(b, 10ms);
+	wheel.schedule(c, 200ms); // More than one revolution of 8 x 10ms
+	CHECK_EQ(wheel.size(), static_cast<size_t>(3));
+
+	wheel.advance(start + 15ms);
+	CHECK_EQ(fired, std::string("b"));
+	wheel.advance(start + 45ms);
+	CHECK_EQ(fired, std::string("ba"));
+	wheel.advance(start + 105ms); // c's slot comes round but its expiry has not
+	CHECK_EQ(fired, std::string("ba"));
+	CHECK_TRUE(c.armed());
+	wheel.advance(start + 215ms);
+	CHECK_EQ(fired, std::string("bac"));
+	CHECK_TRUE(wheel.empty());
+}
+
+TEST_CASE(timer_wheel_cancel_and_reschedule) {
+	eta::TimerWheel wheel(10ms, 16);
+	auto start = eta::TimerWheel::Clock::now();
+	int fired = 0;
+	eta::Timer t([&] { ++fired; });
+	wheel.schedule(t, 20ms);
+	wheel.schedule(t, 50ms); // Re-arming moves it
+	CHECK_EQ(wheel.size(), static_cast<size_t>(1));
+	wheel.advance(start + 35ms);
+	CHECK_EQ(fired, 0);
+	wheel.cancel(t);
+	CHECK_FALSE(t.armed());
+	wheel.advance(start + 100ms);
+	CHECK_EQ(fired, 0);
+
+	{
+		eta::Timer scoped([&] { ++fired; });
+		wheel.schedule(scoped, 10ms);
+	} // Destroying an armed timer cancels it
+	CHECK_TRUE(wheel.empty());
+
+	// A callback may re-arm its own timer
+	eta::Timer periodic;
+	periodic.callback = [&] { if (++fired < 3) wheel.schedule(periodic, 10ms); };
+	wheel.schedule(periodic, 10ms);
+	for (int i = 1; i <= 5; ++i) wheel.advance(start + 100ms + i * 10ms + 5ms);
+	CHECK_EQ(fired, 3);
+}
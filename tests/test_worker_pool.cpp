@@ -0,0 +1,84 @@
+#include "test_framework.hpp"
+#include "async/worker_pool.hpp"
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace eta = etherz::async;
+using namespace std::chrono_literals;
+
+TEST_CASE(spsc_queue_bounded_fifo) {
+	eta::SpscQueue<int> q(3);
+	CHECK_EQ(q.capacity(), static_cast<size_t>(4));
+	for (int i = 0; i < 4; ++i) CHECK_TRUE(q.push(i));
+	int extra = 9;
+	CHECK_FALSE(q.push(extra));
+	CHECK_EQ(extra, 9);
+	int v = -1;
+	for (int i = 0; i < 4; ++i) {
+		CHECK_TRUE(q.pop(v));
+		CHECK_EQ(v, i);
+	}
+	CHECK_FALSE(q.pop(v));
+	CHECK_TRUE(q.empty());
+}
+
+TEST_CASE(worker_pool_pins_keys_in_order) {
+	std::mutex mutex;
+	std::vector<std::pair<int, std::thread::id>> runs;
+	{
+		eta::WorkerPool pool(4);
+		for (int i = 0; i < 50; ++i) {
+			eta::WorkerPool::Task task = [&, i] {
+				std::lock_guard lock(mutex);
+				runs.emplace_back(i, std::this_thread::get_id());
+			};
+			CHECK_TRUE(pool.submit(7, task));
+		}
+		for (int i = 0; i < 200; ++i) {
+			std::this_thread::sleep_for(5ms);
+			std::lock_guard lock(mutex);
+			if (runs.size() == 50) break;
+		}
+	}
+	CHECK_EQ(runs.size(), static_cast<size_t>(50));
+	bool ordered = true, one_thread = true;
+	for (size_t i = 0; i < runs.size(); ++i) {
+		ordered = ordered && runs[i].first == static_cast<int>(i);
+		one_thread = one_thread && runs[i].second == runs[0].second;
+	}
+	CHECK_TRUE(ordered);
+	CHECK_TRUE(one_thread);
+	CHECK_TRUE(runs[0].second != std::this_thread::get_id());
+}
+
+TEST_CASE(worker_pool_runs_keys_in_parallel) {
+	std::atomic<int> done{0};
+	auto start = std::chrono::steady_clock::now();
+	{
+		eta::WorkerPool pool(4);
+		for (uint64_t key = 0; key < 4; ++key) {
+			eta::WorkerPool::Task task = [&] { std::this_thread::sleep_for(50ms); ++done; };
+			CHECK_TRUE(pool.submit(key, task));
+		}
+		while (done.load() < 4 && std::chrono::steady_clock::now() - start < 2s) std::this_thread::sleep_for(1ms);
+	}
+	CHECK_EQ(done.load(), 4);
+	CHECK_TRUE(std::chrono::steady_clock::now() - start < 150ms);
+}
+
+TEST_CASE(worker_pool_full_queue_rejects) {
+	std::atomic<bool> release{false};
+	eta::WorkerPool pool(1, 2);
+	eta::WorkerPool::Task block = [&] { while (!release.load()) std::this_thread::sleep_for(1ms); };
+	CHECK_TRUE(pool.submit(0, block));
+	std::this_thread::sleep_for(20ms); // Let the worker take it off the queue
+	int accepted = 0;
+	for (int i = 0; i < 4; ++i) {
+		eta::WorkerPool::Task task = [] {};
+		if (pool.submit(0, task)) ++accepted;
+		else CHECK_TRUE(static_cast<bool>(task)); // Left with the caller
+	}
+	CHECK_EQ(accepted, 2);
+	release = true;
+}
@@ -0,0 +1,619 @@
+/**
+ * @file etherz_load.cpp
+ * @brief wrk-style HTTP/1.1 load generator on async::EventLoop
+ *
+ * Each thread runs its own EventLoop over a share of the connections and
+ * keeps its own latency histogram; the histograms are merged at the end.
+ *
+ * Closed loop (default): every connection keeps `pipeline` requests in
+ * flight and sends the next one as soon as a response completes, so the
+ * offered load adapts to the server. Latency is measured from the send.
+ *
+ * Fixed rate (-R): requests follow a per-connection schedule that adds up
+ * to the given rate, and latency is measured from when each request was
+ * due rather than when it could be sent. A stalled server therefore shows
+ * up in the latency of every request that should have been sent during
+ * the stall (coordinated-omission correction, as in wrk2).
+ *
+ * Only loopback targets are accepted. --serve starts an in-process
+ * HttpServer on the target port, so the whole stack can be measured from
+ * one binary.
+ *
+ * Usage: etherz_load [options] <http://127.0.0.1:port/path>
+ */
+
+#include "protocol/http_server.hpp"
+#include "protocol/http_metrics.hpp"
+#include "protocol/url.hpp"
+#include "async/event_loop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+#include <print>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+namespace etp = etherz::protocol;
+namespace etn = etherz::net;
+namespace eta = etherz::async;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+	std::string url;
+	size_t connections = 64;
+	size_t threads = 1;
+	double seconds = 10.0;
+	double rate = 0;        ///< Requests/s over all connections; 0 = closed loop
+	size_t pipeline = 1;    ///< Requests in flight per connection
+	double timeout = 2.0;   ///< Seconds before an unanswered request counts as a timeout
+	std::string method = "GET";
+	std::vector<std::string> headers;
+	std::string body;
+	bool json = false;
+	bool serve = false;
+	size_t serve_body = 64; ///< Response body bytes of the --serve target
+	size_t serve_workers = 0;
+};
+
+struct Stats {
+	etp::LatencyHistogram latency;
+	uint64_t requests = 0;
+	uint64_t bytes_read = 0;
+	uint64_t non_2xx = 0;
+	uint64_t connect_errors = 0;
+	uint64_t read_errors = 0;
+	uint64_t write_errors = 0;
+	uint64_t timeouts = 0;
+	uint64_t max_ns = 0;
+};
+
+/**
+ * @brief One keep-alive connection and the framing state of the response being read
+ */
+struct Connection {
+	struct Pending {
+		Clock::time_point start; ///< Due time (fixed rate) or send time (closed loop)
+		Clock::time_point sent;
+	};
+
+	etn::Socket<etn::Ip<4>> socket;
+	std::string in;
+	std::string out;              ///< Request bytes the socket has not taken yet
+	std::deque<Pending> pending;
+	Clock::time_point next_due;   ///< Fixed rate: when the next request is due
+
+	// Response framing
+	bool in_body = false;
+	bool chunked = false;
+	bool until_close = false;
+	bool close_after = false;
+	int status = 0;
+	uint64_t body_left = 0;
+	etp::http_parser::ChunkedDecoder decoder;
+};
+
+// ═══════════════════════════════════════════════
+//  Load Thread
+// ═══════════════════════════════════════════════
+
+/**
+ * @brief Drives a share of the connections on its own EventLoop
+ */
+class LoadThread {
+public:
+	LoadThread(const Options& opt, etn::SocketAddress<etn::Ip<4>> addr, std::string_view request,
+		size_t connections, double rate, size_t first_index, size_t total_connections)
+		: opt_(opt), addr_(addr), request_(request), rate_(rate)
+		, first_index_(first_index), total_connections_(total_connections) {
+		conns_.reserve(connections);
+		for (size_t i = 0; i < connections; ++i) conns_.push_back(std::make_unique<Connection>());
+	}
+
+	/**
+	 * @brief Run until end, then wait up to the request timeout for stragglers
+	 */
+	void run(Clock::time_point start, Clock::time_point end) {
+		// Every connection carries an equal share of the rate
+		if (rate_ > 0) {
+			interval_ = std::chrono::duration_cast<Clock::duration>(
+				std::chrono::duration<double>(static_cast<double>(conns_.size()) / rate_));
+		}
+		for (size_t i = 0; i < conns_.size(); ++i) {
+			auto& c = *conns_[i];
+			// Stagger the schedules so connections do not fire in lockstep
+			c.next_due = start + std::chrono::duration_cast<Clock::duration>(
+				interval_ * (static_cast<double>(first_index_ + i) / static_cast<double>(total_connections_)));
+			if (!connect(c)) continue;
+			if (rate_ <= 0) {
+				for (size_t p = 0; p < opt_.pipeline; ++p) send_request(c, Clock::now());
+			}
+		}
+
+		auto next_timeout_check = start;
+		while (true) {
+			auto now = Clock::now();
+			if (now >= end) break;
+			int wait_ms = 10;
+			if (rate_ > 0) {
+				auto next = send_due(now);
+				auto until = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+				wait_ms = static_cast<int>(std::clamp<int64_t>(until, 0, 10));
+			}
+			loop_.run_once(wait_ms);
+			if (now >= next_timeout_check) {
+				expire(now);
+				next_timeout_check = now + std::chrono::milliseconds(100);
+			}
+		}
+
+		sending_ = false;
+		auto give_up = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt_.timeout));
+		auto outstanding = [&] {
+			return std::any_of(conns_.begin(), conns_.end(), [](const auto& c) { return !c->pending.empty(); });
+		};
+		while (outstanding() && Clock::now() < give_up) loop_.run_once(10);
+		for (auto& c : conns_) {
+			stats_.timeouts += c->pending.size();
+			close(*c);
+		}
+	}
+
+	const Stats& stats() const noexcept { return stats_; }
+
+private:
+	const Options& opt_;
+	etn::SocketAddress<etn::Ip<4>> addr_;
+	std::string_view request_;
+	double rate_;
+	size_t first_index_;
+	size_t total_connections_;
+	Clock::duration interval_{};
+	eta::EventLoop loop_;
+	std::vector<std::unique_ptr<Connection>> conns_;
+	Stats stats_;
+	bool sending_ = true;
+
+	bool connect(Connection& c) {
+		c.socket = {};
+		c.in.clear();
+		c.out.clear();
+		c.pending.clear();
+		c.in_body = false;
+		c.socket.create();
+		if (etherz::core::is_error(c.socket.connect(addr_))) {
+			++stats_.connect_errors;
+			c.socket.close();
+			return false;
+		}
+		c.socket.set_nonblocking(true);
+		loop_.add(c.socket.native_handle(), eta::PollEvent::ReadReady,
+			[this, conn = &c](etn::impl::socket_t, eta::PollEvent ev) { on_event(*conn, ev); });
+		return true;
+	}
+
+	void close(Connection& c) {
+		if (c.socket.native_handle() != etn::impl::invalid_socket) loop_.remove(c.socket.native_handle());
+		c.socket.close();
+	}
+
+	/// Reconnect after the server closed; requests still in flight are lost
+	void reset(Connection& c, uint64_t& error_counter) {
+		error_counter += c.pending.size();
+		close(c);
+		if (!sending_ || !connect(c)) return;
+		if (rate_ <= 0) {
+			for (size_t p = 0; p < opt_.pipeline; ++p) send_request(c, Clock::now());
+		}
+	}
+
+	void send_request(Connection& c, Clock::time_point start) {
+		c.pending.push_back({start, Clock::now()});
+		bool idle = c.out.empty();
+		c.out.append(request_);
+		if (idle) flush(c);
+	}
+
+	/// Fixed rate: send what is due; returns the earliest upcoming due time
+	Clock::time_point send_due(Clock::time_point now) {
+		auto next = now + std::chrono::milliseconds(10);
+		for (auto& cp : conns_) {
+			auto& c = *cp;
+			if (c.socket.native_handle() == etn::impl::invalid_socket) {
+				if (!connect(c)) continue;
+			}
+			while (c.next_due <= now && c.pending.size() < opt_.pipeline) {
+				send_request(c, c.next_due);
+				c.next_due += interval_;
+			}
+			if (c.pending.size() < opt_.pipeline) next = std::min(next, c.next_due);
+		}
+		return next;
+	}
+
+	void flush(Connection& c) {
+		while (!c.out.empty()) {
+			int n = c.socket.send(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(c.out.data()), c.out.size()));
+			if (n < 0 && etherz::core::last_platform_error() == etherz::core::Error::WouldBlock) {
+				loop_.add(c.socket.native_handle(), eta::PollEvent::ReadReady | eta::PollEvent::WriteReady,
+					[this, conn = &c](etn::impl::socket_t, eta::PollEvent ev) { on_event(*conn, ev); });
+				return;
+			}
+			if (n <= 0) {
+				reset(c, stats_.write_errors);
+				return;
+			}
+			c.out.erase(0, static_cast<size_t>(n));
+		}
+	}
+
+	void on_event(Connection& c, eta::PollEvent ev) {
+		if ((ev & eta::PollEvent::WriteReady) != eta::PollEvent::None) {
+			loop_.add(c.socket.native_handle(), eta::PollEvent::ReadReady,
+				[this, conn = &c](etn::impl::socket_t, eta::PollEvent e) { on_event(*conn, e); });
+			flush(c);
+			if (c.socket.native_handle() == etn::impl::invalid_socket) return;
+		}
+		std::array<uint8_t, 16384> buf{};
+		while (true) {
+			int n = c.socket.recv(buf);
+			if (n > 0) {
+				stats_.bytes_read += static_cast<uint64_t>(n);
+				c.in.append(reinterpret_cast<const char*>(buf.data()), static_cast<size_t>(n));
+				continue;
+			}
+			if (n < 0 && etherz::core::last_platform_error() == etherz::core::Error::WouldBlock) break;
+			// Peer closed: that ends a body framed by the connection itself
+			if (!parse(c)) return;
+			if (c.in_body && c.until_close) complete(c);
+			else reset(c, stats_.read_errors);
+			return;
+		}
+		parse(c);
+	}
+
+	/**
+	 * @brief Complete every whole response in the input buffer
+	 * @return false if the connection was reset on the way (its buffers now belong to a new socket)
+	 */
+	bool parse(Connection& c) {
+		size_t pos = 0;
+		while (true) {
+			if (!c.in_body) {
+				auto head_end = c.in.find("\r\n\r\n", pos);
+				if (head_end == std::string::npos) break;
+				if (!parse_head(c, std::string_view(c.in).substr(pos, head_end - pos))) {
+					reset(c, stats_.read_errors);
+					return false;
+				}
+				pos = head_end + 4;
+			}
+			if (c.chunked) {
+				std::string_view data;
+				do {
+					pos += c.decoder.decode(std::string_view(c.in).substr(pos), data);
+				} while (!data.empty());
+				if (c.decoder.failed()) {
+					reset(c, stats_.read_errors);
+					return false;
+				}
+				if (!c.decoder.done()) break;
+			} else if (c.until_close) {
+				pos = c.in.size();
+				break;
+			} else {
+				auto n = std::min<uint64_t>(c.body_left, c.in.size() - pos);
+				pos += static_cast<size_t>(n);
+				c.body_left -= n;
+				if (c.body_left > 0) break;
+			}
+			if (!complete(c)) return false;
+		}
+		c.in.erase(0, pos);
+		return true;
+	}
+
+	bool parse_head(Connection& c, std::string_view head) {
+		if (head.size() < 12 || !head.starts_with("HTTP/1.")) return false;
+		c.status = std::atoi(std::string(head.substr(9, 3)).c_str());
+		c.in_body = true;
+		c.chunked = false;
+		c.until_close = false;
+		c.close_after = head[7] == '0';
+		c.body_left = 0;
+		bool has_length = false;
+		size_t line = head.find("\r\n");
+		while (line != std::string_view::npos) {
+			line += 2;
+			auto eol = head.find("\r\n", line);
+			auto field = head.substr(line, eol == std::string_view::npos ? std::string_view::npos : eol - line);
+			auto colon = field.find(':');
+			if (colon != std::string_view::npos) {
+				auto name = field.substr(0, colon);
+				auto value = etp::detail::trim(field.substr(colon + 1));
+				if (etp::detail::iequals(name, "Content-Length")) {
+					c.body_left = static_cast<uint64_t>(std::strtoull(std::string(value).c_str(), nullptr, 10));
+					has_length = true;
+				} else if (etp::detail::iequals(name, "Transfer-Encoding")) {
+					c.chunked = etp::detail::icontains(value, "chunked");
+				} else if (etp::detail::iequals(name, "Connection")) {
+					if (etp::detail::icontains(value, "close")) c.close_after = true;
+					else if (etp::detail::icontains(value, "keep-alive")) c.close_after = false;
+				}
+			}
+			line = eol;
+		}
+		bool bodiless = opt_.method == "HEAD" || c.status / 100 == 1 || c.status == 204 || c.status == 304;
+		if (bodiless) {
+			c.chunked = false;
+			c.body_left = 0;
+		} else if (c.chunked) {
+			c.decoder = {};
+		} else if (!has_length) {
+			c.until_close = true;
+		}
+		return true;
+	}
+
+	/// Record the response just read; false if that reset the connection
+	bool complete(Connection& c) {
+		c.in_body = false;
+		if (c.pending.empty()) {
+			// A response nobody asked for
+			reset(c, stats_.read_errors);
+			return false;
+		}
+		auto now = Clock::now();
+		auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - c.pending.front().start).count());
+		c.pending.pop_front();
+		stats_.latency.record(ns, true);
+		stats_.max_ns = std::max(stats_.max_ns, ns);
+		++stats_.requests;
+		if (c.status < 200 || c.status >= 300) ++stats_.non_2xx;
+		if (c.close_after || c.until_close) {
+			reset(c, stats_.read_errors);
+			return false;
+		}
+		if (rate_ <= 0 && sending_) send_request(c, Clock::now());
+		return c.socket.native_handle() != etn::impl::invalid_socket;
+	}
+
+	/// Drop connections whose oldest request has waited past the timeout
+	void expire(Clock::time_point now) {
+		auto limit = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt_.timeout));
+		for (auto& c : conns_) {
+			if (!c->pending.empty() && now - c->pending.front().sent > limit) reset(*c, stats_.timeouts);
+		}
+	}
+};
+
+// ═══════════════════════════════════════════════
+//  Command Line
+// ═══════════════════════════════════════════════
+
+static void usage() {
+	std::print(
+		"Usage: etherz_load [options] <url>\n"
+		"  -c, --connections N   Open connections (default 64)\n"
+		"  -t, --threads N       Threads, each with its own event loop (default 1)\n"
+		"  -d, --duration S      Seconds to run (default 10)\n"
+		"  -R, --rate N          Fixed total rate in req/s with coordinated-omission\n"
+		"                        correction; omit for closed loop\n"
+		"  -p, --pipeline N      Requests in flight per connection (default 1)\n"
+		"  -m, --method M        Request method (default GET)\n"
+		"  -H, --header 'K: V'   Extra request header (repeatable)\n"
+		"  -b, --body TEXT       Request body\n"
+		"      --timeout S       Seconds before a request counts as timed out (default 2)\n"
+		"      --json            Print the report as JSON\n"
+		"      --serve           Serve the URL from an in-process HttpServer\n"
+		"      --serve-body N    Response body bytes of --serve (default 64)\n"
+		"      --serve-workers N Worker threads of --serve (default 0: on the loop)\n"
+		"The target must be a loopback address.\n");
+}
+
+static bool parse_args(int argc, char* argv[], Options& opt) {
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+		auto number = [&](auto& out) {
+			auto v = value();
+			if (!v) return false;
+			out = static_cast<std::remove_reference_t<decltype(out)>>(std::atof(v));
+			return true;
+		};
+		bool ok = true;
+		if (arg == "-c" || arg == "--connections") ok = number(opt.connections);
+		else if (arg == "-t" || arg == "--threads") ok = number(opt.threads);
+		else if (arg == "-d" || arg == "--duration") ok = number(opt.seconds);
+		else if (arg == "-R" || arg == "--rate") ok = number(opt.rate);
+		else if (arg == "-p" || arg == "--pipeline") ok = number(opt.pipeline);
+		else if (arg == "--timeout") ok = number(opt.timeout);
+		else if (arg == "--serve-body") ok = number(opt.serve_body);
+		else if (arg == "--serve-workers") ok = number(opt.serve_workers);
+		else if (arg == "-m" || arg == "--method") { auto v = value(); ok = v; if (v) opt.method = v; }
+		else if (arg == "-H" || arg == "--header") { auto v = value(); ok = v; if (v) opt.headers.emplace_back(v); }
+		else if (arg == "-b" || arg == "--body") { auto v = value(); ok = v; if (v) opt.body = v; }
+		else if (arg == "--json") opt.json = true;
+		else if (arg == "--serve") opt.serve = true;
+		else if (arg == "-h" || arg == "--help") return false;
+		else if (!arg.starts_with('-') && opt.url.empty()) opt.url = arg;
+		else ok = false;
+		if (!ok) {
+			std::print(stderr, "etherz_load: bad argument '{}'\n", arg);
+			return false;
+		}
+	}
+	if (opt.url.empty()) return false;
+	opt.connections = std::max<size_t>(opt.connections, 1);
+	opt.threads = std::clamp<size_t>(opt.threads, 1, opt.connections);
+	opt.pipeline = std::max<size_t>(opt.pipeline, 1);
+	return true;
+}
+
+static std::string build_request(const Options& opt, const etp::Url& url) {
+	std::string path = url.path.empty() ? "/" : url.path;
+	if (!url.query.empty()) path += "?" + url.query;
+	std::string req = std::format("{} {} HTTP/1.1\r\nHost: {}:{}\r\n", opt.method, path, url.host, url.port);
+	for (const auto& h : opt.headers) req += h + "\r\n";
+	if (!opt.body.empty()) req += std::format("Content-Length: {}\r\n", opt.body.size());
+	req += "\r\n";
+	req += opt.body;
+	return req;
+}
+
+// ═══════════════════════════════════════════════
+//  Report
+// ═══════════════════════════════════════════════
+
+static constexpr std::array<double, 6> QUANTILES = {0.50, 0.75, 0.90, 0.99, 0.999, 0.9999};
+
+static double us(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+/// Histogram buckets report their upper bound; never past the exact maximum
+static uint64_t quantile(const Stats& s, const etp::LatencyHistogram::Snapshot& h, double q) {
+	return std::min(h.percentile(q), s.max_ns);
+}
+
+static void report_text(const Options& opt, const Stats& s, const etp::LatencyHistogram::Snapshot& h, double elapsed) {
+	std::print("{} connections, {} thread(s), {}, pipeline {}\n\n", opt.connections, opt.threads,
+		opt.rate > 0 ? std::format("fixed rate {:.0f} req/s", opt.rate) : std::string("closed loop"), opt.pipeline);
+	std::print("  Requests     {:>12}   {:>10.1f} req/s\n", s.requests, static_cast<double>(s.requests) / elapsed);
+	std::print("  Transfer     {:>12.2f} MiB {:>8.2f} MiB/s\n",
+		static_cast<double>(s.bytes_read) / (1024.0 * 1024.0), static_cast<double>(s.bytes_read) / (1024.0 * 1024.0) / elapsed);
+	std::print("  Errors       connect {}, read {}, write {}, timeout {}, non-2xx {}\n\n",
+		s.connect_errors, s.read_errors, s.write_errors, s.timeouts, s.non_2xx);
+	std::print("  Latency{}\n", opt.rate > 0 ? " (from scheduled send)" : "");
+	std::print("  {:>10} {:>12.1f} us\n", "mean", h.count ? us(h.sum_ns) / static_cast<double>(h.count) : 0.0);
+	for (double q : QUANTILES) std::print("  {:>9}% {:>12.1f} us\n", q * 100.0, us(quantile(s, h, q)));
+	std::print("  {:>10} {:>12.1f} us\n", "max", us(s.max_ns));
+}
+
+/// JSON string contents: quotes, backslashes and control characters escaped
+static std::string json_escape(std::string_view v) {
+	std::string out;
+	for (char c : v) {
+		if (c == '"' || c == '\\') out += '\\';
+		if (static_cast<unsigned char>(c) < 0x20) { out += std::format("\\u{:04x}", static_cast<unsigned>(c)); continue; }
+		out += c;
+	}
+	return out;
+}
+
+static void report_json(const Options& opt, const Stats& s, const etp::LatencyHistogram::Snapshot& h, double elapsed) {
+	std::string percentiles;
+	for (double q : QUANTILES) {
+		if (!percentiles.empty()) percentiles += ",";
+		percentiles += std::format("\"p{}\":{:.1f}", q * 100.0, us(quantile(s, h, q)));
+	}
+	std::print("{{\"url\":\"{}\",\"mode\":\"{}\",\"rate\":{:.1f},\"connections\":{},\"threads\":{},\"pipeline\":{},"
+		"\"duration_s\":{:.3f},\"requests\":{},\"requests_per_s\":{:.1f},\"bytes_read\":{},"
+		"\"errors\":{{\"connect\":{},\"read\":{},\"write\":{},\"timeout\":{},\"non_2xx\":{}}},"
+		"\"latency_us\":{{\"mean\":{:.1f},{},\"max\":{:.1f}}}}}\n",
+		json_escape(opt.url), opt.rate > 0 ? "rate" : "closed", opt.rate, opt.connections, opt.threads, opt.pipeline,
+		elapsed, s.requests, static_cast<double>(s.requests) / elapsed, s.bytes_read,
+		s.connect_errors, s.read_errors, s.write_errors, s.timeouts, s.non_2xx,
+		h.count ? us(h.sum_ns) / static_cast<double>(h.count) : 0.0, percentiles, us(s.max_ns));
+}
+
+// ═══════════════════════════════════════════════
+//  Main
+// ═══════════════════════════════════════════════
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	Options opt;
+	if (!parse_args(argc, argv, opt)) {
+		usage();
+		return 2;
+	}
+
+	auto url = etp::Url::parse(opt.url);
+	if (url.scheme != "http") {
+		std::print(stderr, "etherz_load: only http:// URLs are supported\n");
+		return 2;
+	}
+	etn::Ip<4> ip = url.host == "localhost" ? etn::Ip<4>(127, 0, 0, 1) : etn::Ip<4>(std::string_view(url.host));
+	if (ip.bytes()[0] != 127) {
+		std::print(stderr, "etherz_load: {} is not a loopback address\n", url.host);
+		return 2;
+	}
+	etn::SocketAddress<etn::Ip<4>> addr(ip, url.port);
+
+	// Optional in-process target
+	std::unique_ptr<etp::HttpServer> server;
+	eta::EventLoop server_loop;
+	std::atomic<bool> serving{true};
+	std::thread server_thread;
+	if (opt.serve) {
+		server = std::make_unique<etp::HttpServer>();
+		auto path = url.path.empty() ? std::string("/") : url.path;
+		server->route(etp::method_from_string(opt.method), path,
+			[body = std::string(opt.serve_body, 'x')](const etp::HttpRequest&) {
+				etp::HttpResponse resp;
+				resp.body = body;
+				return resp;
+			});
+		if (opt.serve_workers > 0) server->enable_workers(opt.serve_workers);
+		if (etherz::core::is_error(server->listen(addr))) {
+			std::print(stderr, "etherz_load: cannot listen on port {}\n", url.port);
+			return 1;
+		}
+		server->attach(server_loop);
+		server_thread = std::thread([&] {
+			while (serving.load(std::memory_order_relaxed)) server_loop.run_once(50);
+		});
+	}
+
+	auto request = build_request(opt, url);
+	if (!opt.json) {
+		std::print("Running {:.1f}s test @ {}\n", opt.seconds, opt.url);
+	}
+
+	std::vector<std::unique_ptr<LoadThread>> loaders;
+	size_t assigned = 0;
+	for (size_t t = 0; t < opt.threads; ++t) {
+		size_t share = opt.connections / opt.threads + (t < opt.connections % opt.threads ? 1 : 0);
+		double rate = opt.rate * static_cast<double>(share) / static_cast<double>(opt.connections);
+		loaders.push_back(std::make_unique<LoadThread>(opt, addr, request, share, rate, assigned, opt.connections));
+		assigned += share;
+	}
+
+	auto start = Clock::now();
+	auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.seconds));
+	std::vector<std::thread> threads;
+	for (auto& l : loaders) threads.emplace_back([&, loader = l.get()] { loader->run(start, end); });
+	for (auto& th : threads) th.join();
+	double elapsed = opt.seconds;
+
+	Stats total;
+	etp::LatencyHistogram::Snapshot histogram;
+	for (const auto& l : loaders) {
+		const auto& s = l->stats();
+		s.latency.snapshot_into(histogram);
+		total.requests += s.requests;
+		total.bytes_read += s.bytes_read;
+		total.non_2xx += s.non_2xx;
+		total.connect_errors += s.connect_errors;
+		total.read_errors += s.read_errors;
+		total.write_errors += s.write_errors;
+		total.timeouts += s.timeouts;
+		total.max_ns = std::max(total.max_ns, s.max_ns);
+	}
+
+	if (opt.json) report_json(opt, total, histogram, elapsed);
+	else report_text(opt, total, histogram, elapsed);
+
+	if (server) {
+		serving = false;
+		server_thread.join();
+		server->stop();
+	}
+	return 0;
+}